@@ -628,6 +628,8 @@ generate_vs(struct draw_llvm_variant *variant,
                      NULL,
                      draw_sampler,
                      &llvm->draw->vs.vertex_shader->info,
+                     NULL,
+                     NULL,
                      NULL);
 
    {
@@ -1444,7 +1446,8 @@ static void
 draw_gs_llvm_emit_vertex(const struct lp_build_tgsi_gs_iface *gs_base,
                          struct lp_build_tgsi_context * bld_base,
                          LLVMValueRef (*outputs)[4],
-                         LLVMValueRef emitted_vertices_vec)
+                         LLVMValueRef emitted_vertices_vec,
+                         LLVMValueRef mask_vec)
 {
    const struct draw_gs_llvm_iface *gs_iface = draw_gs_llvm_iface(gs_base);
    struct draw_gs_llvm_variant *variant = gs_iface->variant;
@@ -1477,8 +1480,10 @@ draw_gs_llvm_emit_vertex(const struct lp_build_tgsi_gs_iface *gs_base,
 static void
 draw_gs_llvm_end_primitive(const struct lp_build_tgsi_gs_iface *gs_base,
                            struct lp_build_tgsi_context * bld_base,
+                           LLVMValueRef total_emitted_vertices_vec,
                            LLVMValueRef verts_per_prim_vec,
-                           LLVMValueRef emitted_prims_vec)
+                           LLVMValueRef emitted_prims_vec,
+                           LLVMValueRef mask_vec)
 {
    const struct draw_gs_llvm_iface *gs_iface = draw_gs_llvm_iface(gs_base);
    struct draw_gs_llvm_variant *variant = gs_iface->variant;
@@ -2237,7 +2242,9 @@ draw_gs_llvm_generate(struct draw_llvm *llvm,
                      NULL,
                      sampler,
                      &llvm->draw->gs.geometry_shader->info,
-                     (const struct lp_build_tgsi_gs_iface *)&gs_iface);
+                     (const struct lp_build_tgsi_gs_iface *)&gs_iface,
+                     NULL,
+                     NULL);
 
    sampler->destroy(sampler);
 
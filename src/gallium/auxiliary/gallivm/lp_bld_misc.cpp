@@ -187,6 +187,32 @@ lp_build_load_volatile(LLVMBuilderRef B, LLVMValueRef PointerVal,
 }
 
 
+/**
+ * Atomic compare and exchange, returning the previous value at PointerVal.
+ * The C API only exposes cmpxchg with LLVM 3.9.
+ */
+extern "C"
+LLVMValueRef
+lp_build_atomic_cmpxchg(LLVMBuilderRef B, LLVMValueRef PointerVal,
+                        LLVMValueRef Cmp, LLVMValueRef New)
+{
+   llvm::IRBuilder<> *Builder = llvm::unwrap(B);
+#if HAVE_LLVM >= 0x0305
+   llvm::Value *Res =
+      Builder->CreateAtomicCmpXchg(llvm::unwrap(PointerVal),
+                                   llvm::unwrap(Cmp), llvm::unwrap(New),
+                                   llvm::SequentiallyConsistent,
+                                   llvm::SequentiallyConsistent);
+   return llvm::wrap(Builder->CreateExtractValue(Res, 0));
+#else
+   return llvm::wrap(Builder->CreateAtomicCmpXchg(llvm::unwrap(PointerVal),
+                                                  llvm::unwrap(Cmp),
+                                                  llvm::unwrap(New),
+                                                  llvm::SequentiallyConsistent));
+#endif
+}
+
+
 extern "C"
 void
 lp_set_load_alignment(LLVMValueRef Inst,
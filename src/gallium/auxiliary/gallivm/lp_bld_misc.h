@@ -59,6 +59,10 @@ extern LLVMValueRef
 lp_build_load_volatile(LLVMBuilderRef B, LLVMValueRef PointerVal,
                        const char *Name);
 
+extern LLVMValueRef
+lp_build_atomic_cmpxchg(LLVMBuilderRef B, LLVMValueRef PointerVal,
+                        LLVMValueRef Cmp, LLVMValueRef New);
+
 extern int
 lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
                                         struct lp_generated_code **OutCode,
@@ -2019,10 +2019,48 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
 }
 
 
+/**
+ * Swizzle the row byte offset and the row of a pixel into their parts of
+ * the address in an image stored in Y-major tiles.  The tiles are 4KB,
+ * 128 bytes by 32 rows, made of 16 byte wide columns running down the tile,
+ * so the two parts still just add up.
+ *
+ * Only for 1x1 pixel blocks of at most 16 bytes, with y_stride (the pitch)
+ * a multiple of 128.
+ */
+static void
+lp_build_sample_tiled_offset(struct lp_build_context *bld,
+                             LLVMValueRef x_offset,
+                             LLVMValueRef y,
+                             LLVMValueRef y_stride,
+                             LLVMValueRef *out_x_offset,
+                             LLVMValueRef *out_y_offset)
+{
+   LLVMValueRef tile, column, byte;
+   LLVMValueRef tile_row, row;
+
+   tile = lp_build_shl_imm(bld, lp_build_shr_imm(bld, x_offset, 7), 12);
+   column = lp_build_and(bld, x_offset,
+                         lp_build_const_int_vec(bld->gallivm, bld->type, 0x70));
+   column = lp_build_shl_imm(bld, column, 5);
+   byte = lp_build_and(bld, x_offset,
+                       lp_build_const_int_vec(bld->gallivm, bld->type, 0xf));
+   *out_x_offset = lp_build_add(bld, lp_build_add(bld, tile, column), byte);
+
+   tile_row = lp_build_mul(bld, lp_build_shr_imm(bld, y, 5),
+                           lp_build_shl_imm(bld, y_stride, 5));
+   row = lp_build_and(bld, y,
+                      lp_build_const_int_vec(bld->gallivm, bld->type, 0x1f));
+   row = lp_build_shl_imm(bld, row, 4);
+   *out_y_offset = lp_build_add(bld, tile_row, row);
+}
+
+
 /**
  * Compute the offset of a pixel block.
  *
  * x, y, z, y_stride, z_stride are vectors, and they refer to pixels.
+ * If tiled, the images are stored in Y-major tiles.
  *
  * Returns the relative offset and i,j sub-block coordinates
  */
@@ -2034,6 +2072,7 @@ lp_build_sample_offset(struct lp_build_context *bld,
                        LLVMValueRef z,
                        LLVMValueRef y_stride,
                        LLVMValueRef z_stride,
+                       boolean tiled,
                        LLVMValueRef *out_offset,
                        LLVMValueRef *out_i,
                        LLVMValueRef *out_j)
@@ -2049,7 +2088,18 @@ lp_build_sample_offset(struct lp_build_context *bld,
                                   x, x_stride,
                                   &offset, out_i);
 
-   if (y && y_stride) {
+   if (tiled) {
+      LLVMValueRef y_offset;
+      assert(y && y_stride);
+      assert(format_desc->block.width == 1 &&
+             format_desc->block.height == 1 &&
+             format_desc->block.bits <= 128);
+      lp_build_sample_tiled_offset(bld, offset, y, y_stride,
+                                   &offset, &y_offset);
+      offset = lp_build_add(bld, offset, y_offset);
+      *out_j = bld->zero;
+   }
+   else if (y && y_stride) {
       LLVMValueRef y_offset;
       lp_build_sample_partial_offset(bld,
                                      format_desc->block.height,
@@ -801,6 +801,7 @@ lp_build_sample_image_nearest_afloat(struct lp_build_sample_context *bld,
                           x_icoord, y_icoord,
                           z_icoord,
                           row_stride_vec, img_stride_vec,
+                          bld->static_texture_state->tiled,
                           &offset,
                           &x_subcoord, &y_subcoord);
    if (mipoffsets) {
@@ -139,6 +139,7 @@ lp_build_sample_texel_soa(struct lp_build_sample_context *bld,
    lp_build_sample_offset(&bld->int_coord_bld,
                           bld->format_desc,
                           x, y, z, y_stride, z_stride,
+                          bld->static_texture_state->tiled,
                           &offset, &i, &j);
    if (mipoffsets) {
       offset = lp_build_add(&bld->int_coord_bld, offset, mipoffsets);
@@ -2376,6 +2377,7 @@ lp_build_fetch_texel(struct lp_build_sample_context *bld,
    lp_build_sample_offset(int_coord_bld,
                           bld->format_desc,
                           x, y, z, row_stride_vec, img_stride_vec,
+                          bld->static_texture_state->tiled,
                           &offset, &i, &j);
 
    if (bld->static_texture_state->target != PIPE_BUFFER) {
@@ -2803,6 +2805,8 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
             use_aos &= lp_is_simple_wrap_mode(derived_sampler_state.wrap_r);
          }
       }
+      /* the AoS path works out neighbour offsets from linear strides */
+      use_aos &= !static_texture_state->tiled;
       if ((static_texture_state->target == PIPE_TEXTURE_CUBE ||
            static_texture_state->target == PIPE_TEXTURE_CUBE_ARRAY) &&
           derived_sampler_state.seamless_cube_map &&
@@ -67,6 +67,8 @@ struct lp_build_mask_context;
 struct gallivm_state;
 struct lp_derivatives;
 struct lp_build_tgsi_gs_iface;
+struct lp_build_tgsi_cs_iface;
+struct lp_build_tgsi_tess_iface;
 
 
 enum lp_build_tex_modifier {
@@ -170,6 +172,21 @@ struct lp_bld_tgsi_system_values {
    LLVMValueRef prim_id;
    LLVMValueRef basevertex;
    LLVMValueRef invocation_id;
+
+   /* compute shader: thread_id is per lane, the others are uniform */
+   LLVMValueRef thread_id[3];
+   LLVMValueRef block_id[3];
+   LLVMValueRef grid_size[3];
+   LLVMValueRef block_size[3];
+
+   /* tessellation: tess_coord is per lane, the others are uniform */
+   LLVMValueRef vertices_in;
+   LLVMValueRef tess_coord[3];
+   LLVMValueRef tess_outer[4];
+   LLVMValueRef tess_inner[2];
+
+   /* fragment shader input coverage, per lane */
+   LLVMValueRef sample_mask_in;
 };
 
 
@@ -237,7 +254,9 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
                   LLVMValueRef thread_data_ptr,
                   struct lp_build_sampler_soa *sampler,
                   const struct tgsi_shader_info *info,
-                  const struct lp_build_tgsi_gs_iface *gs_iface);
+                  const struct lp_build_tgsi_gs_iface *gs_iface,
+                  struct lp_build_tgsi_cs_iface *cs_iface,
+                  const struct lp_build_tgsi_tess_iface *tess_iface);
 
 
 void
@@ -421,17 +440,87 @@ struct lp_build_tgsi_gs_iface
    void (*emit_vertex)(const struct lp_build_tgsi_gs_iface *gs_iface,
                        struct lp_build_tgsi_context * bld_base,
                        LLVMValueRef (*outputs)[4],
-                       LLVMValueRef emitted_vertices_vec);
+                       LLVMValueRef emitted_vertices_vec,
+                       LLVMValueRef mask_vec);
    void (*end_primitive)(const struct lp_build_tgsi_gs_iface *gs_iface,
                          struct lp_build_tgsi_context * bld_base,
+                         LLVMValueRef total_emitted_vertices_vec,
                          LLVMValueRef verts_per_prim_vec,
-                         LLVMValueRef emitted_prims_vec);
+                         LLVMValueRef emitted_prims_vec,
+                         LLVMValueRef mask_vec);
    void (*gs_epilogue)(const struct lp_build_tgsi_gs_iface *gs_iface,
                        struct lp_build_tgsi_context * bld_base,
                        LLVMValueRef total_emitted_vertices_vec,
                        LLVMValueRef emitted_prims_vec);
 };
 
+/**
+ * Compute shader code generation interface.
+ *
+ * Tessellation control shaders use barrier() and temps_ptr as well, their
+ * invocations of a patch synchronize like the threads of a group.
+ */
+struct lp_build_tgsi_cs_iface
+{
+   /* thread group shared memory (TGSI_FILE_MEMORY) and its size in bytes */
+   LLVMValueRef shared_ptr;
+   LLVMValueRef shared_size;
+
+   /* arrays of shader buffer (TGSI_FILE_BUFFER) pointers and byte sizes */
+   LLVMValueRef ssbo_ptr;
+   LLVMValueRef ssbo_sizes_ptr;
+
+   /* If set, the temporaries are kept here instead of in allocas, so they
+    * keep their values across barriers.  Updated by barrier().
+    */
+   LLVMValueRef temps_ptr;
+
+   /* Emits TGSI_OPCODE_BARRIER, which is only allowed outside of control
+    * flow.  Code emitted after it must only run once all threads of the
+    * group completed the code before, with the thread system values updated
+    * accordingly.
+    */
+   void (*barrier)(struct lp_build_tgsi_cs_iface *cs_iface,
+                   struct lp_build_tgsi_context *bld_base,
+                   struct lp_bld_tgsi_system_values *system_values);
+};
+
+/**
+ * Tessellation shader code generation interface.
+ *
+ * Inputs of tessellation control and evaluation shaders, and the outputs
+ * of control shaders, live in patch memory of the driver's choosing.
+ * vertex_index is NULL for per-patch registers.
+ */
+struct lp_build_tgsi_tess_iface
+{
+   LLVMValueRef (*fetch_input)(const struct lp_build_tgsi_tess_iface *tess_iface,
+                               struct lp_build_tgsi_context *bld_base,
+                               boolean is_vindex_indirect,
+                               LLVMValueRef vertex_index,
+                               boolean is_aindex_indirect,
+                               LLVMValueRef attrib_index,
+                               LLVMValueRef swizzle_index);
+
+   /* control shaders only, NULL otherwise */
+   LLVMValueRef (*fetch_output)(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                struct lp_build_tgsi_context *bld_base,
+                                boolean is_vindex_indirect,
+                                LLVMValueRef vertex_index,
+                                boolean is_aindex_indirect,
+                                LLVMValueRef attrib_index,
+                                LLVMValueRef swizzle_index);
+   void (*store_output)(const struct lp_build_tgsi_tess_iface *tess_iface,
+                        struct lp_build_tgsi_context *bld_base,
+                        boolean is_vindex_indirect,
+                        LLVMValueRef vertex_index,
+                        boolean is_aindex_indirect,
+                        LLVMValueRef attrib_index,
+                        LLVMValueRef swizzle_index,
+                        LLVMValueRef value,
+                        LLVMValueRef mask_vec);
+};
+
 struct lp_build_tgsi_soa_context
 {
    struct lp_build_tgsi_context bld_base;
@@ -445,6 +534,10 @@ struct lp_build_tgsi_soa_context
    LLVMValueRef emitted_vertices_vec_ptr;
    LLVMValueRef max_output_vertices_vec;
 
+   struct lp_build_tgsi_cs_iface *cs_iface;
+
+   const struct lp_build_tgsi_tess_iface *tess_iface;
+
    LLVMValueRef consts_ptr;
    LLVMValueRef const_sizes_ptr;
    LLVMValueRef consts[LP_MAX_TGSI_CONST_BUFFERS];
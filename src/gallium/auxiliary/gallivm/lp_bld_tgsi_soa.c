@@ -65,6 +65,7 @@
 #include "lp_bld_printf.h"
 #include "lp_bld_sample.h"
 #include "lp_bld_struct.h"
+#include "lp_bld_misc.h"
 
 /* SM 4.0 says that subroutines can nest 32 deep and 
  * we need one more for our main function */
@@ -102,6 +103,9 @@ emit_dump_reg(struct gallivm_state *gallivm,
    lp_build_print_value(gallivm, buf, value);
 }
 
+static LLVMValueRef
+mask_vec(struct lp_build_tgsi_context *bld_base);
+
 /*
  * Return the context for the current function.
  * (always 'main', if shader doesn't do any function calls)
@@ -1083,14 +1087,14 @@ emit_mask_scatter(struct lp_build_tgsi_soa_context *bld,
 
 /**
  * Read the current value of the ADDR register, convert the floats to
- * ints, add the base index and return the vector of offsets.
- * The offsets will be used to index into the constant buffer or
- * temporary register file.
+ * ints, add the base index and return the vector of offsets, clamped to
+ * index_limit unless that is negative.
  */
 static LLVMValueRef
-get_indirect_index(struct lp_build_tgsi_soa_context *bld,
-                   unsigned reg_file, unsigned reg_index,
-                   const struct tgsi_ind_register *indirect_reg)
+get_indirect_index_limit(struct lp_build_tgsi_soa_context *bld,
+                         unsigned reg_index,
+                         const struct tgsi_ind_register *indirect_reg,
+                         int index_limit)
 {
    LLVMBuilderRef builder = bld->bld_base.base.gallivm->builder;
    struct lp_build_context *uint_bld = &bld->bld_base.uint_bld;
@@ -1101,8 +1105,6 @@ get_indirect_index(struct lp_build_tgsi_soa_context *bld,
    LLVMValueRef max_index;
    LLVMValueRef index;
 
-   assert(bld->indirect_files & (1 << reg_file));
-
    base = lp_build_const_int_vec(bld->bld_base.base.gallivm, uint_bld->type, reg_index);
 
    assert(swizzle < 4);
@@ -1127,6 +1129,29 @@ get_indirect_index(struct lp_build_tgsi_soa_context *bld,
 
    index = lp_build_add(uint_bld, base, rel);
 
+   if (index_limit >= 0) {
+      max_index = lp_build_const_int_vec(bld->bld_base.base.gallivm,
+                                         uint_bld->type, index_limit);
+
+      assert(!uint_bld->type.sign);
+      index = lp_build_min(uint_bld, index, max_index);
+   }
+
+   return index;
+}
+
+/**
+ * Indirect offsets into a register file.
+ * The offsets will be used to index into the constant buffer or
+ * temporary register file.
+ */
+static LLVMValueRef
+get_indirect_index(struct lp_build_tgsi_soa_context *bld,
+                   unsigned reg_file, unsigned reg_index,
+                   const struct tgsi_ind_register *indirect_reg)
+{
+   assert(bld->indirect_files & (1 << reg_file));
+
    /*
     * emit_fetch_constant handles constant buffer overflow so this code
     * is pointless for them.
@@ -1136,16 +1161,9 @@ get_indirect_index(struct lp_build_tgsi_soa_context *bld,
     * to return incorrect data (not necessarily 0) for indices that are
     * larger than the declared size but smaller than the buffer size.
     */
-   if (reg_file != TGSI_FILE_CONSTANT) {
-      max_index = lp_build_const_int_vec(bld->bld_base.base.gallivm,
-                                         uint_bld->type,
-                                         bld->bld_base.info->file_max[reg_file]);
-
-      assert(!uint_bld->type.sign);
-      index = lp_build_min(uint_bld, index, max_index);
-   }
-
-   return index;
+   return get_indirect_index_limit(bld, reg_index, indirect_reg,
+                                   reg_file != TGSI_FILE_CONSTANT ?
+                                   bld->bld_base.info->file_max[reg_file] : -1);
 }
 
 static struct lp_build_context *
@@ -1568,6 +1586,102 @@ emit_fetch_gs_input(
    return res;
 }
 
+/**
+ * Register fetch through the tessellation interface.  Per-vertex registers
+ * are two dimensional, the vertex index is bounded by the driver.
+ */
+static LLVMValueRef
+emit_fetch_tess_reg(
+   struct lp_build_tgsi_context * bld_base,
+   const struct tgsi_full_src_register * reg,
+   enum tgsi_opcode_type stype,
+   unsigned swizzle,
+   LLVMValueRef (*fetch)(const struct lp_build_tgsi_tess_iface *,
+                         struct lp_build_tgsi_context *,
+                         boolean, LLVMValueRef,
+                         boolean, LLVMValueRef,
+                         LLVMValueRef))
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef attrib_index = NULL;
+   LLVMValueRef vertex_index = NULL;
+   LLVMValueRef swizzle_index = lp_build_const_int32(gallivm, swizzle);
+   boolean is_vindex_indirect = FALSE;
+   LLVMValueRef res;
+
+   if (reg->Register.Indirect) {
+      attrib_index = get_indirect_index(bld,
+                                        reg->Register.File,
+                                        reg->Register.Index,
+                                        &reg->Indirect);
+   } else {
+      attrib_index = lp_build_const_int32(gallivm, reg->Register.Index);
+   }
+
+   if (reg->Register.Dimension) {
+      is_vindex_indirect = reg->Dimension.Indirect;
+      if (reg->Dimension.Indirect) {
+         vertex_index = get_indirect_index_limit(bld,
+                                                 reg->Dimension.Index,
+                                                 &reg->DimIndirect,
+                                                 -1);
+      } else {
+         vertex_index = lp_build_const_int32(gallivm, reg->Dimension.Index);
+      }
+   }
+
+   res = fetch(bld->tess_iface, bld_base,
+               is_vindex_indirect, vertex_index,
+               reg->Register.Indirect, attrib_index,
+               swizzle_index);
+
+   assert(res);
+   if (stype == TGSI_TYPE_DOUBLE) {
+      LLVMValueRef swizzle_index = lp_build_const_int32(gallivm, swizzle + 1);
+      LLVMValueRef res2;
+      res2 = fetch(bld->tess_iface, bld_base,
+                   is_vindex_indirect, vertex_index,
+                   reg->Register.Indirect, attrib_index,
+                   swizzle_index);
+      assert(res2);
+      res = emit_fetch_double(bld_base, stype, res, res2);
+   } else if (stype == TGSI_TYPE_UNSIGNED) {
+      res = LLVMBuildBitCast(builder, res, bld_base->uint_bld.vec_type, "");
+   } else if (stype == TGSI_TYPE_SIGNED) {
+      res = LLVMBuildBitCast(builder, res, bld_base->int_bld.vec_type, "");
+   }
+
+   return res;
+}
+
+static LLVMValueRef
+emit_fetch_tess_input(
+   struct lp_build_tgsi_context * bld_base,
+   const struct tgsi_full_src_register * reg,
+   enum tgsi_opcode_type stype,
+   unsigned swizzle)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+
+   return emit_fetch_tess_reg(bld_base, reg, stype, swizzle,
+                              bld->tess_iface->fetch_input);
+}
+
+static LLVMValueRef
+emit_fetch_tess_output(
+   struct lp_build_tgsi_context * bld_base,
+   const struct tgsi_full_src_register * reg,
+   enum tgsi_opcode_type stype,
+   unsigned swizzle)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+
+   return emit_fetch_tess_reg(bld_base, reg, stype, swizzle,
+                              bld->tess_iface->fetch_output);
+}
+
 static LLVMValueRef
 emit_fetch_temporary(
    struct lp_build_tgsi_context * bld_base,
@@ -1678,6 +1792,67 @@ emit_fetch_system_value(
       atype = TGSI_TYPE_UNSIGNED;
       break;
 
+   case TGSI_SEMANTIC_THREAD_ID:
+      res = swizzle < 3 ? bld->system_values.thread_id[swizzle] :
+                          bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_BLOCK_ID:
+      res = swizzle < 3 ?
+         lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                   bld->system_values.block_id[swizzle]) :
+         bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_GRID_SIZE:
+      res = swizzle < 3 ?
+         lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                   bld->system_values.grid_size[swizzle]) :
+         bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_BLOCK_SIZE:
+      res = swizzle < 3 ?
+         lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                   bld->system_values.block_size[swizzle]) :
+         bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_VERTICESIN:
+      res = lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                      bld->system_values.vertices_in);
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_TESSCOORD:
+      res = swizzle < 3 ? bld->system_values.tess_coord[swizzle] :
+                          bld_base->base.zero;
+      atype = TGSI_TYPE_FLOAT;
+      break;
+
+   case TGSI_SEMANTIC_TESSOUTER:
+      res = lp_build_broadcast_scalar(&bld_base->base,
+                                      bld->system_values.tess_outer[swizzle]);
+      atype = TGSI_TYPE_FLOAT;
+      break;
+
+   case TGSI_SEMANTIC_TESSINNER:
+      res = swizzle < 2 ?
+         lp_build_broadcast_scalar(&bld_base->base,
+                                   bld->system_values.tess_inner[swizzle]) :
+         bld_base->base.zero;
+      atype = TGSI_TYPE_FLOAT;
+      break;
+
+   case TGSI_SEMANTIC_SAMPLEMASK:
+      res = bld->system_values.sample_mask_in;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
    default:
       assert(!"unexpected semantic in emit_fetch_system_value");
       res = bld_base->base.zero;
@@ -1891,7 +2066,38 @@ emit_store_chan(
       /* Outputs are always stored as floats */
       value = LLVMBuildBitCast(builder, value, float_bld->vec_type, "");
 
-      if (reg->Register.Indirect) {
+      if (bld->tess_iface && bld->tess_iface->store_output) {
+         LLVMValueRef attrib_index = indirect_index;
+         LLVMValueRef vertex_index = NULL;
+         LLVMValueRef mask = mask_vec(bld_base);
+
+         assert(dtype != TGSI_TYPE_DOUBLE);
+         if (!reg->Register.Indirect)
+            attrib_index = lp_build_const_int32(gallivm, reg->Register.Index);
+         if (reg->Register.Dimension) {
+            if (reg->Dimension.Indirect)
+               vertex_index = get_indirect_index_limit(bld,
+                                                       reg->Dimension.Index,
+                                                       &reg->DimIndirect,
+                                                       -1);
+            else
+               vertex_index = lp_build_const_int32(gallivm,
+                                                   reg->Dimension.Index);
+         }
+         if (pred) {
+            pred = LLVMBuildBitCast(builder, pred, int_bld->vec_type, "");
+            mask = LLVMBuildAnd(builder, mask, pred, "");
+         }
+
+         bld->tess_iface->store_output(bld->tess_iface, bld_base,
+                                       reg->Dimension.Indirect,
+                                       vertex_index,
+                                       reg->Register.Indirect,
+                                       attrib_index,
+                                       lp_build_const_int32(gallivm, chan_index),
+                                       value, mask);
+      }
+      else if (reg->Register.Indirect) {
          LLVMValueRef index_vec;  /* indexes into the output registers */
          LLVMValueRef outputs_array;
          LLVMTypeRef fptr_type;
@@ -2028,6 +2234,12 @@ emit_store(
    unsigned chan_index;
    struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
    enum tgsi_opcode_type dtype = tgsi_opcode_infer_dst_type(inst->Instruction.Opcode);
+
+   /* STORE writes to memory itself, there is no register to update */
+   if (inst->Dst[0].Register.File == TGSI_FILE_BUFFER ||
+       inst->Dst[0].Register.File == TGSI_FILE_MEMORY)
+      return;
+
    if(info->num_dst) {
       LLVMValueRef pred[TGSI_NUM_CHANNELS];
 
@@ -3452,7 +3664,8 @@ emit_vertex(
       gather_outputs(bld);
       bld->gs_iface->emit_vertex(bld->gs_iface, &bld->bld_base,
                                  bld->outputs,
-                                 total_emitted_vertices_vec);
+                                 total_emitted_vertices_vec,
+                                 mask);
       increment_vec_ptr_by_mask(bld_base, bld->emitted_vertices_vec_ptr,
                                 mask);
       increment_vec_ptr_by_mask(bld_base, bld->total_emitted_vertices_vec_ptr,
@@ -3478,6 +3691,8 @@ end_primitive_masked(struct lp_build_tgsi_context * bld_base,
 
    if (bld->gs_iface->end_primitive) {
       struct lp_build_context *uint_bld = &bld_base->uint_bld;
+      LLVMValueRef total_emitted_vertices_vec =
+         LLVMBuildLoad(builder, bld->total_emitted_vertices_vec_ptr, "");
       LLVMValueRef emitted_vertices_vec =
          LLVMBuildLoad(builder, bld->emitted_vertices_vec_ptr, "");
       LLVMValueRef emitted_prims_vec =
@@ -3493,8 +3708,10 @@ end_primitive_masked(struct lp_build_tgsi_context * bld_base,
       mask = LLVMBuildAnd(builder, mask, emitted_mask, "");
 
       bld->gs_iface->end_primitive(bld->gs_iface, &bld->bld_base,
+                                   total_emitted_vertices_vec,
                                    emitted_vertices_vec,
-                                   emitted_prims_vec);
+                                   emitted_prims_vec,
+                                   mask);
 
 #if DUMP_GS_EMITS
       lp_build_print_value(bld->bld_base.base.gallivm,
@@ -3536,6 +3753,342 @@ end_primitive(
    }
 }
 
+/**
+ * Get a dword pointer to the shader buffer or shared memory accessed by a
+ * memory instruction, and its size in bytes.
+ */
+static void
+get_memory_ptr(struct lp_build_tgsi_soa_context * bld,
+               unsigned file,
+               unsigned index,
+               LLVMValueRef *ptr,
+               LLVMValueRef *size)
+{
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+   LLVMTypeRef ptr_type =
+      LLVMPointerType(LLVMInt32TypeInContext(gallivm->context), 0);
+
+   if (file == TGSI_FILE_MEMORY) {
+      *ptr = bld->cs_iface->shared_ptr;
+      *size = bld->cs_iface->shared_size;
+   }
+   else {
+      LLVMValueRef lindex = lp_build_const_int32(gallivm, index);
+
+      assert(file == TGSI_FILE_BUFFER);
+      *ptr = lp_build_array_get(gallivm, bld->cs_iface->ssbo_ptr, lindex);
+      *size = lp_build_array_get(gallivm, bld->cs_iface->ssbo_sizes_ptr,
+                                 lindex);
+   }
+   *ptr = LLVMBuildBitCast(gallivm->builder, *ptr, ptr_type, "");
+}
+
+/**
+ * Begin a loop over the lanes of the execution mask, executing its body
+ * for active lanes only.  Memory is accessed one lane at a time, so that
+ * inactive lanes and out of bounds addresses never touch it.
+ */
+static void
+mem_loop_begin(struct lp_build_tgsi_context * bld_base,
+               struct lp_build_loop_state *loop,
+               struct lp_build_if_state *active)
+{
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef exec_mask = mask_vec(bld_base);
+   LLVMValueRef cond;
+
+   lp_build_loop_begin(loop, gallivm, lp_build_const_int32(gallivm, 0));
+   cond = LLVMBuildExtractElement(builder, exec_mask, loop->counter, "");
+   cond = LLVMBuildICmp(builder, LLVMIntNE, cond,
+                        lp_build_const_int32(gallivm, 0), "");
+   lp_build_if(active, gallivm, cond);
+}
+
+static void
+mem_loop_end(struct lp_build_tgsi_context * bld_base,
+             struct lp_build_loop_state *loop,
+             struct lp_build_if_state *active)
+{
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+
+   lp_build_endif(active);
+   lp_build_loop_end_cond(loop,
+                          lp_build_const_int32(gallivm,
+                                               bld_base->base.type.length),
+                          NULL, LLVMIntUGE);
+}
+
+/**
+ * Begin a conditional on the dword at the given byte offset lying within
+ * size bytes, returning a pointer to the dword.
+ */
+static LLVMValueRef
+mem_dword_begin(struct gallivm_state *gallivm,
+                LLVMValueRef base,
+                LLVMValueRef size,
+                LLVMValueRef offset,
+                struct lp_build_if_state *inbounds)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef end, cond, index;
+
+   end = LLVMBuildAdd(builder, offset, lp_build_const_int32(gallivm, 4), "");
+   cond = LLVMBuildICmp(builder, LLVMIntULE, end, size, "");
+   lp_build_if(inbounds, gallivm, cond);
+
+   index = LLVMBuildLShr(builder, offset, lp_build_const_int32(gallivm, 2), "");
+   return LLVMBuildGEP(builder, base, &index, 1, "");
+}
+
+static void
+load_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   struct lp_build_context *uint_bld = &bld_base->uint_bld;
+   LLVMValueRef result[TGSI_NUM_CHANNELS];
+   LLVMValueRef base, size, offsets, offset;
+   struct lp_build_loop_state loop;
+   struct lp_build_if_state active, inbounds;
+   unsigned chan;
+
+   assert(!inst->Src[0].Register.Indirect);
+   get_memory_ptr(bld, inst->Src[0].Register.File, inst->Src[0].Register.Index,
+                  &base, &size);
+   offsets = lp_build_emit_fetch(bld_base, inst, 1, TGSI_CHAN_X);
+   offsets = LLVMBuildBitCast(builder, offsets, uint_bld->vec_type, "");
+
+   /* out of bounds reads return zero */
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      result[chan] = lp_build_alloca(gallivm, uint_bld->vec_type, "");
+   }
+
+   mem_loop_begin(bld_base, &loop, &active);
+   offset = LLVMBuildExtractElement(builder, offsets, loop.counter, "");
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      LLVMValueRef chan_offset, ptr, value, res;
+
+      chan_offset = LLVMBuildAdd(builder, offset,
+                                 lp_build_const_int32(gallivm, chan * 4), "");
+      ptr = mem_dword_begin(gallivm, base, size, chan_offset, &inbounds);
+      value = LLVMBuildLoad(builder, ptr, "");
+      res = LLVMBuildLoad(builder, result[chan], "");
+      res = LLVMBuildInsertElement(builder, res, value, loop.counter, "");
+      LLVMBuildStore(builder, res, result[chan]);
+      lp_build_endif(&inbounds);
+   }
+   mem_loop_end(bld_base, &loop, &active);
+
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      emit_data->output[chan] =
+         LLVMBuildBitCast(builder, LLVMBuildLoad(builder, result[chan], ""),
+                          bld_base->base.vec_type, "");
+   }
+}
+
+static void
+store_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   struct lp_build_context *uint_bld = &bld_base->uint_bld;
+   LLVMValueRef values[TGSI_NUM_CHANNELS];
+   LLVMValueRef base, size, offsets, offset;
+   struct lp_build_loop_state loop;
+   struct lp_build_if_state active, inbounds;
+   unsigned chan;
+
+   assert(!inst->Dst[0].Register.Indirect);
+   get_memory_ptr(bld, inst->Dst[0].Register.File, inst->Dst[0].Register.Index,
+                  &base, &size);
+   offsets = lp_build_emit_fetch(bld_base, inst, 0, TGSI_CHAN_X);
+   offsets = LLVMBuildBitCast(builder, offsets, uint_bld->vec_type, "");
+
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      values[chan] = lp_build_emit_fetch(bld_base, inst, 1, chan);
+      values[chan] = LLVMBuildBitCast(builder, values[chan],
+                                      uint_bld->vec_type, "");
+   }
+
+   /* out of bounds writes are discarded */
+   mem_loop_begin(bld_base, &loop, &active);
+   offset = LLVMBuildExtractElement(builder, offsets, loop.counter, "");
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      LLVMValueRef chan_offset, ptr, value;
+
+      chan_offset = LLVMBuildAdd(builder, offset,
+                                 lp_build_const_int32(gallivm, chan * 4), "");
+      ptr = mem_dword_begin(gallivm, base, size, chan_offset, &inbounds);
+      value = LLVMBuildExtractElement(builder, values[chan], loop.counter, "");
+      LLVMBuildStore(builder, value, ptr);
+      lp_build_endif(&inbounds);
+   }
+   mem_loop_end(bld_base, &loop, &active);
+}
+
+static void
+atomic_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   struct lp_build_context *uint_bld = &bld_base->uint_bld;
+   LLVMValueRef base, size, offsets, values, cmps = NULL;
+   LLVMValueRef result, offset, ptr, value, old, res;
+   LLVMAtomicRMWBinOp op = LLVMAtomicRMWBinOpAdd;
+   struct lp_build_loop_state loop;
+   struct lp_build_if_state active, inbounds;
+   unsigned chan;
+
+   switch (inst->Instruction.Opcode) {
+   case TGSI_OPCODE_ATOMUADD:
+      op = LLVMAtomicRMWBinOpAdd;
+      break;
+   case TGSI_OPCODE_ATOMXCHG:
+      op = LLVMAtomicRMWBinOpXchg;
+      break;
+   case TGSI_OPCODE_ATOMAND:
+      op = LLVMAtomicRMWBinOpAnd;
+      break;
+   case TGSI_OPCODE_ATOMOR:
+      op = LLVMAtomicRMWBinOpOr;
+      break;
+   case TGSI_OPCODE_ATOMXOR:
+      op = LLVMAtomicRMWBinOpXor;
+      break;
+   case TGSI_OPCODE_ATOMUMIN:
+      op = LLVMAtomicRMWBinOpUMin;
+      break;
+   case TGSI_OPCODE_ATOMUMAX:
+      op = LLVMAtomicRMWBinOpUMax;
+      break;
+   case TGSI_OPCODE_ATOMIMIN:
+      op = LLVMAtomicRMWBinOpMin;
+      break;
+   case TGSI_OPCODE_ATOMIMAX:
+      op = LLVMAtomicRMWBinOpMax;
+      break;
+   case TGSI_OPCODE_ATOMCAS:
+      break;
+   default:
+      assert(0);
+      break;
+   }
+
+   assert(!inst->Src[0].Register.Indirect);
+   get_memory_ptr(bld, inst->Src[0].Register.File, inst->Src[0].Register.Index,
+                  &base, &size);
+   offsets = lp_build_emit_fetch(bld_base, inst, 1, TGSI_CHAN_X);
+   offsets = LLVMBuildBitCast(builder, offsets, uint_bld->vec_type, "");
+   if (inst->Instruction.Opcode == TGSI_OPCODE_ATOMCAS) {
+      cmps = lp_build_emit_fetch(bld_base, inst, 2, TGSI_CHAN_X);
+      cmps = LLVMBuildBitCast(builder, cmps, uint_bld->vec_type, "");
+      values = lp_build_emit_fetch(bld_base, inst, 3, TGSI_CHAN_X);
+   }
+   else {
+      values = lp_build_emit_fetch(bld_base, inst, 2, TGSI_CHAN_X);
+   }
+   values = LLVMBuildBitCast(builder, values, uint_bld->vec_type, "");
+
+   result = lp_build_alloca(gallivm, uint_bld->vec_type, "");
+
+   mem_loop_begin(bld_base, &loop, &active);
+   offset = LLVMBuildExtractElement(builder, offsets, loop.counter, "");
+   ptr = mem_dword_begin(gallivm, base, size, offset, &inbounds);
+   value = LLVMBuildExtractElement(builder, values, loop.counter, "");
+   if (cmps) {
+      LLVMValueRef cmp =
+         LLVMBuildExtractElement(builder, cmps, loop.counter, "");
+      old = lp_build_atomic_cmpxchg(builder, ptr, cmp, value);
+   }
+   else {
+      old = LLVMBuildAtomicRMW(builder, op, ptr, value,
+                               LLVMAtomicOrderingSequentiallyConsistent,
+                               FALSE);
+   }
+   res = LLVMBuildLoad(builder, result, "");
+   res = LLVMBuildInsertElement(builder, res, old, loop.counter, "");
+   LLVMBuildStore(builder, res, result);
+   lp_build_endif(&inbounds);
+   mem_loop_end(bld_base, &loop, &active);
+
+   /* the previous value is returned in all channels */
+   res = LLVMBuildBitCast(builder, LLVMBuildLoad(builder, result, ""),
+                          bld_base->base.vec_type, "");
+   for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+      emit_data->output[chan] = res;
+   }
+}
+
+static void
+resq_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   LLVMBuilderRef builder = bld_base->base.gallivm->builder;
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   LLVMValueRef base, size;
+   unsigned chan;
+
+   assert(!inst->Src[0].Register.Indirect);
+   get_memory_ptr(bld, inst->Src[0].Register.File, inst->Src[0].Register.Index,
+                  &base, &size);
+
+   size = lp_build_broadcast_scalar(&bld_base->uint_bld, size);
+   emit_data->output[TGSI_CHAN_X] =
+      LLVMBuildBitCast(builder, size, bld_base->base.vec_type, "");
+   for (chan = TGSI_CHAN_Y; chan < TGSI_NUM_CHANNELS; chan++) {
+      emit_data->output[chan] = bld_base->base.zero;
+   }
+}
+
+static void
+barrier_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+
+   /* the thread group is split into SIMD chunks, which the interface can
+    * only synchronize between straight-line pieces of the shader */
+   assert(!bld->exec_mask.has_mask);
+   assert(bld->exec_mask.function_stack_size == 1);
+
+   bld->cs_iface->barrier(bld->cs_iface, bld_base, &bld->system_values);
+   if (bld->cs_iface->temps_ptr) {
+      bld->temps_array = bld->cs_iface->temps_ptr;
+   }
+}
+
+static void
+membar_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   /* A thread group runs on a single worker thread, in order, so there is
+    * nothing to wait for.
+    */
+}
+
 static void
 cal_emit(
    const struct lp_build_tgsi_action * action,
@@ -3743,7 +4296,11 @@ static void emit_prologue(struct lp_build_tgsi_context * bld_base)
    struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
    struct gallivm_state * gallivm = bld_base->base.gallivm;
 
-   if (bld->indirect_files & (1 << TGSI_FILE_TEMPORARY)) {
+   if (bld->cs_iface && bld->cs_iface->temps_ptr) {
+      assert(bld->indirect_files & (1 << TGSI_FILE_TEMPORARY));
+      bld->temps_array = bld->cs_iface->temps_ptr;
+   }
+   else if (bld->indirect_files & (1 << TGSI_FILE_TEMPORARY)) {
       LLVMValueRef array_size =
          lp_build_const_int32(gallivm,
                          bld_base->info->file_max[TGSI_FILE_TEMPORARY] * 4 + 4);
@@ -3772,7 +4329,8 @@ static void emit_prologue(struct lp_build_tgsi_context * bld_base)
 
    /* If we have indirect addressing in inputs we need to copy them into
     * our alloca array to be able to iterate over them */
-   if (bld->indirect_files & (1 << TGSI_FILE_INPUT) && !bld->gs_iface) {
+   if (bld->indirect_files & (1 << TGSI_FILE_INPUT) &&
+       !bld->gs_iface && !bld->tess_iface) {
       unsigned index, chan;
       LLVMTypeRef vec_type = bld_base->base.vec_type;
       LLVMValueRef array_size = lp_build_const_int32(gallivm,
@@ -3824,7 +4382,7 @@ static void emit_prologue(struct lp_build_tgsi_context * bld_base)
    if (DEBUG_EXECUTION) {
       lp_build_printf(gallivm, "\n");
       emit_dump_file(bld, TGSI_FILE_CONSTANT);
-      if (!bld->gs_iface)
+      if (!bld->gs_iface && !bld->tess_iface)
          emit_dump_file(bld, TGSI_FILE_INPUT);
    }
 }
@@ -3881,7 +4439,9 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
                   LLVMValueRef thread_data_ptr,
                   struct lp_build_sampler_soa *sampler,
                   const struct tgsi_shader_info *info,
-                  const struct lp_build_tgsi_gs_iface *gs_iface)
+                  const struct lp_build_tgsi_gs_iface *gs_iface,
+                  struct lp_build_tgsi_cs_iface *cs_iface,
+                  const struct lp_build_tgsi_tess_iface *tess_iface)
 {
    struct lp_build_tgsi_soa_context bld;
 
@@ -4022,6 +4582,40 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
                                 max_output_vertices);
    }
 
+   if (cs_iface) {
+      bld.cs_iface = cs_iface;
+      if (cs_iface->temps_ptr) {
+         bld.indirect_files |= (1 << TGSI_FILE_TEMPORARY);
+      }
+      bld.bld_base.op_actions[TGSI_OPCODE_LOAD].emit = load_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_STORE].emit = store_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMUADD].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMXCHG].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMCAS].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMAND].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMOR].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMXOR].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMUMIN].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMUMAX].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMIMIN].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_ATOMIMAX].emit = atomic_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_RESQ].emit = resq_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_BARRIER].emit = barrier_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_MEMBAR].emit = membar_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_MFENCE].emit = membar_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_LFENCE].emit = membar_emit;
+      bld.bld_base.op_actions[TGSI_OPCODE_SFENCE].emit = membar_emit;
+   }
+
+   if (tess_iface) {
+      bld.tess_iface = tess_iface;
+      bld.bld_base.emit_fetch_funcs[TGSI_FILE_INPUT] = emit_fetch_tess_input;
+      if (tess_iface->fetch_output) {
+         bld.bld_base.emit_fetch_funcs[TGSI_FILE_OUTPUT] =
+            emit_fetch_tess_output;
+      }
+   }
+
    lp_exec_mask_init(&bld.exec_mask, &bld.bld_base.int_bld);
 
    bld.system_values = *system_values;
@@ -166,6 +166,7 @@ fd_screen_get_param(struct pipe_screen *pscreen, enum pipe_cap param)
 	case PIPE_CAP_TEXTURE_MIRROR_CLAMP:
 	case PIPE_CAP_COMPUTE:
 	case PIPE_CAP_QUERY_MEMORY_INFO:
+	case PIPE_CAP_CONSERVATIVE_RASTER:
 		return 0;
 
 	case PIPE_CAP_SM3:
@@ -355,6 +355,7 @@ static int si_get_param(struct pipe_screen* pscreen, enum pipe_cap param)
 	case PIPE_CAP_GENERATE_MIPMAP:
 	case PIPE_CAP_STRING_MARKER:
 	case PIPE_CAP_QUERY_BUFFER_OBJECT:
+	case PIPE_CAP_CONSERVATIVE_RASTER:
 		return 0;
 
 	case PIPE_CAP_MAX_SHADER_PATCH_VARYINGS:
@@ -74,6 +74,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 typedef void			VOID;
 typedef void*           LPVOID;
@@ -216,6 +217,33 @@ typedef MEGABYTE    GIGABYTE[1024];
 #define OSALIGNSIMD(RWORD) OSALIGN(RWORD, 32)
 #endif
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Allocates memory for large surfaces and slabs. Allocations of at
+///        least KNOB_HUGE_PAGE_SIZE are rounded up to whole huge pages and
+///        aligned to them, and on Linux advised to be backed by transparent
+///        huge pages. Falls back to a plain aligned allocation. Free with
+///        _aligned_free.
+/// @param size - size in bytes
+/// @param alignment - alignment if not placed on huge pages
+inline
+void *AlignedMallocHuge(size_t size, size_t alignment)
+{
+    if (size >= KNOB_HUGE_PAGE_SIZE)
+    {
+        size_t hugeSize = (size + KNOB_HUGE_PAGE_SIZE - 1) & ~(size_t)(KNOB_HUGE_PAGE_SIZE - 1);
+        void *p = _aligned_malloc(hugeSize, KNOB_HUGE_PAGE_SIZE);
+        if (p)
+        {
+#if defined(MADV_HUGEPAGE)
+            // only a hint, without THP the pages are just small ones
+            madvise(p, hugeSize, MADV_HUGEPAGE);
+#endif
+            return p;
+        }
+    }
+    return _aligned_malloc(size, alignment);
+}
+
 #include "common/swr_assert.h"
 
 #endif//__SWR_OS_H__
@@ -63,6 +63,7 @@ OSALIGNSIMD(union) simdvector
 #define _simd_blend_ps	_mm256_blend_ps
 #define _simd_blendv_ps _mm256_blendv_ps
 #define _simd_store_ps _mm256_store_ps
+#define _simd_storeu_ps _mm256_storeu_ps
 #define _simd_mul_ps _mm256_mul_ps
 #define _simd_add_ps _mm256_add_ps
 #define _simd_sub_ps _mm256_sub_ps
@@ -305,6 +306,7 @@ int _simdemu_movemask_epi8(__m256i a)
 #define _simd_setzero_si _mm256_setzero_si256
 #define _simd_cvttps_epi32 _mm256_cvttps_epi32
 #define _simd_store_si _mm256_store_si256
+#define _simd_storeu_si _mm256_storeu_si256
 #define _simd_broadcast_ss _mm256_broadcast_ss
 #define _simd_maskstore_ps _mm256_maskstore_ps
 #define _simd_load_si _mm256_load_si256
@@ -44,6 +44,8 @@
 #include "common/os.h"
 
 void SetupDefaultState(SWR_CONTEXT *pContext);
+void CopyState(SWR_CONTEXT *pContext, DRAW_STATE& dst, const DRAW_STATE& src);
+void ReleaseState(SWR_CONTEXT *pContext, API_STATE& state);
 
 //////////////////////////////////////////////////////////////////////////
 /// @brief Create SWR Context.
@@ -105,7 +107,7 @@ HANDLE SwrCreateContext(
     for (uint32_t i = 0; i < pContext->NumWorkerThreads; ++i)
     {
         ///@todo Use numa API for allocations using numa information from thread data (if exists).
-        pContext->pScratch[i] = (uint8_t*)_aligned_malloc((32 * 1024), KNOB_SIMD_WIDTH * 4);
+        pContext->pScratch[i] = (uint8_t*)_aligned_malloc(KNOB_MAX_TGSM_SIZE, KNOB_SIMD_WIDTH * 4);
     }
 
     pContext->nextDrawId = 1;
@@ -114,6 +116,15 @@ HANDLE SwrCreateContext(
     // State setup AFTER context is fully initialized
     SetupDefaultState(pContext);
 
+    // Inactive sub-contexts start out with the default state as well
+    if (pContext->subCtxSave)
+    {
+        for (uint32_t i = 0; i < pContext->numSubContexts; ++i)
+        {
+            CopyState(pContext, pContext->subCtxSave[i], *pContext->pCurDrawContext->pState);
+        }
+    }
+
     // initialize hot tile manager
     pContext->pHotTileMgr = new HotTileMgr();
 
@@ -124,6 +135,8 @@ HANDLE SwrCreateContext(
     pContext->pfnLoadTile = pCreateInfo->pfnLoadTile;
     pContext->pfnStoreTile = pCreateInfo->pfnStoreTile;
     pContext->pfnClearTile = pCreateInfo->pfnClearTile;
+    pContext->pfnLoadSurfaceTile = pCreateInfo->pfnLoadSurfaceTile;
+    pContext->pfnStoreSurfaceTile = pCreateInfo->pfnStoreSurfaceTile;
 
     return (HANDLE)pContext;
 }
@@ -133,9 +146,20 @@ void SwrDestroyContext(HANDLE hContext)
     SWR_CONTEXT *pContext = (SWR_CONTEXT*)hContext;
     DestroyThreadPool(pContext, &pContext->threadPool);
 
+    // return the state blocks to their pools
+    if (pContext->subCtxSave)
+    {
+        for (uint32_t i = 0; i < pContext->numSubContexts; ++i)
+        {
+            ReleaseState(pContext, pContext->subCtxSave[i].state);
+        }
+    }
+
     // free the fifos
     for (uint32_t i = 0; i < KNOB_MAX_DRAWS_IN_FLIGHT; ++i)
     {
+        ReleaseState(pContext, pContext->dsRing[i].state);
+
         delete pContext->dcRing[i].pArena;
         delete pContext->dsRing[i].pArena;
         delete(pContext->dcRing[i].pTileMgr);
@@ -158,9 +182,34 @@ void SwrDestroyContext(HANDLE hContext)
     _aligned_free((SWR_CONTEXT*)hContext);
 }
 
-void CopyState(DRAW_STATE& dst, const DRAW_STATE& src)
+//////////////////////////////////////////////////////////////////////////
+/// @brief Drops the references of an API state to its state blocks.
+void ReleaseState(SWR_CONTEXT *pContext, API_STATE& state)
+{
+    pContext->vertexBufferBlocks.Release(state.vertexBuffers);
+    pContext->viewportBlocks.Release(state.vp);
+    pContext->viewportMatrixBlocks.Release(state.vpMatrix);
+    pContext->scissorBlocks.Release(state.scissorRects);
+
+    state.vertexBuffers = nullptr;
+    state.vp = nullptr;
+    state.vpMatrix = nullptr;
+    state.scissorRects = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Copies API state.  State blocks are shared by reference instead
+///        of copied, until either state modifies them.
+void CopyState(SWR_CONTEXT *pContext, DRAW_STATE& dst, const DRAW_STATE& src)
 {
+    ReleaseState(pContext, dst.state);
+
     memcpy(&dst.state, &src.state, sizeof(API_STATE));
+
+    pContext->vertexBufferBlocks.AddRef(dst.state.vertexBuffers);
+    pContext->viewportBlocks.AddRef(dst.state.vp);
+    pContext->viewportMatrixBlocks.AddRef(dst.state.vpMatrix);
+    pContext->scissorBlocks.AddRef(dst.state.scissorRects);
 }
 
 void WakeAllThreads(SWR_CONTEXT *pContext)
@@ -221,7 +270,7 @@ void QueueDraw(SWR_CONTEXT *pContext)
 
         std::unordered_set<uint32_t> lockedTiles;
         uint64_t curDraw[2] = { pContext->pCurDrawContext->drawId, pContext->pCurDrawContext->drawId };
-        WorkOnFifoFE(pContext, 0, curDraw[0], 0);
+        WorkOnFifoFE(pContext, 0, curDraw[0], curDraw[1], 0);
         WorkOnFifoBE(pContext, 0, curDraw[1], lockedTiles);
 
         // restore csr
@@ -275,8 +324,14 @@ void QueueDispatch(SWR_CONTEXT *pContext)
     pContext->pCurDrawContext = nullptr;
 }
 
+static void CloseDrawBatch(SWR_CONTEXT *pContext);
+
 DRAW_CONTEXT* GetDrawContext(SWR_CONTEXT *pContext, bool isSplitDraw = false)
 {
+    // Any API call ends the draw batch, as it may change state the batched
+    // draws have to see.
+    CloseDrawBatch(pContext);
+
     RDTSC_START(APIGetDrawContext);
     // If current draw context is null then need to obtain a new draw context to use from ring.
     if (pContext->pCurDrawContext == nullptr)
@@ -308,10 +363,20 @@ DRAW_CONTEXT* GetDrawContext(SWR_CONTEXT *pContext, bool isSplitDraw = false)
             // draw can receive the state.
             if (isSplitDraw == false)
             {
-                CopyState(*pCurDrawContext->pState, *pPrevDrawContext->pState);
+                CopyState(pContext, *pCurDrawContext->pState, *pPrevDrawContext->pState);
 
                 stateArena.Reset(true);    // Reset memory.
+
+                // Carry the driver private state over as well, so drivers only
+                // need to update it when their state changed.
                 pCurDrawContext->pState->pPrivateState = nullptr;
+                if (pPrevDrawContext->pState->pPrivateState)
+                {
+                    pCurDrawContext->pState->pPrivateState =
+                        stateArena.AllocAligned(pContext->privateStateSize, KNOB_SIMD_WIDTH*sizeof(float));
+                    memcpy(pCurDrawContext->pState->pPrivateState,
+                        pPrevDrawContext->pState->pPrivateState, pContext->privateStateSize);
+                }
 
                 pContext->curStateId++;  // Progress state ring index forward.
             }
@@ -328,7 +393,18 @@ DRAW_CONTEXT* GetDrawContext(SWR_CONTEXT *pContext, bool isSplitDraw = false)
             pContext->curStateId++;  // Progress state ring index forward.
         }
 
-        pCurDrawContext->dependency = 0;
+        // backend work must not overtake a blit still writing its surfaces,
+        // nor the stats query a render condition is evaluated from
+        pCurDrawContext->dependency = pContext->lastBlitDrawId;
+        if (pCurDrawContext->pState->state.pfnRenderCondition)
+        {
+            pCurDrawContext->dependency = std::max(pCurDrawContext->dependency,
+                pCurDrawContext->pState->state.renderConditionDrawId);
+        }
+        // nor may frontend work fetch from a surface a blit or dispatch is
+        // still writing
+        pCurDrawContext->dependencyFE = std::max(pContext->lastDispatchDrawId,
+            pContext->lastBlitDrawId);
         pCurDrawContext->pArena->Reset();
         pCurDrawContext->pContext = pContext;
         pCurDrawContext->isCompute = false; // Dispatch has to set this to true.
@@ -354,6 +430,26 @@ DRAW_CONTEXT* GetDrawContext(SWR_CONTEXT *pContext, bool isSplitDraw = false)
     return pContext->pCurDrawContext;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Queues the open draw batch, if any.
+/// @param pContext - Pointer to SWR context.
+static void CloseDrawBatch(SWR_CONTEXT *pContext)
+{
+    if (!pContext->batchOpen)
+    {
+        return;
+    }
+
+    pContext->batchOpen = false;
+
+    //enqueue DC
+    QueueDraw(pContext);
+
+    // restore culling state
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+    pDC->pState->state.rastState.cullMode = pContext->batchCullMode;
+}
+
 void SWR_API SwrSetActiveSubContext(
     HANDLE hContext,
     uint32_t subContextIndex)
@@ -369,10 +465,12 @@ void SWR_API SwrSetActiveSubContext(
         // Save and restore draw state
         DRAW_CONTEXT* pDC = GetDrawContext(pContext);
         CopyState(
+            pContext,
             pContext->subCtxSave[pContext->curSubCtxId],
             *(pDC->pState));
 
         CopyState(
+            pContext,
             *(pDC->pState),
             pContext->subCtxSave[subContextIndex]);
 
@@ -394,6 +492,12 @@ void SetupDefaultState(SWR_CONTEXT *pContext)
 
     pState->rastState.cullMode = SWR_CULLMODE_NONE;
     pState->rastState.frontWinding = SWR_FRONTWINDING_CCW;
+
+    // zeroed state blocks
+    pContext->vertexBufferBlocks.Modify(pState->vertexBuffers);
+    pContext->viewportBlocks.Modify(pState->vp);
+    pContext->viewportMatrixBlocks.Modify(pState->vpMatrix);
+    pContext->scissorBlocks.Modify(pState->scissorRects);
 }
 
 static INLINE SWR_CONTEXT* GetContext(HANDLE hContext)
@@ -430,6 +534,8 @@ void SwrWaitForIdle(HANDLE hContext)
 {
     SWR_CONTEXT *pContext = GetContext(hContext);
 
+    CloseDrawBatch(pContext);
+
     RDTSC_START(APIWaitForIdle);
     // Wait for all work to complete.
     for (uint32_t dc = 0; dc < KNOB_MAX_DRAWS_IN_FLIGHT; ++dc)
@@ -449,12 +555,14 @@ void SwrSetVertexBuffers(
     uint32_t numBuffers,
     const SWR_VERTEX_BUFFER_STATE* pVertexBuffers)
 {
-    API_STATE* pState = GetDrawState(GetContext(hContext));
+    SWR_CONTEXT *pContext = GetContext(hContext);
+    API_STATE* pState = GetDrawState(pContext);
+    SWR_VERTEX_BUFFER_STATE* pVBs = pContext->vertexBufferBlocks.Modify(pState->vertexBuffers);
 
     for (uint32_t i = 0; i < numBuffers; ++i)
     {
         const SWR_VERTEX_BUFFER_STATE *pVB = &pVertexBuffers[i];
-        pState->vertexBuffers[pVB->index] = *pVB;
+        pVBs[pVB->index] = *pVB;
     }
 }
 
@@ -545,11 +653,13 @@ void SwrSetGsFunc(
 void SwrSetCsFunc(
     HANDLE hContext,
     PFN_CS_FUNC pfnCsFunc,
-    uint32_t totalThreadsInGroup)
+    uint32_t totalThreadsInGroup,
+    uint32_t totalSpillFillSize)
 {
     API_STATE* pState = GetDrawState(GetContext(hContext));
     pState->pfnCsFunc = pfnCsFunc;
     pState->totalThreadsInGroup = totalThreadsInGroup;
+    pState->totalSpillFillSize = totalSpillFillSize;
 }
 
 void SwrSetTsState(
@@ -620,6 +730,16 @@ void SwrSetBlendFunc(
     pState->pfnBlendFunc[renderTarget] = pfnBlendFunc;
 }
 
+void SwrSetOutputMergerFunc(
+    HANDLE hContext,
+    PFN_OUTPUT_MERGER_JIT_FUNC pfnOutputMergerFunc,
+    PFN_OUTPUT_MERGER_JIT_FUNC pfnTileOutputMergerFunc)
+{
+    API_STATE *pState = GetDrawState(GetContext(hContext));
+    pState->pfnOutputMergerFunc = pfnOutputMergerFunc;
+    pState->pfnTileOutputMergerFunc = pfnTileOutputMergerFunc;
+}
+
 void SwrSetLinkage(
     HANDLE hContext,
     uint32_t mask,
@@ -677,6 +797,9 @@ void SwrSetViewports(
     SWR_CONTEXT *pContext = GetContext(hContext);
     API_STATE* pState = GetDrawState(pContext);
 
+    pContext->viewportBlocks.Modify(pState->vp);
+    pContext->viewportMatrixBlocks.Modify(pState->vpMatrix);
+
     memcpy(&pState->vp[0], pViewports, sizeof(SWR_VIEWPORT) * numViewports);
 
     if (pMatrices != nullptr)
@@ -726,8 +849,11 @@ void SwrSetScissorRects(
     SWR_ASSERT(numScissors <= KNOB_NUM_VIEWPORTS_SCISSORS,
         "Invalid number of scissor rects.");
 
-    API_STATE* pState = GetDrawState(GetContext(hContext));
-    memcpy(&pState->scissorRects[0], pScissors, numScissors * sizeof(BBOX));
+    SWR_CONTEXT *pContext = GetContext(hContext);
+    API_STATE* pState = GetDrawState(pContext);
+    BBOX* pScissorRects = pContext->scissorBlocks.Modify(pState->scissorRects);
+
+    memcpy(pScissorRects, pScissors, numScissors * sizeof(BBOX));
 };
 
 void SetupMacroTileScissors(DRAW_CONTEXT *pDC)
@@ -790,9 +916,13 @@ void SetupPipeline(DRAW_CONTEXT *pDC)
         const bool bMultisampleEnable = ((rastState.sampleCount > SWR_MULTISAMPLE_1X) || rastState.bForcedSampleCount) ? 1 : 0;
         const uint32_t centroid = ((pState->state.psState.barycentricsMask & SWR_BARYCENTRIC_CENTROID_MASK) > 0) ? 1 : 0;
 
-        // currently only support 'normal' input coverage
-        SWR_ASSERT(pState->state.psState.inputCoverage == SWR_INPUT_COVERAGE_NORMAL ||
-                   pState->state.psState.inputCoverage == SWR_INPUT_COVERAGE_NONE);
+        // inner coverage comes from the conservative rasterizer, which covers whole
+        // pixels and relies on the backend broadcasting the center result
+        SWR_ASSERT(pState->state.psState.inputCoverage != SWR_INPUT_COVERAGE_INNER_CONSERVATIVE ||
+                   rastState.conservativeRast);
+        SWR_ASSERT(!rastState.conservativeRast ||
+                   (rastState.samplePattern == SWR_MSAA_CENTER_PATTERN &&
+                    pState->state.psState.shadingRate == SWR_SHADING_RATE_PIXEL));
      
         SWR_BARYCENTRICS_MASK barycentricsMask = (SWR_BARYCENTRICS_MASK)pState->state.psState.barycentricsMask;
         
@@ -1049,6 +1179,92 @@ static PFN_FE_WORK_FUNC GetFEDrawFunc(bool IsIndexed, bool HasTessellation, bool
     return FEDrawChooser<>::GetFunc(IsIndexed, HasTessellation, HasGeometryShader, HasStreamOut, RasterizerEnabled);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Appends a small draw to the open draw batch, or opens a new batch
+///        with it.  The batch is queued as a single multi-draw DC by the
+///        next API call, so all its draws share the same state.
+/// @param pContext - Pointer to SWR context.
+/// @param topology - Specifies topology for draw.
+/// @param isIndexed - Draw reads indices from the index buffer.
+/// @param pArgs - SWR_DRAW_(INDEXED_)INDIRECT_ARGS of the draw.
+/// @param argsSize - Size of the draw arguments.
+/// @param numVerts - Vertices of the draw, across all instances.
+/// @return false if the draw can't be batched and has to be queued on its own.
+static bool BatchDraw(
+    SWR_CONTEXT *pContext,
+    PRIMITIVE_TOPOLOGY topology,
+    bool isIndexed,
+    const void *pArgs,
+    uint32_t argsSize,
+    uint64_t numVerts)
+{
+    if (KNOB_MAX_DRAWS_PER_BATCH <= 1 || numVerts > KNOB_MAX_PRIMS_PER_DRAW)
+    {
+        return false;
+    }
+
+    if (pContext->batchOpen)
+    {
+        DRAW_CONTEXT* pDC = pContext->pCurDrawContext;
+        DRAW_INDIRECT_WORK& batch = pDC->FeWork.desc.drawIndirect;
+
+        if (pDC->pState->state.topology == topology &&
+            batch.isIndexed == isIndexed &&
+            batch.maxDrawCount < KNOB_MAX_DRAWS_PER_BATCH &&
+            pContext->batchVerts + numVerts <= KNOB_MAX_PRIMS_PER_DRAW)
+        {
+            memcpy((uint8_t*)batch.pArgs + batch.maxDrawCount * argsSize, pArgs, argsSize);
+            batch.maxDrawCount++;
+            pContext->batchVerts += numVerts;
+            return true;
+        }
+    }
+
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+    API_STATE* pState = &pDC->pState->state;
+
+    // stream output and tessellation draws are split on their own
+    if (pState->soState.soEnable || pState->tsState.tsEnable)
+    {
+        return false;
+    }
+
+    pState->topology = topology;
+    pState->forceFront = false;
+
+    // disable culling for points/lines
+    pContext->batchCullMode = pState->rastState.cullMode;
+    if (topology == TOP_POINT_LIST)
+    {
+        pState->rastState.cullMode = SWR_CULLMODE_NONE;
+        pState->forceFront = true;
+    }
+
+    InitDraw(pDC, false);
+
+    uint8_t* pBatchArgs = (uint8_t*)pDC->pArena->AllocAligned(KNOB_MAX_DRAWS_PER_BATCH * argsSize, sizeof(uint32_t));
+    memcpy(pBatchArgs, pArgs, argsSize);
+
+    pDC->FeWork.type = DRAW;
+    pDC->FeWork.pfnWork = ProcessDrawIndirect;
+    pDC->FeWork.desc.drawIndirect.pfnDraw = GetFEDrawFunc(
+        isIndexed,
+        false,  // HasTessellation
+        pState->gsState.gsEnable,
+        false,  // HasStreamOut
+        pDC->pState->pfnProcessPrims != nullptr);
+    pDC->FeWork.desc.drawIndirect.pArgs = pBatchArgs;
+    pDC->FeWork.desc.drawIndirect.pDrawCount = nullptr;
+    pDC->FeWork.desc.drawIndirect.maxDrawCount = 1;
+    pDC->FeWork.desc.drawIndirect.stride = argsSize;
+    pDC->FeWork.desc.drawIndirect.isIndexed = isIndexed;
+
+    pContext->batchVerts = numVerts;
+    pContext->batchOpen = true;
+
+    return true;
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 /// @brief DrawInstanced
@@ -1074,6 +1290,14 @@ void DrawInstanced(
     RDTSC_START(APIDraw);
 
     SWR_CONTEXT *pContext = GetContext(hContext);
+
+    SWR_DRAW_INDIRECT_ARGS args = { numVertices, numInstances, startVertex, startInstance };
+    if (BatchDraw(pContext, topology, false, &args, sizeof(args), (uint64_t)numVertices * numInstances))
+    {
+        RDTSC_STOP(APIDraw, numVertices * numInstances, 0);
+        return;
+    }
+
     DRAW_CONTEXT* pDC = GetDrawContext(pContext);
 
     int32_t maxVertsPerDraw = MaxVertsPerDraw(pDC, numVertices, topology);
@@ -1191,6 +1415,14 @@ void DrawIndexedInstance(
     RDTSC_START(APIDrawIndexed);
 
     SWR_CONTEXT *pContext = GetContext(hContext);
+
+    SWR_DRAW_INDEXED_INDIRECT_ARGS args = { numIndices, numInstances, indexOffset, baseVertex, startInstance };
+    if (BatchDraw(pContext, topology, true, &args, sizeof(args), (uint64_t)numIndices * numInstances))
+    {
+        RDTSC_STOP(APIDrawIndexed, numIndices * numInstances, 0);
+        return;
+    }
+
     DRAW_CONTEXT* pDC = GetDrawContext(pContext);
     API_STATE* pState = &pDC->pState->state;
 
@@ -1305,6 +1537,166 @@ void SwrDrawIndexedInstanced(
     DrawIndexedInstance(hContext, topology, numIndices, indexOffset, baseVertex, numInstances, startInstance);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief DrawIndirect
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param isIndexed - Draws read indices from the index buffer.
+/// @param pArgs - Array of SWR_DRAW_(INDEXED_)INDIRECT_ARGS.
+/// @param maxDrawCount - Number of draws in pArgs.
+/// @param stride - Distance in bytes between the draw arguments.
+/// @param pDrawCount - Optional number of draws, read with the arguments.
+/// @param dependentFE - Arguments are read from memory earlier draws may write.
+void DrawIndirect(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    bool isIndexed,
+    const void *pArgs,
+    uint32_t maxDrawCount,
+    uint32_t stride,
+    const uint32_t *pDrawCount,
+    bool dependentFE = true)
+{
+    if (KNOB_TOSS_DRAW)
+    {
+        return;
+    }
+
+    RDTSC_START(APIDrawIndirect);
+
+    SWR_CONTEXT *pContext = GetContext(hContext);
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+    API_STATE* pState = &pDC->pState->state;
+
+    pState->topology = topology;
+    pState->forceFront = false;
+
+    // disable culling for points/lines
+    uint32_t oldCullMode = pState->rastState.cullMode;
+    if (topology == TOP_POINT_LIST)
+    {
+        pState->rastState.cullMode = SWR_CULLMODE_NONE;
+        pState->forceFront = true;
+    }
+
+    // The draw count is only known once the arguments are read, so all the
+    // draws run in a single DC instead of being split.
+    InitDraw(pDC, false);
+
+    pDC->FeWork.type = DRAW;
+    pDC->FeWork.pfnWork = ProcessDrawIndirect;
+    pDC->FeWork.desc.drawIndirect.pfnDraw = GetFEDrawFunc(
+        isIndexed,
+        pState->tsState.tsEnable,
+        pState->gsState.gsEnable,
+        pState->soState.soEnable,
+        pDC->pState->pfnProcessPrims != nullptr);
+    pDC->FeWork.desc.drawIndirect.pArgs = (const uint8_t*)pArgs;
+    pDC->FeWork.desc.drawIndirect.pDrawCount = pDrawCount;
+    pDC->FeWork.desc.drawIndirect.maxDrawCount = maxDrawCount;
+    pDC->FeWork.desc.drawIndirect.stride = stride;
+    pDC->FeWork.desc.drawIndirect.isIndexed = isIndexed;
+
+    // arguments may be written by stream output or copies of previous draws
+    if (dependentFE)
+    {
+        pDC->dependencyFE = pDC->drawId - 1;
+    }
+
+    //enqueue DC
+    QueueDraw(pContext);
+
+    // restore culling state
+    pDC = GetDrawContext(pContext);
+    pDC->pState->state.rastState.cullMode = oldCullMode;
+
+    RDTSC_STOP(APIDrawIndirect, maxDrawCount, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrDrawIndirect
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pArgs - Array of SWR_DRAW_INDIRECT_ARGS.
+/// @param maxDrawCount - Number of draws in pArgs.
+/// @param stride - Distance in bytes between the draw arguments.
+/// @param pDrawCount - Optional number of draws, read with the arguments.
+void SwrDrawIndirect(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const void *pArgs,
+    uint32_t maxDrawCount,
+    uint32_t stride,
+    const uint32_t *pDrawCount)
+{
+    DrawIndirect(hContext, topology, false, pArgs, maxDrawCount, stride, pDrawCount);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrDrawIndexedIndirect
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pArgs - Array of SWR_DRAW_INDEXED_INDIRECT_ARGS.
+/// @param maxDrawCount - Number of draws in pArgs.
+/// @param stride - Distance in bytes between the draw arguments.
+/// @param pDrawCount - Optional number of draws, read with the arguments.
+void SwrDrawIndexedIndirect(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const void *pArgs,
+    uint32_t maxDrawCount,
+    uint32_t stride,
+    const uint32_t *pDrawCount)
+{
+    DrawIndirect(hContext, topology, true, pArgs, maxDrawCount, stride, pDrawCount);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrMultiDraw
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pDraws - Array of draws.
+/// @param numDraws - Number of draws in pDraws.
+void SwrMultiDraw(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const SWR_DRAW_INDIRECT_ARGS *pDraws,
+    uint32_t numDraws)
+{
+    SWR_CONTEXT *pContext = GetContext(hContext);
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+
+    // the draws are known now, copy them so the FE can run them early
+    uint32_t size = numDraws * sizeof(SWR_DRAW_INDIRECT_ARGS);
+    void* pArgs = pDC->pArena->AllocAligned(size, sizeof(uint32_t));
+    memcpy(pArgs, pDraws, size);
+
+    DrawIndirect(hContext, topology, false, pArgs, numDraws, sizeof(SWR_DRAW_INDIRECT_ARGS), nullptr, false);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrMultiDrawIndexed
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pDraws - Array of draws.
+/// @param numDraws - Number of draws in pDraws.
+void SwrMultiDrawIndexed(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const SWR_DRAW_INDEXED_INDIRECT_ARGS *pDraws,
+    uint32_t numDraws)
+{
+    SWR_CONTEXT *pContext = GetContext(hContext);
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+
+    // the draws are known now, copy them so the FE can run them early
+    uint32_t size = numDraws * sizeof(SWR_DRAW_INDEXED_INDIRECT_ARGS);
+    void* pArgs = pDC->pArena->AllocAligned(size, sizeof(uint32_t));
+    memcpy(pArgs, pDraws, size);
+
+    DrawIndirect(hContext, topology, true, pArgs, numDraws, sizeof(SWR_DRAW_INDEXED_INDIRECT_ARGS), nullptr, false);
+}
+
 // Attach surfaces to pipeline
 void SwrInvalidateTiles(
     HANDLE hContext,
@@ -1322,6 +1714,28 @@ void SwrInvalidateTiles(
     QueueDraw(pContext);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Sets up the draw context of a dispatch.
+/// @param pContext - SWR context
+/// @param pTaskData - Returns the dispatch description, to be filled in.
+static DRAW_CONTEXT* GetDispatchContext(
+    SWR_CONTEXT *pContext,
+    COMPUTE_DESC *&pTaskData)
+{
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+
+    pDC->isCompute = true;      // This is a compute context.
+    pContext->lastDispatchDrawId = pDC->drawId;
+
+    // Ensure spill fill pointers are initialized to nullptr.
+    memset(pDC->pSpillFill, 0, sizeof(pDC->pSpillFill));
+
+    pTaskData = (COMPUTE_DESC*)pDC->pArena->AllocAligned(sizeof(COMPUTE_DESC), 64);
+    memset(pTaskData, 0, sizeof(COMPUTE_DESC));
+
+    return pDC;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief SwrDispatch
 /// @param hContext - Handle passed back from SwrCreateContext
@@ -1341,14 +1755,8 @@ void SwrDispatch(
 
     RDTSC_START(APIDispatch);
     SWR_CONTEXT *pContext = (SWR_CONTEXT*)hContext;
-    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
-
-    pDC->isCompute = true;      // This is a compute context.
-
-    // Ensure spill fill pointers are initialized to nullptr.
-    memset(pDC->pSpillFill, 0, sizeof(pDC->pSpillFill));
-
-    COMPUTE_DESC* pTaskData = (COMPUTE_DESC*)pDC->pArena->AllocAligned(sizeof(COMPUTE_DESC), 64);
+    COMPUTE_DESC* pTaskData;
+    DRAW_CONTEXT* pDC = GetDispatchContext(pContext, pTaskData);
 
     pTaskData->threadGroupCountX = threadGroupCountX;
     pTaskData->threadGroupCountY = threadGroupCountY;
@@ -1361,12 +1769,40 @@ void SwrDispatch(
     RDTSC_STOP(APIDispatch, threadGroupCountX * threadGroupCountY * threadGroupCountZ, 0);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrDispatchIndirect
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pArgs - Thread group counts in X, Y and Z.  Read when the dispatch
+///                executes, after all earlier work, which may write them.
+void SwrDispatchIndirect(
+    HANDLE hContext,
+    const uint32_t *pArgs)
+{
+    if (KNOB_TOSS_DRAW)
+    {
+        return;
+    }
+
+    RDTSC_START(APIDispatch);
+    SWR_CONTEXT *pContext = (SWR_CONTEXT*)hContext;
+    COMPUTE_DESC* pTaskData;
+    DRAW_CONTEXT* pDC = GetDispatchContext(pContext, pTaskData);
+
+    pTaskData->pIndirectArgs = pArgs;
+    pDC->pDispatch->initializeDeferred(pTaskData);
+
+    QueueDispatch(pContext);
+    RDTSC_STOP(APIDispatch, 0, 0);
+}
+
 // Deswizzles, converts and stores current contents of the hot tiles to surface
-// described by pState
+// described by pState.  pRect optionally limits the store to the macro tiles
+// overlapping it.
 void SwrStoreTiles(
     HANDLE hContext,
     SWR_RENDERTARGET_ATTACHMENT attachment,
-    SWR_TILE_STATE postStoreTileState)
+    SWR_TILE_STATE postStoreTileState,
+    const SWR_RECT *pRect)
 {
     RDTSC_START(APIStoreTiles);
 
@@ -1379,6 +1815,14 @@ void SwrStoreTiles(
     pDC->FeWork.pfnWork = ProcessStoreTiles;
     pDC->FeWork.desc.storeTiles.attachment = attachment;
     pDC->FeWork.desc.storeTiles.postStoreTileState = postStoreTileState;
+    if (pRect)
+    {
+        pDC->FeWork.desc.storeTiles.rect = *pRect;
+    }
+    else
+    {
+        pDC->FeWork.desc.storeTiles.rect = { 0, KNOB_MAX_SCISSOR_X, 0, KNOB_MAX_SCISSOR_Y };
+    }
 
     //enqueue
     QueueDraw(pContext);
@@ -1386,6 +1830,41 @@ void SwrStoreTiles(
     RDTSC_STOP(APIStoreTiles, 0, 0);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrBlit
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pInfo - blit description, copied.
+void SwrBlit(
+    HANDLE hContext,
+    const SWR_BLIT_INFO *pInfo)
+{
+    RDTSC_START(APIBlit);
+
+    SWR_ASSERT(pInfo->dst.numSamples <= 1);
+    SWR_ASSERT(pInfo->numArraySlices > 0);
+
+    SWR_CONTEXT *pContext = GetContext(hContext);
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+
+    BLIT_STATE *pState = (BLIT_STATE*)pDC->pArena->AllocAligned(sizeof(BLIT_STATE), 64);
+    pState->info = *pInfo;
+    memset(pState->pTiles, 0, sizeof(pState->pTiles));
+
+    pDC->FeWork.type = BLIT;
+    pDC->FeWork.pfnWork = ProcessBlit;
+    pDC->FeWork.desc.blit.pState = pState;
+
+    // reads and writes surfaces directly, so cannot execute until all
+    // previous draws have completed, and later draws wait for it.
+    pDC->dependency = pDC->drawId - 1;
+    pContext->lastBlitDrawId = pDC->drawId;
+
+    //enqueue
+    QueueDraw(pContext);
+
+    RDTSC_STOP(APIBlit, 1, 0);
+}
+
 void SwrClearRenderTarget(
     HANDLE hContext,
     uint32_t clearMask,
@@ -1482,6 +1961,7 @@ void SwrGetStats(
 
     // cannot execute until all previous draws have completed
     pDC->dependency = pDC->drawId - 1;
+    pContext->lastQueryDrawId = pDC->drawId;
 
     //enqueue
     QueueDraw(pContext);
@@ -1501,6 +1981,30 @@ void SwrEnableStats(
     pDC->pState->state.enableStats = enable;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Conditionally discards the backend work of subsequent draws
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pfnCondition - Condition callback, nullptr to disable.
+/// @param pUserData - user data passed to the callback
+void SwrSetRenderCondition(
+    HANDLE hContext,
+    PFN_RENDER_CONDITION pfnCondition,
+    void* pUserData)
+{
+    SWR_CONTEXT *pContext = GetContext(hContext);
+    DRAW_CONTEXT* pDC = GetDrawContext(pContext);
+    API_STATE* pState = &pDC->pState->state;
+
+    pState->pfnRenderCondition = pfnCondition;
+    pState->pRenderConditionData = pUserData;
+    pState->renderConditionDrawId = pContext->lastQueryDrawId;
+
+    if (pfnCondition)
+    {
+        pDC->dependency = std::max(pDC->dependency, pContext->lastQueryDrawId);
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Mark end of frame - used for performance profiling
 /// @param hContext - Handle passed back from SwrCreateContext
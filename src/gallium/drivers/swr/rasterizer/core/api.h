@@ -43,6 +43,13 @@
 
 typedef void(SWR_API *PFN_CALLBACK_FUNC)(uint64_t data, uint64_t data2, uint64_t data3);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Function signature for render conditions, evaluated by the
+///        backend once the preceding SwrGetStats has retired.
+/// @param pUserData - user data passed to SwrSetRenderCondition
+/// @return false if the draw and clear work should be discarded.
+typedef bool(SWR_API *PFN_RENDER_CONDITION)(void* pUserData);
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Function signature for load hot tiles
 /// @param hPrivateContext - handle to private data
@@ -77,6 +84,32 @@ typedef void(SWR_API *PFN_CLEAR_TILE)(HANDLE hPrivateContext,
     SWR_RENDERTARGET_ATTACHMENT rtIndex,
     uint32_t x, uint32_t y, const float* pClearColor);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Function signature for loading a macro tile of an arbitrary
+///        surface, rather than one of the bound render targets
+/// @param pSrcSurface - surface to load from
+/// @param dstFormat - format of the hot tile
+/// @param renderTargetIndex - selects the color, depth or stencil load tables
+/// @param x - source x coordinate
+/// @param y - source y coordinate
+/// @param pDstHotTile - pointer to the hot tile surface
+typedef void(SWR_API *PFN_LOAD_SURFACE_TILE)(SWR_SURFACE_STATE *pSrcSurface, SWR_FORMAT dstFormat,
+    SWR_RENDERTARGET_ATTACHMENT renderTargetIndex,
+    uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex, BYTE *pDstHotTile);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Function signature for storing a macro tile to an arbitrary
+///        surface, rather than one of the bound render targets
+/// @param pDstSurface - surface to store to
+/// @param srcFormat - format of the hot tile
+/// @param renderTargetIndex - selects the color, depth or stencil store tables
+/// @param x - destination x coordinate
+/// @param y - destination y coordinate
+/// @param pSrcHotTile - pointer to the hot tile surface
+typedef void(SWR_API *PFN_STORE_SURFACE_TILE)(SWR_SURFACE_STATE *pDstSurface, SWR_FORMAT srcFormat,
+    SWR_RENDERTARGET_ATTACHMENT renderTargetIndex,
+    uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex, BYTE *pSrcHotTile);
+
 //////////////////////////////////////////////////////////////////////////
 /// SWR_CREATECONTEXT_INFO
 /////////////////////////////////////////////////////////////////////////
@@ -95,6 +128,10 @@ struct SWR_CREATECONTEXT_INFO
     PFN_LOAD_TILE pfnLoadTile;
     PFN_STORE_TILE pfnStoreTile;
     PFN_CLEAR_TILE pfnClearTile;
+
+    // surface tile functions, used by SwrBlit
+    PFN_LOAD_SURFACE_TILE pfnLoadSurfaceTile;
+    PFN_STORE_SURFACE_TILE pfnStoreSurfaceTile;
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -238,10 +275,13 @@ void SWR_API SwrSetGsFunc(
 /// @param hContext - Handle passed back from SwrCreateContext
 /// @param pState - Pointer to compute shader function
 /// @param totalThreadsInGroup - product of thread group dimensions.
+/// @param totalSpillFillSize - size in bytes of the spill/fill buffer each
+///        thread group needs, 0 if the shader doesn't use one.
 void SWR_API SwrSetCsFunc(
     HANDLE hContext,
     PFN_CS_FUNC pfnCsFunc,
-    uint32_t totalThreadsInGroup);
+    uint32_t totalThreadsInGroup,
+    uint32_t totalSpillFillSize);
 
 //////////////////////////////////////////////////////////////////////////
 /// @brief Set tessellation state.
@@ -309,6 +349,19 @@ void SWR_API SwrSetBlendFunc(
     uint32_t renderTarget,
     PFN_BLEND_JIT_FUNC pfnBlendFunc);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Set fused output merger function. When set, replaces late
+///        depth/stencil, per-RT blend funcs and hot tile color store for
+///        single sample pixel rate shading.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pfnOutputMergerFunc - function pointer, NULL to disable
+/// @param pfnTileOutputMergerFunc - variant called by raster tile kernels,
+///        which leave the depth/stencil test to it. NULL to disable.
+void SWR_API SwrSetOutputMergerFunc(
+    HANDLE hContext,
+    PFN_OUTPUT_MERGER_JIT_FUNC pfnOutputMergerFunc,
+    PFN_OUTPUT_MERGER_JIT_FUNC pfnTileOutputMergerFunc);
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Set linkage mask
 /// @param hContext - Handle passed back from SwrCreateContext
@@ -364,6 +417,73 @@ void SWR_API SwrDrawIndexed(
     uint32_t indexOffset,
     int32_t baseVertex);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrDrawIndirect
+///        Draw arguments are read from memory when the frontend executes the
+///        draw, after all previous draws have completed, so they may be
+///        written by stream output or copies of earlier draws.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pArgs - Array of SWR_DRAW_INDIRECT_ARGS.
+/// @param maxDrawCount - Number of draws in pArgs.
+/// @param stride - Distance in bytes between the draw arguments.
+/// @param pDrawCount - Optional number of draws, read with the arguments.
+///                     Clamped to maxDrawCount.
+void SWR_API SwrDrawIndirect(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const void *pArgs,
+    uint32_t maxDrawCount,
+    uint32_t stride,
+    const uint32_t *pDrawCount = nullptr);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrDrawIndexedIndirect
+///        Indexed variant of SwrDrawIndirect, reading
+///        SWR_DRAW_INDEXED_INDIRECT_ARGS.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pArgs - Array of SWR_DRAW_INDEXED_INDIRECT_ARGS.
+/// @param maxDrawCount - Number of draws in pArgs.
+/// @param stride - Distance in bytes between the draw arguments.
+/// @param pDrawCount - Optional number of draws, read with the arguments.
+///                     Clamped to maxDrawCount.
+void SWR_API SwrDrawIndexedIndirect(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const void *pArgs,
+    uint32_t maxDrawCount,
+    uint32_t stride,
+    const uint32_t *pDrawCount = nullptr);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrMultiDraw
+///        Runs several draws sharing the same state as one frontend work
+///        item.  Unlike SwrDrawIndirect, the arguments are copied at the
+///        call, so the draws don't wait for previous draws.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pDraws - Array of draws.
+/// @param numDraws - Number of draws in pDraws.
+void SWR_API SwrMultiDraw(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const SWR_DRAW_INDIRECT_ARGS *pDraws,
+    uint32_t numDraws);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrMultiDrawIndexed
+///        Indexed variant of SwrMultiDraw.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param topology - Specifies topology for draw.
+/// @param pDraws - Array of draws.
+/// @param numDraws - Number of draws in pDraws.
+void SWR_API SwrMultiDrawIndexed(
+    HANDLE hContext,
+    PRIMITIVE_TOPOLOGY topology,
+    const SWR_DRAW_INDEXED_INDIRECT_ARGS *pDraws,
+    uint32_t numDraws);
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief SwrDrawIndexedInstanced
 /// @param hContext - Handle passed back from SwrCreateContext
@@ -402,6 +522,15 @@ void SWR_API SwrDispatch(
     uint32_t threadGroupCountY,
     uint32_t threadGroupCountZ);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief SwrDispatchIndirect
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pArgs - Thread group counts in X, Y and Z.  Read when the dispatch
+///                executes, after all earlier work, which may write them.
+void SWR_API SwrDispatchIndirect(
+    HANDLE hContext,
+    const uint32_t *pArgs);
+
 
 enum SWR_TILE_STATE
 {
@@ -411,10 +540,56 @@ enum SWR_TILE_STATE
 };
 
 /// @todo Add a good description for what attachments are and when and why you would use the different SWR_TILE_STATEs.
+/// @param pRect - if non-null, only macro tiles overlapping this pixel rect
+///                (right/bottom exclusive) are stored and transitioned.
 void SWR_API SwrStoreTiles(
     HANDLE hContext,
     SWR_RENDERTARGET_ATTACHMENT attachment,
-    SWR_TILE_STATE postStoreTileState);
+    SWR_TILE_STATE postStoreTileState,
+    const SWR_RECT *pRect);
+
+//////////////////////////////////////////////////////////////////////////
+/// SWR_BLIT_FILTER
+/////////////////////////////////////////////////////////////////////////
+enum SWR_BLIT_FILTER
+{
+    SWR_BLIT_FILTER_POINT,
+    SWR_BLIT_FILTER_LINEAR,
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// SWR_BLIT_INFO
+/////////////////////////////////////////////////////////////////////////
+struct SWR_BLIT_INFO
+{
+    SWR_SURFACE_STATE src;
+    SWR_SURFACE_STATE dst;
+
+    // source region, in pixels.  A negative width or height mirrors it.
+    int32_t srcX, srcY;
+    int32_t srcWidth, srcHeight;
+    uint32_t srcArrayIndex;
+
+    SWR_RECT dstRect;       // pixels, right/bottom exclusive
+    uint32_t dstArrayIndex;
+
+    uint32_t numArraySlices;
+
+    SWR_BLIT_FILTER filter;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Copies a region of one color surface to another, per dst macro
+///        tile on the worker threads.  Converts between formats through the
+///        hot tile format, scales with the given filter and resolves
+///        multisampled sources.  The dst must be single sampled.
+///        Waits in the backend for prior work to retire, and later work
+///        waits for the blit; the API thread does not block.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pInfo - blit description, copied.
+void SWR_API SwrBlit(
+    HANDLE hContext,
+    const SWR_BLIT_INFO *pInfo);
 
 void SWR_API SwrClearRenderTarget(
     HANDLE hContext,
@@ -454,8 +629,9 @@ void SWR_API SwrSetScissorRects(
 ///        draw operation. This is used for external componets such as the
 ///        sampler.
 ///
-/// @note  Client needs to resend private state prior to each draw call.
-///        Also, SWR is responsible for the private state memory.
+/// @note  Private state carries over to later draws like the rest of the
+///        API state, so clients only need to update it when it changes.
+///        SWR is responsible for the private state memory.
 /// @param hContext - Handle passed back from SwrCreateContext
 VOID* SWR_API SwrGetPrivateContextState(
     HANDLE hContext);
@@ -492,6 +668,20 @@ void SWR_API SwrEnableStats(
     HANDLE hContext,
     bool enable);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Conditionally discards the backend work of subsequent draws and
+///        clears.  The condition is evaluated by the workers after the last
+///        SwrGetStats has retired, so it can test the stats it wrote without
+///        stalling the API thread.  Frontend work, including stream output,
+///        is not affected.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pfnCondition - Condition callback, nullptr to disable.
+/// @param pUserData - user data passed to the callback
+void SWR_API SwrSetRenderCondition(
+    HANDLE hContext,
+    PFN_RENDER_CONDITION pfnCondition,
+    void* pUserData);
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Mark end of frame - used for performance profiling
 /// @param hContext - Handle passed back from SwrCreateContext
@@ -79,15 +79,14 @@ void ProcessComputeBE(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t threadGroup
     const COMPUTE_DESC* pTaskData = (COMPUTE_DESC*)pDC->pDispatch->GetTasksData();
     SWR_ASSERT(pTaskData != nullptr);
 
+    const API_STATE& state = GetApiState(pDC);
+
     // Ensure spill fill memory has been allocated.
-    if (pDC->pSpillFill[workerId] == nullptr)
+    if (pDC->pSpillFill[workerId] == nullptr && state.totalSpillFillSize > 0)
     {
-        ///@todo Add state which indicates the spill fill size.
-        pDC->pSpillFill[workerId] = (uint8_t*)pDC->pArena->AllocAlignedSync(4096 * 1024, sizeof(float) * 8);
+        pDC->pSpillFill[workerId] = (uint8_t*)pDC->pArena->AllocAlignedSync(state.totalSpillFillSize, sizeof(float) * 8);
     }
 
-    const API_STATE& state = GetApiState(pDC);
-
     SWR_CS_CONTEXT csContext{ 0 };
     csContext.tileCounter = threadGroupId;
     csContext.dispatchDims[0] = pTaskData->threadGroupCountX;
@@ -417,6 +416,255 @@ void ProcessInvalidateTilesBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t mac
     }
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Offset, in floats, of the red component of pixel (x, y) of a
+///        single sampled color hot tile.  Hot tiles are SOA per SIMD tile,
+///        so the other components follow KNOB_SIMD_WIDTH floats apart.
+static INLINE uint32_t GetBlitPixelOffset(uint32_t x, uint32_t y)
+{
+    // SOA pattern for 2x2 is a subset of 4x2.
+    //   0 1 4 5
+    //   2 3 6 7
+#if (SIMD_TILE_X_DIM == 4)
+    static const uint32_t lane[] = { 0, 1, 4, 5, 2, 3, 6, 7 };
+#elif (SIMD_TILE_X_DIM == 2)
+    static const uint32_t lane[] = { 0, 1, 2, 3 };
+#endif
+    const uint32_t numComps = 4;
+
+    uint32_t rasterTile = (y / KNOB_TILE_Y_DIM) * (KNOB_MACROTILE_X_DIM / KNOB_TILE_X_DIM) + (x / KNOB_TILE_X_DIM);
+    x %= KNOB_TILE_X_DIM;
+    y %= KNOB_TILE_Y_DIM;
+
+    uint32_t simdTile = (y / SIMD_TILE_Y_DIM) * (KNOB_TILE_X_DIM / SIMD_TILE_X_DIM) + (x / SIMD_TILE_X_DIM);
+    uint32_t simdOffset = (y % SIMD_TILE_Y_DIM) * SIMD_TILE_X_DIM + (x % SIMD_TILE_X_DIM);
+
+    return (rasterTile * KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM + simdTile * KNOB_SIMD_WIDTH) * numComps + lane[simdOffset];
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Averages the samples of a multisampled color hot tile into a
+///        single sampled one.  Samples of a raster tile are stored back to
+///        back with identical layouts, so this is a straight vector average.
+static void ResolveBlitTile(const uint8_t *pSrcHotTile, uint8_t *pDstHotTile, uint32_t numSamples)
+{
+    const uint32_t rasterTileFloats = KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * 4;
+    const uint32_t numRasterTiles = (KNOB_MACROTILE_X_DIM / KNOB_TILE_X_DIM) * (KNOB_MACROTILE_Y_DIM / KNOB_TILE_Y_DIM);
+    const simdscalar vScale = _simd_set1_ps(1.0f / numSamples);
+
+    const float *pSrc = (const float*)pSrcHotTile;
+    float *pDst = (float*)pDstHotTile;
+
+    for (uint32_t t = 0; t < numRasterTiles; ++t)
+    {
+        for (uint32_t i = 0; i < rasterTileFloats; i += KNOB_SIMD_WIDTH)
+        {
+            simdscalar vSum = _simd_load_ps(&pSrc[i]);
+            for (uint32_t sample = 1; sample < numSamples; ++sample)
+            {
+                vSum = _simd_add_ps(vSum, _simd_load_ps(&pSrc[sample * rasterTileFloats + i]));
+            }
+            _simd_store_ps(&pDst[i], _simd_mul_ps(vSum, vScale));
+        }
+        pSrc += rasterTileFloats * numSamples;
+        pDst += rasterTileFloats;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// BlitSource - small direct mapped cache of resolved source macro tiles.
+///              Neighbouring tiles map to different slots, so a dst macro
+///              tile never thrashes unless the blit minifies.
+//////////////////////////////////////////////////////////////////////////
+struct BlitSource
+{
+    static const uint32_t NumSlots = 4;
+    static const uint32_t TileSize = KNOB_MACROTILE_X_DIM * KNOB_MACROTILE_Y_DIM * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp / 8;
+
+    SWR_CONTEXT *pContext;
+    SWR_SURFACE_STATE *pSurface;
+    uint32_t arrayIndex;
+    uint32_t width, height;     // of the source lod
+
+    uint8_t *pSlots;            // NumSlots single sampled tiles
+    uint8_t *pStaging;          // multisampled tile, if the source is
+    uint32_t tags[NumSlots];
+
+    void Reset(uint32_t slice)
+    {
+        arrayIndex = slice;
+        for (uint32_t i = 0; i < NumSlots; ++i)
+        {
+            tags[i] = 0xffffffff;
+        }
+    }
+
+    void GetPixel(uint32_t x, uint32_t y, float color[4])
+    {
+        uint32_t tileX = x / KNOB_MACROTILE_X_DIM;
+        uint32_t tileY = y / KNOB_MACROTILE_Y_DIM;
+        uint32_t slot = (tileX & 1) | ((tileY & 1) << 1);
+        uint32_t tag = (tileY << 16) | tileX;
+        uint8_t *pTile = pSlots + slot * TileSize;
+
+        if (tags[slot] != tag)
+        {
+            if (pSurface->numSamples > 1)
+            {
+                pContext->pfnLoadSurfaceTile(pSurface, KNOB_COLOR_HOT_TILE_FORMAT, SWR_ATTACHMENT_COLOR0,
+                    tileX * KNOB_MACROTILE_X_DIM, tileY * KNOB_MACROTILE_Y_DIM, arrayIndex, pStaging);
+                ResolveBlitTile(pStaging, pTile, pSurface->numSamples);
+            }
+            else
+            {
+                pContext->pfnLoadSurfaceTile(pSurface, KNOB_COLOR_HOT_TILE_FORMAT, SWR_ATTACHMENT_COLOR0,
+                    tileX * KNOB_MACROTILE_X_DIM, tileY * KNOB_MACROTILE_Y_DIM, arrayIndex, pTile);
+            }
+            tags[slot] = tag;
+        }
+
+        const float *pSrc = (const float*)pTile + GetBlitPixelOffset(x % KNOB_MACROTILE_X_DIM, y % KNOB_MACROTILE_Y_DIM);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            color[c] = pSrc[c * KNOB_SIMD_WIDTH];
+        }
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief BE handler for SwrBlit.  Produces one dst macro tile, loading
+///        it first if the blit only partially covers it.
+void ProcessBlitBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void *pData)
+{
+    RDTSC_START(BEBlit);
+    BLIT_DESC *pDesc = (BLIT_DESC*)pData;
+    BLIT_STATE *pState = pDesc->pState;
+    SWR_BLIT_INFO &info = pState->info;
+    SWR_CONTEXT *pContext = pDC->pContext;
+
+    static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format for blit");
+    const uint32_t tileSize = BlitSource::TileSize;
+    const uint32_t numSrcSamples = std::max(info.src.numSamples, 1U);
+
+    if (pState->pTiles[workerId] == nullptr)
+    {
+        size_t size = tileSize * (1 + BlitSource::NumSlots);
+        if (numSrcSamples > 1)
+        {
+            size += tileSize * numSrcSamples;
+        }
+        pState->pTiles[workerId] = (uint8_t*)pDC->pArena->AllocAlignedSync(size, KNOB_SIMD_WIDTH * 4);
+    }
+
+    uint8_t *pDstTile = pState->pTiles[workerId];
+
+    BlitSource src;
+    src.pContext = pContext;
+    src.pSurface = &info.src;
+    src.width = std::max(info.src.width >> info.src.lod, 1U);
+    src.height = std::max(info.src.height >> info.src.lod, 1U);
+    src.pSlots = pDstTile + tileSize;
+    src.pStaging = src.pSlots + tileSize * BlitSource::NumSlots;
+
+    uint32_t tileX, tileY;
+    MacroTileMgr::getTileIndices(macroTile, tileX, tileY);
+    uint32_t x0 = tileX * KNOB_MACROTILE_X_DIM;
+    uint32_t y0 = tileY * KNOB_MACROTILE_Y_DIM;
+
+    // dst pixels of this tile that the blit writes
+    uint32_t dstWidth = std::max(info.dst.width >> info.dst.lod, 1U);
+    uint32_t dstHeight = std::max(info.dst.height >> info.dst.lod, 1U);
+    uint32_t xMin = std::max(info.dstRect.left, x0);
+    uint32_t yMin = std::max(info.dstRect.top, y0);
+    uint32_t xMax = std::min(std::min(info.dstRect.right, x0 + KNOB_MACROTILE_X_DIM), dstWidth);
+    uint32_t yMax = std::min(std::min(info.dstRect.bottom, y0 + KNOB_MACROTILE_Y_DIM), dstHeight);
+    if (xMin >= xMax || yMin >= yMax)
+    {
+        RDTSC_STOP(BEBlit, 0, pDC->drawId);
+        return;
+    }
+
+    // pixels past the surface edge are never stored
+    bool fullTile = xMin == x0 && yMin == y0 &&
+        (xMax == x0 + KNOB_MACROTILE_X_DIM || xMax == dstWidth) &&
+        (yMax == y0 + KNOB_MACROTILE_Y_DIM || yMax == dstHeight);
+
+    // map dst pixel centers to the src region
+    float scaleX = (float)info.srcWidth / (float)(info.dstRect.right - info.dstRect.left);
+    float scaleY = (float)info.srcHeight / (float)(info.dstRect.bottom - info.dstRect.top);
+    float offsetX = (float)info.srcX - ((float)info.dstRect.left - 0.5f) * scaleX;
+    float offsetY = (float)info.srcY - ((float)info.dstRect.top - 0.5f) * scaleY;
+    int32_t maxX = (int32_t)src.width - 1;
+    int32_t maxY = (int32_t)src.height - 1;
+
+    for (uint32_t slice = 0; slice < info.numArraySlices; ++slice)
+    {
+        src.Reset(info.srcArrayIndex + slice);
+        uint32_t dstArrayIndex = info.dstArrayIndex + slice;
+
+        if (!fullTile)
+        {
+            pContext->pfnLoadSurfaceTile(&info.dst, KNOB_COLOR_HOT_TILE_FORMAT, SWR_ATTACHMENT_COLOR0,
+                x0, y0, dstArrayIndex, pDstTile);
+        }
+
+        for (uint32_t y = yMin; y < yMax; ++y)
+        {
+            float sy = (float)y * scaleY + offsetY;
+
+            for (uint32_t x = xMin; x < xMax; ++x)
+            {
+                float sx = (float)x * scaleX + offsetX;
+                float color[4];
+
+                if (info.filter == SWR_BLIT_FILTER_POINT)
+                {
+                    int32_t ix = std::min(std::max((int32_t)floorf(sx), 0), maxX);
+                    int32_t iy = std::min(std::max((int32_t)floorf(sy), 0), maxY);
+                    src.GetPixel(ix, iy, color);
+                }
+                else
+                {
+                    float fx = sx - 0.5f;
+                    float fy = sy - 0.5f;
+                    float flx = floorf(fx);
+                    float fly = floorf(fy);
+                    float wx = fx - flx;
+                    float wy = fy - fly;
+                    int32_t ix0 = std::min(std::max((int32_t)flx, 0), maxX);
+                    int32_t iy0 = std::min(std::max((int32_t)fly, 0), maxY);
+                    int32_t ix1 = std::min(std::max((int32_t)flx + 1, 0), maxX);
+                    int32_t iy1 = std::min(std::max((int32_t)fly + 1, 0), maxY);
+
+                    float c00[4], c10[4], c01[4], c11[4];
+                    src.GetPixel(ix0, iy0, c00);
+                    src.GetPixel(ix1, iy0, c10);
+                    src.GetPixel(ix0, iy1, c01);
+                    src.GetPixel(ix1, iy1, c11);
+
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        float top = c00[c] + (c10[c] - c00[c]) * wx;
+                        float bottom = c01[c] + (c11[c] - c01[c]) * wx;
+                        color[c] = top + (bottom - top) * wy;
+                    }
+                }
+
+                float *pDst = (float*)pDstTile + GetBlitPixelOffset(x - x0, y - y0);
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    pDst[c * KNOB_SIMD_WIDTH] = color[c];
+                }
+            }
+        }
+
+        pContext->pfnStoreSurfaceTile(&info.dst, KNOB_COLOR_HOT_TILE_FORMAT, SWR_ATTACHMENT_COLOR0,
+            x0, y0, dstArrayIndex, pDstTile);
+    }
+
+    RDTSC_STOP(BEBlit, (xMax - xMin) * (yMax - yMin), pDC->drawId);
+}
+
 #if KNOB_SIMD_WIDTH == 8
 const __m256 vQuadCenterOffsetsX = { 0.5, 1.5, 0.5, 1.5, 2.5, 3.5, 2.5, 3.5 };
 const __m256 vQuadCenterOffsetsY = { 0.5, 0.5, 1.5, 1.5, 0.5, 0.5, 1.5, 1.5 };
@@ -828,6 +1076,7 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
     RDTSC_START(BESetup);
     // type safety guaranteed from template instantiation in BEChooser<>::GetFunc
     static const bool bInputCoverage = (bool)inputCoverage;
+    static const bool bInnerCoverage = (inputCoverage == SWR_INPUT_COVERAGE_INNER_CONSERVATIVE);
     static const bool bCentroidPos = (bool)centroidPos;
 
     SWR_CONTEXT *pContext = pDC->pContext;
@@ -837,6 +1086,7 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
     const SWR_BLEND_STATE *pBlendState = &state.blendState;
     const BACKEND_FUNCS& backendFuncs = pDC->pState->backendFuncs;
     uint64_t coverageMask = work.coverageMask[0];
+    uint64_t innerCoverageMask = work.innerCoverageMask;
 
     // broadcast scalars
     BarycentricCoeffs coeffs;
@@ -881,6 +1131,46 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
     psContext.pSamplePosX = (const float*)&MultisampleTraits<SWR_MULTISAMPLE_1X>::samplePosX;
     psContext.pSamplePosY = (const float*)&MultisampleTraits<SWR_MULTISAMPLE_1X>::samplePosY;
 
+    // raster tile kernel evaluates barycentrics, coverage, early-Z and output merger for every quad itself
+    if(!bInputCoverage && !bCentroidPos && !rastState.clipDistanceMask && (pPSState->pfnPixelTileShader != nullptr))
+    {
+        SWR_ASSERT(state.pfnTileOutputMergerFunc != nullptr, "Raster tile kernel requires fused output merger");
+
+        SWR_PS_TILE_CONTEXT tileContext;
+        tileContext.coverageMask = coverageMask;
+        tileContext.x = (float)x;
+        tileContext.y = (float)y;
+        for(uint32_t i = 0; i < 3; ++i)
+        {
+            tileContext.I[i] = work.I[i];
+            tileContext.J[i] = work.J[i];
+            tileContext.Z[i] = work.Z[i];
+            tileContext.OneOverW[i] = work.OneOverW[i];
+        }
+        tileContext.recipDet = work.recipDet;
+        for(uint32_t rt = 0; rt < NumRT; ++rt)
+        {
+            tileContext.pColorBase[rt] = pColorBase[rt];
+        }
+        tileContext.pDepthBase = pDepthBase;
+        tileContext.pStencilBase = pStencilBase;
+        tileContext.pBlendState = pBlendState;
+        tileContext.pViewport = &state.vp[0];
+        tileContext.pfnOutputMerger = state.pfnTileOutputMergerFunc;
+        tileContext.psInvocations = 0;
+        tileContext.depthPassCount = 0;
+
+        psContext.sampleIndex = 0;
+
+        RDTSC_START(BEPixelShader);
+        pPSState->pfnPixelTileShader(GetPrivateState(pDC), &psContext, &tileContext);
+        RDTSC_STOP(BEPixelShader, 0, 0);
+
+        UPDATE_STAT(PsInvocations, tileContext.psInvocations);
+        UPDATE_STAT(DepthPassCount, tileContext.depthPassCount);
+        return;
+    }
+
     for(uint32_t yy = y; yy < y + KNOB_TILE_Y_DIM; yy += SIMD_TILE_Y_DIM)
     {
         // UL pixel corner
@@ -890,9 +1180,14 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
 
         for(uint32_t xx = x; xx < x + KNOB_TILE_X_DIM; xx += SIMD_TILE_X_DIM)
         {
-            if(bInputCoverage)
+            if(bInnerCoverage)
             {
-                generateInputCoverage<SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, false>(&work.coverageMask[0], psContext.inputMask, pBlendState->sampleMask);
+                // a single bit, fully covered or not
+                generateInputCoverage<SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, true>(&innerCoverageMask, psContext.inputMask, pBlendState->sampleMask);
+            }
+            else if(bInputCoverage)
+            {
+                generateInputCoverage<SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, false>(&coverageMask, psContext.inputMask, pBlendState->sampleMask);
             }
 
             if(coverageMask & MASK)
@@ -963,6 +1258,19 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
 
                 vCoverageMask = _simd_castsi_ps(psContext.activeMask);
 
+                // fused late-Z, output merger and depth/stencil write
+                if(state.pfnOutputMergerFunc != nullptr)
+                {
+                    RDTSC_START(BEOutputMerger);
+                    state.pfnOutputMergerFunc(pBlendState, &state.vp[0], psContext.shaded, &psContext.vZ, work.triFlags.frontFacing,
+                                              pColorBase, pDepthBase, pStencilBase, &psContext.oMask, (simdscalari*)&vCoverageMask,
+                                              (simdscalari*)&depthPassMask, (simdscalari*)&stencilPassMask);
+                    RDTSC_STOP(BEOutputMerger, 0, 0);
+
+                    UPDATE_STAT(DepthPassCount, _mm_popcnt_u32(_simd_movemask_ps(depthPassMask)));
+                    goto Endtile;
+                }
+
                 // late-Z
                 if(!CanEarlyZ(pPSState))
                 {
@@ -1001,6 +1309,7 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
 Endtile:
             RDTSC_START(BEEndTile);
             coverageMask >>= (SIMD_TILE_Y_DIM * SIMD_TILE_X_DIM);
+            innerCoverageMask >>= (SIMD_TILE_Y_DIM * SIMD_TILE_X_DIM);
             pDepthBase += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp) / 8;
             pStencilBase += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_STENCIL_HOT_TILE_FORMAT>::bpp) / 8;
 
@@ -1019,6 +1328,7 @@ void BackendSampleRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_
     // type safety guaranteed from template instantiation in BEChooser<>::GetFunc
     static const SWR_MULTISAMPLE_COUNT sampleCount = (SWR_MULTISAMPLE_COUNT)sampleCountT;
     static const bool bInputCoverage = (bool)inputCoverage;
+    static const bool bInnerCoverage = (inputCoverage == SWR_INPUT_COVERAGE_INNER_CONSERVATIVE);
     static const bool bCentroidPos = (bool)centroidPos;
 
     RDTSC_START(BESetup);
@@ -1091,7 +1401,11 @@ void BackendSampleRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_
             backendFuncs.pfnCalcPixelBarycentrics(coeffs, psContext);
             RDTSC_STOP(BEBarycentric, 0, 0);
 
-            if(bInputCoverage)
+            if(bInnerCoverage)
+            {
+                generateInputCoverage<SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, true>(&work.innerCoverageMask, psContext.inputMask, pBlendState->sampleMask);
+            }
+            else if(bInputCoverage)
             {
                 generateInputCoverage<sampleCount, SWR_MSAA_STANDARD_PATTERN, false>(&work.coverageMask[0], psContext.inputMask, pBlendState->sampleMask);
             }
@@ -1210,6 +1524,7 @@ void BackendSampleRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_
                 work.coverageMask[sample] >>= (SIMD_TILE_Y_DIM * SIMD_TILE_X_DIM);
             }
             RDTSC_START(BEEndTile);
+            work.innerCoverageMask >>= (SIMD_TILE_Y_DIM * SIMD_TILE_X_DIM);
             pDepthBase += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp) / 8;
             pStencilBase += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_STENCIL_HOT_TILE_FORMAT>::bpp) / 8;
 
@@ -1229,6 +1544,7 @@ void BackendPixelRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_t
     static const SWR_MULTISAMPLE_COUNT sampleCount = (SWR_MULTISAMPLE_COUNT)sampleCountT;
     static const bool bIsStandardPattern = (bool)samplePattern;
     static const bool bInputCoverage = (bool)inputCoverage;
+    static const bool bInnerCoverage = (inputCoverage == SWR_INPUT_COVERAGE_INNER_CONSERVATIVE);
     static const bool bCentroidPos = (bool)centroidPos;
     static const bool bForcedSampleCount = (bool)forcedSampleCount;
 
@@ -1322,7 +1638,11 @@ void BackendPixelRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_t
             // set pixel center positions
             psContext.vX.center = _simd_add_ps(vQuadCenterOffsetsX, _simd_set1_ps((float)xx));
 
-            if (bInputCoverage)
+            if (bInnerCoverage)
+            {
+                generateInputCoverage<SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, true>(&work.innerCoverageMask, psContext.inputMask, pBlendState->sampleMask);
+            }
+            else if (bInputCoverage)
             {
                 generateInputCoverage<sampleCount, bIsStandardPattern, bForcedSampleCount>(&work.coverageMask[0], psContext.inputMask, pBlendState->sampleMask);
             }
@@ -1533,6 +1853,7 @@ Endtile:
             {
                 work.coverageMask[sample] >>= (SIMD_TILE_Y_DIM * SIMD_TILE_X_DIM);
             }
+            work.innerCoverageMask >>= (SIMD_TILE_Y_DIM * SIMD_TILE_X_DIM);
 
             pDepthBase += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp) / 8;
             pStencilBase += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_STENCIL_HOT_TILE_FORMAT>::bpp) / 8;
@@ -1645,7 +1966,7 @@ void InitClearTilesTable()
 }
 
 PFN_BACKEND_FUNC gBackendNullPs[SWR_MULTISAMPLE_TYPE_MAX];
-PFN_BACKEND_FUNC gBackendSingleSample[2][2] = {};
+PFN_BACKEND_FUNC gBackendSingleSample[SWR_INPUT_COVERAGE_MAX][2] = {};
 PFN_BACKEND_FUNC gBackendPixelRateTable[SWR_MULTISAMPLE_TYPE_MAX][SWR_MSAA_SAMPLE_PATTERN_MAX][SWR_INPUT_COVERAGE_MAX][2][2] = {};
 PFN_BACKEND_FUNC gBackendSampleRateTable[SWR_MULTISAMPLE_TYPE_MAX][SWR_INPUT_COVERAGE_MAX][2] = {};
 PFN_OUTPUT_MERGER gBackendOutputMergerTable[SWR_NUM_RENDERTARGETS+1][SWR_MULTISAMPLE_TYPE_MAX] = {};
@@ -1786,6 +2107,22 @@ struct BEChooser
         }
     }
 
+    // Recursively parse args
+    template <typename... TArgsT>
+    static PFN_BACKEND_FUNC GetFunc(SWR_INPUT_COVERAGE tArg, TArgsT... remainingArgs)
+    {
+        switch(tArg)
+        {
+        case SWR_INPUT_COVERAGE_NONE: return BEChooser<ArgsT..., SWR_INPUT_COVERAGE_NONE>::GetFunc(remainingArgs...); break;
+        case SWR_INPUT_COVERAGE_NORMAL: return BEChooser<ArgsT..., SWR_INPUT_COVERAGE_NORMAL>::GetFunc(remainingArgs...); break;
+        case SWR_INPUT_COVERAGE_INNER_CONSERVATIVE: return BEChooser<ArgsT..., SWR_INPUT_COVERAGE_INNER_CONSERVATIVE>::GetFunc(remainingArgs...); break;
+        default:
+            SWR_ASSERT(0 && "Invalid input coverage\n");
+            return nullptr;
+            break;
+        }
+    }
+
     // Recursively parse args
     template <typename... TArgsT>
     static PFN_BACKEND_FUNC GetFunc(uint32_t tArg, TArgsT... remainingArgs)
@@ -1839,12 +2176,14 @@ void InitBackendBarycentricsTables(PFN_CALC_PIXEL_BARYCENTRICS (&pixelTable)[2],
     }
 }
 
-void InitBackendSampleFuncTable(PFN_BACKEND_FUNC (&table)[2][2])
+void InitBackendSampleFuncTable(PFN_BACKEND_FUNC (&table)[SWR_INPUT_COVERAGE_MAX][2])
 {
     gBackendSingleSample[0][0] = BEChooser<>::GetFunc(SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, SWR_INPUT_COVERAGE_NONE, 0, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_SINGLE_SAMPLE);
     gBackendSingleSample[0][1] = BEChooser<>::GetFunc(SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, SWR_INPUT_COVERAGE_NONE, 1, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_SINGLE_SAMPLE);
     gBackendSingleSample[1][0] = BEChooser<>::GetFunc(SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, SWR_INPUT_COVERAGE_NORMAL, 0, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_SINGLE_SAMPLE);
     gBackendSingleSample[1][1] = BEChooser<>::GetFunc(SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, SWR_INPUT_COVERAGE_NORMAL, 1, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_SINGLE_SAMPLE);
+    gBackendSingleSample[2][0] = BEChooser<>::GetFunc(SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, SWR_INPUT_COVERAGE_INNER_CONSERVATIVE, 0, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_SINGLE_SAMPLE);
+    gBackendSingleSample[2][1] = BEChooser<>::GetFunc(SWR_MULTISAMPLE_1X, SWR_MSAA_STANDARD_PATTERN, SWR_INPUT_COVERAGE_INNER_CONSERVATIVE, 1, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_SINGLE_SAMPLE);
 }
 
 template <SWR_MULTISAMPLE_COUNT numSampleRates, SWR_MSAA_SAMPLE_PATTERN numSamplePatterns, SWR_INPUT_COVERAGE numCoverageModes>
@@ -1859,9 +2198,9 @@ void InitBackendPixelFuncTable(PFN_BACKEND_FUNC (&table)[numSampleRates][numSamp
                 for(uint32_t isCentroid = 0; isCentroid < 2; isCentroid++)
                 {
                     table[sampleCount][samplePattern][inputCoverage][isCentroid][0] =
-                        BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, samplePattern, inputCoverage, isCentroid, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_PIXEL_RATE);
+                        BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, samplePattern, (SWR_INPUT_COVERAGE)inputCoverage, isCentroid, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_PIXEL_RATE);
                     table[sampleCount][samplePattern][inputCoverage][isCentroid][1] =
-                        BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, samplePattern, inputCoverage, isCentroid, 1, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_PIXEL_RATE);
+                        BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, samplePattern, (SWR_INPUT_COVERAGE)inputCoverage, isCentroid, 1, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_PIXEL_RATE);
                 }
             }
         }
@@ -1876,9 +2215,9 @@ void InitBackendSampleFuncTable(PFN_BACKEND_FUNC (&table)[numSampleRates][numCov
         for(uint32_t inputCoverage = SWR_INPUT_COVERAGE_NONE; inputCoverage < numCoverageModes; inputCoverage++)
         {
             table[sampleCount][inputCoverage][0] =
-                BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, SWR_MSAA_STANDARD_PATTERN, inputCoverage, 0, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_SAMPLE_RATE);
+                BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, SWR_MSAA_STANDARD_PATTERN, (SWR_INPUT_COVERAGE)inputCoverage, 0, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_SAMPLE_RATE);
             table[sampleCount][inputCoverage][1] =
-                BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, SWR_MSAA_STANDARD_PATTERN, inputCoverage, 1, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_SAMPLE_RATE);
+                BEChooser<>::GetFunc((SWR_MULTISAMPLE_COUNT)sampleCount, SWR_MSAA_STANDARD_PATTERN, (SWR_INPUT_COVERAGE)inputCoverage, 1, 0, (SWR_BACKEND_FUNCS)SWR_BACKEND_MSAA_SAMPLE_RATE);
         }
     }
 }
@@ -38,6 +38,7 @@
 #include "core/utils.h"
 #include "core/arena.h"
 #include "core/fifo.hpp"
+#include "core/stateblock.h"
 #include "core/knobs.h"
 #include "common/simdintrin.h"
 #include "core/threads.h"
@@ -82,6 +83,7 @@ struct SWR_TRIANGLE_DESC
     float *pUserClipBuffer;
 
     uint64_t coverageMask[SWR_MAX_NUM_MULTISAMPLES];
+    uint64_t innerCoverageMask;     // conservative rast: pixels fully inside the triangle
 
     TRI_FLAGS triFlags;
 };
@@ -95,6 +97,20 @@ struct TRIANGLE_WORK_DESC
     TRI_FLAGS triFlags;
 };
 
+// simple (single pixel) points binned to one macrotile, in submission order
+struct POINT_CLOUD_DESC
+{
+    uint32_t *pX;               // pixel x
+    uint32_t *pY;               // pixel y
+    float *pZ;
+    uint32_t *pPrimID;
+    float *pAttribs;            // numAttribs * 3 verts * 4 components per point
+    uint32_t numAttribs;
+    uint32_t numPoints;
+    uint32_t maxPoints;         // allocated, grows up to KNOB_POINT_CLOUD_BATCH_SIZE
+    uint32_t renderTargetArrayIndex;
+};
+
 union CLEAR_FLAGS
 {
     struct
@@ -134,6 +150,20 @@ struct STORE_TILES_DESC
 {
     SWR_RENDERTARGET_ATTACHMENT attachment;
     SWR_TILE_STATE postStoreTileState;
+    SWR_RECT rect;      // pixels, right/bottom exclusive
+};
+
+struct BLIT_STATE
+{
+    SWR_BLIT_INFO info;
+
+    // Per worker hot tiles, allocated from the draw arena on first use.
+    uint8_t* pTiles[KNOB_MAX_NUM_THREADS];
+};
+
+struct BLIT_DESC
+{
+    BLIT_STATE *pState;
 };
 
 struct COMPUTE_DESC
@@ -141,6 +171,9 @@ struct COMPUTE_DESC
     uint32_t threadGroupCountX;
     uint32_t threadGroupCountY;
     uint32_t threadGroupCountZ;
+
+    // Indirect dispatches read the counts from here, see WorkOnCompute
+    const uint32_t *pIndirectArgs;
 };
 
 typedef void(*PFN_WORK_FUNC)(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile, void* pDesc);
@@ -153,6 +186,7 @@ enum WORK_TYPE
     INVALIDATETILES,
     STORETILES,
     QUERYSTATS,
+    BLIT,
 };
 
 struct BE_WORK
@@ -163,13 +197,17 @@ struct BE_WORK
     {
         SYNC_DESC sync;
         TRIANGLE_WORK_DESC tri;
+        POINT_CLOUD_DESC pointCloud;
         CLEAR_DESC clear;
         INVALIDATE_TILES_DESC invalidateTiles;
         STORE_TILES_DESC storeTiles;
         QUERY_DESC queryStats;
+        BLIT_DESC blit;
     } desc;
 };
 
+typedef void(*PFN_FE_WORK_FUNC)(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, void* pDesc);
+
 struct DRAW_WORK
 {
     DRAW_CONTEXT*   pDC;
@@ -191,7 +229,16 @@ struct DRAW_WORK
     SWR_FORMAT type;                // index buffer type
 };
 
-typedef void(*PFN_FE_WORK_FUNC)(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, void* pDesc);
+struct DRAW_INDIRECT_WORK
+{
+    PFN_FE_WORK_FUNC pfnDraw;       // FE draw function run for each draw
+    const uint8_t* pArgs;           // SWR_DRAW_(INDEXED_)INDIRECT_ARGS array
+    const uint32_t* pDrawCount;     // Optional draw count, read at FE time
+    uint32_t maxDrawCount;
+    uint32_t stride;
+    bool isIndexed;
+};
+
 struct FE_WORK
 {
     WORK_TYPE type;
@@ -200,10 +247,12 @@ struct FE_WORK
     {
         SYNC_DESC sync;
         DRAW_WORK draw;
+        DRAW_INDIRECT_WORK drawIndirect;
         CLEAR_DESC clear;
         INVALIDATE_TILES_DESC invalidateTiles;
         STORE_TILES_DESC storeTiles;
         QUERY_DESC queryStats;
+        BLIT_DESC blit;
     } desc;
 };
 
@@ -218,10 +267,13 @@ struct PA_STATE;
 typedef void(*PFN_PROCESS_PRIMS)(DRAW_CONTEXT *pDC, PA_STATE& pa, uint32_t workerId, simdvector prims[], 
     uint32_t primMask, simdscalari primID);
 
+// API state copied to every new draw state.  The larger arrays are
+// copy-on-write blocks shared with other draw states, see stateblock.h,
+// and have to be modified through the SWR_CONTEXT block pools.
 OSALIGNLINE(struct) API_STATE
 {
     // Vertex Buffers
-    SWR_VERTEX_BUFFER_STATE vertexBuffers[KNOB_NUM_STREAMS];
+    SWR_VERTEX_BUFFER_STATE* vertexBuffers;     // [KNOB_NUM_STREAMS]
 
     // Index Buffer
     SWR_INDEX_BUFFER_STATE  indexBuffer;
@@ -239,6 +291,7 @@ OSALIGNLINE(struct) API_STATE
     // CS - Compute Shader
     PFN_CS_FUNC             pfnCsFunc;
     uint32_t                totalThreadsInGroup;
+    uint32_t                totalSpillFillSize;
 
     // FE - Frontend State
     SWR_FRONTEND_STATE      frontendState;
@@ -275,10 +328,10 @@ OSALIGNLINE(struct) API_STATE
 
     GUARDBAND               gbState;
 
-    SWR_VIEWPORT            vp[KNOB_NUM_VIEWPORTS_SCISSORS];
-    SWR_VIEWPORT_MATRIX     vpMatrix[KNOB_NUM_VIEWPORTS_SCISSORS];
+    SWR_VIEWPORT*           vp;                 // [KNOB_NUM_VIEWPORTS_SCISSORS]
+    SWR_VIEWPORT_MATRIX*    vpMatrix;           // [KNOB_NUM_VIEWPORTS_SCISSORS]
 
-    BBOX                    scissorRects[KNOB_NUM_VIEWPORTS_SCISSORS];
+    BBOX*                   scissorRects;       // [KNOB_NUM_VIEWPORTS_SCISSORS]
     BBOX                    scissorInFixedPoint;
 
     // Backend state
@@ -293,9 +346,21 @@ OSALIGNLINE(struct) API_STATE
     SWR_BLEND_STATE         blendState;
     PFN_BLEND_JIT_FUNC      pfnBlendFunc[SWR_NUM_RENDERTARGETS];
 
+    // Optional fused late depth/stencil, blend and hot tile store for single sample backend
+    PFN_OUTPUT_MERGER_JIT_FUNC pfnOutputMergerFunc;
+
+    // Output merger called by raster tile kernels, always tests depth/stencil
+    PFN_OUTPUT_MERGER_JIT_FUNC pfnTileOutputMergerFunc;
+
     // Stats are incremented when this is true.
     bool enableStats;
 
+    // Render condition, evaluated by the backend after renderConditionDrawId
+    // has retired.  Draw and clear work is discarded when it fails.
+    PFN_RENDER_CONDITION pfnRenderCondition;
+    void* pRenderConditionData;
+    uint64_t renderConditionDrawId;
+
     struct
     {
         uint32_t colorHottileEnable : 8;
@@ -359,7 +424,7 @@ struct DRAW_STATE
 {
     API_STATE state;
 
-    void* pPrivateState;  // Its required the driver sets this up for each draw.
+    void* pPrivateState;  // Driver state, carried over to later draws like the API state.
 
     // pipeline function pointers, filled in by API thread when setting up the draw
     BACKEND_FUNCS backendFuncs;
@@ -390,6 +455,11 @@ struct DRAW_CONTEXT
 
     uint64_t dependency;
 
+    // FE reads data written by earlier draws (indirect draw arguments,
+    // buffers written by dispatches) and can't start before this draw
+    // has retired.
+    uint64_t dependencyFE;
+
     MacroTileMgr* pTileMgr;
 
     // The following fields are valid if isCompute is true.
@@ -480,6 +550,32 @@ struct SWR_CONTEXT
     PFN_LOAD_TILE pfnLoadTile;
     PFN_STORE_TILE pfnStoreTile;
     PFN_CLEAR_TILE pfnClearTile;
+    PFN_LOAD_SURFACE_TILE pfnLoadSurfaceTile;
+    PFN_STORE_SURFACE_TILE pfnStoreSurfaceTile;
+
+    // Most recent SwrBlit.  Later draws don't start their frontend or
+    // backend work before it retires, as it writes surfaces behind the hot
+    // tiles that shaders may also fetch from.
+    uint64_t lastBlitDrawId;
+
+    // Most recent SwrDispatch.  Later draws don't start their frontend work
+    // before it retires, as they may fetch from buffers it writes.
+    uint64_t lastDispatchDrawId;
+
+    // Most recent SwrGetStats, which render conditions depend on.
+    uint64_t lastQueryDrawId;
+
+    // Copy-on-write blocks of the API_STATE arrays
+    StateBlockPool<SWR_VERTEX_BUFFER_STATE, KNOB_NUM_STREAMS> vertexBufferBlocks;
+    StateBlockPool<SWR_VIEWPORT, KNOB_NUM_VIEWPORTS_SCISSORS> viewportBlocks;
+    StateBlockPool<SWR_VIEWPORT_MATRIX, KNOB_NUM_VIEWPORTS_SCISSORS> viewportMatrixBlocks;
+    StateBlockPool<BBOX, KNOB_NUM_VIEWPORTS_SCISSORS> scissorBlocks;
+
+    // Small draws with unchanged state are appended to the current DC as a
+    // multi-draw, which is queued on the next API call.
+    bool batchOpen;
+    uint32_t batchCullMode;     // cull mode to restore once the batch is queued
+    uint64_t batchVerts;        // vertices across all instances of the batch
 
     // Global Stats
     SWR_STATS stats[KNOB_MAX_NUM_THREADS];
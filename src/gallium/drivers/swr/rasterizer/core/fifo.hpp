@@ -96,6 +96,20 @@ struct QUEUE
         return &mBlocks[block][mHead & (mBlockSize-1)];
     }
 
+    // last entry enqueued, only valid while nothing has been dequeued
+    T* peekTail()
+    {
+        if (mNumEntries == 0)
+        {
+            return nullptr;
+        }
+        if (mTail == 0)
+        {
+            return &mBlocks[mCurBlockIdx - 1][mBlockSize - 1];
+        }
+        return &mCurBlock[mTail - 1];
+    }
+
     void dequeue_noinc()
     {
         mHead ++;
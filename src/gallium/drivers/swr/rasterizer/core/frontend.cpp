@@ -169,15 +169,28 @@ void ProcessStoreTiles(
     uint32_t numMacroTilesX = ((uint32_t)state.vp[0].width + (uint32_t)state.vp[0].x + (macroWidth - 1)) / macroWidth;
     uint32_t numMacroTilesY = ((uint32_t)state.vp[0].height + (uint32_t)state.vp[0].y + (macroHeight - 1)) / macroHeight;
 
+    // limit to the macro tiles overlapping the requested rect
+    const SWR_RECT &rect = pStore->rect;
+    if (rect.right <= rect.left || rect.bottom <= rect.top)
+    {
+        RDTSC_STOP(FEProcessStoreTiles, 0, pDC->drawId);
+        return;
+    }
+
+    uint32_t macroTileXMin = rect.left / macroWidth;
+    uint32_t macroTileYMin = rect.top / macroHeight;
+    uint32_t macroTileXMax = std::min(numMacroTilesX, (rect.right + macroWidth - 1) / macroWidth);
+    uint32_t macroTileYMax = std::min(numMacroTilesY, (rect.bottom + macroHeight - 1) / macroHeight);
+
     // store tiles
     BE_WORK work;
     work.type = STORETILES;
     work.pfnWork = ProcessStoreTileBE;
     work.desc.storeTiles = *pStore;
 
-    for (uint32_t x = 0; x < numMacroTilesX; ++x)
+    for (uint32_t x = macroTileXMin; x < macroTileXMax; ++x)
     {
-        for (uint32_t y = 0; y < numMacroTilesY; ++y)
+        for (uint32_t y = macroTileYMin; y < macroTileYMax; ++y)
         {
             pTileMgr->enqueue(x, y, &work);
         }
@@ -230,6 +243,54 @@ void ProcessInvalidateTiles(
     RDTSC_STOP(FEProcessInvalidateTiles, 0, pDC->drawId);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief FE handler for SwrBlit.
+/// @param pContext - pointer to SWR context.
+/// @param pDC - pointer to draw context.
+/// @param workerId - thread's worker id. Even thread has a unique id.
+/// @param pUserData - Pointer to user data passed back to callback.
+void ProcessBlit(
+    SWR_CONTEXT *pContext,
+    DRAW_CONTEXT *pDC,
+    uint32_t workerId,
+    void *pUserData)
+{
+    RDTSC_START(FEProcessBlit);
+    BLIT_DESC *pBlit = (BLIT_DESC*)pUserData;
+    MacroTileMgr *pTileMgr = pDC->pTileMgr;
+
+    const SWR_RECT &rect = pBlit->pState->info.dstRect;
+    if (rect.right <= rect.left || rect.bottom <= rect.top)
+    {
+        RDTSC_STOP(FEProcessBlit, 0, pDC->drawId);
+        return;
+    }
+
+    // queue a blit to each dst macro tile overlapping the dst rect
+    const uint32_t macroWidth = KNOB_MACROTILE_X_DIM;
+    const uint32_t macroHeight = KNOB_MACROTILE_Y_DIM;
+
+    uint32_t macroTileXMin = rect.left / macroWidth;
+    uint32_t macroTileYMin = rect.top / macroHeight;
+    uint32_t macroTileXMax = std::min<uint32_t>(KNOB_NUM_HOT_TILES_X, (rect.right + macroWidth - 1) / macroWidth);
+    uint32_t macroTileYMax = std::min<uint32_t>(KNOB_NUM_HOT_TILES_Y, (rect.bottom + macroHeight - 1) / macroHeight);
+
+    BE_WORK work;
+    work.type = BLIT;
+    work.pfnWork = ProcessBlitBE;
+    work.desc.blit = *pBlit;
+
+    for (uint32_t x = macroTileXMin; x < macroTileXMax; ++x)
+    {
+        for (uint32_t y = macroTileYMin; y < macroTileYMax; ++y)
+        {
+            pTileMgr->enqueue(x, y, &work);
+        }
+    }
+
+    RDTSC_STOP(FEProcessBlit, 0, pDC->drawId);
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Computes the number of primitives given the number of verts.
 /// @param mode - primitive topology for draw operation.
@@ -983,6 +1044,13 @@ static void TessellationStages(
         }
     }
 
+    // assemble position
+    pa.Assemble(VERTEX_POSITION_SLOT, simdattrib);
+    for (uint32_t i = 0; i < numVertsPerPrim; ++i)
+    {
+        hsContext.vert[i].attrib[VERTEX_POSITION_SLOT] = simdattrib[i];
+    }
+
 #if defined(_DEBUG)
     memset(hsContext.pCPout, 0x90, sizeof(ScalarPatch) * KNOB_SIMD_WIDTH);
 #endif
@@ -1408,6 +1476,86 @@ template void ProcessDraw<true,  true,  true,  false, true >(SWR_CONTEXT *pConte
 template void ProcessDraw<true,  true,  true,  true,  false>(SWR_CONTEXT *pContext, DRAW_CONTEXT *pDC, uint32_t workerId, void *pUserData);
 template void ProcessDraw<true,  true,  true,  true,  true >(SWR_CONTEXT *pContext, DRAW_CONTEXT *pDC, uint32_t workerId, void *pUserData);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief FE handler for SwrDrawIndirect and SwrDrawIndexedIndirect.
+///        Reads the draw arguments and runs the draw FE for each draw.
+/// @param pContext - pointer to SWR context.
+/// @param pDC - pointer to draw context.
+/// @param workerId - thread's worker id.
+/// @param pUserData - Pointer to DRAW_INDIRECT_WORK
+void ProcessDrawIndirect(
+    SWR_CONTEXT *pContext,
+    DRAW_CONTEXT *pDC,
+    uint32_t workerId,
+    void *pUserData)
+{
+    DRAW_INDIRECT_WORK& work = *(DRAW_INDIRECT_WORK*)pUserData;
+    const API_STATE& state = GetApiState(pDC);
+
+    uint32_t drawCount = work.maxDrawCount;
+    if (work.pDrawCount)
+    {
+        drawCount = std::min(drawCount, *work.pDrawCount);
+    }
+
+    uint32_t indexSize = 0;
+    if (work.isIndexed)
+    {
+        switch (state.indexBuffer.format)
+        {
+        case R32_UINT: indexSize = sizeof(uint32_t); break;
+        case R16_UINT: indexSize = sizeof(uint16_t); break;
+        case R8_UINT: indexSize = sizeof(uint8_t); break;
+        default:
+            SWR_ASSERT(0);
+        }
+    }
+
+    for (uint32_t i = 0; i < drawCount; ++i)
+    {
+        const uint8_t* pArgs = work.pArgs + (uint64_t)i * work.stride;
+
+        DRAW_WORK draw = {};
+        draw.pDC = pDC;
+
+        if (work.isIndexed)
+        {
+            const SWR_DRAW_INDEXED_INDIRECT_ARGS& args = *(const SWR_DRAW_INDEXED_INDIRECT_ARGS*)pArgs;
+
+            // indices past the end of the index buffer are masked off by the
+            // fetch, but the first one has to be in bounds
+            uint64_t indexOffset = (uint64_t)args.indexOffset * indexSize;
+            if (indexOffset >= state.indexBuffer.size)
+            {
+                continue;
+            }
+
+            draw.numIndices = args.numIndices;
+            draw.pIB = (const int32_t*)((const uint8_t*)state.indexBuffer.pIndices + indexOffset);
+            draw.type = state.indexBuffer.format;
+            draw.baseVertex = args.baseVertex;
+            draw.numInstances = args.numInstances;
+            draw.startInstance = args.startInstance;
+        }
+        else
+        {
+            const SWR_DRAW_INDIRECT_ARGS& args = *(const SWR_DRAW_INDIRECT_ARGS*)pArgs;
+
+            draw.numVerts = args.numVertsPerInstance;
+            draw.startVertex = args.startVertex;
+            draw.numInstances = args.numInstances;
+            draw.startInstance = args.startInstance;
+        }
+
+        if (draw.numVerts == 0 || draw.numInstances == 0)
+        {
+            continue;
+        }
+
+        work.pfnDraw(pContext, pDC, workerId, &draw);
+    }
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 /// @brief Processes attributes for the backend based on linkage mask and
@@ -1658,12 +1806,23 @@ void BinTriangles(
     simdBBox bbox;
     calcBoundingBoxIntVertical(vXi, vYi, bbox);
 
+    if (rastState.conservativeRast)
+    {
+        // conservative rasterization covers pixels only touching the triangle;
+        // grow the bbox by 1 ULP to bin them, as the rasterizer does
+        bbox.left   = _simd_sub_epi32(bbox.left, _simd_set1_epi32(1));
+        bbox.top    = _simd_sub_epi32(bbox.top, _simd_set1_epi32(1));
+        bbox.right  = _simd_add_epi32(bbox.right, _simd_set1_epi32(1));
+        bbox.bottom = _simd_add_epi32(bbox.bottom, _simd_set1_epi32(1));
+    }
+
     // determine if triangle falls between pixel centers and discard
-    // only discard for non-MSAA case
+    // only discard for non-MSAA case, and not conservative where
+    // those still cover the pixels they touch
     // (left + 127) & ~255
     // (right + 128) & ~255
 
-    if(rastState.sampleCount == SWR_MULTISAMPLE_1X)
+    if(rastState.sampleCount == SWR_MULTISAMPLE_1X && !rastState.conservativeRast)
     {
         origTriMask = triMask;
 
@@ -1765,7 +1924,12 @@ void BinTriangles(
         desc.triFlags.primID = pPrimID[triIndex];
         desc.triFlags.renderTargetArrayIndex = aRTAI[triIndex];
 
-        if(rastState.samplePattern == SWR_MSAA_STANDARD_PATTERN)
+        if (rastState.conservativeRast)
+        {
+            // conservative coverage is per pixel, the backend broadcasts it
+            work.pfnWork = gConservativeRasterizerTable[rastState.scissorEnable];
+        }
+        else if(rastState.samplePattern == SWR_MSAA_STANDARD_PATTERN)
         {
             work.pfnWork = gRasterizerTable[rastState.scissorEnable][rastState.sampleCount];
         }
@@ -1824,6 +1988,49 @@ endBinTriangles:
 
 
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Allocates room for more points in a point cloud batch, starting
+///        at a SIMD's worth and doubling up to KNOB_POINT_CLOUD_BATCH_SIZE
+///        so sparse macrotiles don't each take a full batch of arena.
+/// @param pDC - pointer to draw context.
+/// @param desc - batch to grow, its points are copied over.
+static void GrowPointCloud(DRAW_CONTEXT *pDC, POINT_CLOUD_DESC &desc)
+{
+    uint32_t maxPoints = desc.maxPoints ? std::min(desc.maxPoints * 2, (uint32_t)KNOB_POINT_CLOUD_BATCH_SIZE) : KNOB_SIMD_WIDTH;
+    uint32_t attribsPerPoint = desc.numAttribs * 3 * 4;
+
+    Arena* pArena = pDC->pArena;
+    SWR_ASSERT(pArena != nullptr);
+    uint32_t *pX = (uint32_t*)pArena->AllocAligned(maxPoints * sizeof(uint32_t), 16);
+    uint32_t *pY = (uint32_t*)pArena->AllocAligned(maxPoints * sizeof(uint32_t), 16);
+    float *pZ = (float*)pArena->AllocAligned(maxPoints * sizeof(float), 16);
+    uint32_t *pPrimID = (uint32_t*)pArena->AllocAligned(maxPoints * sizeof(uint32_t), 16);
+    float *pAttribs = nullptr;
+    if (attribsPerPoint)
+    {
+        pAttribs = (float*)pArena->AllocAligned(maxPoints * attribsPerPoint * sizeof(float), 16);
+    }
+
+    if (desc.numPoints)
+    {
+        memcpy(pX, desc.pX, desc.numPoints * sizeof(uint32_t));
+        memcpy(pY, desc.pY, desc.numPoints * sizeof(uint32_t));
+        memcpy(pZ, desc.pZ, desc.numPoints * sizeof(float));
+        memcpy(pPrimID, desc.pPrimID, desc.numPoints * sizeof(uint32_t));
+        if (attribsPerPoint)
+        {
+            memcpy(pAttribs, desc.pAttribs, desc.numPoints * attribsPerPoint * sizeof(float));
+        }
+    }
+
+    desc.pX = pX;
+    desc.pY = pY;
+    desc.pZ = pZ;
+    desc.pPrimID = pPrimID;
+    desc.pAttribs = pAttribs;
+    desc.maxPoints = maxPoints;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Bin SIMD points to the backend.  Only supports point size of 1
 /// @param pDC - pointer to draw context.
@@ -1880,34 +2087,33 @@ void BinPoints(
         primMask &= ~_simd_movemask_ps(_simd_castsi_ps(vXi));
         primMask &= ~_simd_movemask_ps(_simd_castsi_ps(vYi));
 
+        // cull points outside the scissor/viewport
+        simdscalari vPixelX = _simd_srai_epi32(vXi, FIXED_POINT_SHIFT);
+        simdscalari vPixelY = _simd_srai_epi32(vYi, FIXED_POINT_SHIFT);
+        {
+            simdscalari maskOutsideScissorX = _simd_or_si(
+                _simd_cmpgt_epi32(_simd_set1_epi32(state.scissorInFixedPoint.left >> FIXED_POINT_SHIFT), vPixelX),
+                _simd_cmpgt_epi32(vPixelX, _simd_set1_epi32(state.scissorInFixedPoint.right >> FIXED_POINT_SHIFT)));
+            simdscalari maskOutsideScissorY = _simd_or_si(
+                _simd_cmpgt_epi32(_simd_set1_epi32(state.scissorInFixedPoint.top >> FIXED_POINT_SHIFT), vPixelY),
+                _simd_cmpgt_epi32(vPixelY, _simd_set1_epi32(state.scissorInFixedPoint.bottom >> FIXED_POINT_SHIFT)));
+            simdscalari maskOutsideScissorXY = _simd_or_si(maskOutsideScissorX, maskOutsideScissorY);
+            primMask &= ~_simd_movemask_ps(_simd_castsi_ps(maskOutsideScissorXY));
+        }
+
         // compute macro tile coordinates 
         simdscalari macroX = _simd_srai_epi32(vXi, KNOB_MACROTILE_X_DIM_FIXED_SHIFT);
         simdscalari macroY = _simd_srai_epi32(vYi, KNOB_MACROTILE_Y_DIM_FIXED_SHIFT);
+        simdscalari macroID = _simd_or_si(_simd_slli_epi32(macroX, 16), macroY);
 
-        OSALIGNSIMD(uint32_t) aMacroX[KNOB_SIMD_WIDTH], aMacroY[KNOB_SIMD_WIDTH];
+        OSALIGNSIMD(uint32_t) aMacroX[KNOB_SIMD_WIDTH], aMacroY[KNOB_SIMD_WIDTH], aMacroID[KNOB_SIMD_WIDTH];
         _simd_store_si((simdscalari*)aMacroX, macroX);
         _simd_store_si((simdscalari*)aMacroY, macroY);
+        _simd_store_si((simdscalari*)aMacroID, macroID);
 
-        // compute raster tile coordinates
-        simdscalari rasterX = _simd_srai_epi32(vXi, KNOB_TILE_X_DIM_SHIFT + FIXED_POINT_SHIFT);
-        simdscalari rasterY = _simd_srai_epi32(vYi, KNOB_TILE_Y_DIM_SHIFT + FIXED_POINT_SHIFT);
-
-        // compute raster tile relative x,y for coverage mask
-        simdscalari tileAlignedX = _simd_slli_epi32(rasterX, KNOB_TILE_X_DIM_SHIFT);
-        simdscalari tileAlignedY = _simd_slli_epi32(rasterY, KNOB_TILE_Y_DIM_SHIFT);
-
-        simdscalari tileRelativeX = _simd_sub_epi32(_simd_srai_epi32(vXi, FIXED_POINT_SHIFT), tileAlignedX);
-        simdscalari tileRelativeY = _simd_sub_epi32(_simd_srai_epi32(vYi, FIXED_POINT_SHIFT), tileAlignedY);
-
-        OSALIGNSIMD(uint32_t) aTileRelativeX[KNOB_SIMD_WIDTH];
-        OSALIGNSIMD(uint32_t) aTileRelativeY[KNOB_SIMD_WIDTH];
-        _simd_store_si((simdscalari*)aTileRelativeX, tileRelativeX);
-        _simd_store_si((simdscalari*)aTileRelativeY, tileRelativeY);
-
-        OSALIGNSIMD(uint32_t) aTileAlignedX[KNOB_SIMD_WIDTH];
-        OSALIGNSIMD(uint32_t) aTileAlignedY[KNOB_SIMD_WIDTH];
-        _simd_store_si((simdscalari*)aTileAlignedX, tileAlignedX);
-        _simd_store_si((simdscalari*)aTileAlignedY, tileAlignedY);
+        OSALIGNSIMD(uint32_t) aPixelX[KNOB_SIMD_WIDTH], aPixelY[KNOB_SIMD_WIDTH];
+        _simd_store_si((simdscalari*)aPixelX, vPixelX);
+        _simd_store_si((simdscalari*)aPixelY, vPixelY);
 
         OSALIGNSIMD(float) aZ[KNOB_SIMD_WIDTH];
         _simd_store_ps((float*)aZ, primVerts.z);
@@ -1926,61 +2132,69 @@ void BinPoints(
             _simd_store_si((simdscalari*)aRTAI, _simd_setzero_si());
         }
 
+        uint32_t linkageCount = state.linkageCount;
+        uint32_t linkageMask = state.linkageMask;
+        uint32_t numScalarAttribs = linkageCount * 4;
+
         uint32_t *pPrimID = (uint32_t *)&primID;
+        MacroTileMgr *pTileMgr = pDC->pTileMgr;
         DWORD primIndex = 0;
-        // scan remaining valid triangles and bin each separately
+        // append the points of each macrotile in the SIMD to the draw's batch for it
         while (_BitScanForward(&primIndex, primMask))
         {
-            uint32_t linkageCount = state.linkageCount;
-            uint32_t linkageMask = state.linkageMask;
+            uint32_t tileMask = primMask & _simd_movemask_ps(_simd_castsi_ps(
+                _simd_cmpeq_epi32(macroID, _simd_set1_epi32(aMacroID[primIndex]))));
+            primMask &= ~tileMask;
 
-            uint32_t numScalarAttribs = linkageCount * 4;
-
-            BE_WORK work;
-            work.type = DRAW;
-
-            TRIANGLE_WORK_DESC &desc = work.desc.tri;
-
-            // points are always front facing
-            desc.triFlags.frontFacing = 1;
-            desc.triFlags.primID = pPrimID[primIndex];
-            desc.triFlags.renderTargetArrayIndex = aRTAI[primIndex];
-
-            work.pfnWork = RasterizeSimplePoint;
-
-            Arena* pArena = pDC->pArena;
-            SWR_ASSERT(pArena != nullptr);
-
-            // store attributes
-            float *pAttribs = (float*)pArena->AllocAligned(3 * numScalarAttribs * sizeof(float), 16);
-            desc.pAttribs = pAttribs;
-            desc.numAttribs = linkageCount;
-
-            ProcessAttributes<1>(pDC, pa, linkageMask, state.linkageMap, primIndex, pAttribs);
+#if KNOB_ENABLE_TOSS_POINTS
+            if (KNOB_TOSS_SETUP_TRIS)
+            {
+                continue;
+            }
+#endif
+            BE_WORK *pWork = pTileMgr->peekLastQueued(aMacroX[primIndex], aMacroY[primIndex]);
 
-            // store raster tile aligned x, y, perspective correct z
-            float *pTriBuffer = (float*)pArena->AllocAligned(4 * sizeof(float), 16);
-            desc.pTriBuffer = pTriBuffer;
-            *(uint32_t*)pTriBuffer++ = aTileAlignedX[primIndex];
-            *(uint32_t*)pTriBuffer++ = aTileAlignedY[primIndex];
-            *pTriBuffer = aZ[primIndex];
+            DWORD pointIndex = 0;
+            while (_BitScanForward(&pointIndex, tileMask))
+            {
+                tileMask &= ~(1 << pointIndex);
 
-            uint32_t tX = aTileRelativeX[primIndex];
-            uint32_t tY = aTileRelativeY[primIndex];
+                if (pWork == nullptr || pWork->pfnWork != RasterizePointCloud ||
+                    pWork->desc.pointCloud.renderTargetArrayIndex != aRTAI[pointIndex] ||
+                    pWork->desc.pointCloud.numPoints == KNOB_POINT_CLOUD_BATCH_SIZE)
+                {
+                    BE_WORK work;
+                    work.type = DRAW;
+                    work.pfnWork = RasterizePointCloud;
+
+                    POINT_CLOUD_DESC &desc = work.desc.pointCloud;
+                    desc.numAttribs = linkageCount;
+                    desc.numPoints = 0;
+                    desc.maxPoints = 0;
+                    desc.renderTargetArrayIndex = aRTAI[pointIndex];
+                    GrowPointCloud(pDC, desc);
+
+                    pTileMgr->enqueue(aMacroX[primIndex], aMacroY[primIndex], &work);
+                    pWork = pTileMgr->peekLastQueued(aMacroX[primIndex], aMacroY[primIndex]);
+                }
 
-            // pack the relative x,y into the coverageMask, the rasterizer will
-            // generate the true coverage mask from it
-            work.desc.tri.triFlags.coverageMask = tX | (tY << 4);
+                POINT_CLOUD_DESC &desc = pWork->desc.pointCloud;
+                if (desc.numPoints == desc.maxPoints)
+                {
+                    GrowPointCloud(pDC, desc);
+                }
 
-            // bin it
-            MacroTileMgr *pTileMgr = pDC->pTileMgr;
-#if KNOB_ENABLE_TOSS_POINTS
-            if (!KNOB_TOSS_SETUP_TRIS)
-#endif
-            {
-                pTileMgr->enqueue(aMacroX[primIndex], aMacroY[primIndex], &work);
+                uint32_t point = desc.numPoints++;
+                desc.pX[point] = aPixelX[pointIndex];
+                desc.pY[point] = aPixelY[pointIndex];
+                desc.pZ[point] = aZ[pointIndex];
+                desc.pPrimID[point] = pPrimID[pointIndex];
+                if (linkageCount)
+                {
+                    ProcessAttributes<1>(pDC, pa, linkageMask, state.linkageMap, pointIndex,
+                        &desc.pAttribs[point * 3 * numScalarAttribs]);
+                }
             }
-            primMask &= ~(1 << primIndex);
         }
     }
     else
@@ -2297,7 +2511,7 @@ void BinLines(
         desc.triFlags.yMajor = (yMajorMask >> primIndex) & 1;
         desc.triFlags.renderTargetArrayIndex = aRTAI[primIndex];
 
-        work.pfnWork = RasterizeLine;
+        work.pfnWork = gLineRasterizerTable[rastState.sampleCount];
 
         Arena* pArena = pDC->pArena;
         SWR_ASSERT(pArena != nullptr);
@@ -2318,8 +2532,18 @@ void BinLines(
         if (rastState.clipDistanceMask)
         {
             uint32_t numClipDist = _mm_popcnt_u32(rastState.clipDistanceMask);
-            desc.pUserClipBuffer = (float*)pArena->Alloc(numClipDist * 2 * sizeof(float));
-            ProcessUserClipDist<2>(pa, primIndex, rastState.clipDistanceMask, desc.pUserClipBuffer);
+            desc.pUserClipBuffer = (float*)pArena->Alloc(numClipDist * 3 * sizeof(float));
+
+            // the line rasterizer interpolates along the major axis with j = 0;
+            // widen the (c0 - c1, c1) pairs to the backend's 3 coef layout
+            float lineClipDist[2 * 8];
+            ProcessUserClipDist<2>(pa, primIndex, rastState.clipDistanceMask, lineClipDist);
+            for (uint32_t i = 0; i < numClipDist; ++i)
+            {
+                desc.pUserClipBuffer[i * 3 + 0] = lineClipDist[i * 2 + 0];
+                desc.pUserClipBuffer[i * 3 + 1] = 0.0f;
+                desc.pUserClipBuffer[i * 3 + 2] = lineClipDist[i * 2 + 1];
+            }
         }
 
         MacroTileMgr *pTileMgr = pDC->pTileMgr;
@@ -74,6 +74,9 @@
 // Maximum supported active viewports and scissors
 #define KNOB_NUM_VIEWPORTS_SCISSORS         16
 
+// Thread group shared memory per compute thread group, in bytes
+#define KNOB_MAX_TGSM_SIZE                  (32 * 1024)
+
 // Guardband range used by the clipper
 #define KNOB_GUARDBAND_WIDTH                32768.0f
 #define KNOB_GUARDBAND_HEIGHT               32768.0f
@@ -130,6 +133,15 @@
 // enables cut-aware primitive assembler
 #define KNOB_ENABLE_CUT_AWARE_PA               TRUE
 
+// max simple points binned to a macrotile per work item
+#define KNOB_POINT_CLOUD_BATCH_SIZE            1024
+
+// allocations of at least this size go on huge pages where the OS allows
+#define KNOB_HUGE_PAGE_SIZE                    (2 * 1024 * 1024)
+
+// hot tile buffers are carved out of slabs of this size
+#define KNOB_HOT_TILE_SLAB_SIZE                KNOB_HUGE_PAGE_SIZE
+
 ///////////////////////////////////////////////////////////////////////////////
 // Debug knobs
 ///////////////////////////////////////////////////////////////////////////////
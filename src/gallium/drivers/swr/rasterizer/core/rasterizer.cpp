@@ -33,6 +33,7 @@
 #include "multisample.h"
 #include "rdtsc_core.h"
 #include "backend.h"
+#include "depthstencil.h"
 #include "utils.h"
 #include "frontend.h"
 #include "tilemgr.h"
@@ -294,6 +295,25 @@ INLINE __m256d adjustTopLeftRuleIntFix16(const __m128i vA, const __m128i vB, con
     return vEdgeOut;
 }
 
+// Conservative rasterization replaces the top left rule:
+// Move each edge out by the pixel half-diagonal, |a|/2 + |b|/2, the most an edge
+// changes between the pixel center and a pixel corner. A pixel center then tests
+// in as soon as any part of the pixel touches the triangle, edges included.
+// Moving the edge in by the same amount gives the inner coverage test, in only for
+// pixels completely inside; vInnerOffset steps from the one to the other.
+INLINE __m256d adjustConservativeIntFix16(const __m128i vA, const __m128i vB, const __m256d vEdge, __m256d &vInnerOffset)
+{
+    __m128i vAbsAB = _mm_add_epi32(_mm_abs_epi32(vA), _mm_abs_epi32(vB));
+    __m256d vHalfDiagonal = _mm256_mul_pd(_mm256_cvtepi32_pd(vAbsAB), _mm256_set1_pd(FIXED_POINT_SCALE / 2));
+
+    // edge - halfDiagonal <= 0 is in; bump by 1 so the movemask test (edge < 0) includes it
+    __m256d vEdgeOut = _mm256_sub_pd(_mm256_sub_pd(vEdge, vHalfDiagonal), _mm256_set1_pd(1.0));
+
+    // edge + halfDiagonal < 0 is fully covered
+    vInnerOffset = _mm256_add_pd(_mm256_add_pd(vHalfDiagonal, vHalfDiagonal), _mm256_set1_pd(1.0));
+    return vEdgeOut;
+}
+
 // max(abs(dz/dx), abs(dz,dy)
 INLINE float ComputeMaxDepthSlope(const SWR_TRIANGLE_DESC* pDesc)
 {
@@ -422,7 +442,7 @@ void ComputeEdgeData(const POS& p0, const POS& p1, EDGE& edge)
     ComputeEdgeData(p0.y - p1.y, p1.x - p0.x, edge);
 }
 
-template<bool RasterizeScissorEdges, SWR_MULTISAMPLE_COUNT sampleCount>
+template<bool RasterizeScissorEdges, SWR_MULTISAMPLE_COUNT sampleCount, bool ConservativeRast>
 void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile, void* pDesc)
 {
     const TRIANGLE_WORK_DESC &workDesc = *((TRIANGLE_WORK_DESC*)pDesc);
@@ -441,6 +461,11 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
 
     OSALIGN(SWR_TRIANGLE_DESC, 16) triDesc;
     triDesc.pUserClipBuffer = workDesc.pUserClipBuffer;
+    triDesc.innerCoverageMask = 0;
+
+    // conservative coverage is computed once at the pixel center for all samples
+    static_assert(!ConservativeRast || sampleCount == SWR_MULTISAMPLE_1X, "Conservative rasterization is single sample");
+    const bool bInnerCoverage = ConservativeRast && (state.psState.inputCoverage == SWR_INPUT_COVERAGE_INNER_CONSERVATIVE);
 
     __m128 vX, vY, vZ, vRecipW;
     
@@ -578,6 +603,15 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
     OSALIGN(BBOX, 16) bbox;
     calcBoundingBoxInt(vXi, vYi, bbox);
 
+    if (ConservativeRast)
+    {
+        // pixels only touching the bbox are in; must match the binner
+        bbox.left -= 1;
+        bbox.top -= 1;
+        bbox.right += 1;
+        bbox.bottom += 1;
+    }
+
     // Intersect with scissor/viewport
     bbox.left = std::max(bbox.left, state.scissorInFixedPoint.left);
     bbox.right = std::min(bbox.right - 1, state.scissorInFixedPoint.right);
@@ -669,8 +703,18 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
     __m256d vBiDeltaYFix16 = _mm256_mul_pd(vBipd, vDeltaYpd);
     __m256d vEdge = _mm256_add_pd(vAiDeltaXFix16, vBiDeltaYFix16);
 
-    // adjust for top-left rule
-    vEdge = adjustTopLeftRuleIntFix16(vAi, vBi, vEdge);
+    // adjust for top-left rule, or grow the edges for conservative rasterization
+    OSALIGN(double, 32) innerOffsets[4];
+    if (ConservativeRast)
+    {
+        __m256d vInnerOffset;
+        vEdge = adjustConservativeIntFix16(vAi, vBi, vEdge, vInnerOffset);
+        _mm256_store_pd(innerOffsets, vInnerOffset);
+    }
+    else
+    {
+        vEdge = adjustTopLeftRuleIntFix16(vAi, vBi, vEdge);
+    }
 
     // broadcast respective edge results to all lanes
     double* pEdge = (double*)&vEdge;
@@ -868,6 +912,37 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
                 }
             }
 
+            if (bInnerCoverage && anyCoveredSamples)
+            {
+                // same trivial accept/reject and partial rasterization for the edges moved in
+                __m256d vInnerEdge0 = _mm256_add_pd(vEdgeFix16[0], _mm256_set1_pd(innerOffsets[0]));
+                __m256d vInnerEdge1 = _mm256_add_pd(vEdgeFix16[1], _mm256_set1_pd(innerOffsets[1]));
+                __m256d vInnerEdge2 = _mm256_add_pd(vEdgeFix16[2], _mm256_set1_pd(innerOffsets[2]));
+                int innerMask0 = _mm256_movemask_pd(vInnerEdge0);
+                int innerMask1 = _mm256_movemask_pd(vInnerEdge1);
+                int innerMask2 = _mm256_movemask_pd(vInnerEdge2);
+
+                if (!(innerMask0 && innerMask1 && innerMask2))
+                {
+                    triDesc.innerCoverageMask = 0;
+                }
+                else if ((innerMask0 & innerMask1 & innerMask2) == 0xf)
+                {
+                    triDesc.innerCoverageMask = triDesc.coverageMask[0];
+                }
+                else
+                {
+                    double startInnerEdges[3];
+                    const __m256i vLane0Mask = _mm256_set_epi32(0, 0, 0, 0, 0, 0, -1, -1);
+                    _mm256_maskstore_pd(&startInnerEdges[0], vLane0Mask, vInnerEdge0);
+                    _mm256_maskstore_pd(&startInnerEdges[1], vLane0Mask, vInnerEdge1);
+                    _mm256_maskstore_pd(&startInnerEdges[2], vLane0Mask, vInnerEdge2);
+
+                    // scissored pixels are already out of the outer coverage
+                    triDesc.innerCoverageMask = rasterizePartialTile<3>(pDC, startInnerEdges, rastEdges) & triDesc.coverageMask[0];
+                }
+            }
+
 #if KNOB_ENABLE_TOSS_POINTS
             if(KNOB_TOSS_RS)
             {
@@ -1036,7 +1111,147 @@ void RasterizeTriPoint(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile,
     pfnTriRast(pDC, workerId, macroTile, (void*)&newWorkDesc);
 }
 
-void RasterizeSimplePoint(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void* pData)
+// map x,y relative offsets from start of raster tile to bit position in 
+// coverage mask for a pixel
+static const uint32_t gPointCoverageMap[8][8] = {
+    { 0, 1, 4, 5, 8, 9, 12, 13 },
+    { 2, 3, 6, 7, 10, 11, 14, 15 },
+    { 16, 17, 20, 21, 24, 25, 28, 29 },
+    { 18, 19, 22, 23, 26, 27, 30, 31 },
+    { 32, 33, 36, 37, 40, 41, 44, 45 },
+    { 34, 35, 38, 39, 42, 43, 46, 47 },
+    { 48, 49, 52, 53, 56, 57, 60, 61 },
+    { 50, 51, 54, 55, 58, 59, 62, 63 }
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Shades a SIMD of points whose pixel shader outputs are the same
+///        for every pixel. Color, depth and stencil of the points' pixels
+///        are gathered into a SIMD quad's worth of hot tile, run through
+///        the regular depth/stencil test and output merger, and scattered
+///        back. Lanes must hit distinct pixels.
+/// @param numRT - render targets written, 0 without a pixel shader
+/// @param pointMask - lanes holding points
+/// @param offsets - byte offset of each lane's pixel into the depth hot
+///        tile, the stencil and color offsets derive from it
+INLINE void ShadePointCloudSimd(DRAW_CONTEXT *pDC, uint32_t workerId, SWR_PS_CONTEXT &psContext,
+    const simdvector (&shaded)[SWR_NUM_RENDERTARGETS], uint32_t NumRT, const RenderOutputBuffers &renderBuffers,
+    const float *pZ, uint32_t pointMask, const uint32_t (&offsets)[KNOB_SIMD_WIDTH])
+{
+    SWR_CONTEXT *pContext = pDC->pContext;
+    const API_STATE& state = GetApiState(pDC);
+    const BACKEND_FUNCS& backendFuncs = pDC->pState->backendFuncs;
+
+    static_assert(KNOB_DEPTH_HOT_TILE_FORMAT == R32_FLOAT, "Unsupported depth hot tile format");
+    static_assert(KNOB_STENCIL_HOT_TILE_FORMAT == R8_UINT, "Unsupported stencil hot tile format");
+    static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported color hot tile format");
+
+    // a pixel's bit in the raster tile coverage mask is its 4 byte depth offset,
+    // color is stored a SIMD of each component per quad
+    OSALIGNSIMD(uint32_t) colorOffsets[KNOB_SIMD_WIDTH];
+    for (uint32_t lane = 0; lane < KNOB_SIMD_WIDTH; ++lane)
+    {
+        uint32_t bit = offsets[lane] / sizeof(float);
+        uint32_t quad = bit / KNOB_SIMD_WIDTH;
+        colorOffsets[lane] = (bit & ~(KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM - 1)) * 4 * sizeof(float) +
+            (quad % (KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM / KNOB_SIMD_WIDTH)) * KNOB_SIMD_WIDTH * 4 * sizeof(float) +
+            (bit % KNOB_SIMD_WIDTH) * sizeof(float);
+    }
+
+    OSALIGNSIMD(float) depth[KNOB_SIMD_WIDTH];
+    OSALIGNSIMD(uint8_t) stencil[KNOB_SIMD_WIDTH];
+    OSALIGNSIMD(float) color[SWR_NUM_RENDERTARGETS][4 * KNOB_SIMD_WIDTH];
+    uint8_t *pColorBase[SWR_NUM_RENDERTARGETS];
+
+    // gather
+    DWORD lane;
+    uint32_t mask = pointMask;
+    while (_BitScanForward(&lane, mask))
+    {
+        mask &= ~(1 << lane);
+        if (state.depthHottileEnable)
+        {
+            depth[lane] = *(float*)(renderBuffers.pDepth + offsets[lane]);
+        }
+        if (state.stencilHottileEnable)
+        {
+            stencil[lane] = *(renderBuffers.pStencil + offsets[lane] / sizeof(float));
+        }
+        for (uint32_t rt = 0; rt < NumRT; ++rt)
+        {
+            for (uint32_t comp = 0; comp < 4; ++comp)
+            {
+                color[rt][comp * KNOB_SIMD_WIDTH + lane] = *(float*)(renderBuffers.pColor[rt] + colorOffsets[lane] + comp * KNOB_SIMD_WIDTH * sizeof(float));
+            }
+        }
+    }
+    for (uint32_t rt = 0; rt < NumRT; ++rt)
+    {
+        pColorBase[rt] = (uint8_t*)color[rt];
+        psContext.shaded[rt] = shaded[rt];
+    }
+
+    psContext.vZ = _simd_loadu_ps(pZ);
+    simdscalar vCoverageMask = vMask(pointMask);
+    simdscalar stencilPassMask = vCoverageMask;
+    simdscalar depthPassMask = DepthStencilTest(&state.vp[0], &state.depthStencilState, true, psContext.vZ,
+        (uint8_t*)depth, vCoverageMask, stencil, &stencilPassMask);
+
+    uint32_t statMask = _simd_movemask_ps(depthPassMask);
+    UPDATE_STAT(DepthPassCount, _mm_popcnt_u32(statMask));
+
+    // the batch is shaded once, but each point passing the early tests
+    // counts as an invocation, as it would in the pixel backend
+    if (state.psState.pfnPixelShader != nullptr)
+    {
+        UPDATE_STAT(PsInvocations, _mm_popcnt_u32(statMask));
+    }
+
+    if (statMask && NumRT)
+    {
+        RDTSC_START(BEOutputMerger);
+        psContext.oMask = _simd_set1_epi32(-1);
+        backendFuncs.pfnOutputMerger(psContext, pColorBase, 0, &state.blendState, state.pfnBlendFunc,
+                                     vCoverageMask, depthPassMask);
+        RDTSC_STOP(BEOutputMerger, 0, 0);
+    }
+
+    DepthStencilWrite(&state.vp[0], &state.depthStencilState, true, psContext.vZ,
+        (uint8_t*)depth, depthPassMask, vCoverageMask, stencil, stencilPassMask);
+
+    // scatter
+    mask = pointMask;
+    while (_BitScanForward(&lane, mask))
+    {
+        mask &= ~(1 << lane);
+        if (state.depthHottileEnable)
+        {
+            *(float*)(renderBuffers.pDepth + offsets[lane]) = depth[lane];
+        }
+        if (state.stencilHottileEnable)
+        {
+            *(renderBuffers.pStencil + offsets[lane] / sizeof(float)) = stencil[lane];
+        }
+        if (statMask & (1 << lane))
+        {
+            for (uint32_t rt = 0; rt < NumRT; ++rt)
+            {
+                for (uint32_t comp = 0; comp < 4; ++comp)
+                {
+                    *(float*)(renderBuffers.pColor[rt] + colorOffsets[lane] + comp * KNOB_SIMD_WIDTH * sizeof(float)) = color[rt][comp * KNOB_SIMD_WIDTH + lane];
+                }
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Rasterizes a batch of simple points binned to a macrotile. 
+///        Without a pixel shader, or with one whose outputs are constant,
+///        the shader runs at most once for the batch and the points go
+///        through depth/stencil and output merger KNOB_SIMD_WIDTH at a
+///        time. Otherwise each point is handed to the pixel backend.
+void RasterizePointCloud(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void* pData)
 {
 #if KNOB_ENABLE_TOSS_POINTS
     if (KNOB_TOSS_BIN_TRIS)
@@ -1045,57 +1260,146 @@ void RasterizeSimplePoint(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTi
     }
 #endif
 
-    const TRIANGLE_WORK_DESC& workDesc = *(const TRIANGLE_WORK_DESC*)pData;
+    const POINT_CLOUD_DESC& desc = *(const POINT_CLOUD_DESC*)pData;
+    const API_STATE& state = GetApiState(pDC);
+    const SWR_PS_STATE *pPSState = &state.psState;
     const BACKEND_FUNCS& backendFuncs = pDC->pState->backendFuncs;
 
-    // map x,y relative offsets from start of raster tile to bit position in 
-    // coverage mask for the point
-    static const uint32_t coverageMap[8][8] = {
-        { 0, 1, 4, 5, 8, 9, 12, 13 },
-        { 2, 3, 6, 7, 10, 11, 14, 15 },
-        { 16, 17, 20, 21, 24, 25, 28, 29 },
-        { 18, 19, 22, 23, 26, 27, 30, 31 },
-        { 32, 33, 36, 37, 40, 41, 44, 45 },
-        { 34, 35, 38, 39, 42, 43, 46, 47 },
-        { 48, 49, 52, 53, 56, 57, 60, 61 },
-        { 50, 51, 54, 55, 58, 59, 62, 63 }
-    };
+    // hot tile buffers of the macrotile's first raster tile
+    uint32_t macroX, macroY;
+    MacroTileMgr::getTileIndices(macroTile, macroX, macroY);
+    const uint32_t macroLeft = macroX * KNOB_MACROTILE_X_DIM;
+    const uint32_t macroTop = macroY * KNOB_MACROTILE_Y_DIM;
+
+    RenderOutputBuffers renderBuffers;
+    GetRenderHotTiles(pDC, macroTile, macroX * KNOB_MACROTILE_X_DIM_IN_TILES, macroY * KNOB_MACROTILE_Y_DIM_IN_TILES,
+        renderBuffers, 1, desc.renderTargetArrayIndex);
 
-    OSALIGN(SWR_TRIANGLE_DESC, 16) triDesc;
+    static const uint32_t colorRasterTileStep{KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp / 8)};
+    static const uint32_t depthRasterTileStep{KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp / 8)};
+    static const uint32_t stencilRasterTileStep{KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_STENCIL_HOT_TILE_FORMAT>::bpp / 8)};
 
-    // pull point information from triangle buffer
-    // @todo use structs for readability
-    uint32_t tileAlignedX = *(uint32_t*)workDesc.pTriBuffer;
-    uint32_t tileAlignedY = *(uint32_t*)(workDesc.pTriBuffer + 1);
-    float z = *(workDesc.pTriBuffer + 2);
+    const bool bConstantShading = (pPSState->pfnPixelShader == nullptr) ||
+        (pPSState->constantOutput && !pPSState->killsPixel && !pPSState->writesODepth &&
+         !pPSState->usesSourceDepth && !pPSState->usesUAV && (pPSState->inputCoverage == SWR_INPUT_COVERAGE_NONE));
+
+    if (!bConstantShading)
+    {
+        OSALIGN(SWR_TRIANGLE_DESC, 16) triDesc;
+        triDesc.triFlags.frontFacing = 1;
+        triDesc.triFlags.renderTargetArrayIndex = desc.renderTargetArrayIndex;
+        triDesc.innerCoverageMask = 0;
+        triDesc.pUserClipBuffer = nullptr;
+
+        // no interpolation, set up i,j for constant interpolation of z and attribs
+        triDesc.recipDet = 1.0f;
+        triDesc.OneOverW[0] = triDesc.OneOverW[1] = triDesc.OneOverW[2] = 1.0f;
+        triDesc.I[0] = triDesc.I[1] = triDesc.I[2] = 0.0f;
+        triDesc.J[0] = triDesc.J[1] = triDesc.J[2] = 0.0f;
+
+        for (uint32_t point = 0; point < desc.numPoints; ++point)
+        {
+            uint32_t x = desc.pX[point] - macroLeft;
+            uint32_t y = desc.pY[point] - macroTop;
+            uint32_t tileX = x >> KNOB_TILE_X_DIM_SHIFT;
+            uint32_t tileY = y >> KNOB_TILE_Y_DIM_SHIFT;
+
+            // no persp divide needed for points
+            triDesc.pAttribs = triDesc.pPerspAttribs = desc.pAttribs + point * desc.numAttribs * 3 * 4;
+            triDesc.triFlags.primID = desc.pPrimID[point];
+            triDesc.Z[0] = triDesc.Z[1] = triDesc.Z[2] = desc.pZ[point];
+            triDesc.coverageMask[0] = 1ULL << gPointCoverageMap[y & (KNOB_TILE_Y_DIM - 1)][x & (KNOB_TILE_X_DIM - 1)];
+
+            // hot tile buffers are laid out linearly in raster tiles
+            RenderOutputBuffers tileBuffers = renderBuffers;
+            uint32_t tileIndex = tileY * KNOB_MACROTILE_X_DIM_IN_TILES + tileX;
+            StepRasterTileX(state.psState.numRenderTargets, tileBuffers, tileIndex * colorRasterTileStep,
+                tileIndex * depthRasterTileStep, tileIndex * stencilRasterTileStep);
+
+            RDTSC_START(BEPixelBackend);
+            backendFuncs.pfnBackend(pDC, workerId, desc.pX[point] & ~(KNOB_TILE_X_DIM - 1), desc.pY[point] & ~(KNOB_TILE_Y_DIM - 1),
+                triDesc, tileBuffers);
+            RDTSC_STOP(BEPixelBackend, 0, 0);
+        }
+        return;
+    }
 
-    // construct triangle descriptor for point
-    // no interpolation, set up i,j for constant interpolation of z and attribs
-    // @todo implement an optimized backend that doesn't require triangle information
+    // outputs are the same for every pixel, shade once for the batch
+    SWR_PS_CONTEXT psContext;
+    simdvector shaded[SWR_NUM_RENDERTARGETS];
+    const uint32_t numRT = (pPSState->pfnPixelShader != nullptr) ? pPSState->numRenderTargets : 0;
+    if (numRT)
+    {
+        static const float zero[3] = { 0.0f, 0.0f, 0.0f };
+        static const float one[3] = { 1.0f, 1.0f, 1.0f };
+        psContext.pAttribs = psContext.pPerspAttribs = desc.pAttribs;
+        psContext.frontFace = 1;
+        psContext.primID = desc.pPrimID[0];
+        psContext.I = psContext.J = zero;
+        psContext.recipDet = 1.0f;
+        psContext.pRecipW = one;
+        psContext.pSamplePosX = (const float*)&MultisampleTraits<SWR_MULTISAMPLE_1X>::samplePosX;
+        psContext.pSamplePosY = (const float*)&MultisampleTraits<SWR_MULTISAMPLE_1X>::samplePosY;
+        psContext.vX.UL = psContext.vX.center = _simd_set1_ps((float)desc.pX[0] + 0.5f);
+        psContext.vY.UL = psContext.vY.center = _simd_set1_ps((float)desc.pY[0] + 0.5f);
+        psContext.vI.center = psContext.vJ.center = _simd_setzero_ps();
+        psContext.vOneOverW.center = _simd_set1_ps(1.0f);
+        psContext.vZ = _simd_set1_ps(desc.pZ[0]);
+        psContext.sampleIndex = 0;
+        psContext.activeMask = _simd_set1_epi32(-1);
+
+        RDTSC_START(BEPixelShader);
+        pPSState->pfnPixelShader(GetPrivateState(pDC), &psContext);
+        RDTSC_STOP(BEPixelShader, 0, 0);
+
+        for (uint32_t rt = 0; rt < numRT; ++rt)
+        {
+            shaded[rt] = psContext.shaded[rt];
+        }
+    }
 
-    // compute coverage mask from x,y packed into the coverageMask flag
-    // mask indices by the maximum valid index for x/y of coveragemap.
-    uint32_t tX = workDesc.triFlags.coverageMask & 0x7;
-    uint32_t tY = (workDesc.triFlags.coverageMask >> 4) & 0x7;
-    // todo: multisample points?
-    triDesc.coverageMask[0] = 1ULL << coverageMap[tY][tX];
+    for (uint32_t first = 0; first < desc.numPoints; first += KNOB_SIMD_WIDTH)
+    {
+        uint32_t numLanes = std::min(desc.numPoints - first, (uint32_t)KNOB_SIMD_WIDTH);
+        uint32_t pointMask = (1 << numLanes) - 1;
 
-    // no persp divide needed for points
-    triDesc.pAttribs = triDesc.pPerspAttribs = workDesc.pAttribs;
-    triDesc.triFlags = workDesc.triFlags;
-    triDesc.recipDet = 1.0f;
-    triDesc.OneOverW[0] = triDesc.OneOverW[1] = triDesc.OneOverW[2] = 1.0f;
-    triDesc.I[0] = triDesc.I[1] = triDesc.I[2] = 0.0f;
-    triDesc.J[0] = triDesc.J[1] = triDesc.J[2] = 0.0f;
-    triDesc.Z[0] = triDesc.Z[1] = triDesc.Z[2] = z;
+        // byte offset of each point's depth in the macrotile's hot tile; batches
+        // are allocated in whole SIMDs, the lanes past the last point are masked
+        OSALIGNSIMD(uint32_t) offsets[KNOB_SIMD_WIDTH];
+        for (uint32_t lane = 0; lane < KNOB_SIMD_WIDTH; ++lane)
+        {
+            uint32_t point = first + std::min(lane, numLanes - 1);
+            uint32_t x = desc.pX[point] - macroLeft;
+            uint32_t y = desc.pY[point] - macroTop;
+            uint32_t tileIndex = (y >> KNOB_TILE_Y_DIM_SHIFT) * KNOB_MACROTILE_X_DIM_IN_TILES + (x >> KNOB_TILE_X_DIM_SHIFT);
+            offsets[lane] = tileIndex * depthRasterTileStep +
+                gPointCoverageMap[y & (KNOB_TILE_Y_DIM - 1)][x & (KNOB_TILE_X_DIM - 1)] * sizeof(float);
+        }
 
-    RenderOutputBuffers renderBuffers;
-    GetRenderHotTiles(pDC, macroTile, tileAlignedX >> KNOB_TILE_X_DIM_SHIFT , tileAlignedY >> KNOB_TILE_Y_DIM_SHIFT, 
-        renderBuffers, 1, triDesc.triFlags.renderTargetArrayIndex);
+        // points landing on the same pixel must be resolved in order
+        bool conflict = false;
+        for (uint32_t lane = 1; lane < numLanes && !conflict; ++lane)
+        {
+            for (uint32_t other = 0; other < lane; ++other)
+            {
+                conflict |= (offsets[lane] == offsets[other]);
+            }
+        }
 
-    RDTSC_START(BEPixelBackend);
-    backendFuncs.pfnBackend(pDC, workerId, tileAlignedX, tileAlignedY, triDesc, renderBuffers);
-    RDTSC_STOP(BEPixelBackend, 0, 0);
+        if (!conflict)
+        {
+            ShadePointCloudSimd(pDC, workerId, psContext, shaded, numRT, renderBuffers, &desc.pZ[first], pointMask, offsets);
+        }
+        else
+        {
+            for (uint32_t lane = 0; lane < numLanes; ++lane)
+            {
+                OSALIGNSIMD(uint32_t) laneOffsets[KNOB_SIMD_WIDTH] = { offsets[lane] };
+                OSALIGNSIMD(float) laneZ[KNOB_SIMD_WIDTH] = { desc.pZ[first + lane] };
+                ShadePointCloudSimd(pDC, workerId, psContext, shaded, numRT, renderBuffers, laneZ, 1, laneOffsets);
+            }
+        }
+    }
 }
 
 // Get pointers to hot tile memory for color RT, depth, stencil
@@ -1180,18 +1484,58 @@ void StepRasterTileY(uint32_t NumRT, RenderOutputBuffers &buffers, RenderOutputB
 // initialize rasterizer function table
 PFN_WORK_FUNC gRasterizerTable[2][SWR_MULTISAMPLE_TYPE_MAX] =
 {
-    RasterizeTriangle<false, SWR_MULTISAMPLE_1X>,
-    RasterizeTriangle<false, SWR_MULTISAMPLE_2X>,
-    RasterizeTriangle<false, SWR_MULTISAMPLE_4X>,
-    RasterizeTriangle<false, SWR_MULTISAMPLE_8X>,
-    RasterizeTriangle<false, SWR_MULTISAMPLE_16X>,
-    RasterizeTriangle<true, SWR_MULTISAMPLE_1X>,
-    RasterizeTriangle<true, SWR_MULTISAMPLE_2X>,
-    RasterizeTriangle<true, SWR_MULTISAMPLE_4X>,
-    RasterizeTriangle<true, SWR_MULTISAMPLE_8X>,
-    RasterizeTriangle<true, SWR_MULTISAMPLE_16X>
+    RasterizeTriangle<false, SWR_MULTISAMPLE_1X, false>,
+    RasterizeTriangle<false, SWR_MULTISAMPLE_2X, false>,
+    RasterizeTriangle<false, SWR_MULTISAMPLE_4X, false>,
+    RasterizeTriangle<false, SWR_MULTISAMPLE_8X, false>,
+    RasterizeTriangle<false, SWR_MULTISAMPLE_16X, false>,
+    RasterizeTriangle<true, SWR_MULTISAMPLE_1X, false>,
+    RasterizeTriangle<true, SWR_MULTISAMPLE_2X, false>,
+    RasterizeTriangle<true, SWR_MULTISAMPLE_4X, false>,
+    RasterizeTriangle<true, SWR_MULTISAMPLE_8X, false>,
+    RasterizeTriangle<true, SWR_MULTISAMPLE_16X, false>
+};
+
+// conservative rasterizer, indexed by scissor enable; coverage is per pixel
+// and the backend broadcasts it to all samples as for the center pattern
+PFN_WORK_FUNC gConservativeRasterizerTable[2] =
+{
+    RasterizeTriangle<false, SWR_MULTISAMPLE_1X, true>,
+    RasterizeTriangle<true, SWR_MULTISAMPLE_1X, true>
 };
 
+#if KNOB_SIMD_WIDTH == 8
+// UL pixel corners of a SIMD step, in the order of the coverage mask bits
+static const __m256 vLineQuadOffsetsX = {0.0, 1.0, 0.0, 1.0, 2.0, 3.0, 2.0, 3.0};
+static const __m256 vLineQuadOffsetsY = {0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 1.0, 1.0};
+#else
+#error Unsupported vector width
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Diamond exit rule: an endpoint inside the diamond of a pixel
+///        snaps to that pixel's center along the major axis, otherwise
+///        the line starts/ends at the endpoint itself.
+INLINE float DiamondExitMajor(float major, float minor)
+{
+    float centerMajor = floorf(major) + 0.5f;
+    float centerMinor = floorf(minor) + 0.5f;
+    if (fabsf(major - centerMajor) + fabsf(minor - centerMinor) < 0.5f)
+    {
+        return centerMajor;
+    }
+    return major;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Rasterizes a line without expanding it to triangles. Walks the
+///        raster tile columns (x major) or rows (y major) the line crosses
+///        in the macrotile and evaluates coverage a SIMD of pixels at a time.
+///        Single sample lines follow the diamond exit rule at the endpoints,
+///        multisampled lines cover the lineWidth wide rectangle between them.
+///        Attributes interpolate along the major axis directly out of the
+///        v0, v1, v1 buffer from the binner.
+template<SWR_MULTISAMPLE_COUNT sampleCount>
 void RasterizeLine(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void *pData)
 {
     const TRIANGLE_WORK_DESC &workDesc = *((TRIANGLE_WORK_DESC*)pData);
@@ -1202,192 +1546,259 @@ void RasterizeLine(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, voi
     }
 #endif
 
-    // bloat line to two tris and call the triangle rasterizer twice
     RDTSC_START(BERasterizeLine);
 
     const API_STATE &state = GetApiState(pDC);
     const SWR_RASTSTATE &rastState = state.rastState;
+    const BACKEND_FUNCS& backendFuncs = pDC->pState->backendFuncs;
+    const uint32_t numSamples = MultisampleTraits<sampleCount>::numSamples;
+
+    // quantize floating point position to fixed point precision, as for triangles
+    __m128 vX = _mm_load_ps(workDesc.pTriBuffer);
+    __m128 vY = _mm_load_ps(workDesc.pTriBuffer + 4);
+    vX = _mm_mul_ps(_mm_cvtepi32_ps(fpToFixedPoint(vX)), _mm_set1_ps(1.0f / FIXED_POINT_SCALE));
+    vY = _mm_mul_ps(_mm_cvtepi32_ps(fpToFixedPoint(vY)), _mm_set1_ps(1.0f / FIXED_POINT_SCALE));
+
+    OSALIGN(float, 16) x[4], y[4];
+    _mm_store_ps(x, vX);
+    _mm_store_ps(y, vY);
+    const float *z = workDesc.pTriBuffer + 8;
+    const float *recipW = workDesc.pTriBuffer + 12;
+
+    // work in major/minor axis coordinates, the binner picked the major axis
+    const bool yMajor = workDesc.triFlags.yMajor;
+    const float major0 = yMajor ? y[0] : x[0];
+    const float major1 = yMajor ? y[1] : x[1];
+    const float minor0 = yMajor ? x[0] : y[0];
+    const float minor1 = yMajor ? x[1] : y[1];
+
+    if (major0 == major1)
+    {
+        RDTSC_STOP(BERasterizeLine, 0, 0);
+        return;
+    }
 
-    // macrotile dimensioning
-    uint32_t macroX, macroY;
-    MacroTileMgr::getTileIndices(macroTile, macroX, macroY);
-    int32_t macroBoxLeft = macroX * KNOB_MACROTILE_X_DIM_FIXED;
-    int32_t macroBoxRight = macroBoxLeft + KNOB_MACROTILE_X_DIM_FIXED - 1;
-    int32_t macroBoxTop = macroY * KNOB_MACROTILE_Y_DIM_FIXED;
-    int32_t macroBoxBottom = macroBoxTop + KNOB_MACROTILE_Y_DIM_FIXED - 1;
-
-    // create a copy of the triangle buffer to write our adjusted vertices to
-    OSALIGNSIMD(float) newTriBuffer[4 * 4];
-    TRIANGLE_WORK_DESC newWorkDesc = workDesc;
-    newWorkDesc.pTriBuffer = &newTriBuffer[0];
+    const float dir = (major1 > major0) ? 1.0f : -1.0f;
+    const float slope = (minor1 - minor0) / (major1 - major0);
+    const float halfWidth = rastState.lineWidth * 0.5f;
 
-    // create a copy of the attrib buffer to write our adjusted attribs to
-    OSALIGNSIMD(float) newAttribBuffer[4 * 3 * KNOB_NUM_ATTRIBUTES];
-    newWorkDesc.pAttribs = &newAttribBuffer[0];
+    // samples covered along the major axis are in [majorStart, majorEnd),
+    // measured in the direction of the line
+    float majorStart = major0;
+    float majorEnd = major1;
+    if (sampleCount == SWR_MULTISAMPLE_1X)
+    {
+        majorStart = DiamondExitMajor(major0, minor0);
+        majorEnd = DiamondExitMajor(major1, minor1);
+    }
+    const float length = (majorEnd - majorStart) * dir;
 
-    const __m128 vBloat0 = _mm_set_ps(0.5f, -0.5f, -0.5f, 0.5f);
-    const __m128 vBloat1 = _mm_set_ps(0.5f, 0.5f, 0.5f, -0.5f);
+    OSALIGN(SWR_TRIANGLE_DESC, 16) triDesc;
+    triDesc.triFlags = workDesc.triFlags;
+    triDesc.innerCoverageMask = 0;
+
+    // i = (major1 - major) / (major1 - major0) is 1 at v0 and 0 at v1 and
+    // j is 0, so k weights the third vertex the binner padded with v1
+    triDesc.recipDet = 1.0f / (major1 - major0);
+    triDesc.I[0] = yMajor ? 0.0f : -1.0f;
+    triDesc.I[1] = yMajor ? -1.0f : 0.0f;
+    triDesc.I[2] = major1;
+    triDesc.J[0] = triDesc.J[1] = triDesc.J[2] = 0.0f;
 
-    __m128 vX, vY, vZ, vRecipW;
+    triDesc.Z[0] = z[0] - z[1];
+    triDesc.Z[1] = 0.0f;
+    triDesc.Z[2] = z[1];
+    triDesc.Z[2] += ComputeDepthBias(&rastState, &triDesc, z);
 
-    vX = _mm_load_ps(workDesc.pTriBuffer);
-    vY = _mm_load_ps(workDesc.pTriBuffer + 4);
-    vZ = _mm_load_ps(workDesc.pTriBuffer + 8);
-    vRecipW = _mm_load_ps(workDesc.pTriBuffer + 12);
+    triDesc.OneOverW[0] = recipW[0] - recipW[1];
+    triDesc.OneOverW[1] = 0.0f;
+    triDesc.OneOverW[2] = recipW[1];
 
-    // triangle 0
-    // v0,v1 -> v0,v0,v1
-    __m128 vXa = _mm_shuffle_ps(vX, vX, _MM_SHUFFLE(1, 1, 0, 0));
-    __m128 vYa = _mm_shuffle_ps(vY, vY, _MM_SHUFFLE(1, 1, 0, 0));
-    __m128 vZa = _mm_shuffle_ps(vZ, vZ, _MM_SHUFFLE(1, 1, 0, 0));
-    __m128 vRecipWa = _mm_shuffle_ps(vRecipW, vRecipW, _MM_SHUFFLE(1, 1, 0, 0));
+    OSALIGN(float, 16) lineRecipW[4] = { recipW[0], recipW[1], recipW[1], 0.0f };
+    triDesc.pRecipW = lineRecipW;
 
-    __m128 vLineWidth = _mm_set1_ps(pDC->pState->state.rastState.lineWidth);
-    __m128 vAdjust = _mm_mul_ps(vLineWidth, vBloat0);
-    if (workDesc.triFlags.yMajor)
-    {
-        vXa = _mm_add_ps(vAdjust, vXa);
-    }
-    else
+    // calculate perspective correct coefs per vertex attrib
+    float* pPerspAttribs = perspAttribsTLS;
+    float* pAttribs = workDesc.pAttribs;
+    triDesc.pPerspAttribs = pPerspAttribs;
+    triDesc.pAttribs = pAttribs;
+    __m128 vOneOverWV0 = _mm_broadcast_ss(&recipW[0]);
+    __m128 vOneOverWV1 = _mm_broadcast_ss(&recipW[1]);
+    for (uint32_t i = 0; i < workDesc.numAttribs; i++)
     {
-        vYa = _mm_add_ps(vAdjust, vYa);
-    }
-
-    // Store triangle description for rasterizer
-    _mm_store_ps((float*)&newTriBuffer[0], vXa);
-    _mm_store_ps((float*)&newTriBuffer[4], vYa);
-    _mm_store_ps((float*)&newTriBuffer[8], vZa);
-    _mm_store_ps((float*)&newTriBuffer[12], vRecipWa);
+        __m128 attribA = _mm_load_ps(pAttribs);
+        __m128 attribB = _mm_load_ps(pAttribs+=4);
+        pAttribs+=8;
 
-    // binner bins 3 edges for lines as v0, v1, v1
-    // tri0 needs v0, v0, v1
-    for (uint32_t a = 0; a < workDesc.numAttribs; ++a)
-    {
-        __m128 vAttrib0 = _mm_load_ps(&workDesc.pAttribs[a*12 + 0]);
-        __m128 vAttrib1 = _mm_load_ps(&workDesc.pAttribs[a*12 + 4]);
+        attribA = _mm_mul_ps(attribA, vOneOverWV0);
+        attribB = _mm_mul_ps(attribB, vOneOverWV1);
 
-        _mm_store_ps((float*)&newAttribBuffer[a*12 + 0], vAttrib0);
-        _mm_store_ps((float*)&newAttribBuffer[a*12 + 4], vAttrib0);
-        _mm_store_ps((float*)&newAttribBuffer[a*12 + 8], vAttrib1);
+        _mm_store_ps(pPerspAttribs, attribA);
+        _mm_store_ps(pPerspAttribs+=4, attribB);
+        _mm_store_ps(pPerspAttribs+=4, attribB);
+        pPerspAttribs+=4;
     }
 
-    // Store user clip distances for triangle 0
-    float newClipBuffer[3 * 8];
-    uint32_t numClipDist = _mm_popcnt_u32(state.rastState.clipDistanceMask);
-    if (numClipDist)
-    {
-        newWorkDesc.pUserClipBuffer = newClipBuffer;
+    // binner stores the clip distances as plane equations in i, j
+    triDesc.pUserClipBuffer = workDesc.pUserClipBuffer;
 
-        float* pOldBuffer = workDesc.pUserClipBuffer;
-        float* pNewBuffer = newClipBuffer;
-        for (uint32_t i = 0; i < numClipDist; ++i)
-        {
-            // read barycentric coeffs from binner
-            float a = *(pOldBuffer++);
-            float b = *(pOldBuffer++);
-
-            // reconstruct original clip distance at vertices
-            float c0 = a + b;
-            float c1 = b;
-
-            // construct triangle barycentrics
-            *(pNewBuffer++) = c0 - c1;
-            *(pNewBuffer++) = c0 - c1;
-            *(pNewBuffer++) = c1;
-        }
-    }
+    // pixel bounds of the line indexed by axis, intersected with the
+    // macrotile and scissor; right and bottom are exclusive
+    const uint32_t maj = yMajor ? 1 : 0;
+    const uint32_t mnr = 1 - maj;
+    int32_t lineMin[2], lineMax[2];
+    lineMin[maj] = (int32_t)floorf(std::min(major0, major1));
+    lineMax[maj] = (int32_t)floorf(std::max(major0, major1)) + 1;
+    lineMin[mnr] = (int32_t)floorf(std::min(minor0, minor1) - halfWidth);
+    lineMax[mnr] = (int32_t)floorf(std::max(minor0, minor1) + halfWidth) + 1;
 
-    // make sure this macrotile intersects the triangle
-    __m128i vXai = fpToFixedPoint(vXa);
-    __m128i vYai = fpToFixedPoint(vYa);
-    OSALIGN(BBOX, 16) bboxA;
-    calcBoundingBoxInt(vXai, vYai, bboxA);
-
-    if (!(bboxA.left > macroBoxRight ||
-          bboxA.left > state.scissorInFixedPoint.right ||
-          bboxA.right - 1 < macroBoxLeft ||
-          bboxA.right - 1 < state.scissorInFixedPoint.left ||
-          bboxA.top > macroBoxBottom ||
-          bboxA.top > state.scissorInFixedPoint.bottom ||
-          bboxA.bottom - 1 < macroBoxTop ||
-          bboxA.bottom - 1 < state.scissorInFixedPoint.top)) {
-        // rasterize triangle
-        gRasterizerTable[rastState.scissorEnable][rastState.sampleCount](pDC, workerId, macroTile, (void*)&newWorkDesc);
-    }
+    uint32_t macroX, macroY;
+    MacroTileMgr::getTileIndices(macroTile, macroX, macroY);
+    const int32_t macroLeft = macroX * KNOB_MACROTILE_X_DIM;
+    const int32_t macroTop = macroY * KNOB_MACROTILE_Y_DIM;
 
-    // triangle 1
-    // v0,v1 -> v1,v1,v0
-    vXa = _mm_shuffle_ps(vX, vX, _MM_SHUFFLE(1, 0, 1, 1));
-    vYa = _mm_shuffle_ps(vY, vY, _MM_SHUFFLE(1, 0, 1, 1));
-    vZa = _mm_shuffle_ps(vZ, vZ, _MM_SHUFFLE(1, 0, 1, 1));
-    vRecipWa = _mm_shuffle_ps(vRecipW, vRecipW, _MM_SHUFFLE(1, 0, 1, 1));
+    int32_t left = std::max(std::max(lineMin[0], macroLeft), state.scissorInFixedPoint.left >> FIXED_POINT_SHIFT);
+    int32_t right = std::min(std::min(lineMax[0], macroLeft + KNOB_MACROTILE_X_DIM), (state.scissorInFixedPoint.right + 1) >> FIXED_POINT_SHIFT);
+    int32_t top = std::max(std::max(lineMin[1], macroTop), state.scissorInFixedPoint.top >> FIXED_POINT_SHIFT);
+    int32_t bottom = std::min(std::min(lineMax[1], macroTop + KNOB_MACROTILE_Y_DIM), (state.scissorInFixedPoint.bottom + 1) >> FIXED_POINT_SHIFT);
 
-    vAdjust = _mm_mul_ps(vLineWidth, vBloat1);
-    if (workDesc.triFlags.yMajor)
+    if (left >= right || top >= bottom)
     {
-        vXa = _mm_add_ps(vAdjust, vXa);
-    }
-    else
-    {
-        vYa = _mm_add_ps(vAdjust, vYa);
+        RDTSC_STOP(BERasterizeLine, 0, 0);
+        return;
     }
 
-    // Store triangle description for rasterizer
-    _mm_store_ps((float*)&newTriBuffer[0], vXa);
-    _mm_store_ps((float*)&newTriBuffer[4], vYa);
-    _mm_store_ps((float*)&newTriBuffer[8], vZa);
-    _mm_store_ps((float*)&newTriBuffer[12], vRecipWa);
+    // raster tile range, indexed by axis
+    const uint32_t tileShift[2] = { KNOB_TILE_X_DIM_SHIFT, KNOB_TILE_Y_DIM_SHIFT };
+    const int32_t tileMin[2] = { left >> KNOB_TILE_X_DIM_SHIFT, top >> KNOB_TILE_Y_DIM_SHIFT };
+    const int32_t tileMax[2] = { (right - 1) >> KNOB_TILE_X_DIM_SHIFT, (bottom - 1) >> KNOB_TILE_Y_DIM_SHIFT };
 
-    // binner bins 3 edges for lines as v0, v1, v1
-    // tri1 needs v1, v1, v0
-    for (uint32_t a = 0; a < workDesc.numAttribs; ++a)
-    {
-        __m128 vAttrib0 = _mm_load_ps(&workDesc.pAttribs[a * 12 + 0]);
-        __m128 vAttrib1 = _mm_load_ps(&workDesc.pAttribs[a * 12 + 4]);
+    // compute steps between raster tiles for render output buffers
+    static const uint32_t colorRasterTileStep{(KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp / 8)) * MultisampleTraits<sampleCount>::numSamples};
+    static const uint32_t colorRasterTileRowStep{(KNOB_MACROTILE_X_DIM / KNOB_TILE_X_DIM) * colorRasterTileStep};
+    static const uint32_t depthRasterTileStep{(KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp / 8)) * MultisampleTraits<sampleCount>::numSamples};
+    static const uint32_t depthRasterTileRowStep{(KNOB_MACROTILE_X_DIM / KNOB_TILE_X_DIM)* depthRasterTileStep};
+    static const uint32_t stencilRasterTileStep{(KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_STENCIL_HOT_TILE_FORMAT>::bpp / 8)) * MultisampleTraits<sampleCount>::numSamples};
+    static const uint32_t stencilRasterTileRowStep{(KNOB_MACROTILE_X_DIM / KNOB_TILE_X_DIM) * stencilRasterTileStep};
+    RenderOutputBuffers renderBuffers;
 
-        _mm_store_ps((float*)&newAttribBuffer[a * 12 + 0], vAttrib1);
-        _mm_store_ps((float*)&newAttribBuffer[a * 12 + 4], vAttrib1);
-        _mm_store_ps((float*)&newAttribBuffer[a * 12 + 8], vAttrib0);
-    }
+    GetRenderHotTiles(pDC, macroTile, tileMin[0], tileMin[1], renderBuffers, numSamples,
+        triDesc.triFlags.renderTargetArrayIndex);
 
-    // store user clip distance for triangle 1
-    if (numClipDist)
+    const simdscalar vLeft = _simd_set1_ps((float)left);
+    const simdscalar vRight = _simd_set1_ps((float)right);
+    const simdscalar vTop = _simd_set1_ps((float)top);
+    const simdscalar vBottom = _simd_set1_ps((float)bottom);
+    const simdscalar vMajor0 = _simd_set1_ps(major0);
+    const simdscalar vMinor0 = _simd_set1_ps(minor0);
+    const simdscalar vMajorStart = _simd_set1_ps(majorStart);
+    const simdscalar vDir = _simd_set1_ps(dir);
+    const simdscalar vLength = _simd_set1_ps(length);
+    const simdscalar vSlope = _simd_set1_ps(slope);
+    const simdscalar vHalfWidth = _simd_set1_ps(halfWidth);
+    const simdscalar vNegHalfWidth = _simd_set1_ps(-halfWidth);
+
+    // step along the major axis one column/row of raster tiles at a time
+    for (int32_t tileMajor = tileMin[maj]; tileMajor <= tileMax[maj]; ++tileMajor)
     {
-        float* pOldBuffer = workDesc.pUserClipBuffer;
-        float* pNewBuffer = newClipBuffer;
-        for (uint32_t i = 0; i < numClipDist; ++i)
+        // minor extent of the line across this column/row
+        float majorLo = (float)(tileMajor << tileShift[maj]);
+        float majorHi = majorLo + (float)(1 << tileShift[maj]);
+        float minorA = minor0 + slope * (majorLo - major0);
+        float minorB = minor0 + slope * (majorHi - major0);
+        int32_t tileMinorLo = std::max(tileMin[mnr], (int32_t)floorf(std::min(minorA, minorB) - halfWidth) >> tileShift[mnr]);
+        int32_t tileMinorHi = std::min(tileMax[mnr], (int32_t)floorf(std::max(minorA, minorB) + halfWidth) >> tileShift[mnr]);
+
+        for (int32_t tileMinor = tileMinorLo; tileMinor <= tileMinorHi; ++tileMinor)
         {
-            // read barycentric coeffs from binner
-            float a = *(pOldBuffer++);
-            float b = *(pOldBuffer++);
-
-            // reconstruct original clip distance at vertices
-            float c0 = a + b;
-            float c1 = b;
-
-            // construct triangle barycentrics
-            *(pNewBuffer++) = c1 - c0;
-            *(pNewBuffer++) = c1 - c0;
-            *(pNewBuffer++) = c0;
-        }
-    }
+            uint32_t tileX = yMajor ? tileMinor : tileMajor;
+            uint32_t tileY = yMajor ? tileMajor : tileMinor;
+            uint32_t pixelX = tileX << KNOB_TILE_X_DIM_SHIFT;
+            uint32_t pixelY = tileY << KNOB_TILE_Y_DIM_SHIFT;
+
+            RDTSC_START(BERasterizePartial);
+            for (uint32_t sampleNum = 0; sampleNum < numSamples; sampleNum++)
+            {
+                triDesc.coverageMask[sampleNum] = 0;
+            }
+
+            // SIMD steps cover the raster tile in the order the backend consumes the coverage mask
+            const uint32_t stepsX = KNOB_TILE_X_DIM / SIMD_TILE_X_DIM;
+            for (uint32_t step = 0; step < (KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM) / KNOB_SIMD_WIDTH; ++step)
+            {
+                simdscalar vPixelX = _simd_add_ps(vLineQuadOffsetsX, _simd_set1_ps((float)(pixelX + (step % stepsX) * SIMD_TILE_X_DIM)));
+                simdscalar vPixelY = _simd_add_ps(vLineQuadOffsetsY, _simd_set1_ps((float)(pixelY + (step / stepsX) * SIMD_TILE_Y_DIM)));
+
+                // pixels inside the macrotile and scissor
+                simdscalar vInBox = _simd_and_ps(_simd_cmp_ps(vPixelX, vLeft, _CMP_GE_OQ), _simd_cmp_ps(vPixelX, vRight, _CMP_LT_OQ));
+                vInBox = _simd_and_ps(vInBox, _simd_and_ps(_simd_cmp_ps(vPixelY, vTop, _CMP_GE_OQ), _simd_cmp_ps(vPixelY, vBottom, _CMP_LT_OQ)));
+                if (!_simd_movemask_ps(vInBox))
+                {
+                    continue;
+                }
+
+                for (uint32_t sampleNum = 0; sampleNum < numSamples; sampleNum++)
+                {
+                    simdscalar vSampleX = _simd_add_ps(vPixelX, _simd_set1_ps(MultisampleTraits<sampleCount>::X(sampleNum)));
+                    simdscalar vSampleY = _simd_add_ps(vPixelY, _simd_set1_ps(MultisampleTraits<sampleCount>::Y(sampleNum)));
+                    simdscalar vMajor = yMajor ? vSampleY : vSampleX;
+                    simdscalar vMinor = yMajor ? vSampleX : vSampleY;
+
+                    // 0 <= distance along the line < length
+                    simdscalar vAlong = _simd_mul_ps(_simd_sub_ps(vMajor, vMajorStart), vDir);
+                    simdscalar vCovered = _simd_and_ps(vInBox, _simd_cmp_ps(vAlong, _simd_setzero_ps(), _CMP_GE_OQ));
+                    vCovered = _simd_and_ps(vCovered, _simd_cmp_ps(vAlong, vLength, _CMP_LT_OQ));
+
+                    // -halfWidth <= minor distance from the line < halfWidth
+                    simdscalar vAcross = _simd_sub_ps(vMinor, _simd_fmadd_ps(vSlope, _simd_sub_ps(vMajor, vMajor0), vMinor0));
+                    vCovered = _simd_and_ps(vCovered, _simd_cmp_ps(vAcross, vNegHalfWidth, _CMP_GE_OQ));
+                    vCovered = _simd_and_ps(vCovered, _simd_cmp_ps(vAcross, vHalfWidth, _CMP_LT_OQ));
+
+                    triDesc.coverageMask[sampleNum] |= (uint64_t)_simd_movemask_ps(vCovered) << (step * KNOB_SIMD_WIDTH);
+                }
+            }
+            RDTSC_STOP(BERasterizePartial, 0, 0);
+
+            uint64_t anyCoveredSamples = 0;
+            for (uint32_t sampleNum = 0; sampleNum < numSamples; sampleNum++)
+            {
+                anyCoveredSamples |= triDesc.coverageMask[sampleNum];
+            }
+
+#if KNOB_ENABLE_TOSS_POINTS
+            if(KNOB_TOSS_RS)
+            {
+                gToss = triDesc.coverageMask[0];
+            }
+            else
+#endif
+            if(anyCoveredSamples)
+            {
+                // hot tile buffers are laid out linearly in raster tiles
+                RenderOutputBuffers tileBuffers = renderBuffers;
+                uint32_t dx = tileX - tileMin[0];
+                uint32_t dy = tileY - tileMin[1];
+                StepRasterTileX(state.psState.numRenderTargets, tileBuffers,
+                    dx * colorRasterTileStep + dy * colorRasterTileRowStep,
+                    dx * depthRasterTileStep + dy * depthRasterTileRowStep,
+                    dx * stencilRasterTileStep + dy * stencilRasterTileRowStep);
 
-    vXai = fpToFixedPoint(vXa);
-    vYai = fpToFixedPoint(vYa);
-    calcBoundingBoxInt(vXai, vYai, bboxA);
-
-    if (!(bboxA.left > macroBoxRight ||
-          bboxA.left > state.scissorInFixedPoint.right ||
-          bboxA.right - 1 < macroBoxLeft ||
-          bboxA.right - 1 < state.scissorInFixedPoint.left ||
-          bboxA.top > macroBoxBottom ||
-          bboxA.top > state.scissorInFixedPoint.bottom ||
-          bboxA.bottom - 1 < macroBoxTop ||
-          bboxA.bottom - 1 < state.scissorInFixedPoint.top)) {
-        // rasterize triangle
-        gRasterizerTable[rastState.scissorEnable][rastState.sampleCount](pDC, workerId, macroTile, (void*)&newWorkDesc);
+                RDTSC_START(BEPixelBackend);
+                backendFuncs.pfnBackend(pDC, workerId, pixelX, pixelY, triDesc, tileBuffers);
+                RDTSC_STOP(BEPixelBackend, 0, 0);
+            }
+        }
     }
 
     RDTSC_STOP(BERasterizeLine, 1, 0);
 }
 
+// initialize line rasterizer function table
+PFN_WORK_FUNC gLineRasterizerTable[SWR_MULTISAMPLE_TYPE_MAX] =
+{
+    RasterizeLine<SWR_MULTISAMPLE_1X>,
+    RasterizeLine<SWR_MULTISAMPLE_2X>,
+    RasterizeLine<SWR_MULTISAMPLE_4X>,
+    RasterizeLine<SWR_MULTISAMPLE_8X>,
+    RasterizeLine<SWR_MULTISAMPLE_16X>
+};
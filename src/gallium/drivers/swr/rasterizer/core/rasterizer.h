@@ -30,6 +30,7 @@
 #include "context.h"
 
 extern PFN_WORK_FUNC gRasterizerTable[2][SWR_MULTISAMPLE_TYPE_MAX];
-void RasterizeLine(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void *pData);
-void RasterizeSimplePoint(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void *pData);
+extern PFN_WORK_FUNC gConservativeRasterizerTable[2];
+extern PFN_WORK_FUNC gLineRasterizerTable[SWR_MULTISAMPLE_TYPE_MAX];
+void RasterizePointCloud(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void *pData);
 void RasterizeTriPoint(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void *pData);
@@ -30,8 +30,10 @@ BUCKET_DESC gCoreBuckets[] = {
     { "APIDraw", "", true, 0xff000066 },
     { "APIDrawWakeAllThreads", "", false, 0xffffffff },
     { "APIDrawIndexed", "", true, 0xff000066 },
+    { "APIDrawIndirect", "", true, 0xff000066 },
     { "APIDispatch", "", true, 0xff660000 },
     { "APIStoreTiles", "", true, 0xff00ffff },
+    { "APIBlit", "", true, 0xff00ffff },
     { "APIGetDrawContext", "", false, 0xffffffff },
     { "APISync", "", true, 0xff6666ff },
     { "APIWaitForIdle", "", true, 0xff0000ff },
@@ -58,6 +60,7 @@ BUCKET_DESC gCoreBuckets[] = {
     { "FECullBetweenCenters", "", false, 0xffffffff },
     { "FEProcessStoreTiles", "", true, 0xff39c864 },
     { "FEProcessInvalidateTiles", "", true, 0xffffffff },
+    { "FEProcessBlit", "", true, 0xff39c864 },
     { "WorkerWorkOnFifoBE", "", false, 0xff40261c },
     { "WorkerFoundWork", "", false, 0xff573326 },
     { "BELoadTiles", "", true, 0xffb0e2ff },
@@ -80,6 +83,7 @@ BUCKET_DESC gCoreBuckets[] = {
     { "BELateDepthTest", "", false, 0xffffffff },
     { "BEOutputMerger", "", false, 0xffffffff },
     { "BEStoreTiles", "", true, 0xff00cccc },
+    { "BEBlit", "", true, 0xff00cccc },
     { "BEEndTile", "", false, 0xffffffff },
     { "WorkerWaitForThreadEvent", "", false, 0xffffffff },
 };
@@ -35,8 +35,10 @@ enum CORE_BUCKETS
     APIDraw,
     APIDrawWakeAllThreads,
     APIDrawIndexed,
+    APIDrawIndirect,
     APIDispatch,
     APIStoreTiles,
+    APIBlit,
     APIGetDrawContext,
     APISync,
     APIWaitForIdle,
@@ -63,6 +65,7 @@ enum CORE_BUCKETS
     FECullBetweenCenters,
     FEProcessStoreTiles,
     FEProcessInvalidateTiles,
+    FEProcessBlit,
     WorkerWorkOnFifoBE,
     WorkerFoundWork,
     BELoadTiles,
@@ -85,6 +88,7 @@ enum CORE_BUCKETS
     BELateDepthTest,
     BEOutputMerger,
     BEStoreTiles,
+    BEBlit,
     BEEndTile,
     WorkerWaitForThreadEvent,
 
@@ -527,6 +527,31 @@ struct SWR_INDEX_BUFFER_STATE
     uint32_t size;
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// SWR_DRAW_INDIRECT_ARGS
+/// @brief Arguments of a SwrDrawIndirect draw, as laid out in the
+///        argument buffer.
+struct SWR_DRAW_INDIRECT_ARGS
+{
+    uint32_t numVertsPerInstance;
+    uint32_t numInstances;
+    uint32_t startVertex;
+    uint32_t startInstance;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// SWR_DRAW_INDEXED_INDIRECT_ARGS
+/// @brief Arguments of a SwrDrawIndexedIndirect draw, as laid out in the
+///        argument buffer.
+struct SWR_DRAW_INDEXED_INDIRECT_ARGS
+{
+    uint32_t numIndices;
+    uint32_t numInstances;
+    uint32_t indexOffset;
+    int32_t baseVertex;
+    uint32_t startInstance;
+};
+
 
 //////////////////////////////////////////////////////////////////////////
 /// SWR_FETCH_CONTEXT
@@ -787,6 +812,14 @@ typedef void(__cdecl *PFN_CS_FUNC)(HANDLE hPrivateData, SWR_CS_CONTEXT* pCsConte
 typedef void(__cdecl *PFN_SO_FUNC)(SWR_STREAMOUT_CONTEXT& soContext);
 typedef void(__cdecl *PFN_PIXEL_KERNEL)(HANDLE hPrivateData, SWR_PS_CONTEXT *pContext);
 typedef void(__cdecl *PFN_BLEND_JIT_FUNC)(const SWR_BLEND_STATE*, simdvector&, simdvector&, uint32_t, BYTE*, simdvector&, simdscalari*, simdscalari*);
+struct SWR_VIEWPORT;
+typedef void(__cdecl *PFN_OUTPUT_MERGER_JIT_FUNC)(const SWR_BLEND_STATE*, const SWR_VIEWPORT*, simdvector*, simdscalar*, uint32_t,
+                                                  BYTE**, BYTE*, BYTE*, simdscalari*, simdscalari*, simdscalari*, simdscalari*);
+
+// jitted load/store of one raster tile between the hot tile and a surface; ppSurface holds the
+// address of the raster tile's upper left pixel for each sample
+typedef void(__cdecl *PFN_STORE_TILE_JIT_FUNC)(const uint8_t* pSrcHotTile, uint8_t** ppDst, uint32_t pitch);
+typedef void(__cdecl *PFN_LOAD_TILE_JIT_FUNC)(uint8_t* pDstHotTile, uint8_t** ppSrc, uint32_t pitch);
 
 //////////////////////////////////////////////////////////////////////////
 /// FRONTEND_STATE
@@ -898,6 +931,10 @@ struct SWR_RASTSTATE
     uint32_t frontWinding : 1;
     uint32_t scissorEnable : 1;
     uint32_t depthClipEnable : 1;
+
+    // overestimated conservative rasterization of triangles; covers every
+    // pixel the triangle touches, all samples at once
+    uint32_t conservativeRast : 1;
     float pointSize;
     float lineWidth;
 
@@ -988,6 +1025,7 @@ enum SWR_INPUT_COVERAGE
 {
     SWR_INPUT_COVERAGE_NONE,
     SWR_INPUT_COVERAGE_NORMAL,
+    SWR_INPUT_COVERAGE_INNER_CONSERVATIVE,  // 1 for pixels the triangle covers completely
     SWR_INPUT_COVERAGE_MAX,
 };
 
@@ -1007,6 +1045,36 @@ enum SWR_BARYCENTRICS_MASK
     SWR_BARYCENTRICS_MASK_MAX = 0x8
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// SWR_PS_TILE_CONTEXT
+/// @brief Input to a pixel shader kernel that shades a whole raster tile.
+///        The kernel evaluates barycentrics, coverage and early-Z itself
+///        and runs the output merger for each SIMD quad of the tile.
+/////////////////////////////////////////////////////////////////////////
+struct SWR_PS_TILE_CONTEXT
+{
+    uint64_t coverageMask;      // IN: raster tile coverage, 8 bits per SIMD quad
+    float x;                    // IN: upper left x of the raster tile
+    float y;                    // IN: upper left y of the raster tile
+    float I[3];                 // IN: barycentric A, B, and C coefs used to compute I
+    float J[3];                 // IN: barycentric A, B, and C coefs used to compute J
+    float Z[3];                 // IN: Z plane coefs
+    float OneOverW[3];          // IN: 1/w plane coefs
+    float recipDet;             // IN: 1/Det
+
+    uint8_t* pColorBase[SWR_NUM_RENDERTARGETS];     // INOUT: hot tile pointers, advanced per quad
+    uint8_t* pDepthBase;
+    uint8_t* pStencilBase;
+    const SWR_BLEND_STATE* pBlendState;
+    const SWR_VIEWPORT* pViewport;
+    PFN_OUTPUT_MERGER_JIT_FUNC pfnOutputMerger;     // @llvm_pfn
+
+    uint32_t psInvocations;     // OUT: pixels shaded
+    uint32_t depthPassCount;    // OUT: pixels passing depth
+};
+
+typedef void(__cdecl *PFN_PIXEL_TILE_KERNEL)(HANDLE hPrivateData, SWR_PS_CONTEXT *pContext, SWR_PS_TILE_CONTEXT *pTileContext);
+
 // pixel shader state
 struct SWR_PS_STATE
 {
@@ -1015,7 +1083,7 @@ struct SWR_PS_STATE
 
     // dword 2
     uint32_t killsPixel         : 1;    // pixel shader can kill pixels
-    uint32_t inputCoverage      : 1;    // type of input coverage PS uses
+    uint32_t inputCoverage      : 2;    // type of input coverage PS uses
     uint32_t writesODepth       : 1;    // pixel shader writes to depth
     uint32_t usesSourceDepth    : 1;    // pixel shader reads depth
     uint32_t shadingRate        : 2;    // shading per pixel / sample / coarse pixel
@@ -1024,4 +1092,8 @@ struct SWR_PS_STATE
     uint32_t barycentricsMask   : 3;    // which type(s) of barycentric coords does the PS interpolate attributes with
     uint32_t usesUAV            : 1;    // pixel shader accesses UAV 
     uint32_t forceEarlyZ        : 1;    // force execution of early depth/stencil test
+    uint32_t constantOutput     : 1;    // outputs only depend on constants, the same for every pixel
+
+    // dword 3-4
+    PFN_PIXEL_TILE_KERNEL pfnPixelTileShader;   // @llvm_pfn optional, shades a whole raster tile
 };
@@ -0,0 +1,144 @@
+/****************************************************************************
+* Copyright (C) 2016 Intel Corporation.   All Rights Reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice (including the next
+* paragraph) shall be included in all copies or substantial portions of the
+* Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* @file stateblock.h
+*
+* @brief Copy-on-write blocks of API state
+*        Larger arrays of API state are kept in reference counted blocks
+*        that the draw states in the DS ring share by pointer. A block is
+*        only copied when a state call modifies it while other draw states
+*        still reference it, so moving to a new draw state costs the same
+*        no matter how large the arrays are.
+*
+*        Blocks are only ever referenced, modified and released by the API
+*        thread; workers just read them through the draw state.
+*
+******************************************************************************/
+#pragma once
+
+#include "common/os.h"
+#include "common/swr_assert.h"
+
+template <typename T, uint32_t NumElements>
+class StateBlockPool
+{
+public:
+    StateBlockPool() = default;
+
+    ~StateBlockPool()
+    {
+        while (m_pFree)
+        {
+            Block* pBlock = m_pFree;
+            m_pFree = pBlock->pNextFree;
+            _aligned_free(pBlock);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Adds a reference from another draw state to a block.
+    /// @param pData - Block data, may be null.
+    void AddRef(const T* pData)
+    {
+        if (pData)
+        {
+            GetBlock(pData)->refCount++;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Drops a draw state's reference to a block, and recycles the
+    ///        block once no draw state references it anymore.
+    /// @param pData - Block data, may be null.
+    void Release(const T* pData)
+    {
+        if (pData)
+        {
+            Block* pBlock = GetBlock(pData);
+            SWR_ASSERT(pBlock->refCount > 0);
+            if (--pBlock->refCount == 0)
+            {
+                pBlock->pNextFree = m_pFree;
+                m_pFree = pBlock;
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Returns the block pData points at for modification. A shared
+    ///        block is copied first and pData updated to point at the copy.
+    /// @param pData - Block data of the draw state, null for a zeroed block.
+    T* Modify(T*& pData)
+    {
+        Block* pBlock = pData ? GetBlock(pData) : nullptr;
+        if (pBlock && pBlock->refCount == 1)
+        {
+            return pData;
+        }
+
+        Block* pNew = Alloc();
+        if (pBlock)
+        {
+            memcpy(pNew->data, pBlock->data, sizeof(pNew->data));
+            pBlock->refCount--;
+        }
+        else
+        {
+            memset(pNew->data, 0, sizeof(pNew->data));
+        }
+
+        pData = pNew->data;
+        return pData;
+    }
+
+private:
+    struct Block
+    {
+        T data[NumElements];    // must be first, draw states point at it
+        uint32_t refCount;
+        Block* pNextFree;
+    };
+
+    static Block* GetBlock(const T* pData)
+    {
+        return (Block*)pData;
+    }
+
+    Block* Alloc()
+    {
+        Block* pBlock = m_pFree;
+        if (pBlock)
+        {
+            m_pFree = pBlock->pNextFree;
+        }
+        else
+        {
+            pBlock = (Block*)_aligned_malloc(sizeof(Block), 64);
+        }
+
+        pBlock->refCount = 1;
+        pBlock->pNextFree = nullptr;
+        return pBlock;
+    }
+
+    Block* m_pFree{ nullptr };
+};
@@ -0,0 +1,642 @@
+/****************************************************************************
+* Copyright (C) 2016 Intel Corporation.   All Rights Reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice (including the next
+* paragraph) shall be included in all copies or substantial portions of the
+* Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* @file tessellator.cpp
+*
+* @brief Tessellator fixed function unit.  Subdivides tri, quad and isoline
+*        patches into domain points and the primitives connecting them.
+*
+******************************************************************************/
+
+#include <algorithm>
+#include <math.h>
+
+#include "common/os.h"
+#include "core/state.h"
+#include "core/utils.h"
+#include "core/tessellator.h"
+
+// Factors are clamped to 64.  The worst case patch is a quad with every
+// factor at the maximum: a 65x65 grid of points, the triangles of the
+// 62x62 inner quads and of the four strips stitching the outer edges to it.
+#define TS_MAX_FACTOR   64
+#define TS_MAX_POINTS   ((TS_MAX_FACTOR + 1) * (TS_MAX_FACTOR + 1))
+#define TS_MAX_PRIMS    (2 * (TS_MAX_FACTOR - 2) * (TS_MAX_FACTOR - 2) + \
+                         4 * (2 * TS_MAX_FACTOR - 2))
+
+// Outputs are written and read a SIMD at a time, pad arrays past the end
+#define TS_PADDED(n)    (((n) + 2 * KNOB_SIMD_WIDTH - 1) / KNOB_SIMD_WIDTH * KNOB_SIMD_WIDTH)
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Tessellation context.  Lives in memory provided by the caller
+///        and holds the output of the last TSTessellate.
+struct TS_CONTEXT
+{
+    SWR_TS_DOMAIN           domain;
+    SWR_TS_PARTITIONING     partitioning;
+    SWR_TS_OUTPUT_TOPOLOGY  outputTopology;
+
+    uint32_t                numPoints;
+    uint32_t                numPrims;
+
+    OSALIGNSIMD(float)      u[TS_PADDED(TS_MAX_POINTS)];
+    OSALIGNSIMD(float)      v[TS_PADDED(TS_MAX_POINTS)];
+    OSALIGNSIMD(uint32_t)   indices[3][TS_PADDED(TS_MAX_PRIMS)];
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Subdivision of an edge by a processed tessellation factor.
+///        numSegments - 2 segments are 1/factor long, the other two share
+///        the rest and sit symmetrically next to the middle of the edge.
+struct TS_EDGE
+{
+    uint32_t    numSegments;
+    uint32_t    numFull;        // full segments on each half before the short one
+    float       fullLength;
+    float       shortEnd;       // position of the point ending the short segment
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Clamp and round a tessellation factor for the partitioning.
+/// @param bumpOne - treat a factor of exactly one as slightly more, as
+///        inner factors are whenever the patch isn't a single primitive.
+static TS_EDGE ProcessFactor(float factor, SWR_TS_PARTITIONING partitioning, bool bumpOne)
+{
+    float minFactor = (partitioning == SWR_TS_EVEN_FRACTIONAL) ? 2.0f : 1.0f;
+    float maxFactor = (partitioning == SWR_TS_ODD_FRACTIONAL) ? 63.0f : float(TS_MAX_FACTOR);
+
+    // inner factors may still be NaN here, which take the minimum
+    factor = (factor >= minFactor) ? std::min(factor, maxFactor) : minFactor;
+    if (bumpOne && factor == 1.0f)
+    {
+        factor = nextafterf(1.0f, 2.0f);
+    }
+
+    uint32_t n = uint32_t(ceilf(factor));
+    switch (partitioning)
+    {
+    case SWR_TS_INTEGER:            factor = float(n); break;
+    case SWR_TS_ODD_FRACTIONAL:     n |= 1; break;
+    case SWR_TS_EVEN_FRACTIONAL:    n = (n + 1) & ~1; break;
+    default: SWR_ASSERT(0, "Invalid tessellation partitioning: %d", partitioning);
+    }
+
+    TS_EDGE edge;
+    edge.numSegments = n;
+    edge.numFull = (n >= 2) ? (n - 2) / 2 : 0;
+    edge.fullLength = 1.0f / factor;
+    float shortLength = (n >= 2) ? 0.5f * (1.0f - (n - 2) * edge.fullLength) : 0.0f;
+    edge.shortEnd = edge.numFull * edge.fullLength + shortLength;
+    return edge;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Parametric positions of the numSegments + 1 points of an edge,
+///        a SIMD at a time.  Points of the second half mirror the ones of
+///        the first, so e[n - k] == 1 - e[k] exactly and the edge is split
+///        the same way whichever direction a patch walks it in.
+static void EdgePositions(const TS_EDGE& edge, float* pPos)
+{
+    const simdscalar vN = _simd_set1_ps(float(edge.numSegments));
+    const simdscalar vNumFull = _simd_set1_ps(float(edge.numFull));
+    const simdscalar vLength = _simd_set1_ps(edge.fullLength);
+    const simdscalar vShortEnd = _simd_set1_ps(edge.shortEnd);
+    const simdscalar vOne = _simd_set1_ps(1.0f);
+    simdscalar vK = _simd_cvtepi32_ps(_mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+
+    for (uint32_t k = 0; k <= edge.numSegments; k += KNOB_SIMD_WIDTH)
+    {
+        simdscalar vMirrorK = _simd_sub_ps(vN, vK);
+        simdscalar vHalfK = _simd_min_ps(vK, vMirrorK);
+        simdscalar vPos = _simd_blendv_ps(vShortEnd, _simd_mul_ps(vHalfK, vLength),
+                                          _simd_cmple_ps(vHalfK, vNumFull));
+        vPos = _simd_blendv_ps(vPos, _simd_sub_ps(vOne, vPos), _simd_cmplt_ps(vMirrorK, vK));
+        _simd_storeu_ps(&pPos[k], vPos);
+
+        vK = _simd_add_ps(vK, _simd_set1_ps(float(KNOB_SIMD_WIDTH)));
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief A patch is culled when any outer factor of its domain is not
+///        positive, NaN included.
+INLINE static bool IsCulled(const SWR_TESSELLATION_FACTORS& tf, uint32_t numOuter)
+{
+    for (uint32_t i = 0; i < numOuter; ++i)
+    {
+        if (!(tf.OuterTessFactors[i] > 0.0f))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+INLINE static uint32_t AddPoint(TS_CONTEXT& ctx, float u, float v)
+{
+    SWR_ASSERT(ctx.numPoints < TS_MAX_POINTS);
+    ctx.u[ctx.numPoints] = u;
+    ctx.v[ctx.numPoints] = v;
+    return ctx.numPoints++;
+}
+
+INLINE static void AddTriangle(TS_CONTEXT& ctx, uint32_t i0, uint32_t i1, uint32_t i2)
+{
+    SWR_ASSERT(ctx.numPrims < TS_MAX_PRIMS);
+    ctx.indices[0][ctx.numPrims] = i0;
+    ctx.indices[1][ctx.numPrims] = i1;
+    ctx.indices[2][ctx.numPrims] = i2;
+    ctx.numPrims++;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Append the first count lanes of SIMD primitives.
+INLINE static void AddPrims(TS_CONTEXT& ctx, simdscalari vI0, simdscalari vI1,
+                            simdscalari vI2, uint32_t count)
+{
+    SWR_ASSERT(ctx.numPrims + count <= TS_MAX_PRIMS);
+    _simd_storeu_si((simdscalari*)&ctx.indices[0][ctx.numPrims], vI0);
+    _simd_storeu_si((simdscalari*)&ctx.indices[1][ctx.numPrims], vI1);
+    _simd_storeu_si((simdscalari*)&ctx.indices[2][ctx.numPrims], vI2);
+    ctx.numPrims += count;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Append a row of count points sharing v, SIMD at a time.
+static void AddPointRow(TS_CONTEXT& ctx, const float* pU, float v, uint32_t count)
+{
+    SWR_ASSERT(ctx.numPoints + count <= TS_MAX_POINTS);
+    const simdscalar vV = _simd_set1_ps(v);
+    float* pOutU = &ctx.u[ctx.numPoints];
+    float* pOutV = &ctx.v[ctx.numPoints];
+
+    for (uint32_t i = 0; i < count; i += KNOB_SIMD_WIDTH)
+    {
+        _simd_storeu_ps(&pOutU[i], _simd_loadu_ps(&pU[i]));
+        _simd_storeu_ps(&pOutV[i], vV);
+    }
+    ctx.numPoints += count;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Triangulate the strip between two runs of points, the outer one
+///        on the boundary side.  Both run counter-clockwise around the
+///        domain, the positions are increasing along that direction and
+///        comparable between the runs.  Steps along whichever run has the
+///        next segment midpoint first.
+static void StitchStrip(
+    TS_CONTEXT& ctx,
+    const uint32_t* pOuter, const float* pOuterPos, uint32_t numOuterSegments,
+    const uint32_t* pInner, const float* pInnerPos, uint32_t numInnerSegments)
+{
+    uint32_t i = 0, j = 0;
+    while (i < numOuterSegments || j < numInnerSegments)
+    {
+        bool stepOuter;
+        if (i == numOuterSegments)
+        {
+            stepOuter = false;
+        }
+        else if (j == numInnerSegments)
+        {
+            stepOuter = true;
+        }
+        else
+        {
+            stepOuter = (pOuterPos[i] + pOuterPos[i + 1]) <= (pInnerPos[j] + pInnerPos[j + 1]);
+        }
+
+        if (stepOuter)
+        {
+            AddTriangle(ctx, pOuter[i], pOuter[i + 1], pInner[j]);
+            ++i;
+        }
+        else
+        {
+            AddTriangle(ctx, pOuter[i], pInner[j + 1], pInner[j]);
+            ++j;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Outer edge run from corner c0 to corner c1.  The edge lies on
+///        the line u = fixedU or v = fixedV, the other coordinate goes
+///        along the edge, reversed if it decreases from c0 to c1.
+static void AddEdgeRun(TS_CONTEXT& ctx, const TS_EDGE& edge, const float* pPos,
+                       uint32_t c0, uint32_t c1, bool alongU, float fixed,
+                       bool reversed, uint32_t* pRun)
+{
+    uint32_t n = edge.numSegments;
+    pRun[0] = c0;
+    for (uint32_t k = 1; k < n; ++k)
+    {
+        float pos = reversed ? pPos[n - k] : pPos[k];
+        pRun[k] = alongU ? AddPoint(ctx, pos, fixed) : AddPoint(ctx, fixed, pos);
+    }
+    pRun[n] = c1;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Quad domain.  The inner factors split the domain into a grid
+///        whose outermost ring of quads is replaced by strips stitching
+///        the grid border to the subdivided outer edges.
+static void TessellateQuad(TS_CONTEXT& ctx, const SWR_TESSELLATION_FACTORS& tf)
+{
+    if (IsCulled(tf, 4))
+    {
+        return;
+    }
+
+    TS_EDGE outer[4];
+    bool allOne = true;
+    for (uint32_t e = 0; e < 4; ++e)
+    {
+        outer[e] = ProcessFactor(tf.OuterTessFactors[e], ctx.partitioning, false);
+        allOne &= (outer[e].numSegments == 1);
+    }
+    TS_EDGE innerU = ProcessFactor(tf.InnerTessFactors[SWR_QUAD_U_TRI_INSIDE], ctx.partitioning, false);
+    TS_EDGE innerV = ProcessFactor(tf.InnerTessFactors[SWR_QUAD_V_INSIDE], ctx.partitioning, false);
+    allOne &= (innerU.numSegments == 1) && (innerV.numSegments == 1);
+
+    uint32_t c00 = AddPoint(ctx, 0.0f, 0.0f);
+    uint32_t c10 = AddPoint(ctx, 1.0f, 0.0f);
+    uint32_t c11 = AddPoint(ctx, 1.0f, 1.0f);
+    uint32_t c01 = AddPoint(ctx, 0.0f, 1.0f);
+
+    if (allOne)
+    {
+        AddTriangle(ctx, c00, c10, c11);
+        AddTriangle(ctx, c00, c11, c01);
+        return;
+    }
+
+    if (innerU.numSegments == 1)
+    {
+        innerU = ProcessFactor(tf.InnerTessFactors[SWR_QUAD_U_TRI_INSIDE], ctx.partitioning, true);
+    }
+    if (innerV.numSegments == 1)
+    {
+        innerV = ProcessFactor(tf.InnerTessFactors[SWR_QUAD_V_INSIDE], ctx.partitioning, true);
+    }
+
+    float outerPos[4][TS_PADDED(TS_MAX_FACTOR + 1)];
+    float innerPosU[TS_PADDED(TS_MAX_FACTOR + 1)];
+    float innerPosV[TS_PADDED(TS_MAX_FACTOR + 1)];
+    for (uint32_t e = 0; e < 4; ++e)
+    {
+        EdgePositions(outer[e], outerPos[e]);
+    }
+    EdgePositions(innerU, innerPosU);
+    EdgePositions(innerV, innerPosV);
+
+    // outer edges counter-clockwise from (0,0): v = 0, u = 1, v = 1, u = 0
+    static const uint32_t edgeOrder[4] =
+    {
+        SWR_QUAD_V_EQ0_TRI_V_LINE_DENSITY,
+        SWR_QUAD_U_EQ1_TRI_W,
+        SWR_QUAD_V_EQ1,
+        SWR_QUAD_U_EQ0_TRI_U_LINE_DETAIL,
+    };
+    uint32_t outerRun[4][TS_MAX_FACTOR + 1];
+    AddEdgeRun(ctx, outer[edgeOrder[0]], outerPos[edgeOrder[0]], c00, c10, true, 0.0f, false, outerRun[0]);
+    AddEdgeRun(ctx, outer[edgeOrder[1]], outerPos[edgeOrder[1]], c10, c11, false, 1.0f, false, outerRun[1]);
+    AddEdgeRun(ctx, outer[edgeOrder[2]], outerPos[edgeOrder[2]], c11, c01, true, 1.0f, true, outerRun[2]);
+    AddEdgeRun(ctx, outer[edgeOrder[3]], outerPos[edgeOrder[3]], c01, c00, false, 0.0f, true, outerRun[3]);
+
+    // inner grid of points, row by row
+    const uint32_t numCols = innerU.numSegments - 1;
+    const uint32_t numRows = innerV.numSegments - 1;
+    const uint32_t gridBase = ctx.numPoints;
+    for (uint32_t row = 0; row < numRows; ++row)
+    {
+        AddPointRow(ctx, &innerPosU[1], innerPosV[row + 1], numCols);
+    }
+
+    // two triangles per grid quad, a SIMD of quads of a row at a time
+    const simdscalari vLanes = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    const simdscalari vOne = _simd_set1_epi32(1);
+    const simdscalari vRowStride = _simd_set1_epi32(numCols);
+    for (uint32_t row = 0; row + 1 < numRows; ++row)
+    {
+        for (uint32_t col = 0; col + 1 < numCols; col += KNOB_SIMD_WIDTH)
+        {
+            uint32_t numQuads = std::min<uint32_t>(numCols - 1 - col, KNOB_SIMD_WIDTH);
+            simdscalari v00 = _simd_add_epi32(_simd_set1_epi32(gridBase + row * numCols + col), vLanes);
+            simdscalari v10 = _simd_add_epi32(v00, vOne);
+            simdscalari v01 = _simd_add_epi32(v00, vRowStride);
+            simdscalari v11 = _simd_add_epi32(v01, vOne);
+            AddPrims(ctx, v00, v10, v11, numQuads);
+            AddPrims(ctx, v00, v11, v01, numQuads);
+        }
+    }
+
+    // grid border runs, counter-clockwise like the outer edges
+    uint32_t innerRun[4][TS_MAX_FACTOR + 1];
+    for (uint32_t col = 0; col < numCols; ++col)
+    {
+        innerRun[0][col] = gridBase + col;
+        innerRun[2][col] = gridBase + (numRows - 1) * numCols + (numCols - 1 - col);
+    }
+    for (uint32_t row = 0; row < numRows; ++row)
+    {
+        innerRun[1][row] = gridBase + row * numCols + numCols - 1;
+        innerRun[3][row] = gridBase + (numRows - 1 - row) * numCols;
+    }
+
+    // the grid border positions are the same in either direction
+    for (uint32_t e = 0; e < 4; ++e)
+    {
+        bool alongU = (e & 1) == 0;
+        StitchStrip(ctx,
+                    outerRun[e], outerPos[edgeOrder[e]], outer[edgeOrder[e]].numSegments,
+                    innerRun[e], alongU ? &innerPosU[1] : &innerPosV[1],
+                    (alongU ? numCols : numRows) - 1);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Triangle domain.  The inner factor places concentric rings of
+///        triangles, ring k with n - 2k segments per side, ending in a
+///        single triangle or the center point.  Consecutive rings and the
+///        subdivided outer edges are stitched together.
+static void TessellateTri(TS_CONTEXT& ctx, const SWR_TESSELLATION_FACTORS& tf)
+{
+    if (IsCulled(tf, 3))
+    {
+        return;
+    }
+
+    TS_EDGE outer[3];
+    bool allOne = true;
+    for (uint32_t e = 0; e < 3; ++e)
+    {
+        outer[e] = ProcessFactor(tf.OuterTessFactors[e], ctx.partitioning, false);
+        allOne &= (outer[e].numSegments == 1);
+    }
+    TS_EDGE inner = ProcessFactor(tf.InnerTessFactors[SWR_QUAD_U_TRI_INSIDE], ctx.partitioning, false);
+    allOne &= (inner.numSegments == 1);
+
+    // corners, counter-clockwise in (u,v)
+    uint32_t cW = AddPoint(ctx, 0.0f, 0.0f);
+    uint32_t cU = AddPoint(ctx, 1.0f, 0.0f);
+    uint32_t cV = AddPoint(ctx, 0.0f, 1.0f);
+
+    if (allOne)
+    {
+        AddTriangle(ctx, cW, cU, cV);
+        return;
+    }
+
+    if (inner.numSegments == 1)
+    {
+        inner = ProcessFactor(tf.InnerTessFactors[SWR_QUAD_U_TRI_INSIDE], ctx.partitioning, true);
+    }
+
+    float outerPos[3][TS_PADDED(TS_MAX_FACTOR + 1)];
+    float innerPos[TS_PADDED(TS_MAX_FACTOR + 1)];
+    for (uint32_t e = 0; e < 3; ++e)
+    {
+        EdgePositions(outer[e], outerPos[e]);
+    }
+    EdgePositions(inner, innerPos);
+
+    // outer edges W->U (v = 0), U->V (w = 0), V->W (u = 0)
+    static const uint32_t edgeOrder[3] =
+    {
+        SWR_QUAD_V_EQ0_TRI_V_LINE_DENSITY,
+        SWR_QUAD_U_EQ1_TRI_W,
+        SWR_QUAD_U_EQ0_TRI_U_LINE_DETAIL,
+    };
+    uint32_t runs[2][3][TS_MAX_FACTOR + 1];
+    uint32_t (*outerRun)[TS_MAX_FACTOR + 1] = runs[0];
+    AddEdgeRun(ctx, outer[edgeOrder[0]], outerPos[edgeOrder[0]], cW, cU, true, 0.0f, false, outerRun[0]);
+    {
+        const TS_EDGE& edge = outer[edgeOrder[1]];
+        const float* pPos = outerPos[edgeOrder[1]];
+        uint32_t n = edge.numSegments;
+        outerRun[1][0] = cU;
+        for (uint32_t k = 1; k < n; ++k)
+        {
+            outerRun[1][k] = AddPoint(ctx, pPos[n - k], pPos[k]);
+        }
+        outerRun[1][n] = cV;
+    }
+    AddEdgeRun(ctx, outer[edgeOrder[2]], outerPos[edgeOrder[2]], cV, cW, false, 0.0f, true, outerRun[2]);
+
+    const float* pOuterPos[3] =
+    {
+        outerPos[edgeOrder[0]], outerPos[edgeOrder[1]], outerPos[edgeOrder[2]]
+    };
+    uint32_t outerSegments[3] =
+    {
+        outer[edgeOrder[0]].numSegments, outer[edgeOrder[1]].numSegments, outer[edgeOrder[2]].numSegments
+    };
+
+    const uint32_t n = inner.numSegments;
+    for (uint32_t k = 1; 2 * k <= n; ++k)
+    {
+        uint32_t (*ringRun)[TS_MAX_FACTOR + 1] = runs[k & 1];
+        const uint32_t m = n - 2 * k;
+
+        if (m == 0)
+        {
+            uint32_t center = AddPoint(ctx, 1.0f / 3.0f, 1.0f / 3.0f);
+            ringRun[0][0] = ringRun[1][0] = ringRun[2][0] = center;
+        }
+        else
+        {
+            // ring corners sit on the medians, sides follow the inner
+            // subdivision between them
+            const float t = 2.0f * innerPos[k] / 3.0f;
+            const float cornerU[3] = { t, 1.0f - 2.0f * t, t };
+            const float cornerV[3] = { t, t, 1.0f - 2.0f * t };
+            const simdscalar vStart = _simd_set1_ps(innerPos[k]);
+            const simdscalar vScale = _simd_set1_ps(1.0f / (1.0f - 2.0f * innerPos[k]));
+            const uint32_t ringBase = ctx.numPoints;
+
+            SWR_ASSERT(ctx.numPoints + 3 * m <= TS_MAX_POINTS);
+            for (uint32_t side = 0; side < 3; ++side)
+            {
+                uint32_t next = (side + 1) % 3;
+                simdscalar vU0 = _simd_set1_ps(cornerU[side]);
+                simdscalar vV0 = _simd_set1_ps(cornerV[side]);
+                simdscalar vDU = _simd_set1_ps(cornerU[next] - cornerU[side]);
+                simdscalar vDV = _simd_set1_ps(cornerV[next] - cornerV[side]);
+                float* pOutU = &ctx.u[ringBase + side * m];
+                float* pOutV = &ctx.v[ringBase + side * m];
+
+                for (uint32_t i = 0; i < m; i += KNOB_SIMD_WIDTH)
+                {
+                    simdscalar vP = _simd_mul_ps(_simd_sub_ps(_simd_loadu_ps(&innerPos[k + i]), vStart), vScale);
+                    _simd_storeu_ps(&pOutU[i], _simd_fmadd_ps(vP, vDU, vU0));
+                    _simd_storeu_ps(&pOutV[i], _simd_fmadd_ps(vP, vDV, vV0));
+                }
+            }
+            ctx.numPoints += 3 * m;
+
+            for (uint32_t side = 0; side < 3; ++side)
+            {
+                for (uint32_t i = 0; i <= m; ++i)
+                {
+                    ringRun[side][i] = ringBase + (side * m + i) % (3 * m);
+                }
+            }
+        }
+
+        for (uint32_t side = 0; side < 3; ++side)
+        {
+            if (k == 1)
+            {
+                StitchStrip(ctx, outerRun[side], pOuterPos[side], outerSegments[side],
+                            ringRun[side], &innerPos[1], m);
+            }
+            else
+            {
+                StitchStrip(ctx, runs[(k - 1) & 1][side], &innerPos[k - 1], m + 2,
+                            ringRun[side], &innerPos[k], m);
+            }
+        }
+
+        if (m == 1)
+        {
+            AddTriangle(ctx, ringRun[0][0], ringRun[1][0], ringRun[2][0]);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Isoline domain.  The density factor gives the number of lines
+///        at v = j / density, the detail factor subdivides each of them.
+static void TessellateIsoline(TS_CONTEXT& ctx, const SWR_TESSELLATION_FACTORS& tf)
+{
+    if (IsCulled(tf, 2))
+    {
+        return;
+    }
+
+    TS_EDGE detail = ProcessFactor(tf.OuterTessFactors[SWR_QUAD_U_EQ0_TRI_U_LINE_DETAIL], ctx.partitioning, false);
+    TS_EDGE density = ProcessFactor(tf.OuterTessFactors[SWR_QUAD_V_EQ0_TRI_V_LINE_DENSITY], SWR_TS_INTEGER, false);
+
+    float pos[TS_PADDED(TS_MAX_FACTOR + 1)];
+    EdgePositions(detail, pos);
+
+    const uint32_t numLinePoints = detail.numSegments + 1;
+    const simdscalari vLanes = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    const simdscalari vOne = _simd_set1_epi32(1);
+
+    for (uint32_t line = 0; line < density.numSegments; ++line)
+    {
+        uint32_t lineBase = ctx.numPoints;
+        AddPointRow(ctx, pos, float(line) / float(density.numSegments), numLinePoints);
+
+        for (uint32_t k = 0; k < detail.numSegments; k += KNOB_SIMD_WIDTH)
+        {
+            uint32_t count = std::min<uint32_t>(detail.numSegments - k, KNOB_SIMD_WIDTH);
+            simdscalari vI0 = _simd_add_epi32(_simd_set1_epi32(lineBase + k), vLanes);
+            AddPrims(ctx, vI0, _simd_add_epi32(vI0, vOne), vI0, count);
+        }
+    }
+}
+
+HANDLE SWR_API TSInitCtx(
+    SWR_TS_DOMAIN tsDomain,
+    SWR_TS_PARTITIONING tsPartitioning,
+    SWR_TS_OUTPUT_TOPOLOGY tsOutputTopology,
+    void* pContextMem,
+    size_t& memSize)
+{
+    if (pContextMem == nullptr || memSize < sizeof(TS_CONTEXT))
+    {
+        memSize = sizeof(TS_CONTEXT);
+        return NULL;
+    }
+    SWR_ASSERT(((uintptr_t)pContextMem & (KNOB_SIMD_WIDTH * sizeof(float) - 1)) == 0);
+
+    TS_CONTEXT* pCtx = (TS_CONTEXT*)pContextMem;
+    pCtx->domain = tsDomain;
+    pCtx->partitioning = tsPartitioning;
+    pCtx->outputTopology = tsOutputTopology;
+    pCtx->numPoints = 0;
+    pCtx->numPrims = 0;
+    memSize = sizeof(TS_CONTEXT);
+
+    return pCtx;
+}
+
+void SWR_API TSDestroyCtx(HANDLE tsCtx)
+{
+    // the context memory belongs to the caller
+}
+
+void SWR_API TSTessellate(
+    HANDLE tsCtx,
+    const SWR_TESSELLATION_FACTORS& tsTessFactors,
+    SWR_TS_TESSELLATED_DATA& tsTessellatedData)
+{
+    TS_CONTEXT& ctx = *(TS_CONTEXT*)tsCtx;
+
+    ctx.numPoints = 0;
+    ctx.numPrims = 0;
+
+    switch (ctx.domain)
+    {
+    case SWR_TS_QUAD:       TessellateQuad(ctx, tsTessFactors); break;
+    case SWR_TS_TRI:        TessellateTri(ctx, tsTessFactors); break;
+    case SWR_TS_ISOLINE:    TessellateIsoline(ctx, tsTessFactors); break;
+    default: SWR_ASSERT(0, "Invalid tessellation domain: %d", ctx.domain);
+    }
+
+    if (ctx.numPrims == 0)
+    {
+        ctx.numPoints = 0;
+    }
+    else if (ctx.outputTopology == SWR_TS_OUTPUT_POINT)
+    {
+        // every domain point once, the connectivity is dropped
+        const simdscalari vLanes = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        for (uint32_t i = 0; i < ctx.numPoints; i += KNOB_SIMD_WIDTH)
+        {
+            _simd_storeu_si((simdscalari*)&ctx.indices[0][i],
+                            _simd_add_epi32(_simd_set1_epi32(i), vLanes));
+        }
+        ctx.numPrims = ctx.numPoints;
+    }
+
+    tsTessellatedData.NumPrimitives = ctx.numPrims;
+    tsTessellatedData.NumDomainPoints = ctx.numPoints;
+    tsTessellatedData.pDomainPointsU = ctx.u;
+    tsTessellatedData.pDomainPointsV = ctx.v;
+
+    // triangles are generated counter-clockwise
+    tsTessellatedData.ppIndices[0] = ctx.indices[0];
+    if (ctx.outputTopology == SWR_TS_OUTPUT_TRI_CW)
+    {
+        tsTessellatedData.ppIndices[1] = ctx.indices[2];
+        tsTessellatedData.ppIndices[2] = ctx.indices[1];
+    }
+    else
+    {
+        tsTessellatedData.ppIndices[1] = ctx.indices[1];
+        tsTessellatedData.ppIndices[2] = ctx.indices[2];
+    }
+}
@@ -532,6 +532,12 @@ void WorkOnFifoBE(
             return;
         }
 
+        // The stats a render condition tests have retired with the dependency,
+        // so every worker evaluates it to the same result.
+        const API_STATE& state = GetApiState(pDC);
+        bool renderConditionPassed = (state.pfnRenderCondition == nullptr) ||
+            state.pfnRenderCondition(state.pRenderConditionData);
+
         // Grab the list of all dirty macrotiles. A tile is dirty if it has work queued to it.
         std::vector<uint32_t> &macroTiles = pDC->pTileMgr->getDirtyTiles();
 
@@ -556,7 +562,7 @@ void WorkOnFifoBE(
                         {
                             pWork = tile.peek();
                             SWR_ASSERT(pWork);
-                            if (pWork->type == DRAW)
+                            if (pWork->type == DRAW && renderConditionPassed)
                             {
                                 InitializeHotTiles(pContext, pDC, tileID, (const TRIANGLE_WORK_DESC*)&pWork->desc);
                             }
@@ -564,7 +570,11 @@ void WorkOnFifoBE(
 
                         while ((pWork = tile.peek()) != nullptr)
                         {
-                            pWork->pfnWork(pDC, workerId, tileID, &pWork->desc);
+                            if (renderConditionPassed ||
+                                (pWork->type != DRAW && pWork->type != CLEAR))
+                            {
+                                pWork->pfnWork(pDC, workerId, tileID, &pWork->desc);
+                            }
                             tile.dequeue();
                         }
                         RDTSC_STOP(WorkerFoundWork, numWorkItems, pDC->drawId);
@@ -598,7 +608,15 @@ void WorkOnFifoBE(
     }
 }
 
-void WorkOnFifoFE(SWR_CONTEXT *pContext, uint32_t workerId, uint64_t &curDrawFE, UCHAR numaNode)
+//////////////////////////////////////////////////////////////////////////
+/// @brief If there is any FE work then go work on it.
+/// @param pContext - pointer to SWR context.
+/// @param workerId - The unique worker ID that is assigned to this thread.
+/// @param curDrawFE - This tracks the draw contexts whose FE this thread has moved past.
+/// @param curDrawBE - First draw not yet completed by this thread's BE.  Draws before it
+///                    have retired, which dependent FEs wait for.
+/// @param numaNode - NUMA node of the worker.
+void WorkOnFifoFE(SWR_CONTEXT *pContext, uint32_t workerId, uint64_t &curDrawFE, uint64_t curDrawBE, UCHAR numaNode)
 {
     // Try to grab the next DC from the ring
     uint64_t drawEnqueued = GetEnqueuedDraw(pContext);
@@ -623,7 +641,10 @@ void WorkOnFifoFE(SWR_CONTEXT *pContext, uint32_t workerId, uint64_t &curDrawFE,
         uint32_t dcSlot = curDraw % KNOB_MAX_DRAWS_IN_FLIGHT;
         DRAW_CONTEXT *pDC = &pContext->dcRing[dcSlot];
 
-        if (!pDC->isCompute && !pDC->FeLock)
+        // dependent FEs wait for the draw they depend on to retire
+        bool dependencyMet = pDC->dependencyFE < curDrawBE;
+
+        if (!pDC->isCompute && !pDC->FeLock && dependencyMet)
         {
             uint32_t initial = InterlockedCompareExchange((volatile uint32_t*)&pDC->FeLock, 1, 0);
             if (initial == 0)
@@ -670,6 +691,31 @@ void WorkOnCompute(
     SWR_ASSERT(pDC->pDispatch != nullptr);
     DispatchQueue& queue = *pDC->pDispatch;
 
+    // Indirect dispatches read their thread group counts only now, when all
+    // earlier work that may write them has retired.
+    if (!queue.isSetup())
+    {
+        if (!queue.tryClaimSetup())
+        {
+            return;
+        }
+
+        COMPUTE_DESC* pTaskData = (COMPUTE_DESC*)queue.GetTasksData();
+        pTaskData->threadGroupCountX = pTaskData->pIndirectArgs[0];
+        pTaskData->threadGroupCountY = pTaskData->pIndirectArgs[1];
+        pTaskData->threadGroupCountZ = pTaskData->pIndirectArgs[2];
+
+        uint32_t totalThreadGroups = pTaskData->threadGroupCountX *
+            pTaskData->threadGroupCountY * pTaskData->threadGroupCountZ;
+        queue.publish(totalThreadGroups);
+
+        if (totalThreadGroups == 0)
+        {
+            pDC->doneCompute = true;
+            return;
+        }
+    }
+
     // Is there any work remaining?
     if (queue.getNumQueued() > 0)
     {
@@ -781,7 +827,7 @@ DWORD workerThreadMain(LPVOID pData)
 
         WorkOnCompute(pContext, workerId, curDrawBE);
 
-        WorkOnFifoFE(pContext, workerId, curDrawFE, numaNode);
+        WorkOnFifoFE(pContext, workerId, curDrawFE, curDrawBE, numaNode);
     }
 
     return 0;
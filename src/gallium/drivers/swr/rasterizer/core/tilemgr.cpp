@@ -87,6 +87,21 @@ void MacroTileMgr::enqueue(uint32_t x, uint32_t y, BE_WORK *pWork)
     tile.enqueue_try_nosync(mArena, pWork);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns the work this draw queued last to a tile so the binner
+///        can append to it, or nullptr if the draw hasn't queued any. The
+///        backend doesn't start on the draw until the frontend is done.
+BE_WORK* MacroTileMgr::peekLastQueued(uint32_t x, uint32_t y)
+{
+    auto tile = mTiles.find(TILE_ID(x, y));
+    if (tile == mTiles.end() || tile->second.mWorkItemsFE == 0)
+    {
+        return nullptr;
+    }
+
+    return tile->second.peekTail();
+}
+
 void MacroTileMgr::markTileComplete(uint32_t id)
 {
     SWR_ASSERT(mTiles.find(id) != mTiles.end());
@@ -30,6 +30,8 @@
 
 #include <set>
 #include <unordered_map>
+#include <vector>
+#include <mutex>
 #include "common/formats.h"
 #include "fifo.hpp"
 #include "context.h"
@@ -71,6 +73,13 @@ struct MacroTileQueue
         return mFifo.peek();
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Peek at the work most recently queued to the fifo.
+    BE_WORK* peekTail()
+    {
+        return mFifo.peekTail();
+    }
+
     bool enqueue_try_nosync(Arena& arena, const BE_WORK* entry)
     {
         return mFifo.enqueue_try_nosync(arena, entry);
@@ -124,6 +133,7 @@ public:
     }
 
     void enqueue(uint32_t x, uint32_t y, BE_WORK *pWork);
+    BE_WORK* peekLastQueued(uint32_t x, uint32_t y);
 
     static INLINE void getTileIndices(uint32_t tileID, uint32_t &x, uint32_t &y)
     {
@@ -168,6 +178,45 @@ public:
         mTasksOutstanding = totalTasks;
 
         mpTaskData = pTaskData;
+        mSetup = SETUP_DONE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Setup a dispatch whose task count isn't known yet.  The first
+    ///        worker to claim it counts the tasks and publishes them.
+    void initializeDeferred(void* pTaskData)
+    {
+        mTasksAvailable = 0;
+        mTasksOutstanding = 0;
+
+        mpTaskData = pTaskData;
+        mSetup = SETUP_PENDING;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Returns true if the task counts are known.
+    bool isSetup()
+    {
+        return mSetup == SETUP_DONE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Attempt to become the worker counting the tasks of a deferred
+    ///        dispatch.
+    bool tryClaimSetup()
+    {
+        return InterlockedCompareExchange(&mSetup, SETUP_CLAIMED, SETUP_PENDING) == SETUP_PENDING;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Publish the task count of a deferred dispatch.
+    void publish(uint32_t totalTasks)
+    {
+        mTasksAvailable = totalTasks;
+        mTasksOutstanding = totalTasks;
+
+        _ReadWriteBarrier();
+        mSetup = SETUP_DONE;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -210,7 +259,8 @@ public:
     /// @brief Work is complete once both the available/outstanding counts have reached 0.
     bool isWorkComplete()
     {
-        return ((mTasksAvailable <= 0) &&
+        return ((mSetup == SETUP_DONE) &&
+                (mTasksAvailable <= 0) &&
                 (mTasksOutstanding <= 0));
     }
 
@@ -228,6 +278,9 @@ public:
 
     OSALIGNLINE(volatile LONG) mTasksAvailable{ 0 };
     OSALIGNLINE(volatile LONG) mTasksOutstanding{ 0 };
+
+    enum { SETUP_DONE, SETUP_PENDING, SETUP_CLAIMED };
+    volatile LONG mSetup{ SETUP_DONE };
 };
 
 
@@ -277,19 +330,10 @@ public:
 
     ~HotTileMgr()
     {
-        for (int x = 0; x < KNOB_NUM_HOT_TILES_X; ++x)
+        // hot tile buffers live in the slabs
+        for (BYTE* pSlab : mSlabs)
         {
-            for (int y = 0; y < KNOB_NUM_HOT_TILES_Y; ++y)
-            {
-                for (int a = 0; a < SWR_NUM_ATTACHMENTS; ++a)
-                {
-                    if (mHotTiles[x][y].Attachment[a].pBuffer != NULL)
-                    {
-                        _aligned_free(mHotTiles[x][y].Attachment[a].pBuffer);
-                        mHotTiles[x][y].Attachment[a].pBuffer = NULL;
-                    }
-                }
-            }
+            _aligned_free(pSlab);
         }
     }
 
@@ -309,7 +353,7 @@ public:
             if (create)
             {
                 uint32_t size = numSamples * mHotTileSize[attachment];
-                hotTile.pBuffer = (BYTE*)_aligned_malloc(size, KNOB_SIMD_WIDTH * 4);
+                hotTile.pBuffer = AllocHotTileBuffer(size);
                 hotTile.state = HOTTILE_INVALID;
                 hotTile.numSamples = numSamples;
                 hotTile.renderTargetArrayIndex = renderTargetArrayIndex;
@@ -329,13 +373,26 @@ public:
                 assert((hotTile.state == HOTTILE_INVALID) ||
                        (hotTile.state == HOTTILE_RESOLVED) || 
                        (hotTile.state == HOTTILE_CLEAR));
-                _aligned_free(hotTile.pBuffer);
+                FreeHotTileBuffer(hotTile.pBuffer, hotTile.numSamples * mHotTileSize[attachment]);
 
                 uint32_t size = numSamples * mHotTileSize[attachment];
-                hotTile.pBuffer = (BYTE*)_aligned_malloc(size, KNOB_SIMD_WIDTH * 4);
+                hotTile.pBuffer = AllocHotTileBuffer(size);
                 hotTile.state = HOTTILE_INVALID;
                 hotTile.numSamples = numSamples;
             }
+            else if (create && numSamples < hotTile.numSamples)
+            {
+                // keep the larger buffer, but lay it out for the new sample count so
+                // clears, loads and stores agree with the backend
+                assert((hotTile.state == HOTTILE_INVALID) ||
+                       (hotTile.state == HOTTILE_RESOLVED) ||
+                       (hotTile.state == HOTTILE_CLEAR));
+                if (hotTile.state != HOTTILE_CLEAR)
+                {
+                    hotTile.state = HOTTILE_INVALID;
+                }
+                hotTile.numSamples = numSamples;
+            }
 
             // if requested render target array index isn't currently loaded, need to store out the current hottile 
             // and load the requested array slice
@@ -384,7 +441,50 @@ public:
     }
 
 private:
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Carves a hot tile buffer out of the current slab, or reuses one
+    ///        of the same size freed by a sample count change. Slabs are
+    ///        placed on huge pages, so the backend's scattered macrotile
+    ///        accesses don't each need their own dTLB entries.
+    /// @param size - buffer size in bytes
+    BYTE* AllocHotTileBuffer(uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(mSlabMutex);
+
+        std::vector<BYTE*>& freeBuffers = mFreeBuffers[size];
+        if (!freeBuffers.empty())
+        {
+            BYTE* pBuffer = freeBuffers.back();
+            freeBuffers.pop_back();
+            return pBuffer;
+        }
+
+        SWR_ASSERT(size <= KNOB_HOT_TILE_SLAB_SIZE);
+        if (mSlabs.empty() || mSlabUsed + size > KNOB_HOT_TILE_SLAB_SIZE)
+        {
+            mSlabs.push_back((BYTE*)AlignedMallocHuge(KNOB_HOT_TILE_SLAB_SIZE, KNOB_SIMD_WIDTH * 4));
+            mSlabUsed = 0;
+        }
+
+        BYTE* pBuffer = mSlabs.back() + mSlabUsed;
+        mSlabUsed += size;
+        return pBuffer;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Returns a hot tile buffer for reuse by buffers of the same size.
+    void FreeHotTileBuffer(BYTE* pBuffer, uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(mSlabMutex);
+        mFreeBuffers[size].push_back(pBuffer);
+    }
+
     HotTileSet mHotTiles[KNOB_NUM_HOT_TILES_X][KNOB_NUM_HOT_TILES_Y];
     uint32_t mHotTileSize[SWR_NUM_ATTACHMENTS];
+
+    std::mutex mSlabMutex;
+    std::vector<BYTE*> mSlabs;
+    uint32_t mSlabUsed{ 0 };
+    std::unordered_map<uint32_t, std::vector<BYTE*>> mFreeBuffers;
 };
 
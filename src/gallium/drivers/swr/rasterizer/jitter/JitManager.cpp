@@ -177,6 +177,8 @@ JitManager::JitManager(uint32_t simdWidth, const char *arch)
     mSimdVectorTy = StructType::get(mContext, std::vector<Type*>(4, mSimtFP32Ty), false);
     mSimdVectorInt32Ty = StructType::get(mContext, std::vector<Type*>(4, mSimtInt32Ty), false);
 
+    SelectGatherStrategy();
+
 #if defined(_WIN32)
     // explicitly instantiate used symbols from potentially staticly linked libs
     sys::DynamicLibrary::AddSymbol("exp2f", &exp2f);
@@ -202,6 +204,57 @@ JitManager::JitManager(uint32_t simdWidth, const char *arch)
 #endif
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Pick how gathers are lowered for this host.  Hardware gather
+///        on Haswell/Broadwell and on AMD parts is slower than a couple of
+///        masked loads plus a permute for small strides, later Intel cores
+///        only lose to it for contiguous accesses.
+void JitManager::SelectGatherStrategy()
+{
+    bool hasGather = mArch.AVX2();
+    StringRef cpu = sys::getHostCPUName();
+
+    switch (KNOB_GATHER_STRATEGY)
+    {
+    case GATHER_STRATEGY_HARDWARE:
+        mUseHardwareGather = hasGather;
+        mMaxGatherPermuteStride = 0;
+        break;
+    case GATHER_STRATEGY_LOAD_PERMUTE:
+        mUseHardwareGather = hasGather;
+        mMaxGatherPermuteStride = 4;
+        break;
+    case GATHER_STRATEGY_SCALAR:
+        mUseHardwareGather = false;
+        mMaxGatherPermuteStride = 0;
+        break;
+    case GATHER_STRATEGY_AUTO:
+    default:
+        if (!hasGather)
+        {
+            mUseHardwareGather = false;
+            mMaxGatherPermuteStride = 4;
+        }
+        else if (cpu.startswith("znver") || cpu.startswith("bdver"))
+        {
+            // microcoded gather
+            mUseHardwareGather = false;
+            mMaxGatherPermuteStride = 4;
+        }
+        else if (cpu == "haswell" || cpu == "broadwell")
+        {
+            mUseHardwareGather = true;
+            mMaxGatherPermuteStride = 4;
+        }
+        else
+        {
+            mUseHardwareGather = true;
+            mMaxGatherPermuteStride = 1;
+        }
+        break;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Create new LLVM module.
 void JitManager::SetupNewModule()
@@ -132,6 +132,19 @@ struct JitLLVMContext : LLVMContext
 {
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// JIT_GATHER_STRATEGY
+/// @brief How Builder::GATHERPS/GATHERDD lower a gather.  Matches the
+/// values of KNOB_GATHER_STRATEGY.
+//////////////////////////////////////////////////////////////////////////
+enum JIT_GATHER_STRATEGY
+{
+    GATHER_STRATEGY_AUTO,           // per CPU model and access pattern
+    GATHER_STRATEGY_HARDWARE,       // vgather whenever the ISA has it
+    GATHER_STRATEGY_LOAD_PERMUTE,   // masked loads + permute for detected strides
+    GATHER_STRATEGY_SCALAR,         // per lane loads
+};
+
 
 //////////////////////////////////////////////////////////////////////////
 /// JitManager
@@ -179,7 +192,12 @@ struct JitManager
 
     JitInstructionSet mArch;
 
+    // gather lowering, resolved from KNOB_GATHER_STRATEGY and the host cpu
+    bool mUseHardwareGather;        ///< emit vgather for unrecognized patterns
+    uint32_t mMaxGatherPermuteStride; ///< max stride in dwords lowered to load/permute, 0 = never
+
     void SetupNewModule();
+    void SelectGatherStrategy();
     bool SetupModuleFromIR(const uint8_t *pIR);
 
     static void DumpToFile(Function *f, const char *fileName);
@@ -442,7 +442,7 @@ struct BlendJit : public Builder
         }
     }
 
-    void AlphaTest(const BLEND_COMPILE_STATE& state, Value* pBlendState, Value* pAlpha, Value* ppMask)
+    Value* AlphaTestResult(const BLEND_COMPILE_STATE& state, Value* pBlendState, Value* pAlpha)
     {
         // load uint32_t reference
         Value* pRef = VBROADCAST(LOAD(pBlendState, { 0, SWR_BLEND_STATE_alphaTestReference }));
@@ -492,6 +492,13 @@ struct BlendJit : public Builder
             }
         }
 
+        return pTest;
+    }
+
+    void AlphaTest(const BLEND_COMPILE_STATE& state, Value* pBlendState, Value* pAlpha, Value* ppMask)
+    {
+        Value* pTest = AlphaTestResult(state, pBlendState, pAlpha);
+
         // load current mask
         Value* pMask = LOAD(ppMask);
 
@@ -508,85 +515,11 @@ struct BlendJit : public Builder
         STORE(pMask, ppMask);
     }
 
-    Function* Create(const BLEND_COMPILE_STATE& state)
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Generates color blend and/or logic op for one render target.
+    ///        src, src1 and dst are clamped/converted in place.
+    void GenerateBlend(const BLEND_COMPILE_STATE& state, Value* constantColor[4], Value* src[4], Value* src1[4], Value* dst[4], Value* result[4])
     {
-        static std::size_t jitNum = 0;
-
-        std::stringstream fnName("BlendShader", std::ios_base::in | std::ios_base::out | std::ios_base::ate);
-        fnName << jitNum++;
-
-        // blend function signature
-        //typedef void(*PFN_BLEND_JIT_FUNC)(const SWR_BLEND_STATE*, simdvector&, simdvector&, uint32_t, BYTE*, simdvector&, simdscalari*, simdscalari*);
-
-        std::vector<Type*> args{
-            PointerType::get(Gen_SWR_BLEND_STATE(JM()), 0), // SWR_BLEND_STATE*
-            PointerType::get(mSimdFP32Ty, 0),               // simdvector& src
-            PointerType::get(mSimdFP32Ty, 0),               // simdvector& src1
-            Type::getInt32Ty(JM()->mContext),               // sampleNum
-            PointerType::get(mSimdFP32Ty, 0),               // uint8_t* pDst
-            PointerType::get(mSimdFP32Ty, 0),               // simdvector& result
-            PointerType::get(mSimdInt32Ty, 0),              // simdscalari* oMask
-            PointerType::get(mSimdInt32Ty, 0),              // simdscalari* pMask
-        };
-
-        FunctionType* fTy = FunctionType::get(IRB()->getVoidTy(), args, false);
-        Function* blendFunc = Function::Create(fTy, GlobalValue::ExternalLinkage, fnName.str(), JM()->mpCurrentModule);
-
-        BasicBlock* entry = BasicBlock::Create(JM()->mContext, "entry", blendFunc);
-
-        IRB()->SetInsertPoint(entry);
-
-        // arguments
-        auto argitr = blendFunc->getArgumentList().begin();
-        Value* pBlendState = &*argitr++;
-        pBlendState->setName("pBlendState");
-        Value* pSrc = &*argitr++;
-        pSrc->setName("src");
-        Value* pSrc1 = &*argitr++;
-        pSrc1->setName("src1");
-        Value* sampleNum = &*argitr++;
-        sampleNum->setName("sampleNum");
-        Value* pDst = &*argitr++;
-        pDst->setName("pDst");
-        Value* pResult = &*argitr++;
-        pResult->setName("result");
-        Value* ppoMask = &*argitr++;
-        ppoMask->setName("ppoMask");
-        Value* ppMask = &*argitr++;
-        ppMask->setName("pMask");
-
-        static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format");
-        Value* dst[4];
-        Value* constantColor[4];
-        Value* src[4];
-        Value* src1[4];
-        Value* result[4];
-        for (uint32_t i = 0; i < 4; ++i)
-        {
-            // load hot tile
-            dst[i] = LOAD(pDst, { i });
-
-            // load constant color
-            constantColor[i] = VBROADCAST(LOAD(pBlendState, { 0, SWR_BLEND_STATE_constantColor, i }));
-
-            // load src
-            src[i] = LOAD(pSrc, { i });
-
-            // load src1
-            src1[i] = LOAD(pSrc1, { i });
-        }
-        Value* currentMask = VIMMED1(-1);
-        if(state.desc.alphaToCoverageEnable)
-        {
-            currentMask = FP_TO_SI(FMUL(src[3], VBROADCAST(C((float)state.desc.numSamples))), mSimdInt32Ty);
-        }
-
-        // alpha test
-        if (state.desc.alphaTestEnable)
-        {
-            AlphaTest(state, pBlendState, src[3], ppMask);
-        }
-
         // color blend
         if (state.blendState.blendEnable)
         {
@@ -634,14 +567,8 @@ struct BlendJit : public Builder
 
                 BlendFunc<true, true>(state.blendState.colorBlendFunc, src, srcFactor, dst, dstFactor, result);
             }
-
-            // store results out
-            for (uint32_t i = 0; i < 4; ++i)
-            {
-                STORE(result[i], pResult, { i });
-            }
         }
-        
+
         if(state.blendState.logicOpEnable)
         {
             const SWR_FORMAT_INFO& info = GetFormatInfo(state.format);
@@ -672,19 +599,29 @@ struct BlendJit : public Builder
 
             LogicOpFunc(state.blendState.logicOpFunc, src, dst, result);
 
-            // store results out
             for(uint32_t i = 0; i < 4; ++i)
             {
                 // clear upper bits from PS output not in RT format after doing logic op
-                result[i] = AND(result[i], vMask[i]);
-
-                STORE(BITCAST(result[i], mSimdFP32Ty), pResult, {i});
+                result[i] = BITCAST(AND(result[i], vMask[i]), mSimdFP32Ty);
             }
         }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Applies alpha to coverage, oMask and sample mask to a coverage mask
+    /// @param vMask - simd integer coverage mask
+    /// @return updated coverage mask
+    Value* SampleCoverage(const BLEND_DESC& desc, Value* pBlendState, Value* srcAlpha, Value* sampleNum, Value* ppoMask, Value* vMask)
+    {
+        Value* currentMask = VIMMED1(-1);
+        if(desc.alphaToCoverageEnable)
+        {
+            currentMask = FP_TO_SI(FMUL(srcAlpha, VBROADCAST(C((float)desc.numSamples))), mSimdInt32Ty);
+        }
 
-        if(state.desc.oMaskEnable)
+        if(desc.oMaskEnable)
         {
-            assert(!(state.desc.alphaToCoverageEnable));
+            assert(!(desc.alphaToCoverageEnable));
             // load current mask
             Value* oMask = LOAD(ppoMask);
             Value* sampleMasked = VBROADCAST(SHL(C(1), sampleNum));
@@ -692,7 +629,7 @@ struct BlendJit : public Builder
             currentMask = AND(oMask, currentMask);
         }
 
-        if(state.desc.sampleMaskEnable)
+        if(desc.sampleMaskEnable)
         {
             Value* sampleMask = LOAD(pBlendState, { 0, SWR_BLEND_STATE_sampleMask});
             Value* sampleMasked = SHL(C(1), sampleNum);
@@ -702,13 +639,108 @@ struct BlendJit : public Builder
             currentMask = AND(sampleMask, currentMask);
         }
 
+        if(desc.sampleMaskEnable || desc.alphaToCoverageEnable ||
+           desc.oMaskEnable)
+        {
+            currentMask = S_EXT(ICMP_SGT(currentMask, VBROADCAST(C(0))), mSimdInt32Ty);
+            vMask = AND(vMask, currentMask);
+        }
+
+        return vMask;
+    }
+
+    Function* Create(const BLEND_COMPILE_STATE& state)
+    {
+        static std::size_t jitNum = 0;
+
+        std::stringstream fnName("BlendShader", std::ios_base::in | std::ios_base::out | std::ios_base::ate);
+        fnName << jitNum++;
+
+        // blend function signature
+        //typedef void(*PFN_BLEND_JIT_FUNC)(const SWR_BLEND_STATE*, simdvector&, simdvector&, uint32_t, BYTE*, simdvector&, simdscalari*, simdscalari*);
+
+        std::vector<Type*> args{
+            PointerType::get(Gen_SWR_BLEND_STATE(JM()), 0), // SWR_BLEND_STATE*
+            PointerType::get(mSimdFP32Ty, 0),               // simdvector& src
+            PointerType::get(mSimdFP32Ty, 0),               // simdvector& src1
+            Type::getInt32Ty(JM()->mContext),               // sampleNum
+            PointerType::get(mSimdFP32Ty, 0),               // uint8_t* pDst
+            PointerType::get(mSimdFP32Ty, 0),               // simdvector& result
+            PointerType::get(mSimdInt32Ty, 0),              // simdscalari* oMask
+            PointerType::get(mSimdInt32Ty, 0),              // simdscalari* pMask
+        };
+
+        FunctionType* fTy = FunctionType::get(IRB()->getVoidTy(), args, false);
+        Function* blendFunc = Function::Create(fTy, GlobalValue::ExternalLinkage, fnName.str(), JM()->mpCurrentModule);
+
+        BasicBlock* entry = BasicBlock::Create(JM()->mContext, "entry", blendFunc);
+
+        IRB()->SetInsertPoint(entry);
+
+        // arguments
+        auto argitr = blendFunc->getArgumentList().begin();
+        Value* pBlendState = &*argitr++;
+        pBlendState->setName("pBlendState");
+        Value* pSrc = &*argitr++;
+        pSrc->setName("src");
+        Value* pSrc1 = &*argitr++;
+        pSrc1->setName("src1");
+        Value* sampleNum = &*argitr++;
+        sampleNum->setName("sampleNum");
+        Value* pDst = &*argitr++;
+        pDst->setName("pDst");
+        Value* pResult = &*argitr++;
+        pResult->setName("result");
+        Value* ppoMask = &*argitr++;
+        ppoMask->setName("ppoMask");
+        Value* ppMask = &*argitr++;
+        ppMask->setName("pMask");
+
+        static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format");
+        Value* dst[4];
+        Value* constantColor[4];
+        Value* src[4];
+        Value* src1[4];
+        Value* result[4];
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            // load hot tile
+            dst[i] = LOAD(pDst, { i });
+
+            // load constant color
+            constantColor[i] = VBROADCAST(LOAD(pBlendState, { 0, SWR_BLEND_STATE_constantColor, i }));
+
+            // load src
+            src[i] = LOAD(pSrc, { i });
+
+            // load src1
+            src1[i] = LOAD(pSrc1, { i });
+        }
+        Value* srcAlpha = src[3];
+
+        // alpha test
+        if (state.desc.alphaTestEnable)
+        {
+            AlphaTest(state, pBlendState, src[3], ppMask);
+        }
+
+        if (state.blendState.blendEnable || state.blendState.logicOpEnable)
+        {
+            GenerateBlend(state, constantColor, src, src1, dst, result);
+
+            // store results out
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                STORE(result[i], pResult, { i });
+            }
+        }
+
         if(state.desc.sampleMaskEnable || state.desc.alphaToCoverageEnable ||
            state.desc.oMaskEnable)
         {
             // load current mask
             Value* pMask = LOAD(ppMask);
-            currentMask = S_EXT(ICMP_SGT(currentMask, VBROADCAST(C(0))), mSimdInt32Ty);
-            Value* outputMask = AND(pMask, currentMask);
+            Value* outputMask = SampleCoverage(state.desc, pBlendState, srcAlpha, sampleNum, ppoMask, pMask);
             // store new mask
             STORE(outputMask, GEP(ppMask, C(0)));
         }
@@ -736,6 +768,308 @@ struct BlendJit : public Builder
 
         return blendFunc;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Generates a depth or stencil compare, a <func> b
+    Value* DepthStencilCompare(uint32_t func, Value* a, Value* b)
+    {
+        bool isFloat = a->getType()->getScalarType()->isFloatingPointTy();
+
+        switch (func)
+        {
+        case ZFUNC_ALWAYS:  return VIMMED1(true);
+        case ZFUNC_NEVER:   return VIMMED1(false);
+        case ZFUNC_LT:      return isFloat ? FCMP_OLT(a, b) : ICMP_ULT(a, b);
+        case ZFUNC_EQ:      return isFloat ? FCMP_OEQ(a, b) : ICMP_EQ(a, b);
+        case ZFUNC_LE:      return isFloat ? FCMP_OLE(a, b) : ICMP_ULE(a, b);
+        case ZFUNC_GT:      return isFloat ? FCMP_OGT(a, b) : ICMP_UGT(a, b);
+        case ZFUNC_NE:      return isFloat ? FCMP_ONE(a, b) : ICMP_NE(a, b);
+        case ZFUNC_GE:      return isFloat ? FCMP_OGE(a, b) : ICMP_UGE(a, b);
+        default:
+            SWR_ASSERT(false, "Invalid depth/stencil test function");
+            return VIMMED1(true);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Generates stencil test against the 8bit stencil hot tile value
+    Value* StencilTest(uint32_t func, uint8_t ref, uint8_t testMask, Value* stencil)
+    {
+        Value* stencilWithMask = AND(stencil, VIMMED1((int)testMask));
+        return DepthStencilCompare(func, VIMMED1((int)(ref & testMask)), stencilWithMask);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Applies a stencil op to the lanes enabled in mask
+    Value* StencilOp(uint32_t op, Value* mask, Value* ref, Value* stencil)
+    {
+        Value* result;
+
+        switch (op)
+        {
+        case STENCILOP_KEEP:    return stencil;
+        case STENCILOP_ZERO:    result = VIMMED1(0); break;
+        case STENCILOP_REPLACE: result = ref; break;
+        case STENCILOP_INCRSAT: result = SELECT(ICMP_ULT(stencil, VIMMED1(0xff)), ADD(stencil, VIMMED1(1)), stencil); break;
+        case STENCILOP_DECRSAT: result = SELECT(ICMP_UGT(stencil, VIMMED1(0)), SUB(stencil, VIMMED1(1)), stencil); break;
+        case STENCILOP_INCR:    result = AND(ADD(stencil, VIMMED1(1)), VIMMED1(0xff)); break;
+        case STENCILOP_DECR:    result = AND(SUB(stencil, VIMMED1(1)), VIMMED1(0xff)); break;
+        case STENCILOP_INVERT:  result = XOR(stencil, VIMMED1(0xff)); break;
+        default:
+            SWR_ASSERT(false, "Invalid stencil op");
+            return stencil;
+        }
+
+        return SELECT(mask, result, stencil);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Generates new stencil values for one face
+    Value* StencilWrite(uint32_t failOp, uint32_t passDepthFailOp, uint32_t passDepthPassOp, uint8_t ref, uint8_t writeMask,
+                        Value* stencil, Value* failMask, Value* passDepthFailMask, Value* passDepthPassMask)
+    {
+        Value* vRef = VIMMED1((int)ref);
+
+        Value* result = StencilOp(failOp, failMask, vRef, stencil);
+        result = StencilOp(passDepthFailOp, passDepthFailMask, vRef, result);
+        result = StencilOp(passDepthPassOp, passDepthPassMask, vRef, result);
+
+        // apply stencil write mask
+        return OR(AND(result, VIMMED1((int)writeMask)), AND(stencil, VIMMED1((int)(~writeMask & 0xff))));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Creates a single kernel performing late depth/stencil test, alpha
+    ///        test, blend, color write mask, hot tile store and depth/stencil write
+    ///        for one SIMD of single sampled pixels.
+    Function* CreateOutputMerger(const OUTPUT_MERGER_COMPILE_STATE& state)
+    {
+        static std::size_t jitNum = 0;
+
+        std::stringstream fnName("OutputMerger", std::ios_base::in | std::ios_base::out | std::ios_base::ate);
+        fnName << jitNum++;
+
+        // output merger function signature
+        //typedef void(*PFN_OUTPUT_MERGER_JIT_FUNC)(const SWR_BLEND_STATE*, const SWR_VIEWPORT*, simdvector*, simdscalar*, uint32_t,
+        //                                          BYTE**, BYTE*, BYTE*, simdscalari*, simdscalari*, simdscalari*, simdscalari*);
+
+        std::vector<Type*> args{
+            PointerType::get(Gen_SWR_BLEND_STATE(JM()), 0),         // SWR_BLEND_STATE*
+            PointerType::get(Gen_SWR_VIEWPORT(JM()), 0),            // SWR_VIEWPORT*
+            PointerType::get(mSimdFP32Ty, 0),                       // simdvector* shaded
+            PointerType::get(mSimdFP32Ty, 0),                       // simdscalar* vZ
+            mInt32Ty,                                               // frontFacing
+            PointerType::get(PointerType::get(mInt8Ty, 0), 0),      // uint8_t** pColorBase
+            PointerType::get(mInt8Ty, 0),                           // uint8_t* pDepthBase
+            PointerType::get(mInt8Ty, 0),                           // uint8_t* pStencilBase
+            PointerType::get(mSimdInt32Ty, 0),                      // simdscalari* oMask
+            PointerType::get(mSimdInt32Ty, 0),                      // simdscalari* pCoverageMask
+            PointerType::get(mSimdInt32Ty, 0),                      // simdscalari* pDepthPassMask
+            PointerType::get(mSimdInt32Ty, 0),                      // simdscalari* pStencilPassMask
+        };
+
+        FunctionType* fTy = FunctionType::get(IRB()->getVoidTy(), args, false);
+        Function* omFunc = Function::Create(fTy, GlobalValue::ExternalLinkage, fnName.str(), JM()->mpCurrentModule);
+
+        BasicBlock* entry = BasicBlock::Create(JM()->mContext, "entry", omFunc);
+
+        IRB()->SetInsertPoint(entry);
+
+        // arguments
+        auto argitr = omFunc->getArgumentList().begin();
+        Value* pBlendState = &*argitr++;
+        pBlendState->setName("pBlendState");
+        Value* pViewport = &*argitr++;
+        pViewport->setName("pViewport");
+        Value* pShaded = &*argitr++;
+        pShaded->setName("shaded");
+        Value* pZ = &*argitr++;
+        pZ->setName("vZ");
+        Value* frontFacing = &*argitr++;
+        frontFacing->setName("frontFacing");
+        Value* ppColorBase = &*argitr++;
+        ppColorBase->setName("pColorBase");
+        Value* pDepthBase = &*argitr++;
+        pDepthBase->setName("pDepthBase");
+        Value* pStencilBase = &*argitr++;
+        pStencilBase->setName("pStencilBase");
+        Value* ppoMask = &*argitr++;
+        ppoMask->setName("ppoMask");
+        Value* pCoverageMask = &*argitr++;
+        pCoverageMask->setName("pCoverageMask");
+        Value* pDepthPassMask = &*argitr++;
+        pDepthPassMask->setName("pDepthPassMask");
+        Value* pStencilPassMask = &*argitr++;
+        pStencilPassMask->setName("pStencilPassMask");
+
+        static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format");
+        static_assert(KNOB_DEPTH_HOT_TILE_FORMAT == R32_FLOAT, "Unsupported depth hot tile format");
+        static_assert(KNOB_STENCIL_HOT_TILE_FORMAT == R8_UINT, "Unsupported stencil hot tile format");
+
+        const SWR_DEPTH_STENCIL_STATE& dsState = state.depthStencilState;
+        const BLEND_COMPILE_STATE& rt0State = state.renderTarget[0];
+        Value* isFront = ICMP_NE(frontFacing, C(0));
+
+        // clamp Z to viewport [minZ..maxZ]
+        Value* vMinZ = VBROADCAST(LOAD(pViewport, { 0, SWR_VIEWPORT_minZ }));
+        Value* vMaxZ = VBROADCAST(LOAD(pViewport, { 0, SWR_VIEWPORT_maxZ }));
+        Value* vZ = VMINPS(vMaxZ, VMAXPS(vMinZ, LOAD(pZ)));
+
+        Value* pDepth = BITCAST(pDepthBase, PointerType::get(mSimdFP32Ty, 0));
+        Value* pStencil = BITCAST(pStencilBase, PointerType::get(VectorType::get(mInt8Ty, JM()->mVWidth), 0));
+
+        Value* stencil = nullptr;
+        if (dsState.stencilTestEnable || dsState.stencilWriteEnable)
+        {
+            stencil = Z_EXT(LOAD(pStencil), mSimdInt32Ty);
+        }
+
+        Value* vCoverage = MASK(LOAD(pCoverageMask));
+        Value* vDepthPass;
+        Value* vStencilPass;
+
+        // late depth/stencil test
+        if (state.earlyZ)
+        {
+            vDepthPass = MASK(LOAD(pDepthPassMask));
+            vStencilPass = MASK(LOAD(pStencilPassMask));
+        }
+        else
+        {
+            Value* vDepthResult = VIMMED1(true);
+            if (dsState.depthTestEnable)
+            {
+                vDepthResult = DepthStencilCompare(dsState.depthTestFunc, vZ, LOAD(pDepth));
+            }
+
+            vStencilPass = VIMMED1(true);
+            if (dsState.stencilTestEnable)
+            {
+                vStencilPass = StencilTest(dsState.stencilTestFunc, dsState.stencilRefValue, dsState.stencilTestMask, stencil);
+                if (dsState.doubleSidedStencilTestEnable)
+                {
+                    Value* vBackPass = StencilTest(dsState.backfaceStencilTestFunc, dsState.backfaceStencilRefValue,
+                                                   dsState.backfaceStencilTestMask, stencil);
+                    vStencilPass = SELECT(isFront, vStencilPass, vBackPass);
+                }
+            }
+
+            vDepthPass = AND(AND(vDepthResult, vStencilPass), vCoverage);
+        }
+
+        // alpha test and coverage modifiers use RT0 output
+        Value* src0Alpha = LOAD(pShaded, { 3 });
+        if (rt0State.desc.alphaTestEnable)
+        {
+            vCoverage = AND(vCoverage, AlphaTestResult(rt0State, pBlendState, src0Alpha));
+        }
+
+        if(rt0State.desc.sampleMaskEnable || rt0State.desc.alphaToCoverageEnable ||
+           rt0State.desc.oMaskEnable)
+        {
+            vCoverage = MASK(SampleCoverage(rt0State.desc, pBlendState, src0Alpha, C(0), ppoMask, VMASK(vCoverage)));
+        }
+
+        // blend and store color with write mask
+        Value* vOutputMask = AND(vCoverage, vDepthPass);
+        for (uint32_t rt = 0; rt < state.numRenderTargets; ++rt)
+        {
+            const BLEND_COMPILE_STATE& rtState = state.renderTarget[rt];
+            if (state.writeMask[rt] == 0)
+            {
+                continue;
+            }
+
+            Value* pColor = BITCAST(LOAD(ppColorBase, { rt }), PointerType::get(mSimdFP32Ty, 0));
+
+            Value* dst[4];
+            Value* dstOrig[4];
+            Value* constantColor[4];
+            Value* src[4];
+            Value* src1[4];
+            Value* result[4];
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                dst[i] = dstOrig[i] = LOAD(pColor, { i });
+                constantColor[i] = VBROADCAST(LOAD(pBlendState, { 0, SWR_BLEND_STATE_constantColor, i }));
+                src[i] = result[i] = LOAD(pShaded, { rt * 4 + i });
+                src1[i] = LOAD(pShaded, { 4 + i });
+            }
+
+            if (rtState.blendState.blendEnable || rtState.blendState.logicOpEnable)
+            {
+                GenerateBlend(rtState, constantColor, src, src1, dst, result);
+            }
+
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                if (state.writeMask[rt] & (1 << i))
+                {
+                    STORE(SELECT(vOutputMask, result[i], dstOrig[i]), pColor, { i });
+                }
+            }
+        }
+
+        // depth/stencil write
+        if (!state.forceEarlyZ)
+        {
+            if (dsState.depthWriteEnable)
+            {
+                Value* vMask = AND(vDepthPass, vCoverage);
+                STORE(SELECT(vMask, vZ, LOAD(pDepth)), pDepth);
+            }
+
+            if (dsState.stencilWriteEnable)
+            {
+                Value* vFailMask = AND(NOT(vStencilPass), vCoverage);
+                Value* vPassDepthPassMask = AND(vStencilPass, vDepthPass);
+                Value* vPassDepthFailMask = AND(vStencilPass, NOT(vDepthPass));
+
+                Value* vStencil = StencilWrite(dsState.stencilFailOp, dsState.stencilPassDepthFailOp, dsState.stencilPassDepthPassOp,
+                                               dsState.stencilRefValue, dsState.stencilWriteMask,
+                                               stencil, vFailMask, vPassDepthFailMask, vPassDepthPassMask);
+                if (dsState.doubleSidedStencilTestEnable)
+                {
+                    Value* vBackStencil = StencilWrite(dsState.backfaceStencilFailOp, dsState.backfaceStencilPassDepthFailOp,
+                                                       dsState.backfaceStencilPassDepthPassOp, dsState.backfaceStencilRefValue,
+                                                       dsState.backfaceStencilWriteMask,
+                                                       stencil, vFailMask, vPassDepthFailMask, vPassDepthPassMask);
+                    vStencil = SELECT(isFront, vStencil, vBackStencil);
+                }
+
+                vStencil = SELECT(vCoverage, vStencil, stencil);
+                STORE(TRUNC(vStencil, VectorType::get(mInt8Ty, JM()->mVWidth)), pStencil);
+            }
+        }
+
+        // return updated masks for stats and subsequent samples
+        STORE(VMASK(vCoverage), pCoverageMask);
+        STORE(VMASK(vDepthPass), pDepthPassMask);
+        STORE(VMASK(vStencilPass), pStencilPassMask);
+
+        RET_VOID();
+
+        JitManager::DumpToFile(omFunc, "");
+
+        FunctionPassManager passes(JM()->mpCurrentModule);
+        passes.add(createBreakCriticalEdgesPass());
+        passes.add(createCFGSimplificationPass());
+        passes.add(createEarlyCSEPass());
+        passes.add(createPromoteMemoryToRegisterPass());
+        passes.add(createCFGSimplificationPass());
+        passes.add(createEarlyCSEPass());
+        passes.add(createInstructionCombiningPass());
+        passes.add(createInstructionSimplifierPass());
+        passes.add(createConstantPropagationPass());
+        passes.add(createSCCPPass());
+        passes.add(createAggressiveDCEPass());
+
+        passes.run(*omFunc);
+
+        JitManager::DumpToFile(omFunc, "optimized");
+
+        return omFunc;
+    }
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -770,3 +1104,19 @@ extern "C" PFN_BLEND_JIT_FUNC JITCALL JitCompileBlend(HANDLE hJitMgr, const BLEN
 
     return JitBlendFunc(hJitMgr, hFunc);
 }
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief JIT compiles fused output merger
+/// @param hJitMgr - JitManager handle
+/// @param state   - output merger state to build function from
+extern "C" PFN_OUTPUT_MERGER_JIT_FUNC JITCALL JitCompileOutputMerger(HANDLE hJitMgr, const OUTPUT_MERGER_COMPILE_STATE& state)
+{
+    JitManager* pJitMgr = reinterpret_cast<JitManager*>(hJitMgr);
+
+    pJitMgr->SetupNewModule();
+
+    BlendJit theJit(pJitMgr);
+    HANDLE hFunc = theJit.CreateOutputMerger(state);
+
+    return (PFN_OUTPUT_MERGER_JIT_FUNC)JitBlendFunc(hJitMgr, hFunc);
+}
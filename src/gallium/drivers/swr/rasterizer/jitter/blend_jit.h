@@ -91,3 +91,23 @@ struct BLEND_COMPILE_STATE
         return memcmp(this, &other, sizeof(BLEND_COMPILE_STATE)) == 0;
     }
 };
+
+//////////////////////////////////////////////////////////////////////////
+/// State required for fused output merger jit
+//////////////////////////////////////////////////////////////////////////
+struct OUTPUT_MERGER_COMPILE_STATE
+{
+    uint32_t numRenderTargets;
+    BLEND_COMPILE_STATE renderTarget[SWR_NUM_RENDERTARGETS];   // alpha test/coverage state taken from RT0
+    uint32_t writeMask[SWR_NUM_RENDERTARGETS];                 // color write enables, bit0 = red .. bit3 = alpha
+
+    SWR_DEPTH_STENCIL_STATE depthStencilState;
+
+    bool earlyZ;            // depth/stencil test already done by the backend before the PS
+    bool forceEarlyZ;       // depth/stencil write already done by the backend before the PS
+
+    bool operator==(const OUTPUT_MERGER_COMPILE_STATE& other) const
+    {
+        return memcmp(this, &other, sizeof(OUTPUT_MERGER_COMPILE_STATE)) == 0;
+    }
+};
@@ -544,6 +544,180 @@ CallInst* Builder::PRINT(const std::string &printStr)
     return PRINT(printStr, {});
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Compute the per lane stride of a SIMD index vector, in index
+/// units.  Recognizes constant progressions, splats and sums/scales of
+/// those, which is what fetch and friends build their offsets from.
+/// @param v - SIMD wide i32 index vector
+/// @param stride - (out) difference between adjacent lanes
+static bool GetIndexStride(Value* v, int64_t &stride)
+{
+    uint32_t numElems = v->getType()->getVectorNumElements();
+
+    if (Constant *pConst = dyn_cast<Constant>(v))
+    {
+        int64_t elems[2];
+        for (uint32_t i = 0; i < numElems; ++i)
+        {
+            ConstantInt *pElem = dyn_cast_or_null<ConstantInt>(pConst->getAggregateElement(i));
+            if (pElem == nullptr)
+            {
+                return false;
+            }
+            int64_t elem = pElem->getSExtValue();
+            if (i < 2)
+            {
+                elems[i] = elem;
+            }
+            else if (elem != elems[0] + i * (elems[1] - elems[0]))
+            {
+                return false;
+            }
+        }
+        stride = elems[1] - elems[0];
+        return true;
+    }
+
+    if (ShuffleVectorInst *pShuffle = dyn_cast<ShuffleVectorInst>(v))
+    {
+        // splat
+        for (uint32_t i = 0; i < numElems; ++i)
+        {
+            if (pShuffle->getMaskValue(i) != 0)
+            {
+                return false;
+            }
+        }
+        stride = 0;
+        return true;
+    }
+
+    if (BinaryOperator *pOp = dyn_cast<BinaryOperator>(v))
+    {
+        int64_t s0, s1;
+        if (!GetIndexStride(pOp->getOperand(0), s0) || !GetIndexStride(pOp->getOperand(1), s1))
+        {
+            return false;
+        }
+
+        // scale factors have to be constant splats
+        ConstantInt *pFactor0 = nullptr;
+        ConstantInt *pFactor1 = nullptr;
+        if (s0 == 0 && isa<Constant>(pOp->getOperand(0)))
+        {
+            pFactor0 = dyn_cast_or_null<ConstantInt>(cast<Constant>(pOp->getOperand(0))->getAggregateElement(0U));
+        }
+        if (s1 == 0 && isa<Constant>(pOp->getOperand(1)))
+        {
+            pFactor1 = dyn_cast_or_null<ConstantInt>(cast<Constant>(pOp->getOperand(1))->getAggregateElement(0U));
+        }
+
+        switch (pOp->getOpcode())
+        {
+        case Instruction::Add:
+            stride = s0 + s1;
+            return true;
+        case Instruction::Sub:
+            stride = s0 - s1;
+            return true;
+        case Instruction::Mul:
+            if (pFactor1)
+            {
+                stride = s0 * pFactor1->getSExtValue();
+                return true;
+            }
+            if (pFactor0)
+            {
+                stride = s1 * pFactor0->getSExtValue();
+                return true;
+            }
+            return false;
+        case Instruction::Shl:
+            if (pFactor1 == nullptr || pFactor1->getZExtValue() > 31)
+            {
+                return false;
+            }
+            stride = s0 << pFactor1->getZExtValue();
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Decide whether a gather should be lowered to masked loads plus
+/// a permute.  That's the case when the lanes are a small, dword aligned
+/// stride apart, as allowed by JitManager::mMaxGatherPermuteStride.
+/// @param vIndices - SIMD wide value of VB byte offsets
+/// @param scale - value to scale indices by
+/// @param dwordStride - (out) distance between lanes in dwords
+bool Builder::GatherStride(Value* vIndices, Value* scale, uint32_t &dwordStride)
+{
+    ConstantInt *pScale = dyn_cast<ConstantInt>(scale);
+    int64_t stride;
+
+    if (JM()->mMaxGatherPermuteStride == 0 || pScale == nullptr ||
+        !GetIndexStride(vIndices, stride))
+    {
+        return false;
+    }
+
+    stride *= pScale->getZExtValue();
+    if (stride <= 0 || (stride % 4) != 0 || stride / 4 > JM()->mMaxGatherPermuteStride)
+    {
+        return false;
+    }
+
+    dwordStride = (uint32_t)(stride / 4);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Emit a strided gather as SIMD wide masked loads of the spanned
+/// memory followed by shuffles that pick out every dwordStride'th dword.
+/// Only dwords belonging to active lanes are read, inactive lanes are 0.
+/// @param pBase - Int8* base VB address pointer value
+/// @param vIndices - SIMD wide value of VB byte offsets
+/// @param vMask - SIMD wide mask that controls whether to access memory
+/// @param scale - value to scale indices by
+/// @param dwordStride - distance between lanes in dwords, from GatherStride
+Value *Builder::GatherLoadPermute(Value* pBase, Value* vIndices, Value* vMask, Value* scale, uint32_t dwordStride)
+{
+    const uint32_t vWidth = JM()->mVWidth;
+    const uint32_t numChunks = dwordStride;
+
+    Value *vIntMask = BITCAST(vMask, mSimdInt32Ty);
+    Value *offset = MUL(VEXTRACT(vIndices, C(0)), Z_EXT(scale, mInt32Ty));
+    Value *vResult = VUNDEF_I();
+
+    for (uint32_t c = 0; c < numChunks; ++c)
+    {
+        // load mask: lane mask for the dwords that start an element, else 0
+        std::vector<Constant*> loadMask(vWidth);
+        std::vector<Constant*> permMask(vWidth);
+        for (uint32_t i = 0; i < vWidth; ++i)
+        {
+            uint32_t dword = c * vWidth + i;
+            loadMask[i] = C((dword % dwordStride) == 0 ? dword / dwordStride : vWidth);
+
+            // keep the lanes already filled by earlier chunks
+            uint32_t srcDword = i * dwordStride;
+            permMask[i] = C((srcDword / vWidth) == c ? vWidth + (srcDword % vWidth) : i);
+        }
+
+        Value *vChunkMask = VSHUFFLE(vIntMask, VIMMED1(0), ConstantVector::get(loadMask));
+        Value *pChunk = GEP(pBase, ADD(offset, C(c * vWidth * 4)));
+        Value *vChunk = MASKLOADD(pChunk, vChunkMask);
+
+        vResult = VSHUFFLE(vResult, vChunk, ConstantVector::get(permMask));
+    }
+
+    return vResult;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Generate a masked gather operation in LLVM IR.  If not  
 /// supported on the underlying platform, emulate it with loads
@@ -555,9 +729,15 @@ CallInst* Builder::PRINT(const std::string &printStr)
 Value *Builder::GATHERPS(Value* vSrc, Value* pBase, Value* vIndices, Value* vMask, Value* scale)
 {
     Value* vGather;
+    uint32_t dwordStride;
 
+    if (GatherStride(vIndices, scale, dwordStride))
+    {
+        vGather = GatherLoadPermute(pBase, vIndices, vMask, scale, dwordStride);
+        vGather = SELECT(MASK(vMask), BITCAST(vGather, mSimdFP32Ty), vSrc);
+    }
     // use avx2 gather instruction if available
-    if(JM()->mArch.AVX2())
+    else if(JM()->mUseHardwareGather)
     {
         // force mask to <N x float>, required by vgather
         vMask = BITCAST(vMask, mSimdFP32Ty);
@@ -607,9 +787,15 @@ Value *Builder::GATHERPS(Value* vSrc, Value* pBase, Value* vIndices, Value* vMas
 Value *Builder::GATHERDD(Value* vSrc, Value* pBase, Value* vIndices, Value* vMask, Value* scale)
 {
     Value* vGather;
+    uint32_t dwordStride;
 
+    if (GatherStride(vIndices, scale, dwordStride))
+    {
+        vGather = GatherLoadPermute(pBase, vIndices, vMask, scale, dwordStride);
+        vGather = SELECT(MASK(vMask), vGather, BITCAST(vSrc, mSimdInt32Ty));
+    }
     // use avx2 gather instruction if available
-    if(JM()->mArch.AVX2())
+    else if(JM()->mUseHardwareGather)
     {
         vGather = VGATHERDD(vSrc, pBase, vIndices, vMask, scale);
     }
@@ -98,6 +98,9 @@ Value *MASKLOADD(Value* src, Value* mask);
 void Gather4(const SWR_FORMAT format, Value* pSrcBase, Value* byteOffsets,
                       Value* mask, Value* vGatherComponents[], bool bPackedOutput);
 
+bool GatherStride(Value* indices, Value* scale, uint32_t &dwordStride);
+Value *GatherLoadPermute(Value* pBase, Value* indices, Value* mask, Value* scale, uint32_t dwordStride);
+
 Value *GATHERPS(Value* src, Value* pBase, Value* indices, Value* mask, Value* scale);
 void GATHER4PS(const SWR_FORMAT_INFO &info, Value* pSrcBase, Value* byteOffsets,
                Value* mask, Value* vGatherComponents[], bool bPackedOutput);
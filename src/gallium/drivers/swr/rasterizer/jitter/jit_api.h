@@ -33,6 +33,7 @@
 #include "fetch_jit.h"
 #include "streamout_jit.h"
 #include "blend_jit.h"
+#include "tile_jit.h"
 
 #if defined(_WIN32)
 #define EXCEPTION_PRINT_STACK(ret) ret
@@ -104,5 +105,25 @@ PFN_SO_FUNC JITCALL JitCompileStreamout(HANDLE hJitContext, const STREAMOUT_COMP
 /// @param state   - blend state to build function from
 PFN_BLEND_JIT_FUNC JITCALL JitCompileBlend(HANDLE hJitContext, const BLEND_COMPILE_STATE& state);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief JIT compiles fused output merger
+/// @param hJitContext - Jit Context
+/// @param state   - output merger state to build function from
+PFN_OUTPUT_MERGER_JIT_FUNC JITCALL JitCompileOutputMerger(HANDLE hJitContext, const OUTPUT_MERGER_COMPILE_STATE& state);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief JIT compiles store tile kernel
+/// @param hJitContext - Jit Context
+/// @param state   - format/tile mode/sample count to build function from
+/// @return nullptr if the format or tile mode isn't supported
+PFN_STORE_TILE_JIT_FUNC JITCALL JitCompileStoreTile(HANDLE hJitContext, const TILE_COMPILE_STATE& state);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief JIT compiles load tile kernel
+/// @param hJitContext - Jit Context
+/// @param state   - format/tile mode/sample count to build function from
+/// @return nullptr if the format or tile mode isn't supported
+PFN_LOAD_TILE_JIT_FUNC JITCALL JitCompileLoadTile(HANDLE hJitContext, const TILE_COMPILE_STATE& state);
+
 
 }; // extern "C"
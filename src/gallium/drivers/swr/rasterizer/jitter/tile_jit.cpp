@@ -0,0 +1,510 @@
+/****************************************************************************
+* Copyright (C) 2014-2015 Intel Corporation.   All Rights Reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice (including the next
+* paragraph) shall be included in all copies or substantial portions of the
+* Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* @file tile_jit.cpp
+*
+* @brief Implementation of the load/store tile jitter
+*
+* Notes:
+*
+******************************************************************************/
+#include "jit_api.h"
+#include "tile_jit.h"
+#include "builder.h"
+
+#include <sstream>
+
+// pixels of each row of a SIMD tile, in lane order
+static const uint32_t sRowLanes[2][4] = { { 0, 1, 4, 5 }, { 2, 3, 6, 7 } };
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns true if load/store tile kernels can be jitted for the state.
+static bool IsTileJitSupported(const TILE_COMPILE_STATE& state)
+{
+    // kernels assume a 4x2 SIMD tile layout in the hot tile
+    if (KNOB_SIMD_WIDTH != 8 || state.numSamples == 0)
+    {
+        return false;
+    }
+
+    if (state.tileMode != SWR_TILE_NONE &&
+        state.tileMode != SWR_TILE_MODE_XMAJOR &&
+        state.tileMode != SWR_TILE_MODE_YMAJOR)
+    {
+        return false;
+    }
+
+    const SWR_FORMAT_INFO& info = GetFormatInfo(state.format);
+    if (info.isSRGB || info.isBC || info.isSubsampled || info.isLuminance)
+    {
+        return false;
+    }
+
+    switch (info.bpp)
+    {
+    case 8: case 16: case 32: case 64: case 128:
+        break;
+    default:
+        return false;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t comp = 0; comp < info.numComps; ++comp)
+    {
+        uint32_t bpc = info.bpc[comp];
+        switch (info.type[comp])
+        {
+        case SWR_TYPE_UNUSED:
+        case SWR_TYPE_UINT:
+        case SWR_TYPE_SINT:
+            break;
+        case SWR_TYPE_UNORM:
+            if (bpc > 16) return false;
+            break;
+        case SWR_TYPE_SNORM:
+            if (bpc < 2 || bpc > 16) return false;
+            break;
+        case SWR_TYPE_FLOAT:
+            if (bpc != 10 && bpc != 11 && bpc != 16 && bpc != 32) return false;
+            break;
+        default:
+            return false;
+        }
+
+        // components may not straddle a dword
+        if (bpc == 0 || (offset / 32) != ((offset + bpc - 1) / 32))
+        {
+            return false;
+        }
+        offset += bpc;
+    }
+
+    return offset == info.bpp;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// Interface to Jitting load/store tile kernels
+//////////////////////////////////////////////////////////////////////////
+struct TileJit : public Builder
+{
+    TileJit(JitManager* pJitMgr) : Builder(pJitMgr){};
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Byte offset of a row chunk from the upper left pixel of the
+    ///        raster tile. Chunks never cross a 16 byte Y-major column.
+    Value* ChunkOffset(const TILE_COMPILE_STATE& state, uint32_t xBytes, uint32_t y, Value* pitch)
+    {
+        switch (state.tileMode)
+        {
+        case SWR_TILE_MODE_XMAJOR:
+            // 512B x 8 row tiles
+            return C(y * 512 + xBytes);
+        case SWR_TILE_MODE_YMAJOR:
+            // 128B x 32 row tiles of 16B wide columns
+            return C((xBytes / 16) * 512 + y * 16 + (xBytes % 16));
+        default:
+            return ADD(MUL(C(y), pitch), C(xBytes));
+        }
+    }
+
+    Value* SignExtend(Value* vBits, uint32_t bpc)
+    {
+        if (bpc == 32)
+        {
+            return vBits;
+        }
+        return ASHR(SHL(vBits, VIMMED1(32 - bpc)), VIMMED1(32 - bpc));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Converts a hot tile channel to the raw bits of a component.
+    ///        Matches ConvertPixelFromFloat.
+    Value* PackComponent(SWR_TYPE type, uint32_t bpc, Value* vSrc)
+    {
+        switch (type)
+        {
+        case SWR_TYPE_UNORM:
+        case SWR_TYPE_SNORM:
+        {
+            bool isSigned = (type == SWR_TYPE_SNORM);
+
+            // NaN -> 0, then clamp to the normalized range
+            vSrc = SELECT(FCMP_UNO(vSrc, vSrc), VIMMED1(0.0f), vSrc);
+            vSrc = FCLAMP(vSrc, isSigned ? -1.0f : 0.0f, 1.0f);
+
+            uint32_t maxVal = isSigned ? ((1 << (bpc - 1)) - 1) : ((1 << bpc) - 1);
+            vSrc = FMUL(vSrc, VIMMED1((float)maxVal));
+
+            // round half away from zero
+            Value* vHalf = VIMMED1(0.5f);
+            if (isSigned)
+            {
+                vHalf = SELECT(FCMP_OLT(vSrc, VIMMED1(0.0f)), VIMMED1(-0.5f), vHalf);
+            }
+            return FP_TO_SI(FADD(vSrc, vHalf), mSimdInt32Ty);
+        }
+        case SWR_TYPE_UINT:
+        {
+            Value* vBits = BITCAST(vSrc, mSimdInt32Ty);
+            if (bpc < 32)
+            {
+                Value* vMax = VIMMED1((uint32_t)((1U << bpc) - 1));
+                vBits = SELECT(ICMP_UGT(vBits, vMax), vMax, vBits);
+            }
+            return vBits;
+        }
+        case SWR_TYPE_SINT:
+        {
+            Value* vBits = BITCAST(vSrc, mSimdInt32Ty);
+            if (bpc < 32)
+            {
+                int maxVal = (1 << (bpc - 1)) - 1;
+                vBits = ICLAMP(vBits, VIMMED1(-maxVal - 1), VIMMED1(maxVal));
+            }
+            return vBits;
+        }
+        case SWR_TYPE_FLOAT:
+        {
+            if (bpc == 32)
+            {
+                return BITCAST(vSrc, mSimdInt32Ty);
+            }
+
+            // 11 and 10 bit floats are half floats without sign and low mantissa bits
+            if (bpc < 16)
+            {
+                vSrc = VMAXPS(vSrc, VIMMED1(0.0f));
+            }
+            Value* vHalf = Z_EXT(CVTPS2PH(vSrc, C(_MM_FROUND_TRUNC)), mSimdInt32Ty);
+            return (bpc == 16) ? vHalf : LSHR(vHalf, VIMMED1(15 - bpc));
+        }
+        default:
+            SWR_ASSERT(false, "Unsupported component type");
+            return VIMMED1(0);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Converts the raw bits of a component to a hot tile channel.
+    ///        Matches ConvertPixelToFloat.
+    Value* UnpackComponent(SWR_TYPE type, uint32_t bpc, Value* vBits)
+    {
+        switch (type)
+        {
+        case SWR_TYPE_UNORM:
+            return FMUL(UI_TO_FP(vBits, mSimdFP32Ty), VIMMED1(1.0f / (float)((1 << bpc) - 1)));
+        case SWR_TYPE_SNORM:
+        {
+            Value* vResult = SI_TO_FP(SignExtend(vBits, bpc), mSimdFP32Ty);
+            vResult = FMUL(vResult, VIMMED1(1.0f / (float)((1 << (bpc - 1)) - 1)));
+
+            // most negative value maps to -1.0
+            return VMAXPS(vResult, VIMMED1(-1.0f));
+        }
+        case SWR_TYPE_UINT:
+            return BITCAST(vBits, mSimdFP32Ty);
+        case SWR_TYPE_SINT:
+            return BITCAST(SignExtend(vBits, bpc), mSimdFP32Ty);
+        case SWR_TYPE_FLOAT:
+            if (bpc == 32)
+            {
+                return BITCAST(vBits, mSimdFP32Ty);
+            }
+            if (bpc < 16)
+            {
+                vBits = SHL(vBits, VIMMED1(15 - bpc));
+            }
+            return CVTPH2PS(TRUNC(vBits, mSimdInt16Ty));
+        default:
+            SWR_ASSERT(false, "Unsupported component type");
+            return VIMMED1(0.0f);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Converts and stores one SIMD tile of the hot tile.
+    /// @param pSimdTile - SIMD tile in the hot tile, as <simd float>*
+    /// @param pDst - upper left pixel of the raster tile in the surface
+    /// @param x, y - pixel offset of the SIMD tile in the raster tile
+    void StoreSimdTile(const TILE_COMPILE_STATE& state, Value* pSimdTile, Value* pDst, Value* pitch, uint32_t x, uint32_t y)
+    {
+        const SWR_FORMAT_INFO& info = GetFormatInfo(state.format);
+        const uint32_t dwordsPerPixel = std::max(info.Bpp / 4, 1U);
+        const uint32_t pixelsPerChunk = 4 / dwordsPerPixel;
+
+        // pack all components of each pixel into dwords
+        Value* vDwords[4] = { VIMMED1(0), VIMMED1(0), VIMMED1(0), VIMMED1(0) };
+        uint32_t offset = 0;
+        for (uint32_t comp = 0; comp < info.numComps; ++comp)
+        {
+            uint32_t bpc = info.bpc[comp];
+            if (info.type[comp] != SWR_TYPE_UNUSED)
+            {
+                Value* vBits = PackComponent(info.type[comp], bpc, LOAD(pSimdTile, { info.swizzle[comp] }));
+                if (bpc < 32)
+                {
+                    vBits = AND(vBits, VIMMED1((uint32_t)((1U << bpc) - 1)));
+                }
+                if (offset % 32)
+                {
+                    vBits = SHL(vBits, VIMMED1(offset % 32));
+                }
+                vDwords[offset / 32] = OR(vDwords[offset / 32], vBits);
+            }
+            offset += bpc;
+        }
+
+        // write out each row in chunks of up to 16 bytes
+        for (uint32_t row = 0; row < 2; ++row)
+        {
+            for (uint32_t chunk = 0; chunk < 4 / pixelsPerChunk; ++chunk)
+            {
+                Value* vChunk = VUNDEF(mInt32Ty, 4);
+                for (uint32_t e = 0; e < 4; ++e)
+                {
+                    uint32_t pixel = chunk * pixelsPerChunk + e / dwordsPerPixel;
+                    vChunk = VINSERT(vChunk, VEXTRACT(vDwords[e % dwordsPerPixel], C(sRowLanes[row][pixel])), C(e));
+                }
+
+                if (info.Bpp < 4)
+                {
+                    vChunk = TRUNC(vChunk, VectorType::get(IntegerType::get(JM()->mContext, info.bpp), 4));
+                }
+
+                uint32_t xBytes = (x + chunk * pixelsPerChunk) * info.Bpp;
+                Value* pChunk = GEP(pDst, ChunkOffset(state, xBytes, y + row, pitch));
+                ALIGNED_STORE(vChunk, BITCAST(pChunk, PointerType::get(vChunk->getType(), 0)), 1);
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Loads and converts one SIMD tile into the hot tile.
+    /// @param pSimdTile - SIMD tile in the hot tile, as <simd float>*
+    /// @param pSrc - upper left pixel of the raster tile in the surface
+    /// @param x, y - pixel offset of the SIMD tile in the raster tile
+    void LoadSimdTile(const TILE_COMPILE_STATE& state, Value* pSimdTile, Value* pSrc, Value* pitch, uint32_t x, uint32_t y)
+    {
+        const SWR_FORMAT_INFO& info = GetFormatInfo(state.format);
+        const uint32_t dwordsPerPixel = std::max(info.Bpp / 4, 1U);
+        const uint32_t pixelsPerChunk = 4 / dwordsPerPixel;
+
+        Type* chunkTy = VectorType::get(info.Bpp < 4 ? IntegerType::get(JM()->mContext, info.bpp) : mInt32Ty, 4);
+
+        // gather the dwords of each pixel from the rows
+        Value* vDwords[4] = { VUNDEF_I(), VUNDEF_I(), VUNDEF_I(), VUNDEF_I() };
+        for (uint32_t row = 0; row < 2; ++row)
+        {
+            for (uint32_t chunk = 0; chunk < 4 / pixelsPerChunk; ++chunk)
+            {
+                uint32_t xBytes = (x + chunk * pixelsPerChunk) * info.Bpp;
+                Value* pChunk = GEP(pSrc, ChunkOffset(state, xBytes, y + row, pitch));
+                Value* vChunk = ALIGNED_LOAD(BITCAST(pChunk, PointerType::get(chunkTy, 0)), 1);
+
+                if (info.Bpp < 4)
+                {
+                    vChunk = Z_EXT(vChunk, VectorType::get(mInt32Ty, 4));
+                }
+
+                for (uint32_t e = 0; e < 4; ++e)
+                {
+                    uint32_t pixel = chunk * pixelsPerChunk + e / dwordsPerPixel;
+                    vDwords[e % dwordsPerPixel] = VINSERT(vDwords[e % dwordsPerPixel], VEXTRACT(vChunk, C(e)), C(sRowLanes[row][pixel]));
+                }
+            }
+        }
+
+        // apply format defaults, then unpack the components
+        Value* vChannels[4];
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            vChannels[c] = BITCAST(VIMMED1(info.defaults[c]), mSimdFP32Ty);
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t comp = 0; comp < info.numComps; ++comp)
+        {
+            uint32_t bpc = info.bpc[comp];
+            if (info.type[comp] != SWR_TYPE_UNUSED)
+            {
+                Value* vBits = vDwords[offset / 32];
+                if (offset % 32)
+                {
+                    vBits = LSHR(vBits, VIMMED1(offset % 32));
+                }
+                if (bpc < 32)
+                {
+                    vBits = AND(vBits, VIMMED1((uint32_t)((1U << bpc) - 1)));
+                }
+                vChannels[info.swizzle[comp]] = UnpackComponent(info.type[comp], bpc, vBits);
+            }
+            offset += bpc;
+        }
+
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            STORE(vChannels[c], pSimdTile, { c });
+        }
+    }
+
+    Function* Create(const TILE_COMPILE_STATE& state, bool isStore)
+    {
+        static std::size_t tileNum = 0;
+
+        std::stringstream fnName(isStore ? "StoreTile" : "LoadTile", std::ios_base::in | std::ios_base::out | std::ios_base::ate);
+        fnName << tileNum++;
+
+        // typedef void(__cdecl *PFN_STORE_TILE_JIT_FUNC)(const uint8_t* pSrcHotTile, uint8_t** ppDst, uint32_t pitch);
+        // typedef void(__cdecl *PFN_LOAD_TILE_JIT_FUNC)(uint8_t* pDstHotTile, uint8_t** ppSrc, uint32_t pitch);
+        std::vector<Type*> args{
+            PointerType::get(mInt8Ty, 0),                       // pHotTile
+            PointerType::get(PointerType::get(mInt8Ty, 0), 0),  // ppSurface, one per sample
+            mInt32Ty,                                           // pitch
+        };
+
+        FunctionType* fTy = FunctionType::get(IRB()->getVoidTy(), args, false);
+        Function* tileFunc = Function::Create(fTy, GlobalValue::ExternalLinkage, fnName.str(), JM()->mpCurrentModule);
+
+        BasicBlock* entry = BasicBlock::Create(JM()->mContext, "entry", tileFunc);
+
+        IRB()->SetInsertPoint(entry);
+
+        // arguments
+        auto argitr = tileFunc->getArgumentList().begin();
+        Value* pHotTile = &*argitr++;
+        pHotTile->setName("pHotTile");
+        Value* ppSurface = &*argitr++;
+        ppSurface->setName("ppSurface");
+        Value* pitch = &*argitr++;
+        pitch->setName("pitch");
+
+        const uint32_t hotTileBpp = GetFormatInfo(KNOB_COLOR_HOT_TILE_FORMAT).Bpp;
+        const uint32_t simdTilesPerRow = KNOB_TILE_X_DIM / SIMD_TILE_X_DIM;
+
+        // samples are stored back to back for each raster tile in the hot tile
+        for (uint32_t sample = 0; sample < state.numSamples; ++sample)
+        {
+            Value* pSurface = LOAD(ppSurface, { sample });
+            Value* pSampleTile = GEP(pHotTile, C(sample * KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * hotTileBpp));
+
+            for (uint32_t simdTile = 0; simdTile < (KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM) / KNOB_SIMD_WIDTH; ++simdTile)
+            {
+                Value* pSimdTile = GEP(pSampleTile, C(simdTile * KNOB_SIMD_WIDTH * hotTileBpp));
+                pSimdTile = BITCAST(pSimdTile, PointerType::get(mSimdFP32Ty, 0));
+
+                uint32_t x = (simdTile % simdTilesPerRow) * SIMD_TILE_X_DIM;
+                uint32_t y = (simdTile / simdTilesPerRow) * SIMD_TILE_Y_DIM;
+                if (isStore)
+                {
+                    StoreSimdTile(state, pSimdTile, pSurface, pitch, x, y);
+                }
+                else
+                {
+                    LoadSimdTile(state, pSimdTile, pSurface, pitch, x, y);
+                }
+            }
+        }
+
+        RET_VOID();
+
+        JitManager::DumpToFile(tileFunc, "");
+
+        FunctionPassManager passes(JM()->mpCurrentModule);
+        passes.add(createBreakCriticalEdgesPass());
+        passes.add(createCFGSimplificationPass());
+        passes.add(createEarlyCSEPass());
+        passes.add(createPromoteMemoryToRegisterPass());
+        passes.add(createCFGSimplificationPass());
+        passes.add(createEarlyCSEPass());
+        passes.add(createInstructionCombiningPass());
+        passes.add(createInstructionSimplifierPass());
+        passes.add(createConstantPropagationPass());
+        passes.add(createSCCPPass());
+        passes.add(createAggressiveDCEPass());
+
+        passes.run(*tileFunc);
+
+        JitManager::DumpToFile(tileFunc, "optimized");
+
+        return tileFunc;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief JITs from load/store tile IR
+/// @param hJitMgr - JitManager handle
+/// @param func   - LLVM function IR
+/// @return pointer to the jitted kernel
+static void* JitTileFunc(HANDLE hJitMgr, const HANDLE hFunc)
+{
+    const llvm::Function *func = (const llvm::Function*)hFunc;
+    JitManager* pJitMgr = reinterpret_cast<JitManager*>(hJitMgr);
+    void* pfnTile = (void*)(pJitMgr->mpExec->getFunctionAddress(func->getName().str()));
+    // MCJIT finalizes modules the first time you JIT code from them. After finalized, you cannot add new IR to the module
+    pJitMgr->mIsModuleFinalized = true;
+
+    return pfnTile;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief JIT compiles store tile kernel
+/// @param hJitMgr - JitManager handle
+/// @param state   - format/tile mode/sample count to build function from
+/// @return nullptr if the format or tile mode isn't supported
+extern "C" PFN_STORE_TILE_JIT_FUNC JITCALL JitCompileStoreTile(HANDLE hJitMgr, const TILE_COMPILE_STATE& state)
+{
+    if (!IsTileJitSupported(state))
+    {
+        return nullptr;
+    }
+
+    JitManager* pJitMgr = reinterpret_cast<JitManager*>(hJitMgr);
+
+    pJitMgr->SetupNewModule();
+
+    TileJit theJit(pJitMgr);
+    HANDLE hFunc = theJit.Create(state, true);
+
+    return (PFN_STORE_TILE_JIT_FUNC)JitTileFunc(hJitMgr, hFunc);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief JIT compiles load tile kernel
+/// @param hJitMgr - JitManager handle
+/// @param state   - format/tile mode/sample count to build function from
+/// @return nullptr if the format or tile mode isn't supported
+extern "C" PFN_LOAD_TILE_JIT_FUNC JITCALL JitCompileLoadTile(HANDLE hJitMgr, const TILE_COMPILE_STATE& state)
+{
+    if (!IsTileJitSupported(state))
+    {
+        return nullptr;
+    }
+
+    JitManager* pJitMgr = reinterpret_cast<JitManager*>(hJitMgr);
+
+    pJitMgr->SetupNewModule();
+
+    TileJit theJit(pJitMgr);
+    HANDLE hFunc = theJit.Create(state, false);
+
+    return (PFN_LOAD_TILE_JIT_FUNC)JitTileFunc(hJitMgr, hFunc);
+}
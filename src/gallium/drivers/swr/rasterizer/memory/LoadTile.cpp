@@ -274,6 +274,45 @@ void LoadHotTile(
     BUCKETS_STOP(sBuckets[pSrcSurface->format]);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Loads a full color hottile from a render surface with a jitted
+///        load tile kernel.
+/// @param pfnLoadTile - Kernel compiled for the surface format, tile mode
+///                      and sample count.
+/// @param x, y - Coordinates to macro tile.
+/// @param pDstHotTile - Pointer to Hot Tile
+/// @return false if the macro tile has to go through LoadHotTile instead
+bool LoadHotTileJit(
+    PFN_LOAD_TILE_JIT_FUNC pfnLoadTile,
+    SWR_SURFACE_STATE *pSrcSurface,
+    uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex,
+    uint8_t *pDstHotTile)
+{
+    // force 0 if requested renderTargetArrayIndex is OOB
+    if (renderTargetArrayIndex >= pSrcSurface->depth)
+    {
+        renderTargetArrayIndex = 0;
+    }
+
+    if (pfnLoadTile == nullptr || !CanUseJitTiles(x, y, renderTargetArrayIndex, pSrcSurface))
+    {
+        return false;
+    }
+
+    uint8_t* pSrc[SWR_MAX_NUM_MULTISAMPLES];
+    for (uint32_t row = 0; row < KNOB_MACROTILE_Y_DIM; row += KNOB_TILE_Y_DIM)
+    {
+        for (uint32_t col = 0; col < KNOB_MACROTILE_X_DIM; col += KNOB_TILE_X_DIM)
+        {
+            ComputeRasterTileAddresses(x + col, y + row, renderTargetArrayIndex, pSrcSurface, pSrc);
+            pfnLoadTile(pDstHotTile, pSrc, pSrcSurface->pitch);
+            pDstHotTile += KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp / 8) * pSrcSurface->numSamples;
+        }
+    }
+
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// INIT_LOAD_TILES_TABLE - Helper macro for setting up the tables.
 #define INIT_LOAD_TILES_COLOR_TABLE(tilemode) \
@@ -1563,6 +1563,137 @@ void StoreHotTile(
     BUCKETS_STOP(sBuckets[pDstSurface->format]);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Stores a full color hottile to a render surface with a jitted
+///        store tile kernel.
+/// @param pfnStoreTile - Kernel compiled for the surface format, tile mode
+///                       and sample count.
+/// @param x, y - Coordinates to macro tile.
+/// @param pSrcHotTile - Pointer to Hot Tile
+/// @return false if the macro tile has to go through StoreHotTile instead
+bool StoreHotTileJit(
+    PFN_STORE_TILE_JIT_FUNC pfnStoreTile,
+    SWR_SURFACE_STATE *pDstSurface,
+    uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex,
+    uint8_t *pSrcHotTile)
+{
+    // force 0 if requested renderTargetArrayIndex is OOB
+    if (renderTargetArrayIndex >= pDstSurface->depth)
+    {
+        renderTargetArrayIndex = 0;
+    }
+
+    if (pfnStoreTile == nullptr || KNOB_USE_GENERIC_STORETILE ||
+        !CanUseJitTiles(x, y, renderTargetArrayIndex, pDstSurface))
+    {
+        return false;
+    }
+
+    uint8_t* pDst[SWR_MAX_NUM_MULTISAMPLES];
+    for (uint32_t row = 0; row < KNOB_MACROTILE_Y_DIM; row += KNOB_TILE_Y_DIM)
+    {
+        for (uint32_t col = 0; col < KNOB_MACROTILE_X_DIM; col += KNOB_TILE_X_DIM)
+        {
+            ComputeRasterTileAddresses(x + col, y + row, renderTargetArrayIndex, pDstSurface, pDst);
+            pfnStoreTile(pSrcHotTile, pDst, pDstSurface->pitch);
+            pSrcHotTile += KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp / 8) * pDstSurface->numSamples;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Converts sRGB encoded color components back to linear.
+static INLINE simdscalar ConvertSRGBToFloat(simdscalar vComp)
+{
+    OSALIGNSIMD(float) comp[KNOB_SIMD_WIDTH];
+    _simd_store_ps(comp, vComp);
+    for (uint32_t lane = 0; lane < KNOB_SIMD_WIDTH; ++lane)
+    {
+        float c = comp[lane];
+        comp[lane] = (c <= 0.04045f) ? (c / 12.92f) : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+    return _simd_load_ps(comp);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Averages the samples of a multisampled color hottile and stores
+///        the result to a single sample render surface, while the hottile
+///        is still in cache.
+/// @param pDstSurface - Single sample surface receiving the resolve.
+/// @param srcFormat - Format for hot tile.
+/// @param x, y - Coordinates to macro tile.
+/// @param pSrcHotTile - Pointer to Hot Tile
+/// @param numSamples - Number of samples in the hot tile.
+void StoreHotTileResolve(
+    SWR_SURFACE_STATE *pDstSurface,
+    SWR_FORMAT srcFormat,
+    SWR_RENDERTARGET_ATTACHMENT renderTargetIndex,
+    uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex,
+    uint8_t *pSrcHotTile,
+    uint32_t numSamples)
+{
+    static const uint32_t SAMPLE_TILE_BYTES = KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * (FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp / 8);
+    static const uint32_t NUM_RASTER_TILES = (KNOB_MACROTILE_X_DIM / KNOB_TILE_X_DIM) * (KNOB_MACROTILE_Y_DIM / KNOB_TILE_Y_DIM);
+
+    SWR_ASSERT(renderTargetIndex <= SWR_ATTACHMENT_COLOR7);
+    SWR_ASSERT(srcFormat == KNOB_COLOR_HOT_TILE_FORMAT);
+    SWR_ASSERT(pDstSurface->numSamples == 1);
+
+    if (pDstSurface->type == SURFACE_NULL)
+    {
+        return;
+    }
+
+    // Hot tiles hold linear color, so a plain box filter is already sRGB correct.
+    // Otherwise average the encoded values of the RGB components.  Integer
+    // formats can't be averaged and resolve to sample 0.
+    const SWR_FORMAT_INFO &info = GetFormatInfo(pDstSurface->format);
+    const bool bEncoded = !KNOB_MSAA_RESOLVE_SRGB_LINEAR && info.isSRGB;
+    const bool bInteger = (info.type[0] == SWR_TYPE_UINT) || (info.type[0] == SWR_TYPE_SINT);
+    const uint32_t numAveraged = bInteger ? 1 : numSamples;
+    const simdscalar vInvSamples = _simd_set1_ps(1.0f / numAveraged);
+
+    // Each raster tile holds its samples back to back, as SOA SIMD tiles of
+    // 4 components.  Resolve one raster tile at a time.
+    OSALIGNSIMD(uint8_t) resolved[SAMPLE_TILE_BYTES * NUM_RASTER_TILES];
+    const uint8_t *pSrc = pSrcHotTile;
+    uint8_t *pDst = resolved;
+    for (uint32_t tile = 0; tile < NUM_RASTER_TILES; ++tile)
+    {
+        for (uint32_t v = 0; v < SAMPLE_TILE_BYTES / sizeof(simdscalar); ++v)
+        {
+            const bool bConvert = bEncoded && ((v % 4) < 3);
+            const float *pSample = (const float*)pSrc + v * KNOB_SIMD_WIDTH;
+
+            simdscalar vSum = _simd_setzero_ps();
+            for (uint32_t sample = 0; sample < numAveraged; ++sample)
+            {
+                simdscalar vComp = _simd_load_ps(pSample);
+                if (bConvert)
+                {
+                    vComp = FormatTraits<R32G32B32A32_FLOAT>::convertSrgb(v % 4, vComp);
+                }
+                vSum = _simd_add_ps(vSum, vComp);
+                pSample += SAMPLE_TILE_BYTES / sizeof(float);
+            }
+
+            vSum = _simd_mul_ps(vSum, vInvSamples);
+            if (bConvert)
+            {
+                vSum = ConvertSRGBToFloat(vSum);
+            }
+            _simd_store_ps((float*)pDst + v * KNOB_SIMD_WIDTH, vSum);
+        }
+
+        pSrc += SAMPLE_TILE_BYTES * numSamples;
+        pDst += SAMPLE_TILE_BYTES;
+    }
+
+    StoreHotTile(pDstSurface, srcFormat, renderTargetIndex, x, y, renderTargetArrayIndex, resolved);
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// InitStoreTilesTable - Helper for setting up the tables.
 template <SWR_TILE_MODE TileModeT, size_t NumTileModesT, size_t ArraySizeT>
@@ -579,3 +579,58 @@ void* ComputeSurfaceAddress(uint32_t x, uint32_t y, uint32_t z, uint32_t array,
 {
     return pState->pBaseAddress + ComputeSurfaceOffset<UseCachedOffsets>(x, y, z, array, sampleNum, lod, pState);
 }
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns true if jitted load/store tile kernels can address the
+///        macro tile: it must be fully inside the lod, samples must not be
+///        interleaved and tiled lods must start on a page boundary.
+/// @param x, y - macro tile location in pixels
+/// @param pState - pointer to the surface state
+INLINE
+bool CanUseJitTiles(uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex, const SWR_SURFACE_STATE *pState)
+{
+    if (pState->type == SURFACE_NULL || pState->bInterleavedSamples)
+    {
+        return false;
+    }
+
+    uint32_t lodWidth = std::max(pState->width >> pState->lod, 1U);
+    uint32_t lodHeight = std::max(pState->height >> pState->lod, 1U);
+    if ((x + KNOB_MACROTILE_X_DIM > lodWidth) || (y + KNOB_MACROTILE_Y_DIM > lodHeight))
+    {
+        return false;
+    }
+
+    if (pState->tileMode != SWR_TILE_NONE)
+    {
+        for (uint32_t sampleNum = 0; sampleNum < pState->numSamples; sampleNum++)
+        {
+            size_t lodAddress = (size_t)ComputeSurfaceAddress<false>(0, 0, pState->arrayIndex + renderTargetArrayIndex,
+                                                                      pState->arrayIndex + renderTargetArrayIndex,
+                                                                      sampleNum, pState->lod, pState);
+            if (lodAddress & 0xfff)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Computes the address of a raster tile for each sample, as passed
+///        to jitted load/store tile kernels.
+/// @param x, y - raster tile location in pixels
+/// @param pState - pointer to the surface state
+/// @param ppAddress - receives one address per sample
+INLINE
+void ComputeRasterTileAddresses(uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex, const SWR_SURFACE_STATE *pState, uint8_t** ppAddress)
+{
+    for (uint32_t sampleNum = 0; sampleNum < pState->numSamples; sampleNum++)
+    {
+        ppAddress[sampleNum] = (uint8_t*)ComputeSurfaceAddress<false>(x, y, pState->arrayIndex + renderTargetArrayIndex,
+                                                                      pState->arrayIndex + renderTargetArrayIndex,
+                                                                      sampleNum, pState->lod, pState);
+    }
+}
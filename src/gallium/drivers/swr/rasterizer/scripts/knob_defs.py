@@ -55,6 +55,56 @@ KNOBS = [
                        'defer clear execution to first backend op on hottile, or hottile store'],
     }],
 
+    ['JIT_OUTPUT_MERGER', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Use a single jitted kernel per depth/stencil, blend and render target',
+                       'format combination for late depth/stencil test, alpha test, blend,',
+                       'color write mask and hot tile store in the single sample backend.'],
+    }],
+
+    ['JIT_PIXEL_TILE_KERNEL', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Compile pixel shaders as kernels that loop over a whole raster tile,',
+                       'inlining barycentric evaluation, coverage and early-Z and calling',
+                       'the fused output merger per SIMD quad. Requires JIT_OUTPUT_MERGER.'],
+    }],
+
+    ['JIT_LOAD_STORE_TILES', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Use jitted load/store tile kernels, compiled per surface format, tile mode',
+                       'and sample count, for full color macro tiles.'],
+    }],
+
+    ['MSAA_RESOLVE_SRGB_LINEAR', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Average the samples of sRGB render targets in linear space when a',
+                       'multisampled hot tile is resolved on store.  When disabled, samples',
+                       'are averaged after sRGB encoding, like most hardware resolves.'],
+    }],
+
+    ['FS_SPECIALIZE_FRAMES', {
+        'type'      : 'uint32_t',
+        'default'   : '0',
+        'desc'      : ['Frames the fragment shader constant buffers must stay unchanged before',
+                       'a variant with the constants folded in is compiled in the background.',
+                       'The regular variant is used again as soon as the values change.',
+                       'Does not apply to raster tile kernels.  0 == disabled'],
+    }],
+
+    ['GATHER_STRATEGY', {
+        'type'      : 'uint32_t',
+        'default'   : '0',
+        'desc'      : ['How jitted gathers are emitted.',
+                       '  0 == Choose per CPU model and access pattern',
+                       '  1 == Always use hardware gather when available',
+                       '  2 == Use load/permute for detected strides, hardware gather otherwise',
+                       '  3 == Always use scalar loads'],
+    }],
+
     ['MAX_NUMA_NODES', {
         'type'      : 'uint32_t',
         'default'   : '0',
@@ -128,6 +178,15 @@ KNOBS = [
                        'Should be a multiple of (3 * vectorWidth).'],
     }],
 
+    ['MAX_DRAWS_PER_BATCH', {
+       'type'       : 'uint32_t',
+       'default'    : '64',
+       'desc'       : ['Maximum number of consecutive small draws with unchanged state',
+                       'appended to a single draw context and run as a multi-draw.',
+                       'Batched draws total at most MAX_PRIMS_PER_DRAW vertices.',
+                       '0 or 1 == disabled'],
+    }],
+
     ['MAX_TESS_PRIMS_PER_DRAW', {
        'type'       : 'uint32_t',
        'default'    : '16',
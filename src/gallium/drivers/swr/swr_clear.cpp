@@ -22,6 +22,8 @@
  ***************************************************************************/
 
 #include "swr_context.h"
+#include "swr_resource.h"
+#include "swr_fence.h"
 #include "swr_query.h"
 
 static void
@@ -36,12 +38,15 @@ swr_clear(struct pipe_context *pipe,
 
    UINT clearMask = 0;
 
-   if (!swr_check_render_cond(pipe))
-      return;
+   /* The render condition is applied by the core */
 
+   unsigned dirty = ctx->dirty;
    if (ctx->dirty)
       swr_update_derived(pipe);
 
+   if (dirty || ctx->status_seq != swr_fence_next(ctx->fence))
+      swr_update_resource_status(pipe, NULL);
+
 /* Update clearMask/targetMask */
 #if 0 /* XXX SWR currently only clears SWR_ATTACHMENT_COLOR0, don't bother   \
          checking others yet. */
@@ -0,0 +1,247 @@
+/****************************************************************************
+ * Copyright (C) 2016 Intel Corporation.   All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ ***************************************************************************/
+
+#include "util/u_memory.h"
+#include "util/u_inlines.h"
+
+#include "swr_screen.h"
+#include "swr_context.h"
+#include "swr_state.h"
+#include "swr_resource.h"
+#include "swr_fence.h"
+#include "swr_scratch.h"
+
+static void *
+swr_create_compute_state(struct pipe_context *pipe,
+                         const struct pipe_compute_state *cs)
+{
+   struct swr_compute_shader *swr_cs = new swr_compute_shader;
+   if (!swr_cs)
+      return NULL;
+
+   /* st/mesa hands over TGSI */
+   swr_cs->pipe.tokens = tgsi_dup_tokens((const struct tgsi_token *)cs->prog);
+   swr_cs->req_local_mem = cs->req_local_mem;
+
+   lp_build_tgsi_info(swr_cs->pipe.tokens, &swr_cs->info);
+
+   return swr_cs;
+}
+
+static void
+swr_bind_compute_state(struct pipe_context *pipe, void *cs)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   ctx->cs = (swr_compute_shader *)cs;
+}
+
+static void
+swr_delete_compute_state(struct pipe_context *pipe, void *cs)
+{
+   struct swr_compute_shader *swr_cs = (swr_compute_shader *)cs;
+
+   FREE((void *)swr_cs->pipe.tokens);
+   delete swr_cs;
+}
+
+static void
+swr_set_shader_buffers(struct pipe_context *pipe,
+                       unsigned shader,
+                       unsigned start,
+                       unsigned num,
+                       struct pipe_shader_buffer *buffers)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   assert(shader < PIPE_SHADER_TYPES);
+   assert(start + num <= Elements(ctx->shader_buffers[shader]));
+
+   for (unsigned i = 0; i < num; i++) {
+      struct pipe_shader_buffer *dst = &ctx->shader_buffers[shader][start + i];
+
+      if (buffers) {
+         pipe_resource_reference(&dst->buffer, buffers[i].buffer);
+         dst->buffer_offset = buffers[i].buffer_offset;
+         dst->buffer_size = buffers[i].buffer_size;
+      } else {
+         pipe_resource_reference(&dst->buffer, NULL);
+         dst->buffer_offset = 0;
+         dst->buffer_size = 0;
+      }
+   }
+}
+
+static void
+swr_memory_barrier(struct pipe_context *pipe, unsigned flags)
+{
+   /* Draws after a dispatch wait for it in the core, and the other way
+    * around dispatches only start once earlier draws are done */
+}
+
+/*
+ * Look up a compute shader variant, compiling it on first use.
+ */
+static PFN_CS_FUNC
+swr_get_cs_variant(struct swr_context *ctx, swr_jit_cs_key &key)
+{
+   auto search = ctx->cs->map.find(key);
+   if (search != ctx->cs->map.end())
+      return search->second;
+
+   PFN_CS_FUNC func = swr_compile_cs(ctx, key);
+   ctx->cs->map.insert(std::make_pair(key, func));
+   return func;
+}
+
+/*
+ * Update the compute state of the draw context and mark the resources the
+ * dispatch uses.
+ */
+static void
+swr_update_compute(struct swr_context *ctx, const swr_jit_cs_key &key)
+{
+   struct pipe_context *pipe = &ctx->pipe;
+   swr_draw_context *pDC = &ctx->swrDC;
+
+   /* The dispatch is retired by the next sync submitted on the context
+    * fence */
+   uint64_t seq = swr_fence_next(ctx->fence);
+
+   swr_update_jit_constants(ctx, PIPE_SHADER_COMPUTE, pDC->constantCS,
+                            pDC->num_constantsCS,
+                            &ctx->scratch->cs_constants);
+   swr_update_jit_samplers(ctx, PIPE_SHADER_COMPUTE, key.nr_samplers,
+                           pDC->samplersCS);
+   swr_update_jit_textures(ctx, PIPE_SHADER_COMPUTE, key.nr_sampler_views,
+                           pDC->texturesCS);
+
+   for (unsigned i = 0; i < PIPE_MAX_SHADER_BUFFERS; i++) {
+      struct pipe_shader_buffer *sb =
+         &ctx->shader_buffers[PIPE_SHADER_COMPUTE][i];
+
+      if (sb->buffer) {
+         pDC->buffersCS[i] =
+            (uint8_t *)swr_resource_data(sb->buffer) + sb->buffer_offset;
+         pDC->num_buffersCS[i] = sb->buffer_size;
+         swr_resource_write(pipe, swr_resource(sb->buffer), seq);
+      } else {
+         pDC->buffersCS[i] = NULL;
+         pDC->num_buffersCS[i] = 0;
+      }
+   }
+
+   for (unsigned i = 0; i < key.nr_sampler_views; i++) {
+      struct pipe_sampler_view *view =
+         ctx->sampler_views[PIPE_SHADER_COMPUTE][i];
+      if (view)
+         swr_resource_read(pipe, swr_resource(view->texture), seq);
+   }
+
+   for (unsigned i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
+      struct pipe_constant_buffer *cb =
+         &ctx->constants[PIPE_SHADER_COMPUTE][i];
+      if (cb->buffer)
+         swr_resource_read(pipe, swr_resource(cb->buffer), seq);
+   }
+}
+
+/*
+ * Store the dirty hot tiles of a render target the dispatch samples, from
+ * every attachment it is bound to.  Dispatches wait for all earlier work of
+ * the context, so no sync is needed for the stores to land first.
+ */
+static void
+swr_store_compute_input(struct swr_context *ctx,
+                        struct pipe_resource *resource)
+{
+   struct swr_resource *spr = swr_resource(resource);
+   SWR_SURFACE_STATE *renderTargets = ctx->swrDC.renderTargets;
+
+   if (!(spr->status & SWR_RESOURCE_WRITE))
+      return;
+
+   for (uint32_t i = 0; i < SWR_NUM_ATTACHMENTS; i++) {
+      if (renderTargets[i].pBaseAddress != spr->swr.pBaseAddress)
+         continue;
+
+      swr_store_render_target(&ctx->pipe, i, SWR_TILE_RESOLVED, NULL);
+      if (spr->has_stencil && (i == SWR_ATTACHMENT_DEPTH))
+         swr_store_render_target(
+            &ctx->pipe, SWR_ATTACHMENT_STENCIL, SWR_TILE_RESOLVED, NULL);
+   }
+}
+
+static void
+swr_launch_grid(struct pipe_context *pipe, const struct pipe_grid_info *info)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   if (!info->indirect &&
+       (!info->grid[0] || !info->grid[1] || !info->grid[2]))
+      return;
+
+   swr_jit_cs_key key;
+   memset(&key, 0, sizeof(key));
+   swr_generate_cs_key(key, ctx, ctx->cs, info->block);
+   PFN_CS_FUNC func = swr_get_cs_variant(ctx, key);
+
+   for (unsigned i = 0; i < key.nr_sampler_views; i++) {
+      struct pipe_sampler_view *view =
+         ctx->sampler_views[PIPE_SHADER_COMPUTE][i];
+      if (view)
+         swr_store_compute_input(ctx, view->texture);
+   }
+
+   swr_update_compute(ctx, key);
+   swr_update_draw_context(ctx);
+
+   SwrSetCsFunc(ctx->swrContext,
+                func,
+                info->block[0] * info->block[1] * info->block[2],
+                swr_cs_spill_fill_size(ctx->cs, info->block));
+
+   if (info->indirect) {
+      /* The core reads the arguments once earlier work, which may write
+       * them, has retired */
+      swr_resource_read(pipe, swr_resource(info->indirect),
+                        swr_fence_next(ctx->fence));
+      SwrDispatchIndirect(ctx->swrContext,
+                          (const uint32_t *)
+                          ((const uint8_t *)swr_resource_data(info->indirect)
+                           + info->indirect_offset));
+   } else {
+      SwrDispatch(ctx->swrContext, info->grid[0], info->grid[1], info->grid[2]);
+   }
+}
+
+void
+swr_compute_init(struct pipe_context *pipe)
+{
+   pipe->create_compute_state = swr_create_compute_state;
+   pipe->bind_compute_state = swr_bind_compute_state;
+   pipe->delete_compute_state = swr_delete_compute_state;
+   pipe->set_shader_buffers = swr_set_shader_buffers;
+   pipe->memory_barrier = swr_memory_barrier;
+   pipe->launch_grid = swr_launch_grid;
+}
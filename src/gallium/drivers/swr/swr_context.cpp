@@ -23,11 +23,13 @@
 
 #include "util/u_memory.h"
 #include "util/u_inlines.h"
+#include "util/u_atomic.h"
 #include "util/u_format.h"
 
 extern "C" {
 #include "util/u_transfer.h"
 #include "util/u_surface.h"
+#include "util/u_box.h"
 }
 
 #include "swr_context.h"
@@ -89,13 +91,198 @@ swr_surface_destroy(struct pipe_context *pipe, struct pipe_surface *surf)
 
    /* If the resource has been drawn to, store tiles. */
    if (spr->status & SWR_RESOURCE_WRITE)
-      swr_store_resource(pipe, resource, SWR_TILE_RESOLVED);
+      swr_store_resource(pipe, resource, SWR_TILE_RESOLVED, NULL);
 
    pipe_resource_reference(&resource, NULL);
    FREE(surf);
 }
 
 
+/*
+ * Store the hot tiles of a rendertarget that overlap box of the given level.
+ * Hot tiles only ever hold level 0.  Returns TRUE if tiles outside the box
+ * were left alone and may still be dirty.
+ */
+static boolean
+swr_store_box(struct pipe_context *pipe,
+              struct pipe_resource *resource,
+              unsigned level,
+              const struct pipe_box *box,
+              enum SWR_TILE_STATE post_tile_state)
+{
+   if (level != 0
+       || (box->x == 0 && box->y == 0
+           && box->width >= (int)resource->width0
+           && box->height >= (int)resource->height0)) {
+      swr_store_resource(pipe, resource, post_tile_state, NULL);
+      return FALSE;
+   }
+
+   swr_store_resource(pipe, resource, post_tile_state, box);
+   return TRUE;
+}
+
+/*
+ * Mesa sees merged depth/stencil formats, SWR keeps stencil in a separate
+ * R8 surface.  Copy stencil into (to_zs) or out of the stencil byte of the
+ * merged surface, for the pixels of box only, four pixels at a time.
+ */
+static void
+swr_transfer_stencil(struct swr_resource *spr,
+                     const struct pipe_box *box,
+                     boolean to_zs)
+{
+   unsigned zs_bpp;
+   if (spr->base.format == PIPE_FORMAT_Z24_UNORM_S8_UINT)
+      zs_bpp = 4;
+   else if (spr->base.format == PIPE_FORMAT_Z32_FLOAT_S8X24_UINT)
+      zs_bpp = 8;
+   else
+      return;
+
+   /* stencil byte within a merged pixel */
+   const unsigned s_byte = (zs_bpp == 4) ? 3 : 4;
+
+   /* Z24S8: stencil is the top byte of each dword.
+    * Z32S8X24: stencil is the low byte of every other dword. */
+   const __m128i extract = (zs_bpp == 4)
+      ? _mm_setr_epi8(3, 7, 11, 15, -1, -1, -1, -1,
+                      -1, -1, -1, -1, -1, -1, -1, -1)
+      : _mm_setr_epi8(4, 12, -1, -1, -1, -1, -1, -1,
+                      -1, -1, -1, -1, -1, -1, -1, -1);
+   const __m128i insert = (zs_bpp == 4)
+      ? _mm_setr_epi8(-1, -1, -1, 0, -1, -1, -1, 1,
+                      -1, -1, -1, 2, -1, -1, -1, 3)
+      : _mm_setr_epi8(-1, -1, -1, -1, 0, -1, -1, -1,
+                      -1, -1, -1, -1, 1, -1, -1, -1);
+   const __m128i insert_mask = (zs_bpp == 4)
+      ? _mm_set1_epi32(0xff000000)
+      : _mm_setr_epi32(0, 0xff, 0, 0xff);
+
+   const unsigned zs_pitch = spr->swr.pitch;
+   const unsigned s_pitch = spr->secondary.pitch;
+   const unsigned x0 = box->x;
+   const unsigned x1 = box->x + box->width;
+
+   for (int y = box->y; y < box->y + box->height; y++) {
+      uint8_t *zs = spr->swr.pBaseAddress + y * zs_pitch;
+      uint8_t *s = spr->secondary.pBaseAddress + y * s_pitch;
+      unsigned x = x0;
+
+      for (; x + 4 <= x1; x += 4) {
+         uint8_t *pZS = zs + x * zs_bpp;
+         uint32_t *pS = (uint32_t *)(s + x);
+
+         if (to_zs) {
+            __m128i vS = _mm_cvtsi32_si128(*pS);
+            for (unsigned i = 0; i < zs_bpp / 4; i++) {
+               __m128i *p = (__m128i *)pZS + i;
+               __m128i vZS = _mm_loadu_si128(p);
+               __m128i vIns = _mm_shuffle_epi8(
+                  _mm_srli_epi32(vS, 16 * i), insert);
+               _mm_storeu_si128(
+                  p, _mm_blendv_epi8(vZS, vIns, insert_mask));
+            }
+         } else {
+            uint32_t stencil = 0;
+            for (unsigned i = 0; i < zs_bpp / 4; i++) {
+               __m128i vZS = _mm_loadu_si128((__m128i *)pZS + i);
+               stencil |= (uint32_t)_mm_cvtsi128_si32(
+                  _mm_shuffle_epi8(vZS, extract)) << (16 * i);
+            }
+            *pS = stencil;
+         }
+      }
+
+      for (; x < x1; x++) {
+         if (to_zs)
+            zs[x * zs_bpp + s_byte] = s[x];
+         else
+            s[x] = zs[x * zs_bpp + s_byte];
+      }
+   }
+}
+
+/*
+ * Give a busy buffer fresh storage from the buffer pool, so a discarding
+ * map doesn't have to wait for the draws still reading the old contents.
+ * The old storage is retired to the pool behind those draws.
+ */
+static boolean
+swr_resource_rename(struct pipe_context *pipe,
+                    struct swr_resource *spr,
+                    boolean preserve)
+{
+   struct swr_screen *screen = swr_screen(pipe->screen);
+   unsigned size = spr->base.width0;
+   uint8_t *old_storage = spr->swr.pBaseAddress;
+   uint8_t *new_storage = (uint8_t *)swr_buffer_pool_alloc(screen, size);
+
+   if (!new_storage)
+      return FALSE;
+
+   /* Partial discard keeps the contents outside the mapped range */
+   if (preserve)
+      memcpy(new_storage, old_storage, size);
+
+   spr->swr.pBaseAddress = new_storage;
+   swr_buffer_pool_release(screen, old_storage, size, spr->uses);
+   swr_resource_unused(pipe, spr);
+
+   /* Derived state of any context binding the buffer still points at the
+    * old storage, have them all update it before their next draw */
+   p_atomic_inc(&screen->buffer_renames);
+
+   return TRUE;
+}
+
+/* Mapping a tiled texture goes through a linear copy of the box */
+struct swr_transfer {
+   struct pipe_transfer base;
+   uint8_t *staging;
+};
+
+/*
+ * Copy the box of a level of a Y-major tiled texture out to (or back in
+ * from) the linear staging memory of a transfer, a 16 byte tile column
+ * piece at a time.
+ */
+static void
+swr_transfer_tiled(struct swr_resource *spr,
+                   struct swr_transfer *st,
+                   boolean to_tiled)
+{
+   const struct pipe_transfer *pt = &st->base;
+   const unsigned level = pt->level;
+   const unsigned pitch = spr->row_stride[level];
+   const unsigned bpp = util_format_get_blocksize(spr->base.format);
+   const unsigned x0 = pt->box.x * bpp;
+   const unsigned x1 = x0 + pt->box.width * bpp;
+
+   for (int z = 0; z < pt->box.depth; z++) {
+      uint8_t *image = spr->swr.pBaseAddress + spr->mip_offsets[level]
+         + (pt->box.z + z) * spr->img_stride[level];
+
+      for (int y = 0; y < pt->box.height; y++) {
+         uint8_t *linear =
+            st->staging + z * pt->layer_stride + y * pt->stride;
+
+         for (unsigned x = x0; x < x1;) {
+            unsigned n = MIN2(16 - (x & 15), x1 - x);
+            uint8_t *tiled =
+               image + ComputeOffset2D<SWR_YMAJOR_TILING>(pitch, x,
+                                                           pt->box.y + y);
+            if (to_tiled)
+               memcpy(tiled, linear, n);
+            else
+               memcpy(linear, tiled, n);
+            linear += n;
+            x += n;
+         }
+      }
+   }
+}
+
 static void *
 swr_transfer_map(struct pipe_context *pipe,
                  struct pipe_resource *resource,
@@ -104,7 +291,6 @@ swr_transfer_map(struct pipe_context *pipe,
                  const struct pipe_box *box,
                  struct pipe_transfer **transfer)
 {
-   struct swr_screen *screen = swr_screen(pipe->screen);
    struct swr_resource *spr = swr_resource(resource);
    struct pipe_transfer *pt;
    enum pipe_format format = resource->format;
@@ -114,50 +300,83 @@ swr_transfer_map(struct pipe_context *pipe,
 
    /* If mapping an attached rendertarget, store tiles to surface and set
     * postStoreTileState to SWR_TILE_INVALID so tiles get reloaded on next use
-    * and nothing needs to be done at unmap. */
+    * and nothing needs to be done at unmap.  Only tiles overlapping the box
+    * are stored; the others stay dirty. */
+   boolean partial_store = FALSE;
    if (spr->status & SWR_RESOURCE_WRITE)
-      swr_store_resource(pipe, resource, SWR_TILE_INVALID);
+      partial_store =
+         swr_store_box(pipe, resource, level, box, SWR_TILE_INVALID);
+
+   /* Writes must not race an asynchronous present of the display target */
+   if (spr->display_target && (usage & PIPE_TRANSFER_WRITE))
+      swr_present_wait(swr_screen(pipe->screen), spr->swr.pBaseAddress);
 
    if (!(usage & PIPE_TRANSFER_UNSYNCHRONIZED)) {
-      /* If resource is in use, finish fence before mapping.
-       * Unless requested not to block, then if not done return NULL map */
-      if (usage & PIPE_TRANSFER_DONTBLOCK) {
-         if (swr_is_fence_pending(screen->flush_fence))
-            return NULL;
-      } else {
-         if (spr->status) {
-            /* But, if there's no fence pending, submit one.
-             * XXX: Remove once draw timestamps are finished. */
-            if (!swr_is_fence_pending(screen->flush_fence))
-               swr_fence_submit(swr_context(pipe), screen->flush_fence);
-
-            swr_fence_finish(pipe->screen, screen->flush_fence, 0);
-            swr_resource_unused(pipe, spr);
-         }
+      /* Rename discarded buffers that are still in use.  A partial
+       * discard copies the old contents, which queued stream output or
+       * shader writes would still change, so written buffers wait. */
+      if (resource->target == PIPE_BUFFER
+          && (usage & (PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE
+                       | PIPE_TRANSFER_DISCARD_RANGE))
+          && swr_resource_busy(spr)) {
+         boolean preserve = !(usage & PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE);
+         if (!preserve || !(spr->status & SWR_RESOURCE_WRITE))
+            swr_resource_rename(pipe, spr, preserve);
       }
+
+      /* If resource is in use, wait for the draws referencing it before
+       * mapping.  Unless requested not to block, then if not done return
+       * NULL map */
+      uint64_t timeout = (usage & PIPE_TRANSFER_DONTBLOCK)
+         ? 0 : PIPE_TIMEOUT_INFINITE;
+      if (!swr_resource_finish(pipe, spr, timeout))
+         return NULL;
    }
 
-   pt = CALLOC_STRUCT(pipe_transfer);
-   if (!pt)
+   if (partial_store)
+      swr_resource_dirty(pipe, spr);
+
+   struct swr_transfer *st = CALLOC_STRUCT(swr_transfer);
+   if (!st)
       return NULL;
+   pt = &st->base;
    pipe_resource_reference(&pt->resource, resource);
    pt->level = level;
+
+   if (usage & PIPE_TRANSFER_WRITE) {
+      p_atomic_inc(&spr->write_seq);
+      if (usage & PIPE_TRANSFER_PERSISTENT)
+         p_atomic_inc(&spr->persistent_writes);
+   }
+
+   pt->usage = (enum pipe_transfer_usage)usage;
    pt->box = *box;
+
+   if (swr_resource_is_tiled(spr)) {
+      pt->stride = box->width * util_format_get_blocksize(format);
+      pt->layer_stride = pt->stride * box->height;
+      st->staging = (uint8_t *)MALLOC(pt->layer_stride * box->depth);
+      if (!st->staging) {
+         pipe_resource_reference(&pt->resource, NULL);
+         FREE(st);
+         return NULL;
+      }
+
+      /* Writes may not cover the whole box unless it's discarded */
+      if (!(usage & (PIPE_TRANSFER_DISCARD_RANGE
+                     | PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE)))
+         swr_transfer_tiled(spr, st, FALSE);
+
+      *transfer = pt;
+      return st->staging;
+   }
+
    pt->stride = spr->row_stride[level];
    pt->layer_stride = spr->img_stride[level];
 
    /* if we're mapping the depth/stencil, copy in stencil */
-   if (spr->base.format == PIPE_FORMAT_Z24_UNORM_S8_UINT
-       && spr->has_stencil) {
-      for (unsigned i = 0; i < spr->alignedWidth * spr->alignedHeight; i++) {
-         spr->swr.pBaseAddress[4 * i + 3] = spr->secondary.pBaseAddress[i];
-      }
-   } else if (spr->base.format == PIPE_FORMAT_Z32_FLOAT_S8X24_UINT
-              && spr->has_stencil) {
-      for (unsigned i = 0; i < spr->alignedWidth * spr->alignedHeight; i++) {
-         spr->swr.pBaseAddress[8 * i + 4] = spr->secondary.pBaseAddress[i];
-      }
-   }
+   if (spr->has_stencil && level == 0)
+      swr_transfer_stencil(spr, box, TRUE);
 
    unsigned offset = box->z * pt->layer_stride + box->y * pt->stride
       + box->x * util_format_get_blocksize(format);
@@ -173,24 +392,163 @@ swr_transfer_unmap(struct pipe_context *pipe, struct pipe_transfer *transfer)
    assert(transfer->resource);
 
    struct swr_resource *res = swr_resource(transfer->resource);
-   /* if we're mapping the depth/stencil, copy out stencil */
-   if (res->base.format == PIPE_FORMAT_Z24_UNORM_S8_UINT
-       && res->has_stencil) {
-      for (unsigned i = 0; i < res->alignedWidth * res->alignedHeight; i++) {
-         res->secondary.pBaseAddress[i] = res->swr.pBaseAddress[4 * i + 3];
-      }
-   } else if (res->base.format == PIPE_FORMAT_Z32_FLOAT_S8X24_UINT
-              && res->has_stencil) {
-      for (unsigned i = 0; i < res->alignedWidth * res->alignedHeight; i++) {
-         res->secondary.pBaseAddress[i] = res->swr.pBaseAddress[8 * i + 4];
-      }
+   struct swr_transfer *st = (struct swr_transfer *)transfer;
+
+   if (transfer->usage & PIPE_TRANSFER_WRITE) {
+      swr_resource_commit(res, transfer->level, &transfer->box);
+      p_atomic_inc(&res->write_seq);
+      if (transfer->usage & PIPE_TRANSFER_PERSISTENT)
+         p_atomic_dec(&res->persistent_writes);
+   }
+
+   /* tiled textures get the linear copy written back */
+   if (st->staging) {
+      if (transfer->usage & PIPE_TRANSFER_WRITE)
+         swr_transfer_tiled(res, st, TRUE);
+      FREE(st->staging);
    }
 
+   /* if we're mapping the depth/stencil, copy out stencil */
+   if (res->has_stencil && transfer->level == 0
+       && (transfer->usage & PIPE_TRANSFER_WRITE))
+      swr_transfer_stencil(res, &transfer->box, FALSE);
+
    pipe_resource_reference(&transfer->resource, NULL);
-   FREE(transfer);
+   FREE(st);
 }
 
 
+/*
+ * Queue a copy or blit between level 0 color surfaces to the worker
+ * threads, which convert, scale and resolve per dst macrotile.  Doesn't
+ * wait for anything.  Returns FALSE if the core can't do it.
+ */
+static boolean
+swr_blit_native(struct pipe_context *pipe,
+                struct pipe_resource *dst,
+                enum pipe_format dst_format,
+                const struct pipe_box *dst_box,
+                struct pipe_resource *src,
+                enum pipe_format src_format,
+                const struct pipe_box *src_box,
+                enum SWR_BLIT_FILTER filter)
+{
+   struct swr_context *ctx = swr_context(pipe);
+   struct pipe_screen *screen = pipe->screen;
+   struct swr_resource *spr_dst = swr_resource(dst);
+   struct swr_resource *spr_src = swr_resource(src);
+
+   /* Array layers and 3D slices aren't described by the SWR surfaces, and
+    * tiled textures go through transfers */
+   if (dst == src
+       || swr_resource_is_tiled(spr_dst) || swr_resource_is_tiled(spr_src)
+       || (dst->target != PIPE_TEXTURE_2D && dst->target != PIPE_TEXTURE_RECT)
+       || (src->target != PIPE_TEXTURE_2D && src->target != PIPE_TEXTURE_RECT))
+      return FALSE;
+
+   if (dst->nr_samples > 1
+       || util_format_is_depth_or_stencil(dst_format)
+       || util_format_is_depth_or_stencil(src_format)
+       || util_format_is_pure_integer(dst_format)
+       || util_format_is_pure_integer(src_format))
+      return FALSE;
+
+   /* Load/StoreTile has entries for the rendertarget formats */
+   if (!screen->is_format_supported(screen, dst_format, dst->target,
+                                    dst->nr_samples, PIPE_BIND_RENDER_TARGET)
+       || !screen->is_format_supported(screen, src_format, src->target,
+                                       src->nr_samples,
+                                       PIPE_BIND_RENDER_TARGET))
+      return FALSE;
+
+   if (dst_box->width <= 0 || dst_box->height <= 0
+       || dst_box->x < 0 || dst_box->y < 0
+       || dst_box->x + dst_box->width > KNOB_MAX_SCISSOR_X
+       || dst_box->y + dst_box->height > KNOB_MAX_SCISSOR_Y
+       || src_box->width == 0 || src_box->height == 0)
+      return FALSE;
+
+   /* Store the source tiles the blit reads.  Destination tiles of a bound
+    * rendertarget are stored and invalidated, to be reloaded after the
+    * blit. */
+   struct pipe_box src_rect = *src_box;
+   if (src_rect.width < 0) {
+      src_rect.x += src_rect.width;
+      src_rect.width = -src_rect.width;
+   }
+   if (src_rect.height < 0) {
+      src_rect.y += src_rect.height;
+      src_rect.height = -src_rect.height;
+   }
+   /* The blit waits for all earlier work in the core, StoreTiles
+    * included, so no sync is needed for the CPU to wait on here. */
+   swr_draw_context *pDC = &ctx->swrDC;
+   for (uint32_t i = SWR_ATTACHMENT_COLOR0; i <= SWR_ATTACHMENT_COLOR7; i++)
+      if ((spr_src->status & SWR_RESOURCE_WRITE)
+          && pDC->renderTargets[i].pBaseAddress == spr_src->swr.pBaseAddress)
+         swr_store_render_target(pipe, i, SWR_TILE_RESOLVED, &src_rect);
+
+   if (spr_dst->display_target)
+      swr_present_wait(swr_screen(screen), spr_dst->swr.pBaseAddress);
+
+   SWR_RECT dst_rect;
+   dst_rect.left = dst_box->x;
+   dst_rect.right = dst_box->x + dst_box->width;
+   dst_rect.top = dst_box->y;
+   dst_rect.bottom = dst_box->y + dst_box->height;
+
+   for (uint32_t i = SWR_ATTACHMENT_COLOR0; i <= SWR_ATTACHMENT_COLOR7; i++)
+      if (pDC->renderTargets[i].pBaseAddress == spr_dst->swr.pBaseAddress)
+         swr_store_render_target(pipe, i, SWR_TILE_INVALID, dst_box);
+
+   SWR_BLIT_INFO info;
+   info.src = spr_src->swr;
+   info.src.format = mesa_to_swr_format(src_format);
+   info.dst = spr_dst->swr;
+   info.dst.format = mesa_to_swr_format(dst_format);
+   info.srcX = src_box->x;
+   info.srcY = src_box->y;
+   info.srcWidth = src_box->width;
+   info.srcHeight = src_box->height;
+   info.srcArrayIndex = 0;
+   info.dstRect = dst_rect;
+   info.dstArrayIndex = 0;
+   info.numArraySlices = 1;
+   info.filter = filter;
+
+   SwrBlit(ctx->swrContext, &info);
+   swr_resource_commit(spr_dst, 0, dst_box);
+
+   /* Retired by the next sync on the context fence, like a draw */
+   uint64_t seq = swr_fence_next(ctx->fence);
+   swr_resource_read(pipe, spr_src, seq);
+   swr_resource_read(pipe, spr_dst, seq);
+
+   return TRUE;
+}
+
+
+/*
+ * Whether texels of the format survive conversion to the float hot tile
+ * format and back bit exact.  Padding channels of X formats are dropped,
+ * snorm has two encodings of -1 and shared exponents aren't unique.
+ */
+static boolean
+swr_format_copies_exact(enum pipe_format format)
+{
+   const struct util_format_description *desc =
+      util_format_description(format);
+
+   if (util_format_is_snorm(format) || format == PIPE_FORMAT_R9G9B9E5_FLOAT)
+      return FALSE;
+
+   for (unsigned i = 0; i < desc->nr_channels; i++)
+      if (desc->channel[i].type == UTIL_FORMAT_TYPE_VOID)
+         return FALSE;
+
+   return TRUE;
+}
+
 static void
 swr_resource_copy(struct pipe_context *pipe,
                   struct pipe_resource *dst,
@@ -202,18 +560,41 @@ swr_resource_copy(struct pipe_context *pipe,
                   unsigned src_level,
                   const struct pipe_box *src_box)
 {
-   struct swr_screen *screen = swr_screen(pipe->screen);
+   struct swr_resource *spr_src = swr_resource(src);
+   struct swr_resource *spr_dst = swr_resource(dst);
+   struct pipe_box dst_box;
+   u_box_3d(dstx, dsty, dstz, src_box->width, src_box->height,
+            src_box->depth, &dst_box);
+
+   /* Raw copies only go through the float hot tile format for formats
+    * that survive the round trip bit exact */
+   enum pipe_format format = util_format_linear(src->format);
+   if (dst_level == 0 && src_level == 0
+       && util_format_linear(dst->format) == format
+       && swr_format_copies_exact(format)
+       && src->nr_samples <= 1
+       && swr_blit_native(pipe, dst, format, &dst_box,
+                          src, format, src_box, SWR_BLIT_FILTER_POINT))
+      return;
+
+   /* If either the src or dst is a renderTarget, store the overlapping
+    * tiles before copy */
+   boolean src_partial = FALSE, dst_partial = FALSE;
+   if (spr_src->status & SWR_RESOURCE_WRITE)
+      src_partial = swr_store_box(
+         pipe, src, src_level, src_box, SWR_TILE_RESOLVED);
 
-   /* If either the src or dst is a renderTarget, store tiles before copy */
-   if (swr_resource(src)->status & SWR_RESOURCE_WRITE)
-      swr_store_resource(pipe, src, SWR_TILE_RESOLVED);
+   if (spr_dst->status & SWR_RESOURCE_WRITE)
+      dst_partial = swr_store_box(
+         pipe, dst, dst_level, &dst_box, SWR_TILE_RESOLVED);
 
-   if (swr_resource(dst)->status & SWR_RESOURCE_WRITE)
-      swr_store_resource(pipe, dst, SWR_TILE_RESOLVED);
+   swr_resource_finish(pipe, spr_src, PIPE_TIMEOUT_INFINITE);
+   swr_resource_finish(pipe, spr_dst, PIPE_TIMEOUT_INFINITE);
 
-   swr_fence_finish(pipe->screen, screen->flush_fence, 0);
-   swr_resource_unused(pipe, swr_resource(src));
-   swr_resource_unused(pipe, swr_resource(dst));
+   if (src_partial)
+      swr_resource_dirty(pipe, spr_src);
+   if (dst_partial)
+      swr_resource_dirty(pipe, spr_dst);
 
    if ((dst->target == PIPE_BUFFER && src->target == PIPE_BUFFER)
        || (dst->target != PIPE_BUFFER && src->target != PIPE_BUFFER)) {
@@ -235,13 +616,30 @@ swr_blit(struct pipe_context *pipe, const struct pipe_blit_info *blit_info)
    if (blit_info->render_condition_enable && !swr_check_render_cond(pipe))
       return;
 
+   /* Color resolves read the single sample copy that multisampled hot tiles
+    * are resolved into as they are stored */
    if (info.src.resource->nr_samples > 1 && info.dst.resource->nr_samples <= 1
-       && !util_format_is_depth_or_stencil(info.src.resource->format)
-       && !util_format_is_pure_integer(info.src.resource->format)) {
-      debug_printf("swr: color resolve unimplemented\n");
-      return;
+       && swr_resource(info.src.resource)->resolve_target) {
+      struct swr_resource *spr = swr_resource(info.src.resource);
+      struct pipe_resource *resolve = spr->resolve_target;
+
+      /* Tags the resolve target with the sync retiring the resolve */
+      swr_store_resource(pipe, info.src.resource, SWR_TILE_RESOLVED, NULL);
+
+      info.src.resource = resolve;
    }
 
+   if (info.dst.level == 0 && info.src.level == 0
+       && (info.mask & PIPE_MASK_RGBA) == PIPE_MASK_RGBA
+       && !info.scissor_enable && !info.alpha_blend
+       && swr_blit_native(pipe,
+                          info.dst.resource, info.dst.format, &info.dst.box,
+                          info.src.resource, info.src.format, &info.src.box,
+                          info.filter == PIPE_TEX_FILTER_LINEAR
+                             ? SWR_BLIT_FILTER_LINEAR
+                             : SWR_BLIT_FILTER_POINT))
+      return;
+
    if (util_try_blit_via_copy_region(pipe, &info)) {
       return; /* done */
    }
@@ -263,7 +661,9 @@ swr_blit(struct pipe_context *pipe, const struct pipe_blit_info *blit_info)
    util_blitter_save_vertex_buffer_slot(ctx->blitter, ctx->vertex_buffer);
    util_blitter_save_vertex_elements(ctx->blitter, (void *)ctx->velems);
    util_blitter_save_vertex_shader(ctx->blitter, (void *)ctx->vs);
-   /*util_blitter_save_geometry_shader(ctx->blitter, (void*)ctx->gs);*/
+   util_blitter_save_tessctrl_shader(ctx->blitter, (void *)ctx->tcs);
+   util_blitter_save_tesseval_shader(ctx->blitter, (void *)ctx->tes);
+   util_blitter_save_geometry_shader(ctx->blitter, (void *)ctx->gs);
    util_blitter_save_so_targets(
       ctx->blitter,
       ctx->num_so_targets,
@@ -303,15 +703,31 @@ swr_destroy(struct pipe_context *pipe)
    if (ctx->blitter)
       util_blitter_destroy(ctx->blitter);
 
-   /* Idle core before deleting context */
-   SwrWaitForIdle(ctx->swrContext);
-   if (ctx->swrContext)
+   /* Idle core before deleting context, retiring the draws of resources
+    * that outlive it */
+   if (ctx->swrContext) {
+      if (ctx->fence) {
+         swr_fence_submit(ctx, ctx->fence);
+         swr_fence_finish(pipe->screen, ctx->fence, PIPE_TIMEOUT_INFINITE);
+      }
+      SwrWaitForIdle(ctx->swrContext);
       SwrDestroyContext(ctx->swrContext);
+   }
+
+   for (unsigned i = 0; i < SWR_NUM_ATTACHMENTS; i++)
+      pipe_resource_reference(&ctx->derived.attachments[i], NULL);
 
    delete ctx->blendJIT;
+   delete ctx->outputMergerJIT;
 
    swr_destroy_scratch_buffers(ctx);
 
+   for (unsigned i = 0; i < PIPE_SHADER_TYPES; i++)
+      for (unsigned j = 0; j < PIPE_MAX_SHADER_BUFFERS; j++)
+         pipe_resource_reference(&ctx->shader_buffers[i][j].buffer, NULL);
+
+   swr_fence_reference(pipe->screen, &ctx->fence, NULL);
+
    FREE(ctx);
 }
 
@@ -327,6 +743,8 @@ swr_render_condition(struct pipe_context *pipe,
    ctx->render_cond_query = query;
    ctx->render_cond_mode = mode;
    ctx->render_cond_cond = condition;
+
+   swr_update_render_condition(pipe);
 }
 
 struct pipe_context *
@@ -335,6 +753,9 @@ swr_create_context(struct pipe_screen *screen, void *priv, unsigned flags)
    struct swr_context *ctx = CALLOC_STRUCT(swr_context);
    ctx->blendJIT =
       new std::unordered_map<BLEND_COMPILE_STATE, PFN_BLEND_JIT_FUNC>;
+   ctx->outputMergerJIT =
+      new std::unordered_map<OUTPUT_MERGER_COMPILE_STATE,
+                             PFN_OUTPUT_MERGER_JIT_FUNC>;
 
    SWR_CREATECONTEXT_INFO createInfo;
    createInfo.driver = GL;
@@ -343,6 +764,8 @@ swr_create_context(struct pipe_screen *screen, void *priv, unsigned flags)
    createInfo.pfnLoadTile = swr_LoadHotTile;
    createInfo.pfnStoreTile = swr_StoreHotTile;
    createInfo.pfnClearTile = swr_StoreHotTileClear;
+   createInfo.pfnLoadSurfaceTile = LoadHotTile;
+   createInfo.pfnStoreSurfaceTile = StoreHotTile;
    ctx->swrContext = SwrCreateContext(&createInfo);
 
    /* Init Load/Store/ClearTiles Tables */
@@ -353,6 +776,10 @@ swr_create_context(struct pipe_screen *screen, void *priv, unsigned flags)
    if (ctx->swrContext == NULL)
       goto fail;
 
+   ctx->fence = swr_fence_create();
+   if (!ctx->fence)
+      goto fail;
+
    ctx->pipe.screen = screen;
    ctx->pipe.destroy = swr_destroy;
    ctx->pipe.priv = priv;
@@ -371,6 +798,7 @@ swr_create_context(struct pipe_screen *screen, void *priv, unsigned flags)
    swr_clear_init(&ctx->pipe);
    swr_draw_init(&ctx->pipe);
    swr_query_init(&ctx->pipe);
+   swr_compute_init(&ctx->pipe);
 
    ctx->pipe.blit = swr_blit;
    ctx->blitter = util_blitter_create(&ctx->pipe);
@@ -47,7 +47,9 @@
 #define SWR_NEW_FRAMEBUFFER (1 << 13)
 #define SWR_NEW_CLIP (1 << 14)
 #define SWR_NEW_SO (1 << 15)
-#define SWR_NEW_ALL 0x0000ffff
+#define SWR_NEW_GS (1 << 16)
+#define SWR_NEW_TS (1 << 17)
+#define SWR_NEW_ALL 0x0003ffff
 
 namespace std
 {
@@ -57,6 +59,13 @@ template <> struct hash<BLEND_COMPILE_STATE> {
       return util_hash_crc32(&k, sizeof(k));
    }
 };
+
+template <> struct hash<OUTPUT_MERGER_COMPILE_STATE> {
+   std::size_t operator()(const OUTPUT_MERGER_COMPILE_STATE &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
 };
 
 struct swr_jit_texture {
@@ -89,7 +98,42 @@ struct swr_draw_context {
    swr_jit_texture texturesFS[PIPE_MAX_SHADER_SAMPLER_VIEWS];
    swr_jit_sampler samplersFS[PIPE_MAX_SAMPLERS];
 
+   const float *constantCS[PIPE_MAX_CONSTANT_BUFFERS];
+   unsigned num_constantsCS[PIPE_MAX_CONSTANT_BUFFERS];
+   swr_jit_texture texturesCS[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   swr_jit_sampler samplersCS[PIPE_MAX_SAMPLERS];
+   uint8_t *buffersCS[PIPE_MAX_SHADER_BUFFERS];
+   unsigned num_buffersCS[PIPE_MAX_SHADER_BUFFERS]; /* bytes */
+
+   const float *constantGS[PIPE_MAX_CONSTANT_BUFFERS];
+   unsigned num_constantsGS[PIPE_MAX_CONSTANT_BUFFERS];
+   swr_jit_texture texturesGS[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   swr_jit_sampler samplersGS[PIPE_MAX_SAMPLERS];
+
+   const float *constantTCS[PIPE_MAX_CONSTANT_BUFFERS];
+   unsigned num_constantsTCS[PIPE_MAX_CONSTANT_BUFFERS];
+   swr_jit_texture texturesTCS[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   swr_jit_sampler samplersTCS[PIPE_MAX_SAMPLERS];
+
+   const float *constantTES[PIPE_MAX_CONSTANT_BUFFERS];
+   unsigned num_constantsTES[PIPE_MAX_CONSTANT_BUFFERS];
+   swr_jit_texture texturesTES[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   swr_jit_sampler samplersTES[PIPE_MAX_SAMPLERS];
+
+   /* levels the pass through control shader hands on, without a TCS */
+   float tessOuterLevel[4];
+   float tessInnerLevel[2];
+
    SWR_SURFACE_STATE renderTargets[SWR_NUM_ATTACHMENTS];
+
+   /* jitted load/store tile kernels per color attachment, NULL when the
+    * attachment takes the LoadTile/StoreTile table path */
+   PFN_LOAD_TILE_JIT_FUNC pfnLoadTile[SWR_NUM_RENDERTARGETS];
+   PFN_STORE_TILE_JIT_FUNC pfnStoreTile[SWR_NUM_RENDERTARGETS];
+
+   /* single sample surfaces the multisampled color attachments resolve to
+    * whenever their hot tiles are stored */
+   SWR_SURFACE_STATE resolveTargets[SWR_NUM_RENDERTARGETS];
 };
 
 struct swr_context {
@@ -97,6 +141,12 @@ struct swr_context {
 
    HANDLE swrContext;
 
+   /* Syncs submitted on this context, in order.  Resources record which
+    * sync retires the draws referencing them. */
+   struct pipe_fence_handle *fence;
+   uint64_t status_seq; /* fence sequence the bound resources carry */
+   unsigned buffer_renames; /* screen buffer_renames derived state saw */
+
    /** Constant state objects */
    struct swr_blend_state *blend;
    struct pipe_sampler_state *samplers[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
@@ -104,13 +154,18 @@ struct swr_context {
    struct pipe_rasterizer_state *rasterizer;
 
    struct swr_vertex_shader *vs;
+   struct swr_tess_ctrl_shader *tcs;
+   struct swr_tess_eval_shader *tes;
+   struct swr_geometry_shader *gs;
    struct swr_fragment_shader *fs;
+   struct swr_compute_shader *cs;
    struct swr_vertex_element_state *velems;
 
    /** Other rendering state */
    struct pipe_blend_color blend_color;
    struct pipe_stencil_ref stencil_ref;
    struct pipe_clip_state clip;
+   unsigned patch_vertices; /* of the last patch draw */
    struct pipe_constant_buffer
       constants[PIPE_SHADER_TYPES][PIPE_MAX_CONSTANT_BUFFERS];
    struct pipe_framebuffer_state framebuffer;
@@ -118,6 +173,8 @@ struct swr_context {
    struct pipe_scissor_state scissor;
    struct pipe_sampler_view *
       sampler_views[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   struct pipe_shader_buffer
+      shader_buffers[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_BUFFERS];
 
    struct pipe_viewport_state viewport;
    struct pipe_vertex_buffer vertex_buffer[PIPE_MAX_ATTRIBS];
@@ -129,6 +186,7 @@ struct swr_context {
    struct pipe_query *render_cond_query;
    uint render_cond_mode;
    boolean render_cond_cond;
+   struct swr_query_stats *render_cond_stats; /* read by the core */
    unsigned active_queries;
 
    unsigned num_vertex_buffers;
@@ -147,6 +205,10 @@ struct swr_context {
    // blend jit functions
    std::unordered_map<BLEND_COMPILE_STATE, PFN_BLEND_JIT_FUNC> *blendJIT;
 
+   // fused output merger jit functions
+   std::unordered_map<OUTPUT_MERGER_COMPILE_STATE, PFN_OUTPUT_MERGER_JIT_FUNC>
+      *outputMergerJIT;
+
    /* Derived SWR API DrawState */
    struct swr_derived_state derived;
 
@@ -154,6 +216,13 @@ struct swr_context {
    struct swr_draw_context swrDC;
 
    unsigned dirty; /**< Mask of SWR_NEW_x flags */
+
+   PFN_FETCH_FUNC fetch_func; /**< Fetch shader last set in the core */
+
+   /* Names the FS constants bound, changes whenever they may have */
+   unsigned fs_constants_stamp;
+   /* write_seq of the bound FS constant buffers when last stamped */
+   unsigned fs_constants_write_seq[PIPE_MAX_CONSTANT_BUFFERS];
 };
 
 static INLINE struct swr_context *
@@ -178,5 +247,7 @@ void swr_clear_init(struct pipe_context *pipe);
 
 void swr_draw_init(struct pipe_context *pipe);
 
+void swr_compute_init(struct pipe_context *pipe);
+
 void swr_finish(struct pipe_context *pipe);
 #endif
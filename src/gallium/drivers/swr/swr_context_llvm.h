@@ -107,6 +107,55 @@ Gen_swr_draw_context(JitManager *pShG)
                      PIPE_MAX_SHADER_SAMPLER_VIEWS)); // texturesFS
    members.push_back(ArrayType::get(Gen_swr_jit_sampler(pShG),
                                     PIPE_MAX_SAMPLERS)); // samplersFS
+   members.push_back(
+      ArrayType::get(PointerType::get(Type::getFloatTy(ctx), 0),
+                     PIPE_MAX_CONSTANT_BUFFERS)); // constantCS
+   members.push_back(ArrayType::get(
+      Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS)); // num_constantsCS
+   members.push_back(
+      ArrayType::get(Gen_swr_jit_texture(pShG),
+                     PIPE_MAX_SHADER_SAMPLER_VIEWS)); // texturesCS
+   members.push_back(ArrayType::get(Gen_swr_jit_sampler(pShG),
+                                    PIPE_MAX_SAMPLERS)); // samplersCS
+   members.push_back(
+      ArrayType::get(PointerType::get(Type::getInt8Ty(ctx), 0),
+                     PIPE_MAX_SHADER_BUFFERS)); // buffersCS
+   members.push_back(ArrayType::get(
+      Type::getInt32Ty(ctx), PIPE_MAX_SHADER_BUFFERS)); // num_buffersCS
+   members.push_back(
+      ArrayType::get(PointerType::get(Type::getFloatTy(ctx), 0),
+                     PIPE_MAX_CONSTANT_BUFFERS)); // constantGS
+   members.push_back(ArrayType::get(
+      Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS)); // num_constantsGS
+   members.push_back(
+      ArrayType::get(Gen_swr_jit_texture(pShG),
+                     PIPE_MAX_SHADER_SAMPLER_VIEWS)); // texturesGS
+   members.push_back(ArrayType::get(Gen_swr_jit_sampler(pShG),
+                                    PIPE_MAX_SAMPLERS)); // samplersGS
+   members.push_back(
+      ArrayType::get(PointerType::get(Type::getFloatTy(ctx), 0),
+                     PIPE_MAX_CONSTANT_BUFFERS)); // constantTCS
+   members.push_back(ArrayType::get(
+      Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS)); // num_constantsTCS
+   members.push_back(
+      ArrayType::get(Gen_swr_jit_texture(pShG),
+                     PIPE_MAX_SHADER_SAMPLER_VIEWS)); // texturesTCS
+   members.push_back(ArrayType::get(Gen_swr_jit_sampler(pShG),
+                                    PIPE_MAX_SAMPLERS)); // samplersTCS
+   members.push_back(
+      ArrayType::get(PointerType::get(Type::getFloatTy(ctx), 0),
+                     PIPE_MAX_CONSTANT_BUFFERS)); // constantTES
+   members.push_back(ArrayType::get(
+      Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS)); // num_constantsTES
+   members.push_back(
+      ArrayType::get(Gen_swr_jit_texture(pShG),
+                     PIPE_MAX_SHADER_SAMPLER_VIEWS)); // texturesTES
+   members.push_back(ArrayType::get(Gen_swr_jit_sampler(pShG),
+                                    PIPE_MAX_SAMPLERS)); // samplersTES
+   members.push_back(
+      ArrayType::get(Type::getFloatTy(ctx), 4)); // tessOuterLevel
+   members.push_back(
+      ArrayType::get(Type::getFloatTy(ctx), 2)); // tessInnerLevel
    members.push_back(ArrayType::get(Gen_SWR_SURFACE_STATE(pShG),
                                     SWR_NUM_ATTACHMENTS)); // renderTargets
 
@@ -121,4 +170,24 @@ static const UINT swr_draw_context_texturesVS = 4;
 static const UINT swr_draw_context_samplersVS = 5;
 static const UINT swr_draw_context_texturesFS = 6;
 static const UINT swr_draw_context_samplersFS = 7;
-static const UINT swr_draw_context_renderTargets = 8;
+static const UINT swr_draw_context_constantCS = 8;
+static const UINT swr_draw_context_num_constantsCS = 9;
+static const UINT swr_draw_context_texturesCS = 10;
+static const UINT swr_draw_context_samplersCS = 11;
+static const UINT swr_draw_context_buffersCS = 12;
+static const UINT swr_draw_context_num_buffersCS = 13;
+static const UINT swr_draw_context_constantGS = 14;
+static const UINT swr_draw_context_num_constantsGS = 15;
+static const UINT swr_draw_context_texturesGS = 16;
+static const UINT swr_draw_context_samplersGS = 17;
+static const UINT swr_draw_context_constantTCS = 18;
+static const UINT swr_draw_context_num_constantsTCS = 19;
+static const UINT swr_draw_context_texturesTCS = 20;
+static const UINT swr_draw_context_samplersTCS = 21;
+static const UINT swr_draw_context_constantTES = 22;
+static const UINT swr_draw_context_num_constantsTES = 23;
+static const UINT swr_draw_context_texturesTES = 24;
+static const UINT swr_draw_context_samplersTES = 25;
+static const UINT swr_draw_context_tessOuterLevel = 26;
+static const UINT swr_draw_context_tessInnerLevel = 27;
+static const UINT swr_draw_context_renderTargets = 28;
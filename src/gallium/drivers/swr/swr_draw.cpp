@@ -30,12 +30,14 @@
 
 #include "util/u_draw.h"
 #include "util/u_prim.h"
+#include "util/u_atomic.h"
 
 /*
  * Convert mesa PIPE_PRIM_X to SWR enum PRIMITIVE_TOPOLOGY
  */
 static INLINE enum PRIMITIVE_TOPOLOGY
-swr_convert_prim_topology(const unsigned mode)
+swr_convert_prim_topology(const unsigned mode,
+                          const unsigned vertices_per_patch)
 {
    switch (mode) {
    case PIPE_PRIM_POINTS:
@@ -66,6 +68,9 @@ swr_convert_prim_topology(const unsigned mode)
       return TOP_TRI_LIST_ADJ;
    case PIPE_PRIM_TRIANGLE_STRIP_ADJACENCY:
       return TOP_TRI_STRIP_ADJ;
+   case PIPE_PRIM_PATCHES:
+      return (enum PRIMITIVE_TOPOLOGY)(TOP_PATCHLIST_BASE
+                                       + vertices_per_patch);
    default:
       assert(0 && "Unknown topology");
       return TOP_UNKNOWN;
@@ -73,6 +78,63 @@ swr_convert_prim_topology(const unsigned mode)
 };
 
 
+static boolean
+swr_has_user_buffers(struct swr_context *ctx,
+                     const struct pipe_draw_info *info)
+{
+   for (uint32_t i = 0; i < ctx->num_vertex_buffers; i++)
+      if (ctx->vertex_buffer[i].user_buffer)
+         return TRUE;
+
+   return info->indexed && ctx->index_buffer.user_buffer;
+}
+
+
+/*
+ * Queue an indirect draw.  The core reads the arguments, and the draw
+ * count for multi-draws, when it executes the draw, so nothing is mapped
+ * or waited for here.
+ */
+static void
+swr_draw_indirect(struct pipe_context *pipe,
+                  const struct pipe_draw_info *info)
+{
+   struct swr_context *ctx = swr_context(pipe);
+   uint64_t seq = swr_fence_next(ctx->fence);
+   const uint32_t *draw_count = NULL;
+
+   const uint8_t *args =
+      (const uint8_t *)swr_resource_data(info->indirect)
+      + info->indirect_offset;
+   swr_resource_read(pipe, swr_resource(info->indirect), seq);
+
+   if (info->indirect_params) {
+      draw_count = (const uint32_t *)
+         ((const uint8_t *)swr_resource_data(info->indirect_params)
+          + info->indirect_params_offset);
+      swr_resource_read(pipe, swr_resource(info->indirect_params), seq);
+   }
+
+   enum PRIMITIVE_TOPOLOGY topology =
+      swr_convert_prim_topology(info->mode, info->vertices_per_patch);
+
+   if (info->indexed)
+      SwrDrawIndexedIndirect(ctx->swrContext,
+                             topology,
+                             args,
+                             info->indirect_count,
+                             info->indirect_stride,
+                             draw_count);
+   else
+      SwrDrawIndirect(ctx->swrContext,
+                      topology,
+                      args,
+                      info->indirect_count,
+                      info->indirect_stride,
+                      draw_count);
+}
+
+
 /*
  * Draw vertex arrays, with optional indexing, optional instancing.
  */
@@ -81,26 +143,74 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
 {
    struct swr_context *ctx = swr_context(pipe);
 
-   if (!swr_check_render_cond(pipe))
+   /* The core only discards back-end work of draws failing the render
+    * condition, stream output has to be skipped here */
+   if (ctx->num_so_targets && !swr_check_render_cond(pipe))
       return;
 
-   if (info->indirect) {
+   /* Client arrays are copied to scratch space using the index bounds of
+    * the draw, which aren't known before the indirect arguments are read */
+   if (info->indirect && swr_has_user_buffers(ctx, info)) {
       util_draw_indirect(pipe, info);
       return;
    }
 
-   /* Update derived state, pass draw info to update function */
-   if (ctx->dirty)
+   /* Pass through control shaders and the control point counts depend on
+    * the patch size */
+   if (info->mode == PIPE_PRIM_PATCHES
+       && info->vertices_per_patch != ctx->patch_vertices) {
+      ctx->patch_vertices = info->vertices_per_patch;
+      ctx->dirty |= SWR_NEW_TS;
+   }
+
+   /* Buffers renamed by any context since the last draw moved to storage
+    * the derived state doesn't point at yet */
+   struct swr_screen *screen = swr_screen(pipe->screen);
+   unsigned renames = p_atomic_read(&screen->buffer_renames);
+   if (ctx->buffer_renames != renames) {
+      ctx->buffer_renames = renames;
+      ctx->dirty |= SWR_NEW_VERTEX | SWR_NEW_VSCONSTANTS
+         | SWR_NEW_FSCONSTANTS | SWR_NEW_SAMPLER_VIEW | SWR_NEW_SO;
+   }
+
+   /* Update derived state, pass draw info to update function.  The core
+    * carries the draw context over to later draws, so it only needs to be
+    * uploaded again when derived state changed.  Draws that make no other
+    * API call are batched together by the core. */
+   unsigned dirty = ctx->dirty;
+   if (ctx->dirty) {
       swr_update_derived(pipe, info);
+      swr_update_draw_context(ctx);
+   }
 
-   swr_update_draw_context(ctx);
+   /* Tag the bound resources with the sync that retires this draw */
+   if (dirty || ctx->status_seq != swr_fence_next(ctx->fence))
+      swr_update_resource_status(pipe, info);
+
+   /* Stream output captures the last stage before the rasterizer, in the
+    * topology that stage produces */
+   struct pipe_stream_output_info *so;
+   PFN_SO_FUNC *soFunc;
+   unsigned so_prim;
+   if (ctx->gs) {
+      so = &ctx->gs->pipe.stream_output;
+      soFunc = ctx->gs->soFunc;
+      so_prim = ctx->gs->info.base.properties[TGSI_PROPERTY_GS_OUTPUT_PRIM];
+   } else if (ctx->tes) {
+      so = &ctx->tes->pipe.stream_output;
+      soFunc = ctx->tes->soFunc;
+      so_prim = ctx->tes->output_prim;
+   } else {
+      so = &ctx->vs->pipe.stream_output;
+      soFunc = ctx->vs->soFunc;
+      so_prim = info->mode;
+   }
 
-   if (ctx->vs->pipe.stream_output.num_outputs) {
-      if (!ctx->vs->soFunc[info->mode]) {
+   if (so->num_outputs) {
+      if (!soFunc[so_prim]) {
          STREAMOUT_COMPILE_STATE state = {0};
-         struct pipe_stream_output_info *so = &ctx->vs->pipe.stream_output;
 
-         state.numVertsPerPrim = u_vertices_per_prim(info->mode);
+         state.numVertsPerPrim = u_vertices_per_prim(so_prim);
 
          uint32_t offsets[MAX_SO_STREAMS] = {0};
          uint32_t num = 0;
@@ -133,12 +243,12 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
          state.stream.numDecls = num;
 
          HANDLE hJitMgr = swr_screen(pipe->screen)->hJitMgr;
-         ctx->vs->soFunc[info->mode] = JitCompileStreamout(hJitMgr, state);
-         debug_printf("so shader    %p\n", ctx->vs->soFunc[info->mode]);
-         assert(ctx->vs->soFunc[info->mode] && "Error: SoShader = NULL");
+         soFunc[so_prim] = JitCompileStreamout(hJitMgr, state);
+         debug_printf("so shader    %p\n", soFunc[so_prim]);
+         assert(soFunc[so_prim] && "Error: SoShader = NULL");
       }
 
-      SwrSetSoFunc(ctx->swrContext, ctx->vs->soFunc[info->mode], 0);
+      SwrSetSoFunc(ctx->swrContext, soFunc[so_prim], 0);
    }
 
    struct swr_vertex_element_state *velems = ctx->velems;
@@ -157,11 +267,22 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
       assert(velems->fsFunc && "Error: FetchShader = NULL");
    }
 
-   SwrSetFetchFunc(ctx->swrContext, velems->fsFunc);
+   if (ctx->fetch_func != velems->fsFunc) {
+      SwrSetFetchFunc(ctx->swrContext, velems->fsFunc);
+      ctx->fetch_func = velems->fsFunc;
+   }
+
+   if (info->indirect) {
+      swr_draw_indirect(pipe, info);
+      return;
+   }
+
+   enum PRIMITIVE_TOPOLOGY topology =
+      swr_convert_prim_topology(info->mode, info->vertices_per_patch);
 
    if (info->indexed)
       SwrDrawIndexedInstanced(ctx->swrContext,
-                              swr_convert_prim_topology(info->mode),
+                              topology,
                               info->count,
                               info->instance_count,
                               info->start,
@@ -169,7 +290,7 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
                               info->start_instance);
    else
       SwrDrawInstanced(ctx->swrContext,
-                       swr_convert_prim_topology(info->mode),
+                       topology,
                        info->count,
                        info->instance_count,
                        info->start,
@@ -183,7 +304,6 @@ swr_flush(struct pipe_context *pipe,
           unsigned flags)
 {
    struct swr_context *ctx = swr_context(pipe);
-   struct swr_screen *screen = swr_screen(pipe->screen);
    struct pipe_surface *cb = ctx->framebuffer.cbufs[0];
 
    /* If the current renderTarget is the display surface, store tiles back to
@@ -191,10 +311,14 @@ swr_flush(struct pipe_context *pipe,
     * Other renderTargets get stored back when attachment changes or
     * swr_surface_destroy */
    if (cb && swr_resource(cb->texture)->display_target)
-      swr_store_resource(pipe, cb->texture, SWR_TILE_RESOLVED);
+      swr_store_resource(pipe, cb->texture, SWR_TILE_RESOLVED, NULL);
+
+   /* Queue a sync behind everything submitted so far, for the returned
+    * fence and for other contexts waiting on resources drawn here */
+   swr_fence_submit(ctx, ctx->fence);
 
    if (fence)
-      swr_fence_reference(pipe->screen, fence, screen->flush_fence);
+      swr_fence_reference(pipe->screen, fence, ctx->fence);
 }
 
 void
@@ -203,18 +327,20 @@ swr_finish(struct pipe_context *pipe)
    struct pipe_fence_handle *fence = nullptr;
 
    swr_flush(pipe, &fence, 0);
-   swr_fence_finish(pipe->screen, fence, 0);
+   swr_fence_finish(pipe->screen, fence, PIPE_TIMEOUT_INFINITE);
    swr_fence_reference(pipe->screen, &fence, NULL);
 }
 
 
 /*
- * Store SWR HotTiles back to renderTarget surface.
+ * Store SWR HotTiles back to renderTarget surface.  If box is given, only
+ * the macrotiles it overlaps are stored.
  */
 void
 swr_store_render_target(struct pipe_context *pipe,
                         uint32_t attachment,
-                        enum SWR_TILE_STATE post_tile_state)
+                        enum SWR_TILE_STATE post_tile_state,
+                        const struct pipe_box *box)
 {
    struct swr_context *ctx = swr_context(pipe);
    struct swr_draw_context *pDC = &ctx->swrDC;
@@ -222,6 +348,9 @@ swr_store_render_target(struct pipe_context *pipe,
 
    /* Only proceed if there's a valid surface to store to */
    if (renderTarget->pBaseAddress) {
+      /* Don't overwrite a display target that is still being presented */
+      swr_present_wait(swr_screen(pipe->screen), renderTarget->pBaseAddress);
+
       /* Set viewport to full renderTarget width/height and disable scissor
        * before StoreTiles */
       boolean change_viewport =
@@ -241,10 +370,20 @@ swr_store_render_target(struct pipe_context *pipe,
          SwrSetRastState(ctx->swrContext, &ctx->derived.rastState);
       }
 
+      SWR_RECT rect, *pRect = NULL;
+      if (box) {
+         rect.left = box->x;
+         rect.right = box->x + box->width;
+         rect.top = box->y;
+         rect.bottom = box->y + box->height;
+         pRect = &rect;
+      }
+
       swr_update_draw_context(ctx);
       SwrStoreTiles(ctx->swrContext,
                     (enum SWR_RENDERTARGET_ATTACHMENT)attachment,
-                    post_tile_state);
+                    post_tile_state,
+                    pRect);
 
       /* Restore viewport and scissor enable */
       if (change_viewport)
@@ -259,30 +398,37 @@ swr_store_render_target(struct pipe_context *pipe,
 void
 swr_store_resource(struct pipe_context *pipe,
                    struct pipe_resource *resource,
-                   enum SWR_TILE_STATE post_tile_state)
+                   enum SWR_TILE_STATE post_tile_state,
+                   const struct pipe_box *box)
 {
    /* Only store resource if it has been written to */
    if (swr_resource(resource)->status & SWR_RESOURCE_WRITE) {
       struct swr_context *ctx = swr_context(pipe);
-      struct swr_screen *screen = swr_screen(pipe->screen);
       struct swr_resource *spr = swr_resource(resource);
 
       swr_draw_context *pDC = &ctx->swrDC;
       SWR_SURFACE_STATE *renderTargets = pDC->renderTargets;
       for (uint32_t i = 0; i < SWR_NUM_ATTACHMENTS; i++)
          if (renderTargets[i].pBaseAddress == spr->swr.pBaseAddress) {
-            swr_store_render_target(pipe, i, post_tile_state);
+            swr_store_render_target(pipe, i, post_tile_state, box);
 
             /* Mesa thinks depth/stencil are fused, so we'll never get an
              * explicit resource for stencil.  So, if checking depth, then
              * also check for stencil. */
             if (spr->has_stencil && (i == SWR_ATTACHMENT_DEPTH)) {
                swr_store_render_target(
-                  pipe, SWR_ATTACHMENT_STENCIL, post_tile_state);
+                  pipe, SWR_ATTACHMENT_STENCIL, post_tile_state, box);
             }
 
-            /* This fence signals StoreTiles completion */
-            swr_fence_submit(ctx, screen->flush_fence);
+            /* This sync signals StoreTiles completion */
+            swr_fence_submit(ctx, ctx->fence);
+            uint64_t seq = swr_fence(ctx->fence)->write;
+            swr_resource_use(pipe, spr, seq);
+
+            /* ... and the resolve of multisampled color tiles */
+            if (spr->resolve_target)
+               swr_resource_read(pipe, swr_resource(spr->resolve_target),
+                                 seq);
 
             break;
          }
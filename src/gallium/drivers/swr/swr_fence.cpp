@@ -27,11 +27,11 @@
 
 #include "swr_context.h"
 #include "swr_screen.h"
+#include "swr_resource.h"
 #include "swr_fence.h"
 
-#if defined(PIPE_CC_MSVC) // portable thread yield
-   #define sched_yield SwitchToThread
-#endif
+#include <chrono>
+#include <new>
 
 /*
  * Fence callback, called by back-end thread on completion of all rendering up
@@ -43,7 +43,9 @@ swr_sync_cb(UINT64 userData, UINT64 userData2, UINT64 userData3)
    struct swr_fence *fence = (struct swr_fence *)userData;
 
    /* Correct value is in SwrSync data, and not the fence write field. */
+   std::lock_guard<std::mutex> lock(fence->mutex);
    fence->read = userData2;
+   fence->cond.notify_all();
 }
 
 /*
@@ -54,9 +56,8 @@ swr_fence_submit(struct swr_context *ctx, struct pipe_fence_handle *fh)
 {
    struct swr_fence *fence = swr_fence(fh);
 
-   fence->write++;
-   fence->pending = TRUE;
-   SwrSync(ctx->swrContext, swr_sync_cb, (UINT64)fence, fence->write, 0);
+   uint64_t seq = ++fence->write;
+   SwrSync(ctx->swrContext, swr_sync_cb, (UINT64)fence, seq, 0);
 }
 
 /*
@@ -66,11 +67,13 @@ struct pipe_fence_handle *
 swr_fence_create()
 {
    static int fence_id = 0;
-   struct swr_fence *fence = CALLOC_STRUCT(swr_fence);
+   struct swr_fence *fence = new (std::nothrow) struct swr_fence;
    if (!fence)
       return NULL;
 
    pipe_reference_init(&fence->reference, 1);
+   fence->read = 0;
+   fence->write = 0;
    fence->id = fence_id++;
 
    return (struct pipe_fence_handle *)fence;
@@ -80,7 +83,7 @@ swr_fence_create()
 static void
 swr_fence_destroy(struct swr_fence *fence)
 {
-   FREE(fence);
+   delete fence;
 }
 
 /**
@@ -105,11 +108,32 @@ swr_fence_reference(struct pipe_screen *screen,
       swr_fence_destroy(old);
 }
 
-static INLINE boolean
-swr_is_fence_done(struct pipe_fence_handle *fence_handle)
+/*
+ * Wait until the sync with sequence number seq has retired, or timeout
+ * nanoseconds have passed.  Sleeps on the fence condition variable instead
+ * of spinning.
+ */
+boolean
+swr_fence_wait(struct pipe_fence_handle *fence_handle,
+               uint64_t seq,
+               uint64_t timeout)
 {
    struct swr_fence *fence = swr_fence(fence_handle);
-   return (fence->read == fence->write);
+
+   if (fence->read >= seq)
+      return TRUE;
+   if (timeout == 0)
+      return FALSE;
+
+   std::unique_lock<std::mutex> lock(fence->mutex);
+   auto done = [fence, seq] { return fence->read >= seq; };
+
+   if (timeout == PIPE_TIMEOUT_INFINITE) {
+      fence->cond.wait(lock, done);
+      return TRUE;
+   }
+
+   return fence->cond.wait_for(lock, std::chrono::nanoseconds(timeout), done);
 }
 
 /*
@@ -120,14 +144,109 @@ swr_fence_finish(struct pipe_screen *screen,
                  struct pipe_fence_handle *fence_handle,
                  uint64_t timeout)
 {
-   while (!swr_is_fence_done(fence_handle))
-      sched_yield();
+   return swr_fence_wait(
+      fence_handle, swr_fence(fence_handle)->write, timeout);
+}
+
+/*
+ * Record that the draws queued on pipe up to the sync with sequence number
+ * seq on its fence reference the resource.  Each context using the
+ * resource gets a slot; slots whose draws have retired are recycled.
+ */
+void
+swr_resource_use(struct pipe_context *pipe,
+                 struct swr_resource *spr,
+                 uint64_t seq)
+{
+   struct pipe_fence_handle *fence = swr_context(pipe)->fence;
+   struct swr_resource_use *use = NULL;
 
-   swr_fence(fence_handle)->pending = FALSE;
+   for (unsigned i = 0; i < SWR_MAX_RESOURCE_USES && !use; i++)
+      if (spr->uses[i].fence == fence)
+         use = &spr->uses[i];
+
+   for (unsigned i = 0; i < SWR_MAX_RESOURCE_USES && !use; i++)
+      if (!spr->uses[i].fence
+          || swr_fence_retired(spr->uses[i].fence, spr->uses[i].seq))
+         use = &spr->uses[i];
+
+   if (!use) {
+      /* Every slot holds draws of another context.  Wait for what that
+       * context has submitted, as it can't be made to submit from here. */
+      use = &spr->uses[0];
+      uint64_t submitted = swr_fence(use->fence)->write;
+      swr_fence_wait(use->fence, MIN2(use->seq, submitted),
+                     PIPE_TIMEOUT_INFINITE);
+   }
 
+   if (use->fence != fence) {
+      swr_fence_reference(pipe->screen, &use->fence, fence);
+      use->seq = seq;
+   } else
+      use->seq = MAX2(use->seq, seq);
+}
+
+boolean
+swr_resource_uses_retired(const struct swr_resource_use *uses)
+{
+   for (unsigned i = 0; i < SWR_MAX_RESOURCE_USES; i++)
+      if (uses[i].fence && !swr_fence_retired(uses[i].fence, uses[i].seq))
+         return FALSE;
    return TRUE;
 }
 
+void
+swr_resource_uses_release(struct swr_resource_use *uses)
+{
+   for (unsigned i = 0; i < SWR_MAX_RESOURCE_USES; i++)
+      swr_fence_reference(NULL, &uses[i].fence, NULL);
+}
+
+/*
+ * Whether draws referencing the resource are still queued.  Doesn't submit
+ * anything, so it is cheap enough to probe with.
+ */
+boolean
+swr_resource_busy(const struct swr_resource *spr)
+{
+   return spr->status && !swr_resource_uses_retired(spr->uses);
+}
+
+/*
+ * Wait only for the draws that reference the resource, as recorded in
+ * its uses, rather than for all outstanding rendering.  Submits a sync on
+ * pipe if none has been queued behind its draws yet.  Draws another context
+ * hasn't submitted a sync for are only waited for up to its last sync;
+ * st/mesa flushes a context before sharing its results.
+ */
+boolean
+swr_resource_finish(struct pipe_context *pipe,
+                    struct swr_resource *spr,
+                    uint64_t timeout)
+{
+   if (!spr->status)
+      return TRUE;
+
+   for (unsigned i = 0; i < SWR_MAX_RESOURCE_USES; i++) {
+      struct swr_resource_use *use = &spr->uses[i];
+      if (!use->fence || swr_fence_retired(use->fence, use->seq))
+         continue;
+
+      uint64_t seq = use->seq;
+      if (seq > swr_fence(use->fence)->write) {
+         if (pipe && use->fence == swr_context(pipe)->fence)
+            swr_fence_submit(swr_context(pipe), use->fence);
+         else
+            seq = swr_fence(use->fence)->write;
+      }
+
+      if (!swr_fence_wait(use->fence, seq, timeout))
+         return FALSE;
+   }
+
+   swr_resource_unused(pipe, spr);
+   return TRUE;
+}
 
 uint64_t
 swr_get_timestamp(struct pipe_screen *screen)
@@ -142,9 +261,4 @@ swr_fence_init(struct pipe_screen *p_screen)
    p_screen->fence_reference = swr_fence_reference;
    p_screen->fence_finish = swr_fence_finish;
    p_screen->get_timestamp = swr_get_timestamp;
-
-   /* Create persistant StoreTiles "flush" fence, used to signal completion
-    * of flushing tile state back to resource texture, via StoreTiles. */
-   struct swr_screen *screen = swr_screen(p_screen);
-   screen->flush_fence = swr_fence_create();
 }
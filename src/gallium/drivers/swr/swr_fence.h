@@ -25,17 +25,29 @@
 #include "pipe/p_state.h"
 #include "util/u_inlines.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 struct pipe_screen;
+struct swr_context;
+struct swr_resource;
+struct swr_resource_use;
 
 struct swr_fence {
    struct pipe_reference reference;
 
-   uint64_t read;
-   uint64_t write;
-
-   unsigned pending;
+   /* Sequence number of the last retired (read) and submitted (write)
+    * SwrSync.  Syncs retire in submission order.  Only the owning context
+    * submits, but other contexts and the present thread poll both. */
+   std::atomic<uint64_t> read;
+   std::atomic<uint64_t> write;
 
    unsigned id; /* Just for reference */
+
+   /* Signalled by the back-end whenever read advances */
+   std::mutex mutex;
+   std::condition_variable cond;
 };
 
 
@@ -45,10 +57,18 @@ swr_fence(struct pipe_fence_handle *fence)
    return (struct swr_fence *)fence;
 }
 
+/* Sequence number of the next sync submitted on the fence, which retires
+ * everything queued since the last one */
+static INLINE uint64_t
+swr_fence_next(struct pipe_fence_handle *fence_handle)
+{
+   return swr_fence(fence_handle)->write + 1;
+}
+
 static INLINE boolean
-swr_is_fence_pending(struct pipe_fence_handle *fence_handle)
+swr_fence_retired(struct pipe_fence_handle *fence_handle, uint64_t seq)
 {
-   return swr_fence(fence_handle)->pending;
+   return swr_fence(fence_handle)->read >= seq;
 }
 
 
@@ -64,6 +84,20 @@ boolean swr_fence_finish(struct pipe_screen *screen,
                          struct pipe_fence_handle *fence_handle,
                          uint64_t timeout);
 
+boolean swr_fence_wait(struct pipe_fence_handle *fence_handle,
+                       uint64_t seq,
+                       uint64_t timeout);
+
+boolean swr_resource_busy(const struct swr_resource *spr);
+
+boolean swr_resource_finish(struct pipe_context *pipe,
+                            struct swr_resource *spr,
+                            uint64_t timeout);
+
+boolean swr_resource_uses_retired(const struct swr_resource_use *uses);
+
+void swr_resource_uses_release(struct swr_resource_use *uses);
+
 void
 swr_fence_submit(struct swr_context *ctx, struct pipe_fence_handle *fence);
 
@@ -37,6 +37,26 @@ void StoreHotTile(
     UINT x, UINT y, uint32_t renderTargetArrayIndex,
     BYTE *pSrcHotTile);
 
+void StoreHotTileResolve(
+    SWR_SURFACE_STATE *pDstSurface,
+    SWR_FORMAT srcFormat,
+    SWR_RENDERTARGET_ATTACHMENT renderTargetIndex,
+    UINT x, UINT y, uint32_t renderTargetArrayIndex,
+    BYTE *pSrcHotTile,
+    uint32_t numSamples);
+
+bool LoadHotTileJit(
+    PFN_LOAD_TILE_JIT_FUNC pfnLoadTile,
+    SWR_SURFACE_STATE *pSrcSurface,
+    UINT x, UINT y, uint32_t renderTargetArrayIndex,
+    BYTE *pDstHotTile);
+
+bool StoreHotTileJit(
+    PFN_STORE_TILE_JIT_FUNC pfnStoreTile,
+    SWR_SURFACE_STATE *pDstSurface,
+    UINT x, UINT y, uint32_t renderTargetArrayIndex,
+    BYTE *pSrcHotTile);
+
 void StoreHotTileClear(
     SWR_SURFACE_STATE *pDstSurface,
     SWR_RENDERTARGET_ATTACHMENT renderTargetIndex,
@@ -55,6 +75,11 @@ swr_LoadHotTile(HANDLE hPrivateContext,
    swr_draw_context *pDC = (swr_draw_context*)hPrivateContext;
    SWR_SURFACE_STATE *pSrcSurface = &pDC->renderTargets[renderTargetIndex];
 
+   if (renderTargetIndex <= SWR_ATTACHMENT_COLOR7 &&
+       LoadHotTileJit(pDC->pfnLoadTile[renderTargetIndex], pSrcSurface,
+                      x, y, renderTargetArrayIndex, pDstHotTile))
+      return;
+
    LoadHotTile(pSrcSurface, dstFormat, renderTargetIndex, x, y, renderTargetArrayIndex, pDstHotTile);
 }
 
@@ -69,7 +94,18 @@ swr_StoreHotTile(HANDLE hPrivateContext,
    swr_draw_context *pDC = (swr_draw_context*)hPrivateContext;
    SWR_SURFACE_STATE *pDstSurface = &pDC->renderTargets[renderTargetIndex];
 
-   StoreHotTile(pDstSurface, srcFormat, renderTargetIndex, x, y, renderTargetArrayIndex, pSrcHotTile);
+   if (renderTargetIndex > SWR_ATTACHMENT_COLOR7 ||
+       !StoreHotTileJit(pDC->pfnStoreTile[renderTargetIndex], pDstSurface,
+                        x, y, renderTargetArrayIndex, pSrcHotTile))
+      StoreHotTile(pDstSurface, srcFormat, renderTargetIndex, x, y, renderTargetArrayIndex, pSrcHotTile);
+
+   // Multisampled color attachments also resolve into their single sample
+   // copy while the hot tile is still in cache
+   if (renderTargetIndex <= SWR_ATTACHMENT_COLOR7 &&
+       pDC->resolveTargets[renderTargetIndex].pBaseAddress)
+      StoreHotTileResolve(&pDC->resolveTargets[renderTargetIndex], srcFormat,
+                          renderTargetIndex, x, y, renderTargetArrayIndex,
+                          pSrcHotTile, pDstSurface->numSamples);
 }
 
 INLINE void
@@ -24,7 +24,10 @@
 #ifndef SWR_PUBLIC_H
 #define SWR_PUBLIC_H
 
+#include <stdint.h>
+
 struct pipe_screen;
+struct pipe_resource;
 struct sw_winsys;
 struct sw_displaytarget;
 
@@ -38,6 +41,10 @@ struct sw_winsys *swr_get_winsys(struct pipe_screen *pipe);
 
 struct sw_displaytarget *swr_get_displaytarget(struct pipe_resource *resource);
 
+/* Bytes of memory backing the resource's storage.  Lazily committed
+ * textures only count the pages written so far. */
+uint64_t swr_get_committed_size(struct pipe_resource *resource);
+
 
 #ifdef __cplusplus
 }
@@ -29,6 +29,7 @@
 #include "swr_query.h"
 #include "swr_screen.h"
 #include "swr_state.h"
+#include "swr_scratch.h"
 
 
 static struct swr_query *
@@ -42,7 +43,7 @@ swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
 {
    struct swr_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES || type >= PIPE_QUERY_DRIVER_SPECIFIC);
    assert(index < MAX_SO_STREAMS);
 
    pq = CALLOC_STRUCT(swr_query);
@@ -50,172 +51,175 @@ swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
    if (pq) {
       pq->type = type;
       pq->index = index;
+      pq->stats = CALLOC_STRUCT(swr_query_stats);
+      if (!pq->stats) {
+         FREE(pq);
+         return NULL;
+      }
+      pq->stats->type = type;
+      pq->stats->index = index;
    }
 
    return (struct pipe_query *)pq;
 }
 
 
-static void
-swr_destroy_query(struct pipe_context *pipe, struct pipe_query *q)
+/*
+ * Whether queued core work may still write or read the storage of a pair:
+ * its SwrGetStats, or draws under a render condition on it.
+ */
+static boolean
+swr_query_stats_busy(struct swr_context *ctx,
+                     const struct swr_query_stats *stats)
 {
-   struct swr_query *pq = swr_query(q);
+   return stats == ctx->render_cond_stats
+      || !swr_fence_retired(ctx->fence, stats->seq);
+}
 
-   if (pq->fence) {
-      if (!swr_is_fence_pending(pq->fence)) {
-         swr_fence_submit(swr_context(pipe), pq->fence);
-         swr_fence_finish(pipe->screen, pq->fence, 0);
+/*
+ * Free the storage of earlier pairs that nothing queued refers to.
+ */
+static void
+swr_query_collect(struct swr_context *ctx, struct swr_query *pq)
+{
+   struct swr_query_stats **link = &pq->old;
+
+   while (*link) {
+      struct swr_query_stats *stats = *link;
+      if (swr_query_stats_busy(ctx, stats))
+         link = &stats->next;
+      else {
+         *link = stats->next;
+         FREE(stats);
       }
-      swr_fence_reference(pipe->screen, &pq->fence, NULL);
    }
-
-   FREE(pq);
 }
 
 
-// XXX Create a fence callback, rather than stalling SwrWaitForIdle
 static void
-swr_gather_stats(struct pipe_context *pipe, struct swr_query *pq)
+swr_destroy_query(struct pipe_context *pipe, struct pipe_query *q)
 {
    struct swr_context *ctx = swr_context(pipe);
+   struct swr_query *pq = swr_query(q);
 
-   assert(pq->result);
-   union pipe_query_result *result = pq->result;
-   boolean enable_stats = pq->enable_stats;
-   SWR_STATS swr_stats = {0};
-
-   if (pq->fence) {
-      if (!swr_is_fence_pending(pq->fence)) {
-         swr_fence_submit(ctx, pq->fence);
-         swr_fence_finish(pipe->screen, pq->fence, 0);
-      }
-      swr_fence_reference(pipe->screen, &pq->fence, NULL);
-   }
-
-   /*
-    * These queries don't need SWR Stats enabled in the core
-    * Set and return.
-    */
-   switch (pq->type) {
-   case PIPE_QUERY_TIMESTAMP:
-   case PIPE_QUERY_TIME_ELAPSED:
-      result->u64 = swr_get_timestamp(pipe->screen);
-      return;
-      break;
-   case PIPE_QUERY_TIMESTAMP_DISJOINT:
-      /* nothing to do here */
-      return;
-      break;
-   case PIPE_QUERY_GPU_FINISHED:
-      result->b = TRUE; /* XXX TODO Add an api func to SWR to compare drawId
-                           vs LastRetiredId? */
-      return;
-      break;
-   default:
-      /* Any query that needs SwrCore stats */
-      break;
+   if (ctx->render_cond_query == q)
+      pipe->render_condition(pipe, NULL, FALSE, 0);
+
+   /* Queued work may still write the stats, or evaluate a render condition
+    * reading them */
+   pq->stats->next = pq->old;
+   pq->old = pq->stats;
+   swr_query_collect(ctx, pq);
+   if (pq->old) {
+      swr_fence_submit(ctx, ctx->fence);
+      swr_fence_finish(pipe->screen, ctx->fence, PIPE_TIMEOUT_INFINITE);
+      swr_query_collect(ctx, pq);
    }
 
-   /*
-    * All other results are collected from SwrCore counters
-    */
+   FREE(pq);
+}
 
-   /* XXX, Should turn this into a fence callback and skip the stall */
-   SwrGetStats(ctx->swrContext, &swr_stats);
-   /* SwrGetStats returns immediately, wait for collection */
-   SwrWaitForIdle(ctx->swrContext);
 
-   switch (pq->type) {
-   case PIPE_QUERY_OCCLUSION_PREDICATE:
+/*
+ * Queries counted by the SwrCore stats, rather than sampled by the driver.
+ */
+static boolean
+swr_query_uses_core_stats(unsigned type)
+{
+   switch (type) {
    case PIPE_QUERY_OCCLUSION_COUNTER:
-      result->u64 = swr_stats.DepthPassCount;
-      break;
+   case PIPE_QUERY_OCCLUSION_PREDICATE:
    case PIPE_QUERY_PRIMITIVES_GENERATED:
-      result->u64 = swr_stats.IaPrimitives;
-      break;
    case PIPE_QUERY_PRIMITIVES_EMITTED:
-      result->u64 = swr_stats.SoNumPrimsWritten[pq->index];
-      break;
    case PIPE_QUERY_SO_STATISTICS:
-   case PIPE_QUERY_SO_OVERFLOW_PREDICATE: {
-      struct pipe_query_data_so_statistics *so_stats = &result->so_statistics;
-      so_stats->num_primitives_written =
-         swr_stats.SoNumPrimsWritten[pq->index];
-      so_stats->primitives_storage_needed =
-         swr_stats.SoPrimStorageNeeded[pq->index];
-   } break;
-   case PIPE_QUERY_PIPELINE_STATISTICS: {
-      struct pipe_query_data_pipeline_statistics *p_stats =
-         &result->pipeline_statistics;
-      p_stats->ia_vertices = swr_stats.IaVertices;
-      p_stats->ia_primitives = swr_stats.IaPrimitives;
-      p_stats->vs_invocations = swr_stats.VsInvocations;
-      p_stats->gs_invocations = swr_stats.GsInvocations;
-      p_stats->gs_primitives = swr_stats.GsPrimitives;
-      p_stats->c_invocations = swr_stats.CPrimitives;
-      p_stats->c_primitives = swr_stats.CPrimitives;
-      p_stats->ps_invocations = swr_stats.PsInvocations;
-      p_stats->hs_invocations = swr_stats.HsInvocations;
-      p_stats->ds_invocations = swr_stats.DsInvocations;
-      p_stats->cs_invocations = swr_stats.CsInvocations;
-   } break;
+   case PIPE_QUERY_SO_OVERFLOW_PREDICATE:
+   case PIPE_QUERY_PIPELINE_STATISTICS:
+      return TRUE;
    default:
-      assert(0 && "Unsupported query");
-      break;
+      return FALSE;
    }
-
-   /* Only change stat collection if there are no active queries */
-   if (ctx->active_queries == 0)
-      SwrEnableStats(ctx->swrContext, enable_stats);
 }
 
 
-static boolean
-swr_get_query_result(struct pipe_context *pipe,
-                     struct pipe_query *q,
-                     boolean wait,
-                     union pipe_query_result *result)
+static uint64_t
+swr_query_sample(struct swr_context *ctx, unsigned type)
 {
-   struct swr_context *ctx = swr_context(pipe);
-   struct swr_query *pq = swr_query(q);
-
-   if (pq->fence) {
-      if (!swr_is_fence_pending(pq->fence)) {
-         swr_fence_submit(ctx, pq->fence);
-         if (!wait)
-            return FALSE;
-         swr_fence_finish(pipe->screen, pq->fence, 0);
-      }
-      swr_fence_reference(pipe->screen, &pq->fence, NULL);
+   switch (type) {
+   case PIPE_QUERY_TIMESTAMP:
+   case PIPE_QUERY_TIME_ELAPSED:
+      return swr_get_timestamp(ctx->pipe.screen);
+   case SWR_QUERY_SCRATCH_SIZE:
+      return ctx->scratch->size;
+   case SWR_QUERY_SCRATCH_HIGH_WATER:
+      return ctx->scratch->high_water;
+   case SWR_QUERY_SCRATCH_WAITS:
+      return ctx->scratch->num_waits;
+   case SWR_QUERY_TEXTURE_COMMITTED:
+      return swr_screen(ctx->pipe.screen)->committed_size;
+   default:
+      return 0;
    }
+}
+
+
+/*
+ * Compute the result from the start and end stats.  Called on the API
+ * thread once the end stats have retired, and by the workers to evaluate
+ * render conditions.
+ */
+static void
+swr_query_compute(const struct swr_query_stats *stats,
+                  union pipe_query_result *result)
+{
+   const SWR_STATS *start = &stats->start;
+   const SWR_STATS *end = &stats->end;
+   unsigned index = stats->index;
 
    /* XXX: Need to handle counter rollover */
 
-   switch (pq->type) {
+   switch (stats->type) {
    /* Booleans */
    case PIPE_QUERY_OCCLUSION_PREDICATE:
-      result->b = pq->end.u64 != pq->start.u64 ? TRUE : FALSE;
+      result->b = end->DepthPassCount != start->DepthPassCount;
       break;
    case PIPE_QUERY_GPU_FINISHED:
-      result->b = pq->end.b;
+      result->b = TRUE;
+      break;
+   case PIPE_QUERY_SO_OVERFLOW_PREDICATE:
+      result->b = (end->SoNumPrimsWritten[index]
+                   - start->SoNumPrimsWritten[index])
+         > (end->SoPrimStorageNeeded[index]
+            - start->SoPrimStorageNeeded[index]);
+      break;
+   /* Levels */
+   case SWR_QUERY_SCRATCH_SIZE:
+   case SWR_QUERY_SCRATCH_HIGH_WATER:
+   case SWR_QUERY_TEXTURE_COMMITTED:
+      result->u64 = stats->end_value;
       break;
    /* Counters */
-   case PIPE_QUERY_OCCLUSION_COUNTER:
+   case SWR_QUERY_SCRATCH_WAITS:
    case PIPE_QUERY_TIMESTAMP:
    case PIPE_QUERY_TIME_ELAPSED:
+      result->u64 = stats->end_value - stats->start_value;
+      break;
+   case PIPE_QUERY_OCCLUSION_COUNTER:
+      result->u64 = end->DepthPassCount - start->DepthPassCount;
+      break;
    case PIPE_QUERY_PRIMITIVES_GENERATED:
+      result->u64 = end->IaPrimitives - start->IaPrimitives;
+      break;
    case PIPE_QUERY_PRIMITIVES_EMITTED:
-      result->u64 = pq->end.u64 - pq->start.u64;
+      result->u64 =
+         end->SoNumPrimsWritten[index] - start->SoNumPrimsWritten[index];
       break;
    /* Structures */
    case PIPE_QUERY_SO_STATISTICS: {
       struct pipe_query_data_so_statistics *so_stats = &result->so_statistics;
-      struct pipe_query_data_so_statistics *start = &pq->start.so_statistics;
-      struct pipe_query_data_so_statistics *end = &pq->end.so_statistics;
       so_stats->num_primitives_written =
-         end->num_primitives_written - start->num_primitives_written;
+         end->SoNumPrimsWritten[index] - start->SoNumPrimsWritten[index];
       so_stats->primitives_storage_needed =
-         end->primitives_storage_needed - start->primitives_storage_needed;
+         end->SoPrimStorageNeeded[index] - start->SoPrimStorageNeeded[index];
    } break;
    case PIPE_QUERY_TIMESTAMP_DISJOINT: {
       /* os_get_time_nano returns nanoseconds */
@@ -225,35 +229,46 @@ swr_get_query_result(struct pipe_context *pipe,
    case PIPE_QUERY_PIPELINE_STATISTICS: {
       struct pipe_query_data_pipeline_statistics *p_stats =
          &result->pipeline_statistics;
-      struct pipe_query_data_pipeline_statistics *start =
-         &pq->start.pipeline_statistics;
-      struct pipe_query_data_pipeline_statistics *end =
-         &pq->end.pipeline_statistics;
-      p_stats->ia_vertices = end->ia_vertices - start->ia_vertices;
-      p_stats->ia_primitives = end->ia_primitives - start->ia_primitives;
-      p_stats->vs_invocations = end->vs_invocations - start->vs_invocations;
-      p_stats->gs_invocations = end->gs_invocations - start->gs_invocations;
-      p_stats->gs_primitives = end->gs_primitives - start->gs_primitives;
-      p_stats->c_invocations = end->c_invocations - start->c_invocations;
-      p_stats->c_primitives = end->c_primitives - start->c_primitives;
-      p_stats->ps_invocations = end->ps_invocations - start->ps_invocations;
-      p_stats->hs_invocations = end->hs_invocations - start->hs_invocations;
-      p_stats->ds_invocations = end->ds_invocations - start->ds_invocations;
-      p_stats->cs_invocations = end->cs_invocations - start->cs_invocations;
-   } break;
-   case PIPE_QUERY_SO_OVERFLOW_PREDICATE: {
-      struct pipe_query_data_so_statistics *start = &pq->start.so_statistics;
-      struct pipe_query_data_so_statistics *end = &pq->end.so_statistics;
-      uint64_t num_primitives_written =
-         end->num_primitives_written - start->num_primitives_written;
-      uint64_t primitives_storage_needed =
-         end->primitives_storage_needed - start->primitives_storage_needed;
-      result->b = num_primitives_written > primitives_storage_needed;
+      p_stats->ia_vertices = end->IaVertices - start->IaVertices;
+      p_stats->ia_primitives = end->IaPrimitives - start->IaPrimitives;
+      p_stats->vs_invocations = end->VsInvocations - start->VsInvocations;
+      p_stats->gs_invocations = end->GsInvocations - start->GsInvocations;
+      p_stats->gs_primitives = end->GsPrimitives - start->GsPrimitives;
+      p_stats->c_invocations = end->CPrimitives - start->CPrimitives;
+      p_stats->c_primitives = end->CPrimitives - start->CPrimitives;
+      p_stats->ps_invocations = end->PsInvocations - start->PsInvocations;
+      p_stats->hs_invocations = end->HsInvocations - start->HsInvocations;
+      p_stats->ds_invocations = end->DsInvocations - start->DsInvocations;
+      p_stats->cs_invocations = end->CsInvocations - start->CsInvocations;
    } break;
    default:
       assert(0 && "Unsupported query");
       break;
    }
+}
+
+
+static boolean
+swr_get_query_result(struct pipe_context *pipe,
+                     struct pipe_query *q,
+                     boolean wait,
+                     union pipe_query_result *result)
+{
+   struct swr_context *ctx = swr_context(pipe);
+   struct swr_query_stats *stats = swr_query(q)->stats;
+
+   /* Poll the sync retiring the end stats.  It is submitted once if the
+    * draws haven't been flushed yet, so polling makes progress; syncs
+    * don't stall later draws. */
+   if (!swr_fence_retired(ctx->fence, stats->seq)) {
+      if (stats->seq > swr_fence(ctx->fence)->write)
+         swr_fence_submit(ctx, ctx->fence);
+      if (!swr_fence_wait(ctx->fence, stats->seq,
+                          wait ? PIPE_TIMEOUT_INFINITE : 0))
+         return FALSE;
+   }
+
+   swr_query_compute(stats, result);
 
    return TRUE;
 }
@@ -263,20 +278,33 @@ swr_begin_query(struct pipe_context *pipe, struct pipe_query *q)
 {
    struct swr_context *ctx = swr_context(pipe);
    struct swr_query *pq = swr_query(q);
+   struct swr_query_stats *stats = pq->stats;
+
+   /* The previous pair keeps its storage while queued work refers to it,
+    * the new pair starts from fresh storage */
+   swr_query_collect(ctx, pq);
+   if (swr_query_stats_busy(ctx, stats)) {
+      stats = CALLOC_STRUCT(swr_query_stats);
+      if (!stats)
+         return false;
+      pq->stats->next = pq->old;
+      pq->old = pq->stats;
+      pq->stats = stats;
+   } else
+      memset(stats, 0, sizeof(*stats));
 
    /* Initialize Results */
-   memset(&pq->start, 0, sizeof(pq->start));
-   memset(&pq->end, 0, sizeof(pq->end));
-
-   /* Gather start stats and enable SwrCore counters */
-   pq->result = &pq->start;
-   pq->enable_stats = TRUE;
-   swr_gather_stats(pipe, pq);
-   ctx->active_queries++;
-
-   /* override start timestamp to 0 for TIMESTAMP query */
-   if (pq->type == PIPE_QUERY_TIMESTAMP)
-      pq->start.u64 = 0;
+   stats->type = pq->type;
+   stats->index = pq->index;
+
+   if (swr_query_uses_core_stats(pq->type)) {
+      /* Start stats are written by the back-end, enable SwrCore counters */
+      SwrGetStats(ctx->swrContext, &stats->start);
+      SwrEnableStats(ctx->swrContext, TRUE);
+      ctx->active_queries++;
+   } else {
+      stats->start_value = swr_query_sample(ctx, pq->type);
+   }
 
    return true;
 }
@@ -286,24 +314,97 @@ swr_end_query(struct pipe_context *pipe, struct pipe_query *q)
 {
    struct swr_context *ctx = swr_context(pipe);
    struct swr_query *pq = swr_query(q);
+   struct swr_query_stats *stats = pq->stats;
+
+   if (swr_query_uses_core_stats(pq->type)) {
+      assert(ctx->active_queries
+             && "swr_end_query, there are no active queries!");
+      ctx->active_queries--;
+
+      /* End stats are written when the draws issued so far retire.  Only
+       * disable SwrCore counters if there are no active queries. */
+      SwrGetStats(ctx->swrContext, &stats->end);
+      if (ctx->active_queries == 0)
+         SwrEnableStats(ctx->swrContext, FALSE);
+   } else {
+      /* TIMESTAMP and GPU_FINISHED are ended without being begun */
+      stats->end_value = swr_query_sample(ctx, pq->type);
+   }
+
+   /* The result is available once the next sync on the context retires */
+   if (swr_query_uses_core_stats(pq->type)
+       || pq->type == PIPE_QUERY_GPU_FINISHED)
+      stats->seq = swr_fence_next(ctx->fence);
+}
 
-   assert(ctx->active_queries
-          && "swr_end_query, there are no active queries!");
-   ctx->active_queries--;
 
-   /* Gather end stats and disable SwrCore counters */
-   pq->result = &pq->end;
-   pq->enable_stats = FALSE;
-   swr_gather_stats(pipe, pq);
+/*
+ * Render condition callbacks, run by the workers once the SwrGetStats
+ * writing the query's end stats has retired.
+ */
+static bool
+swr_query_nonzero(const struct swr_query_stats *stats)
+{
+   union pipe_query_result result;
+
+   memset(&result, 0, sizeof(result));
+   swr_query_compute(stats, &result);
+
+   return result.u64 != 0;
 }
 
+static bool
+swr_render_condition_true(void *data)
+{
+   return !swr_query_nonzero((const struct swr_query_stats *)data);
+}
+
+static bool
+swr_render_condition_false(void *data)
+{
+   return swr_query_nonzero((const struct swr_query_stats *)data);
+}
 
+
+/*
+ * Hand the current render condition to the core, which discards the
+ * back-end work of draws and clears that fail it without stalling here.
+ */
+void
+swr_update_render_condition(struct pipe_context *pipe)
+{
+   struct swr_context *ctx = swr_context(pipe);
+   struct swr_query *pq = swr_query(ctx->render_cond_query);
+
+   /* Draws queued so far evaluate the condition from the previous pair */
+   if (ctx->render_cond_stats)
+      ctx->render_cond_stats->seq = MAX2(ctx->render_cond_stats->seq,
+                                         swr_fence_next(ctx->fence));
+
+   if (!pq) {
+      ctx->render_cond_stats = NULL;
+      SwrSetRenderCondition(ctx->swrContext, nullptr, nullptr);
+      return;
+   }
+
+   ctx->render_cond_stats = pq->stats;
+   SwrSetRenderCondition(ctx->swrContext,
+                         ctx->render_cond_cond ? swr_render_condition_true
+                                               : swr_render_condition_false,
+                         pq->stats);
+}
+
+
+/*
+ * Evaluate the render condition on the API thread, for work the core
+ * condition doesn't cover: stream output and native blits.
+ */
 boolean
 swr_check_render_cond(struct pipe_context *pipe)
 {
    struct swr_context *ctx = swr_context(pipe);
    boolean b, wait;
-   uint64_t result;
+   union pipe_query_result result;
 
    if (!ctx->render_cond_query)
       return TRUE; /* no query predicate, draw normally */
@@ -311,14 +412,53 @@ swr_check_render_cond(struct pipe_context *pipe)
    wait = (ctx->render_cond_mode == PIPE_RENDER_COND_WAIT
            || ctx->render_cond_mode == PIPE_RENDER_COND_BY_REGION_WAIT);
 
-   b = pipe->get_query_result(
-      pipe, ctx->render_cond_query, wait, (union pipe_query_result *)&result);
+   /* Without waiting, work goes ahead unless the result is already there;
+    * nothing is submitted to find out */
+   if (!wait && !swr_fence_retired(ctx->fence, ctx->render_cond_stats->seq))
+      return TRUE;
+
+   memset(&result, 0, sizeof(result));
+   b = pipe->get_query_result(pipe, ctx->render_cond_query, wait, &result);
    if (b)
-      return (!result == ctx->render_cond_cond);
+      return (!result.u64 == ctx->render_cond_cond);
    else
       return TRUE;
 }
 
+int
+swr_get_driver_query_info(struct pipe_screen *screen,
+                          unsigned index,
+                          struct pipe_driver_query_info *info)
+{
+#define QUERY(NAME, ENUM, UNITS, RESULT) \
+   {NAME, ENUM, {0}, UNITS, RESULT, 0, 0x0}
+
+   static const struct pipe_driver_query_info queries[] = {
+      QUERY("scratch-size", SWR_QUERY_SCRATCH_SIZE,
+            PIPE_DRIVER_QUERY_TYPE_BYTES,
+            PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE),
+      QUERY("scratch-high-water", SWR_QUERY_SCRATCH_HIGH_WATER,
+            PIPE_DRIVER_QUERY_TYPE_BYTES,
+            PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE),
+      QUERY("scratch-waits", SWR_QUERY_SCRATCH_WAITS,
+            PIPE_DRIVER_QUERY_TYPE_UINT64,
+            PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE),
+      QUERY("texture-committed", SWR_QUERY_TEXTURE_COMMITTED,
+            PIPE_DRIVER_QUERY_TYPE_BYTES,
+            PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE),
+   };
+#undef QUERY
+
+   if (!info)
+      return Elements(queries);
+
+   if (index >= Elements(queries))
+      return 0;
+
+   *info = queries[index];
+   return 1;
+}
+
 void
 swr_query_init(struct pipe_context *pipe)
 {
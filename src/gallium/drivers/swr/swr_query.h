@@ -26,21 +26,51 @@
 
 
 #include <limits.h>
+#include "api.h"
 
-struct swr_query {
+/* Storage of one begin/end pair.  The back-end accumulates the core stats
+ * into start and end as the SwrGetStats queued at begin/end retire, and the
+ * workers read them to evaluate render conditions, so the storage of a pair
+ * is only reused once nothing queued refers to it any more. */
+struct swr_query_stats {
    unsigned type; /* PIPE_QUERY_* */
    unsigned index;
 
-   union pipe_query_result *result;
-   union pipe_query_result start;
-   union pipe_query_result end;
+   SWR_STATS start;
+   SWR_STATS end;
+
+   /* Timestamps and driver stats, sampled on the API thread */
+   uint64_t start_value;
+   uint64_t end_value;
 
-   struct pipe_fence_handle *fence;
+   /* Sequence number of the sync on the context fence retiring the end
+    * stats, and the draws a render condition on them applied to */
+   uint64_t seq;
 
-   boolean enable_stats;
+   struct swr_query_stats *next; /* older pairs still in use */
 };
 
+struct swr_query {
+   unsigned type; /* PIPE_QUERY_* */
+   unsigned index;
+
+   struct swr_query_stats *stats; /* current begin/end pair */
+   struct swr_query_stats *old; /* earlier pairs the core may still read */
+};
+
+/* Driver specific queries */
+#define SWR_QUERY_SCRATCH_SIZE (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define SWR_QUERY_SCRATCH_HIGH_WATER (PIPE_QUERY_DRIVER_SPECIFIC + 1)
+#define SWR_QUERY_SCRATCH_WAITS (PIPE_QUERY_DRIVER_SPECIFIC + 2)
+#define SWR_QUERY_TEXTURE_COMMITTED (PIPE_QUERY_DRIVER_SPECIFIC + 3)
+
 extern void swr_query_init(struct pipe_context *pipe);
 
+extern int swr_get_driver_query_info(struct pipe_screen *screen,
+                                     unsigned index,
+                                     struct pipe_driver_query_info *info);
+
+extern void swr_update_render_condition(struct pipe_context *pipe);
+
 extern boolean swr_check_render_cond(struct pipe_context *pipe);
 #endif
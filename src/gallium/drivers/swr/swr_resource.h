@@ -26,6 +26,7 @@
 
 #include "pipe/p_state.h"
 #include "api.h"
+#include "memory/TilingFunctions.h"
 
 struct sw_displaytarget;
 
@@ -35,6 +36,16 @@ enum swr_resource_status {
    SWR_RESOURCE_WRITE = 0x2,
 };
 
+/* Draws of one context reference the resource up to the sync with
+ * sequence number seq on that context's fence */
+struct swr_resource_use {
+   struct pipe_fence_handle *fence;
+   uint64_t seq;
+};
+
+/* Contexts whose outstanding draws are tracked per resource */
+#define SWR_MAX_RESOURCE_USES 2
+
 struct swr_resource {
    struct pipe_resource base;
 
@@ -49,12 +60,34 @@ struct swr_resource {
 
    struct sw_displaytarget *display_target;
 
+   /* Single sample copy of a multisampled color resource, kept up to date
+    * as its hot tiles are stored. */
+   struct pipe_resource *resolve_target;
+
+   /* Large color textures are an anonymous mapping of lazy_size bytes,
+    * whose pages commit on first write and read as zero until then.
+    * committed_pages has a bit per page written, set atomically.
+    * committed_size is the bytes of storage backing the resource, see
+    * swr_get_committed_size. */
+   unsigned lazy_size;
+   uint32_t *committed_pages;
+   uint64_t committed_size;
+
    unsigned row_stride[PIPE_MAX_TEXTURE_LEVELS];
    unsigned img_stride[PIPE_MAX_TEXTURE_LEVELS];
    unsigned mip_offsets[PIPE_MAX_TEXTURE_LEVELS];
 
    enum swr_resource_status status;
 
+   /* CPU writes, bumped as write transfers map and unmap.  Persistent
+    * write maps may write at any time while outstanding. */
+   unsigned write_seq;
+   unsigned persistent_writes;
+
+   /* Syncs retiring the last draws or StoreTiles referencing the
+    * resource, per context. */
+   struct swr_resource_use uses[SWR_MAX_RESOURCE_USES];
+
    /* pipe_context to which resource is currently bound. */
    struct pipe_context *bound_to_context;
 };
@@ -98,18 +131,46 @@ swr_resource_data(struct pipe_resource *resource)
    return swr_r->swr.pBaseAddress;
 }
 
+/*
+ * Sampled textures, render targets included, are stored in Y-major tiles:
+ * 4KB tiles of 128 bytes by 32 rows, made of 16 byte wide columns running
+ * down the tile, so texels neighbouring vertically share cachelines.  The
+ * core loads and stores hot tiles of Y-major surfaces, mapping them goes
+ * through a linear staging copy.
+ */
+#define SWR_TILE_YMAJOR_WIDTH 128 /* bytes */
+#define SWR_TILE_YMAJOR_HEIGHT 32 /* rows */
+
+static INLINE boolean
+swr_resource_is_tiled(const struct swr_resource *res)
+{
+   return res->swr.tileMode == SWR_TILE_MODE_YMAJOR;
+}
+
+typedef TilingTraits<SWR_TILE_MODE_YMAJOR, 32> SWR_YMAJOR_TILING;
+
+
+void swr_resource_commit(struct swr_resource *spr,
+                         unsigned level,
+                         const struct pipe_box *box);
 
 void swr_store_render_target(struct pipe_context *pipe,
                              uint32_t attachment,
-                             enum SWR_TILE_STATE post_tile_state);
+                             enum SWR_TILE_STATE post_tile_state,
+                             const struct pipe_box *box);
 
 void swr_store_resource(struct pipe_context *pipe,
                         struct pipe_resource *resource,
-                        enum SWR_TILE_STATE post_tile_state);
+                        enum SWR_TILE_STATE post_tile_state,
+                        const struct pipe_box *box);
 
 void swr_update_resource_status(struct pipe_context *,
                                 const struct pipe_draw_info *);
 
+void swr_resource_use(struct pipe_context *pipe,
+                      struct swr_resource *spr,
+                      uint64_t seq);
+
 /*
  * Functions to indicate a resource's in-use status.
  */
@@ -120,14 +181,26 @@ swr_resource_status & operator|=(enum swr_resource_status & a,
 }
 
 static INLINE void
-swr_resource_read(struct pipe_context *pipe, struct swr_resource *resource)
+swr_resource_read(struct pipe_context *pipe, struct swr_resource *resource,
+                  uint64_t seq)
 {
    resource->status |= SWR_RESOURCE_READ;
+   swr_resource_use(pipe, resource, seq);
+   resource->bound_to_context = pipe;
+}
+
+static INLINE void
+swr_resource_write(struct pipe_context *pipe, struct swr_resource *resource,
+                   uint64_t seq)
+{
+   resource->status |= SWR_RESOURCE_WRITE;
+   swr_resource_use(pipe, resource, seq);
    resource->bound_to_context = pipe;
 }
 
+/* Hot tiles of the resource in pipe are still dirty after a partial store */
 static INLINE void
-swr_resource_write(struct pipe_context *pipe, struct swr_resource *resource)
+swr_resource_dirty(struct pipe_context *pipe, struct swr_resource *resource)
 {
    resource->status |= SWR_RESOURCE_WRITE;
    resource->bound_to_context = pipe;
@@ -23,10 +23,87 @@
 
 #include "util/u_memory.h"
 #include "swr_context.h"
+#include "swr_screen.h"
 #include "swr_scratch.h"
+#include "swr_fence.h"
 #include "api.h"
 
 
+/*
+ * Make room for a copy of size bytes in a new current chunk.  The oldest
+ * chunk is reused once the draws copying into it retired, or replaced by a
+ * larger chunk if it's too small.  Otherwise the ring grows by a chunk,
+ * unless that takes it past SWR_SCRATCH_MAX_SIZE, in which case the draws
+ * that last used the oldest chunk are waited for instead.  Returns FALSE if
+ * a new chunk can't be allocated.
+ */
+static boolean
+swr_scratch_next_chunk(struct swr_context *ctx,
+                       struct swr_scratch_space *space,
+                       unsigned int size)
+{
+   struct swr_scratch_buffers *scratch = ctx->scratch;
+   struct pipe_fence_handle *fence = ctx->fence;
+   unsigned chunk_size = MAX2(size, SWR_SCRATCH_CHUNK_SIZE);
+
+   while (space->current) {
+      struct swr_scratch_chunk *current = space->current;
+      struct swr_scratch_chunk *oldest = current->next;
+
+      if (!swr_fence_retired(fence, oldest->seq)) {
+         if (space->size + chunk_size <= SWR_SCRATCH_MAX_SIZE)
+            break;
+
+         if (oldest->seq > swr_fence(fence)->write)
+            swr_fence_submit(ctx, fence);
+         swr_fence_wait(fence, oldest->seq, PIPE_TIMEOUT_INFINITE);
+         scratch->num_waits++;
+      }
+
+      if (oldest->size >= size) {
+         space->current = oldest;
+         space->head = 0;
+         return TRUE;
+      }
+
+      /* Too small for this copy, replace it by a larger chunk */
+      if (oldest == current)
+         space->current = NULL;
+      else
+         current->next = oldest->next;
+      space->size -= oldest->size;
+      scratch->size -= oldest->size;
+      align_free(oldest->data);
+      FREE(oldest);
+   }
+
+   struct swr_scratch_chunk *chunk = CALLOC_STRUCT(swr_scratch_chunk);
+   if (!chunk)
+      return FALSE;
+
+   chunk->size = chunk_size;
+   chunk->data = (BYTE *)align_malloc(chunk->size, 64);
+   if (!chunk->data) {
+      FREE(chunk);
+      return FALSE;
+   }
+
+   struct swr_scratch_chunk *current = space->current;
+   if (current) {
+      chunk->next = current->next;
+      current->next = chunk;
+   } else
+      chunk->next = chunk;
+   space->current = chunk;
+   space->head = 0;
+
+   space->size += chunk->size;
+   scratch->size += chunk->size;
+   scratch->high_water = MAX2(scratch->high_water, scratch->size);
+
+   return TRUE;
+}
+
 void *
 swr_copy_to_scratch_space(struct swr_context *ctx,
                           struct swr_scratch_space *space,
@@ -38,48 +115,16 @@ swr_copy_to_scratch_space(struct swr_context *ctx,
    assert(user_buffer);
    assert(size);
 
-   if (size >= 2048) { /* XXX TODO create KNOB_ for this */
-      /* Use per draw SwrAllocDrawContextMemory for larger copies */
-      ptr = SwrAllocDrawContextMemory(ctx->swrContext, size, 4);
-   } else {
-      /* Allocate enough so that MAX_DRAWS_IN_FLIGHT sets fit. */
-      unsigned int max_size_in_flight = size * KNOB_MAX_DRAWS_IN_FLIGHT;
-
-      /* Need to grow space */
-      if (max_size_in_flight > space->current_size) {
-         /* Must idle the pipeline, this is infrequent */
-         SwrWaitForIdle(ctx->swrContext);
-
-         space->current_size = max_size_in_flight;
-
-         if (space->base) {
-            align_free(space->base);
-            space->base = NULL;
-         }
-
-         if (!space->base) {
-            space->base = (BYTE *)align_malloc(space->current_size, 4);
-            space->head = (void *)space->base;
-         }
-      }
+   if (!space->current || space->head + size > space->current->size) {
+      if (!swr_scratch_next_chunk(ctx, space, size))
+         return NULL;
+   }
 
-      /* Wrap */
-      if (((BYTE *)space->head + size)
-          >= ((BYTE *)space->base + space->current_size)) {
-         /*
-          * TODO XXX: Should add a fence on wrap.  Assumption is that
-          * current_space >> size, and there are at least MAX_DRAWS_IN_FLIGHT
-          * draws in scratch.  So fence would always be met on wrap.  A fence
-          * would ensure that first frame in buffer is done before wrapping.
-          * If fence ever needs to be waited on, can increase buffer size.
-          * So far in testing, this hasn't been necessary.
-          */
-         space->head = space->base;
-      }
+   ptr = space->current->data + space->head;
+   space->head += align(size, 16);
 
-      ptr = space->head;
-      space->head = (BYTE *)space->head + size;
-   }
+   /* Retired by the next sync on the context fence, like the draw */
+   space->current->seq = swr_fence_next(ctx->fence);
 
    /* Copy user_buffer to scratch */
    memcpy(ptr, user_buffer, size);
@@ -97,20 +142,39 @@ swr_init_scratch_buffers(struct swr_context *ctx)
    ctx->scratch = scratch;
 }
 
+static void
+swr_free_scratch_space(struct swr_scratch_space *space)
+{
+   struct swr_scratch_chunk *chunk = space->current;
+
+   if (!chunk)
+      return;
+
+   /* Break the ring, then free it in order */
+   struct swr_scratch_chunk *next = chunk->next;
+   chunk->next = NULL;
+   while (next) {
+      chunk = next;
+      next = chunk->next;
+      align_free(chunk->data);
+      FREE(chunk);
+   }
+}
+
 void
 swr_destroy_scratch_buffers(struct swr_context *ctx)
 {
    struct swr_scratch_buffers *scratch = ctx->scratch;
 
    if (scratch) {
-      if (scratch->vs_constants.base)
-         align_free(scratch->vs_constants.base);
-      if (scratch->fs_constants.base)
-         align_free(scratch->fs_constants.base);
-      if (scratch->vertex_buffer.base)
-         align_free(scratch->vertex_buffer.base);
-      if (scratch->index_buffer.base)
-         align_free(scratch->index_buffer.base);
+      swr_free_scratch_space(&scratch->vs_constants);
+      swr_free_scratch_space(&scratch->fs_constants);
+      swr_free_scratch_space(&scratch->gs_constants);
+      swr_free_scratch_space(&scratch->tcs_constants);
+      swr_free_scratch_space(&scratch->tes_constants);
+      swr_free_scratch_space(&scratch->cs_constants);
+      swr_free_scratch_space(&scratch->vertex_buffer);
+      swr_free_scratch_space(&scratch->index_buffer);
       FREE(scratch);
    }
 }
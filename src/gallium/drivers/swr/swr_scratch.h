@@ -24,19 +24,43 @@
 #ifndef SWR_SCRATCH_H
 #define SWR_SCRATCH_H
 
-struct swr_scratch_space {
-   void *head;
-   unsigned int current_size;
-   /* TODO XXX: Add a fence for wrap condition. */
+/* Scratch chunks smaller than this are never allocated */
+#define SWR_SCRATCH_CHUNK_SIZE (256 * 1024)
+
+/* Size a scratch space grows to before it waits for draws instead */
+#define SWR_SCRATCH_MAX_SIZE (16 * 1024 * 1024)
 
-   void *base;
+/* Chunk of a scratch ring, reusable once the fence of the owning context
+ * reaches seq.  Only that context submits on its fence, so seq and the
+ * fence's atomic sequences never mix with other contexts' syncs. */
+struct swr_scratch_chunk {
+   struct swr_scratch_chunk *next; /* ring order, oldest after current */
+   unsigned size;
+   uint64_t seq;
+
+   BYTE *data;
+};
+
+struct swr_scratch_space {
+   struct swr_scratch_chunk *current; /* chunk being filled */
+   unsigned head; /* offset of the next copy in current */
+   unsigned size; /* total size of the ring */
 };
 
 struct swr_scratch_buffers {
    struct swr_scratch_space vs_constants;
    struct swr_scratch_space fs_constants;
+   struct swr_scratch_space gs_constants;
+   struct swr_scratch_space tcs_constants;
+   struct swr_scratch_space tes_constants;
+   struct swr_scratch_space cs_constants;
    struct swr_scratch_space vertex_buffer;
    struct swr_scratch_space index_buffer;
+
+   /* Statistics, exposed as driver queries */
+   uint64_t size; /* scratch memory currently allocated */
+   uint64_t high_water; /* most scratch memory ever allocated */
+   uint64_t num_waits; /* waits for draws to reuse a chunk */
 };
 
 
@@ -44,13 +68,15 @@ struct swr_scratch_buffers {
  * swr_copy_to_scratch_space
  * Copies size bytes of user_buffer into the scratch ring buffer.
  * Used to store temporary data such as client arrays and constants.
+ * The copy stays valid until the sync submitted on the context fence after
+ * the draw using it retires.
  *
  * Inputs:
  *   space ptr to scratch pool (vs_constants, fs_constants)
  *   user_buffer, data to copy into scratch space
  *   size to be copied
  * Returns:
- *   pointer to data copied to scratch space.
+ *   pointer to data copied to scratch space, NULL if out of memory.
  */
 void *swr_copy_to_scratch_space(struct swr_context *ctx,
                                 struct swr_scratch_space *space,
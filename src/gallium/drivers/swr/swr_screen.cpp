@@ -27,6 +27,8 @@
 #include "util/u_format.h"
 #include "util/u_inlines.h"
 #include "util/u_cpu_detect.h"
+#include "util/u_debug.h"
+#include "util/u_atomic.h"
 
 #include "state_tracker/sw_winsys.h"
 
@@ -39,11 +41,18 @@ extern "C" {
 #include "swr_context.h"
 #include "swr_resource.h"
 #include "swr_fence.h"
+#include "swr_query.h"
 #include "gen_knobs.h"
 
 #include "jit_api.h"
 
 #include <stdio.h>
+#include <sys/mman.h>
+
+/* Presents from a separate thread call into the winsys concurrently with
+ * the application, so this needs a thread safe display connection (e.g.
+ * XInitThreads). */
+DEBUG_GET_ONCE_BOOL_OPTION(swr_async_present, "SWR_ASYNC_PRESENT", FALSE)
 
 /* MSVC case instensitive compare */
 #if defined(PIPE_CC_MSVC)
@@ -60,6 +69,10 @@ extern "C" {
 #define SWR_MAX_TEXTURE_CUBE_LEVELS 14  /* 8K x 8K for now */
 #define SWR_MAX_TEXTURE_ARRAY_LAYERS 512 /* 8K x 512 / 8K x 8K x 512 */
 
+/* Textures from this size on are committed a page at a time as written */
+#define SWR_LAZY_TEXTURE_SIZE (16 * 1024 * 1024)
+#define SWR_PAGE_SIZE 4096
+
 static const char *
 swr_get_name(struct pipe_screen *screen)
 {
@@ -95,8 +108,15 @@ swr_is_format_supported(struct pipe_screen *screen,
    if (!format_desc)
       return FALSE;
 
-   if (sample_count > 1)
-      return FALSE;
+   /* Multisampled surfaces are only rendered to and resolved, never
+    * sampled or displayed */
+   if (sample_count > 1) {
+      if (sample_count > 8 || !util_is_power_of_two(sample_count)
+          || target == PIPE_BUFFER || target == PIPE_TEXTURE_3D
+          || (bind & (PIPE_BIND_SAMPLER_VIEW | PIPE_BIND_DISPLAY_TARGET
+                      | PIPE_BIND_SCANOUT | PIPE_BIND_SHARED)))
+         return FALSE;
+   }
 
    if (bind
        & (PIPE_BIND_DISPLAY_TARGET | PIPE_BIND_SCANOUT | PIPE_BIND_SHARED)) {
@@ -182,6 +202,8 @@ swr_get_param(struct pipe_screen *screen, enum pipe_cap param)
       return 1;
    case PIPE_CAP_DEPTH_CLIP_DISABLE:
       return 1;
+   case PIPE_CAP_CONSERVATIVE_RASTER:
+      return 1;
    case PIPE_CAP_MAX_STREAM_OUTPUT_BUFFERS:
       return MAX_SO_STREAMS;
    case PIPE_CAP_MAX_STREAM_OUTPUT_SEPARATE_COMPONENTS:
@@ -226,7 +248,7 @@ swr_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_QUADS_FOLLOW_PROVOKING_VERTEX_CONVENTION:
       return 0;
    case PIPE_CAP_COMPUTE:
-      return 0;
+      return 1;
    case PIPE_CAP_USER_VERTEX_BUFFERS:
    case PIPE_CAP_USER_INDEX_BUFFERS:
    case PIPE_CAP_USER_CONSTANT_BUFFERS:
@@ -278,6 +300,8 @@ swr_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_MAX_TEXTURE_GATHER_OFFSET:
       return 0;
    case PIPE_CAP_DRAW_INDIRECT:
+   case PIPE_CAP_MULTI_DRAW_INDIRECT:
+   case PIPE_CAP_MULTI_DRAW_INDIRECT_PARAMS:
       return 1;
 
    case PIPE_CAP_VENDOR_ID:
@@ -312,7 +336,7 @@ swr_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_DEVICE_RESET_STATUS_QUERY:
       return 0;
    case PIPE_CAP_MAX_SHADER_PATCH_VARYINGS:
-      return 0;
+      return 30; /* of the ScalarPatch slots, one holds inner level .zw */
    case PIPE_CAP_DEPTH_BOUNDS_TEST:
       return 0; // xxx
    case PIPE_CAP_TEXTURE_FLOAT_LINEAR:
@@ -325,8 +349,6 @@ swr_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_CLEAR_TEXTURE:
    case PIPE_CAP_DRAW_PARAMETERS:
    case PIPE_CAP_TGSI_PACK_HALF_FLOAT:
-   case PIPE_CAP_MULTI_DRAW_INDIRECT:
-   case PIPE_CAP_MULTI_DRAW_INDIRECT_PARAMS:
    case PIPE_CAP_TGSI_FS_POSITION_IS_SYSVAL:
    case PIPE_CAP_TGSI_FS_FACE_IS_INTEGER_SYSVAL:
    case PIPE_CAP_SHADER_BUFFER_OFFSET_ALIGNMENT:
@@ -350,13 +372,146 @@ swr_get_shader_param(struct pipe_screen *screen,
                      unsigned shader,
                      enum pipe_shader_cap param)
 {
-   if (shader == PIPE_SHADER_VERTEX || shader == PIPE_SHADER_FRAGMENT)
+   if (shader == PIPE_SHADER_VERTEX || shader == PIPE_SHADER_FRAGMENT ||
+       shader == PIPE_SHADER_GEOMETRY)
       return gallivm_get_shader_param(param);
 
-   // Todo: geometry, tesselation, compute
+   if (shader == PIPE_SHADER_COMPUTE) {
+      switch (param) {
+      case PIPE_SHADER_CAP_MAX_INPUTS:
+      case PIPE_SHADER_CAP_MAX_OUTPUTS:
+         return 0;
+      case PIPE_SHADER_CAP_MAX_SHADER_BUFFERS:
+         return PIPE_MAX_SHADER_BUFFERS;
+      default:
+         return gallivm_get_shader_param(param);
+      }
+   }
+
+   /* control points hold the per-vertex varyings in KNOB_NUM_ATTRIBUTES
+    * slots */
+   if (shader == PIPE_SHADER_TESS_CTRL || shader == PIPE_SHADER_TESS_EVAL) {
+      switch (param) {
+      case PIPE_SHADER_CAP_MAX_INPUTS:
+      case PIPE_SHADER_CAP_MAX_OUTPUTS:
+         return 32;
+      case PIPE_SHADER_CAP_MAX_SHADER_BUFFERS:
+         return 0;
+      default:
+         return gallivm_get_shader_param(param);
+      }
+   }
+
    return 0;
 }
 
+/*
+ * Thread groups run on a single worker, a SIMD chunk of threads at a time,
+ * so the limits only bound the barrier spill space per group.
+ */
+static int
+swr_get_compute_param(struct pipe_screen *screen,
+                      enum pipe_compute_cap param,
+                      void *ret)
+{
+   union {
+      const char *ir_target;
+      uint64_t grid_dimension;
+      uint64_t max_grid_size[3];
+      uint64_t max_block_size[3];
+      uint64_t max_threads_per_block;
+      uint64_t max_local_size;
+      uint64_t max_private_size;
+      uint64_t max_input_size;
+      uint64_t max_mem_alloc_size;
+      uint32_t max_clock_frequency;
+      uint32_t max_compute_units;
+      uint32_t images_supported;
+      uint32_t subgroup_size;
+   } val;
+   const void *ptr;
+   int size;
+
+   switch (param) {
+   case PIPE_COMPUTE_CAP_IR_TARGET:
+      val.ir_target = "swr";
+      ptr = val.ir_target;
+      size = strlen(val.ir_target) + 1;
+      break;
+   case PIPE_COMPUTE_CAP_GRID_DIMENSION:
+      val.grid_dimension = 3;
+      ptr = &val.grid_dimension;
+      size = sizeof(val.grid_dimension);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_GRID_SIZE:
+      val.max_grid_size[0] = 65535;
+      val.max_grid_size[1] = 65535;
+      val.max_grid_size[2] = 65535;
+      ptr = &val.max_grid_size;
+      size = sizeof(val.max_grid_size);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_BLOCK_SIZE:
+      val.max_block_size[0] = 1024;
+      val.max_block_size[1] = 1024;
+      val.max_block_size[2] = 64;
+      ptr = &val.max_block_size;
+      size = sizeof(val.max_block_size);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_THREADS_PER_BLOCK:
+      val.max_threads_per_block = 1024;
+      ptr = &val.max_threads_per_block;
+      size = sizeof(val.max_threads_per_block);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_GLOBAL_SIZE:
+   case PIPE_COMPUTE_CAP_MAX_MEM_ALLOC_SIZE:
+      val.max_mem_alloc_size = 1u << 31;
+      ptr = &val.max_mem_alloc_size;
+      size = sizeof(val.max_mem_alloc_size);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_LOCAL_SIZE:
+      /* shared memory is the per worker scratch */
+      val.max_local_size = KNOB_MAX_TGSM_SIZE;
+      ptr = &val.max_local_size;
+      size = sizeof(val.max_local_size);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_PRIVATE_SIZE:
+   case PIPE_COMPUTE_CAP_MAX_INPUT_SIZE:
+      val.max_input_size = 0;
+      ptr = &val.max_input_size;
+      size = sizeof(val.max_input_size);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_CLOCK_FREQUENCY:
+      val.max_clock_frequency = 1000; /* arbitrary */
+      ptr = &val.max_clock_frequency;
+      size = sizeof(val.max_clock_frequency);
+      break;
+   case PIPE_COMPUTE_CAP_MAX_COMPUTE_UNITS:
+      val.max_compute_units = util_cpu_caps.nr_cpus;
+      ptr = &val.max_compute_units;
+      size = sizeof(val.max_compute_units);
+      break;
+   case PIPE_COMPUTE_CAP_IMAGES_SUPPORTED:
+      val.images_supported = 0;
+      ptr = &val.images_supported;
+      size = sizeof(val.images_supported);
+      break;
+   case PIPE_COMPUTE_CAP_SUBGROUP_SIZE:
+      val.subgroup_size = KNOB_SIMD_WIDTH;
+      ptr = &val.subgroup_size;
+      size = sizeof(val.subgroup_size);
+      break;
+   default:
+      /* should only get here on unhandled cases */
+      debug_printf("Unexpected PIPE_COMPUTE_CAP %d query\n", param);
+      return 0;
+   }
+
+   if (ret)
+      memcpy(ret, ptr, size);
+
+   return size;
+}
+
 
 static float
 swr_get_paramf(struct pipe_screen *screen, enum pipe_capf param)
@@ -448,8 +603,13 @@ swr_displaytarget_layout(struct swr_screen *screen, struct swr_resource *res)
 
    void *map = winsys->displaytarget_map(winsys, dt, 0);
 
+   /* Tiles are stored straight into the winsys buffer (XShm segment or
+    * shared mapping where available), so use its stride */
    res->display_target = dt;
    res->swr.pBaseAddress = (uint8_t*) map;
+   res->swr.pitch = stride;
+   res->row_stride[0] = stride;
+   res->img_stride[0] = stride * res->alignedHeight;
 
    /* Clear the display target surface */
    if (map)
@@ -460,6 +620,166 @@ swr_displaytarget_layout(struct swr_screen *screen, struct swr_resource *res)
    return TRUE;
 }
 
+/*
+ * Sampled color textures are stored in Y-major tiles, render targets
+ * included since the core loads and stores their hot tiles in that layout.
+ * Depth/stencil, anything the winsys displays or that's mapped for fast CPU
+ * access stays linear, as do formats whose pixels could straddle a 16 byte
+ * tile column.
+ */
+static boolean
+swr_texture_use_tiling(const struct pipe_resource *pt,
+                       const SWR_FORMAT_INFO &finfo)
+{
+   if (!(pt->bind & PIPE_BIND_SAMPLER_VIEW)
+       || (pt->bind & (PIPE_BIND_DEPTH_STENCIL
+                       | PIPE_BIND_DISPLAY_TARGET | PIPE_BIND_SCANOUT
+                       | PIPE_BIND_SHARED | PIPE_BIND_LINEAR
+                       | PIPE_BIND_SHADER_IMAGE))
+       || pt->usage == PIPE_USAGE_STAGING
+       || pt->nr_samples > 1)
+      return FALSE;
+
+   switch (pt->target) {
+   case PIPE_TEXTURE_2D:
+   case PIPE_TEXTURE_RECT:
+   case PIPE_TEXTURE_2D_ARRAY:
+   case PIPE_TEXTURE_CUBE:
+   case PIPE_TEXTURE_CUBE_ARRAY:
+   case PIPE_TEXTURE_3D:
+      break;
+   default:
+      return FALSE;
+   }
+
+   const struct util_format_description *desc =
+      util_format_description(pt->format);
+   return desc->block.width == 1 && desc->block.height == 1
+      && util_is_power_of_two(finfo.Bpp) && finfo.Bpp <= 16;
+}
+
+/*
+ * Large color textures are reserved rather than allocated, so volume and
+ * array levels or layers the app never fills don't cost memory.  Shader
+ * images are written behind the driver's back, multisampled surfaces are
+ * rendered to all over.
+ */
+static boolean
+swr_texture_commit_lazily(const struct swr_resource *res,
+                          unsigned total_size)
+{
+   const struct pipe_resource *pt = &res->base;
+
+   return pt->target != PIPE_BUFFER
+      && total_size >= SWR_LAZY_TEXTURE_SIZE
+      && !res->has_depth && !res->has_stencil
+      && pt->nr_samples <= 1
+      && !(pt->bind & (PIPE_BIND_DEPTH_STENCIL
+                       | PIPE_BIND_DISPLAY_TARGET | PIPE_BIND_SCANOUT
+                       | PIPE_BIND_SHARED | PIPE_BIND_SHADER_IMAGE));
+}
+
+/*
+ * Reserve an anonymous mapping for a lazily committed texture.  Its pages
+ * read as the zero page until written.  Returns NULL on failure.
+ */
+static void *
+swr_texture_reserve(struct swr_resource *res, unsigned total_size)
+{
+   void *map = mmap(NULL, total_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+   if (map == MAP_FAILED)
+      return NULL;
+
+   unsigned num_pages = DIV_ROUND_UP(total_size, SWR_PAGE_SIZE);
+   res->committed_pages =
+      (uint32_t *)CALLOC(DIV_ROUND_UP(num_pages, 32), sizeof(uint32_t));
+   if (!res->committed_pages) {
+      munmap(map, total_size);
+      return NULL;
+   }
+
+   res->lazy_size = total_size;
+   return map;
+}
+
+/* Mark the pages of [start, end) committed, returns the newly marked ones.
+ * Contexts sharing the texture may commit pages of it concurrently. */
+static unsigned
+swr_commit_range(struct swr_resource *spr, unsigned start, unsigned end)
+{
+   unsigned count = 0;
+
+   for (unsigned page = start / SWR_PAGE_SIZE;
+        page <= (end - 1) / SWR_PAGE_SIZE; page++) {
+      uint32_t *word = &spr->committed_pages[page / 32];
+      uint32_t bit = 1u << (page % 32);
+      uint32_t old = p_atomic_read(word);
+
+      while (!(old & bit)) {
+         uint32_t prev = p_atomic_cmpxchg(word, old, old | bit);
+         if (prev == old) {
+            count++;
+            break;
+         }
+         old = prev;
+      }
+   }
+
+   return count;
+}
+
+/*
+ * Account for the pages of a lazily committed texture that writes to box
+ * of level commit.  Does nothing for other resources.
+ */
+void
+swr_resource_commit(struct swr_resource *spr,
+                    unsigned level,
+                    const struct pipe_box *box)
+{
+   if (!spr->committed_pages || box->width <= 0 || box->height <= 0
+       || p_atomic_read(&spr->committed_size) >= spr->lazy_size)
+      return;
+
+   enum pipe_format format = spr->base.format;
+   const unsigned pitch = spr->row_stride[level];
+   const unsigned x0 = util_format_get_nblocksx(format, box->x)
+      * util_format_get_blocksize(format);
+   const unsigned x1 = util_format_get_nblocksx(format, box->x + box->width)
+      * util_format_get_blocksize(format);
+   const unsigned y0 = util_format_get_nblocksy(format, box->y);
+   const unsigned y1 = util_format_get_nblocksy(format, box->y + box->height);
+   unsigned count = 0;
+
+   for (int z = box->z; z < box->z + box->depth; z++) {
+      unsigned image = spr->mip_offsets[level] + z * spr->img_stride[level];
+
+      if (swr_resource_is_tiled(spr)) {
+         /* Tiles are page sized and aligned */
+         for (unsigned y = y0 & ~(SWR_TILE_YMAJOR_HEIGHT - 1); y < y1;
+              y += SWR_TILE_YMAJOR_HEIGHT) {
+            for (unsigned x = x0 & ~(SWR_TILE_YMAJOR_WIDTH - 1); x < x1;
+                 x += SWR_TILE_YMAJOR_WIDTH) {
+               unsigned tile =
+                  image + ComputeOffset2D<SWR_YMAJOR_TILING>(pitch, x, y);
+               count += swr_commit_range(spr, tile, tile + SWR_PAGE_SIZE);
+            }
+         }
+      } else {
+         for (unsigned y = y0; y < y1; y++)
+            count += swr_commit_range(
+               spr, image + y * pitch + x0, image + y * pitch + x1);
+      }
+   }
+
+   if (count) {
+      p_atomic_add(&spr->committed_size, (uint64_t)count * SWR_PAGE_SIZE);
+      p_atomic_add(&swr_screen(spr->base.screen)->committed_size,
+                   (uint64_t)count * SWR_PAGE_SIZE);
+   }
+}
+
 static boolean
 swr_texture_layout(struct swr_screen *screen,
                    struct swr_resource *res,
@@ -480,11 +800,13 @@ swr_texture_layout(struct swr_screen *screen,
    res->swr.height = pt->height0;
    res->swr.depth = pt->depth0;
    res->swr.type = swr_convert_target_type(pt->target);
-   res->swr.tileMode = SWR_TILE_NONE;
    res->swr.format = mesa_to_swr_format(fmt);
-   res->swr.numSamples = (1 << pt->nr_samples);
+   res->swr.numSamples = MAX2(pt->nr_samples, 1);
 
    SWR_FORMAT_INFO finfo = GetFormatInfo(res->swr.format);
+   const boolean tiled = !res->has_depth && !res->has_stencil
+      && swr_texture_use_tiling(pt, finfo);
+   res->swr.tileMode = tiled ? SWR_TILE_MODE_YMAJOR : SWR_TILE_NONE;
 
    unsigned total_size = 0;
    unsigned width = pt->width0;
@@ -504,6 +826,13 @@ swr_texture_layout(struct swr_screen *screen,
          alignedHeight = height;
       }
 
+      if (tiled) {
+         /* Every level and slice starts on a tile */
+         alignedWidth = align(alignedWidth * finfo.Bpp, SWR_TILE_YMAJOR_WIDTH)
+            / finfo.Bpp;
+         alignedHeight = align(alignedHeight, SWR_TILE_YMAJOR_HEIGHT);
+      }
+
       if (level == 0) {
          res->alignedWidth = alignedWidth;
          res->alignedHeight = alignedHeight;
@@ -523,6 +852,9 @@ swr_texture_layout(struct swr_screen *screen,
       else
          num_slices = 1;
 
+      /* Samples are stored as planes following one another, like slices */
+      num_slices *= res->swr.numSamples;
+
       total_size += res->img_stride[level] * num_slices;
       if (total_size > SWR_MAX_TEXTURE_SIZE)
          return FALSE;
@@ -535,9 +867,27 @@ swr_texture_layout(struct swr_screen *screen,
    res->swr.halign = res->alignedWidth;
    res->swr.valign = res->alignedHeight;
    res->swr.pitch = res->row_stride[0];
+   res->swr.qpitch = res->alignedHeight;
 
    if (allocate) {
-      res->swr.pBaseAddress = (BYTE *)_aligned_malloc(total_size, 64);
+      /* Orphaned buffers come back through the buffer pool.  Large
+       * surfaces go on huge pages, the backend touches them a macrotile at
+       * a time all over the surface. */
+      if (pt->target == PIPE_BUFFER) {
+         res->swr.pBaseAddress =
+            (BYTE *)swr_buffer_pool_alloc(screen, total_size);
+      } else {
+         if (swr_texture_commit_lazily(res, total_size))
+            res->swr.pBaseAddress =
+               (BYTE *)swr_texture_reserve(res, total_size);
+         if (!res->swr.pBaseAddress)
+            res->swr.pBaseAddress =
+               (BYTE *)AlignedMallocHuge(total_size, tiled ? 4096 : 64);
+      }
+
+      /* Lazily committed textures count their pages as they're written */
+      if (!res->lazy_size)
+         res->committed_size = total_size;
 
       if (res->has_depth && res->has_stencil) {
          SWR_FORMAT_INFO finfo = GetFormatInfo(res->secondary.format);
@@ -547,17 +897,31 @@ swr_texture_layout(struct swr_screen *screen,
          res->secondary.type = SURFACE_2D;
          res->secondary.tileMode = SWR_TILE_NONE;
          res->secondary.format = R8_UINT;
-         res->secondary.numSamples = (1 << pt->nr_samples);
+         res->secondary.numSamples = res->swr.numSamples;
          res->secondary.pitch = res->alignedWidth * finfo.Bpp;
+         res->secondary.qpitch = res->alignedHeight;
 
-         res->secondary.pBaseAddress = (BYTE *)_aligned_malloc(
-            res->alignedHeight * res->secondary.pitch, 64);
+         res->secondary.pBaseAddress = (BYTE *)AlignedMallocHuge(
+            res->alignedHeight * res->secondary.pitch
+               * res->secondary.numSamples, 64);
       }
    }
 
    return TRUE;
 }
 
+/* Free the storage of a texture allocated by swr_texture_layout */
+static void
+swr_texture_free(struct swr_screen *screen, struct swr_resource *res)
+{
+   if (res->lazy_size) {
+      munmap(res->swr.pBaseAddress, res->lazy_size);
+      p_atomic_add(&screen->committed_size, -(int64_t)res->committed_size);
+      FREE(res->committed_pages);
+   } else
+      _aligned_free(res->swr.pBaseAddress);
+}
+
 static boolean
 swr_can_create_resource(struct pipe_screen *screen,
                         const struct pipe_resource *templat)
@@ -594,6 +958,20 @@ swr_resource_create(struct pipe_screen *_screen,
          /* texture map */
          if (!swr_texture_layout(screen, res, true))
             goto fail;
+
+         /* Multisampled color surfaces resolve into a single sample copy
+          * as their hot tiles are stored */
+         if (res->base.nr_samples > 1 && !res->has_depth
+             && !res->has_stencil) {
+            struct pipe_resource resolve_templat = *templat;
+            resolve_templat.nr_samples = 0;
+            res->resolve_target =
+               _screen->resource_create(_screen, &resolve_templat);
+            if (!res->resolve_target) {
+               swr_texture_free(screen, res);
+               goto fail;
+            }
+         }
       }
    } else {
       /* other data (vertex buffer, const buffer, etc) */
@@ -622,16 +1000,19 @@ swr_resource_destroy(struct pipe_screen *p_screen, struct pipe_resource *pt)
    struct swr_resource *spr = swr_resource(pt);
    struct pipe_context *pipe = spr->bound_to_context;
 
-   /* Only wait on fence if the resource is being used */
-   if (pipe && spr->status) {
-      /* But, if there's no fence pending, submit one.
-       * XXX: Remove once draw timestamps are implmented. */
-      if (!swr_is_fence_pending(screen->flush_fence))
-         swr_fence_submit(swr_context(pipe), screen->flush_fence);
-
-      swr_fence_finish(p_screen, screen->flush_fence, 0);
-      swr_resource_unused(pipe, spr);
+   /* Only wait for the draws that use the resource.  Storage of a busy
+    * buffer goes to the buffer pool instead, to be freed or reused once
+    * those draws are done. */
+   if (pipe) {
+      boolean is_buffer = pt->target == PIPE_BUFFER;
+      if (!swr_resource_finish(
+             pipe, spr, is_buffer ? 0 : PIPE_TIMEOUT_INFINITE)) {
+         swr_buffer_pool_release(
+            screen, spr->swr.pBaseAddress, pt->width0, spr->uses);
+         spr->swr.pBaseAddress = NULL;
+      }
    }
+   swr_resource_uses_release(spr->uses);
 
    /*
     * Free resource primary surface.  If resource is display target, winsys
@@ -640,12 +1021,15 @@ swr_resource_destroy(struct pipe_screen *p_screen, struct pipe_resource *pt)
    if (spr->display_target) {
       /* display target */
       struct sw_winsys *winsys = screen->winsys;
+      swr_present_wait(screen, spr->swr.pBaseAddress);
       winsys->displaytarget_destroy(winsys, spr->display_target);
    } else
-      _aligned_free(spr->swr.pBaseAddress);
+      swr_texture_free(screen, spr);
 
    _aligned_free(spr->secondary.pBaseAddress);
 
+   pipe_resource_reference(&spr->resolve_target, NULL);
+
    FREE(spr);
 }
 
@@ -663,16 +1047,176 @@ swr_flush_frontbuffer(struct pipe_screen *p_screen,
    struct swr_resource *spr = swr_resource(resource);
    struct pipe_context *pipe = spr->bound_to_context;
 
+   debug_assert(spr->display_target);
+   if (!spr->display_target)
+      return;
+
+   /* Only one present in flight, in order */
+   swr_present_wait(screen, NULL);
+
+   if (pipe && screen->async_present) {
+      struct sw_displaytarget *dt = spr->display_target;
+      struct pipe_box box;
+      boolean has_box = sub_box != NULL;
+      if (has_box)
+         box = *sub_box;
+
+      /* Return to the application and display once the StoreTiles of the
+       * surface have retired.  swr_flush normally queued the sync for them
+       * already; one is only submitted if not.  The job holds a reference
+       * to the context fence, which may outlive the context. */
+      struct swr_context *ctx = swr_context(pipe);
+      struct pipe_fence_handle *fence = NULL;
+      uint64_t seq = 0;
+      for (unsigned i = 0; i < SWR_MAX_RESOURCE_USES; i++)
+         if (spr->uses[i].fence == ctx->fence)
+            seq = spr->uses[i].seq;
+      if (seq > swr_fence(ctx->fence)->write)
+         swr_fence_submit(ctx, ctx->fence);
+      swr_fence_reference(p_screen, &fence, ctx->fence);
+
+      SwrEndFrame(ctx->swrContext);
+      p_atomic_inc(&screen->frame);
+
+      pipe_mutex_lock(screen->present_mutex);
+      screen->present_surface = spr->swr.pBaseAddress;
+      *screen->present_job = std::async(std::launch::async,
+         [screen, dt, fence, seq, context_private, box, has_box]() mutable {
+            struct pipe_box sub_box = box;
+            swr_fence_wait(fence, seq, PIPE_TIMEOUT_INFINITE);
+            swr_fence_reference(&screen->base, &fence, NULL);
+            screen->winsys->displaytarget_display(
+               screen->winsys, dt, context_private,
+               has_box ? &sub_box : NULL);
+         });
+      pipe_mutex_unlock(screen->present_mutex);
+      return;
+   }
+
    if (pipe) {
-      swr_fence_finish(p_screen, screen->flush_fence, 0);
-      swr_resource_unused(pipe, spr);
+      swr_resource_finish(pipe, spr, PIPE_TIMEOUT_INFINITE);
       SwrEndFrame(swr_context(pipe)->swrContext);
+      p_atomic_inc(&screen->frame);
    }
 
-   debug_assert(spr->display_target);
-   if (spr->display_target)
-      winsys->displaytarget_display(
-         winsys, spr->display_target, context_private, sub_box);
+   winsys->displaytarget_display(
+      winsys, spr->display_target, context_private, sub_box);
+}
+
+
+/*
+ * Wait for an asynchronous present still reading the surface, before it is
+ * written again.  NULL waits for any present.
+ */
+void
+swr_present_wait(struct swr_screen *screen, const void *surface)
+{
+   if (!screen->async_present)
+      return;
+
+   pipe_mutex_lock(screen->present_mutex);
+   if (screen->present_job->valid()
+       && (!surface || surface == screen->present_surface))
+      screen->present_job->get();
+   pipe_mutex_unlock(screen->present_mutex);
+}
+
+
+/*
+ * Look up (compiling on first use) the load/store tile kernels for a color
+ * surface.  Returns NULL kernels for formats and tile modes the tile jitter
+ * doesn't handle; those keep using the table driven LoadTile/StoreTile.
+ */
+void
+swr_get_tile_jit(struct swr_screen *screen,
+                 const SWR_SURFACE_STATE *surface,
+                 PFN_LOAD_TILE_JIT_FUNC *pfnLoadTile,
+                 PFN_STORE_TILE_JIT_FUNC *pfnStoreTile)
+{
+   TILE_COMPILE_STATE state;
+   memset(&state, 0, sizeof(state));
+   state.format = surface->format;
+   state.tileMode = surface->tileMode;
+   state.numSamples = surface->numSamples;
+
+   pipe_mutex_lock(screen->tile_jit_mutex);
+
+   auto load = screen->loadTileJIT->find(state);
+   if (load == screen->loadTileJIT->end())
+      load = screen->loadTileJIT->insert(std::make_pair(
+         state, JitCompileLoadTile(screen->hJitMgr, state))).first;
+
+   auto store = screen->storeTileJIT->find(state);
+   if (store == screen->storeTileJIT->end())
+      store = screen->storeTileJIT->insert(std::make_pair(
+         state, JitCompileStoreTile(screen->hJitMgr, state))).first;
+
+   *pfnLoadTile = load->second;
+   *pfnStoreTile = store->second;
+
+   pipe_mutex_unlock(screen->tile_jit_mutex);
+}
+
+/*
+ * Allocate buffer storage, reusing idle storage of the same size from the
+ * buffer pool when there is any.  The pool is kept in release order, oldest
+ * first, so removal shifts the younger entries down.
+ */
+void *
+swr_buffer_pool_alloc(struct swr_screen *screen, unsigned size)
+{
+   std::vector<swr_pooled_buffer> &pool = *screen->buffer_pool;
+   void *ptr = NULL;
+
+   pipe_mutex_lock(screen->buffer_pool_mutex);
+   for (unsigned i = 0; i < pool.size(); i++) {
+      if (pool[i].size == size && swr_resource_uses_retired(pool[i].uses)) {
+         ptr = pool[i].ptr;
+         swr_resource_uses_release(pool[i].uses);
+         pool.erase(pool.begin() + i);
+         break;
+      }
+   }
+   pipe_mutex_unlock(screen->buffer_pool_mutex);
+
+   if (!ptr)
+      ptr = _aligned_malloc(size, 64);
+
+   return ptr;
+}
+
+/*
+ * Hand storage still referenced by the draws recorded in uses to the buffer
+ * pool, which takes over their fence references.  Idle storage beyond
+ * SWR_BUFFER_POOL_SIZE is freed, oldest first.
+ */
+void
+swr_buffer_pool_release(struct swr_screen *screen,
+                        void *ptr,
+                        unsigned size,
+                        struct swr_resource_use *uses)
+{
+   std::vector<swr_pooled_buffer> &pool = *screen->buffer_pool;
+   unsigned idle_size = 0;
+
+   swr_pooled_buffer buffer = {ptr, size};
+   memcpy(buffer.uses, uses, sizeof(buffer.uses));
+   memset(uses, 0, sizeof(buffer.uses));
+
+   pipe_mutex_lock(screen->buffer_pool_mutex);
+   pool.push_back(buffer);
+
+   for (unsigned i = pool.size(); i-- > 0;) {
+      if (!swr_resource_uses_retired(pool[i].uses))
+         continue;
+      idle_size += pool[i].size;
+      if (idle_size > SWR_BUFFER_POOL_SIZE) {
+         _aligned_free(pool[i].ptr);
+         swr_resource_uses_release(pool[i].uses);
+         pool.erase(pool.begin() + i);
+      }
+   }
+   pipe_mutex_unlock(screen->buffer_pool_mutex);
 }
 
 
@@ -684,8 +1228,24 @@ swr_destroy_screen(struct pipe_screen *p_screen)
 
    fprintf(stderr, "SWR destroy screen!\n");
 
-   swr_fence_finish(p_screen, screen->flush_fence, 0);
-   swr_fence_reference(p_screen, &screen->flush_fence, NULL);
+   swr_present_wait(screen, NULL);
+   delete screen->present_job;
+   pipe_mutex_destroy(screen->present_mutex);
+
+   for (auto &buffer : *screen->buffer_pool) {
+      _aligned_free(buffer.ptr);
+      swr_resource_uses_release(buffer.uses);
+   }
+   delete screen->buffer_pool;
+   pipe_mutex_destroy(screen->buffer_pool_mutex);
+
+   delete screen->loadTileJIT;
+   delete screen->storeTileJIT;
+   pipe_mutex_destroy(screen->tile_jit_mutex);
+
+   if (screen->hJitMgrSpec)
+      JitDestroyContext(screen->hJitMgrSpec);
+   pipe_mutex_destroy(screen->spec_jit_mutex);
 
    JitDestroyContext(screen->hJitMgr);
 
@@ -718,7 +1278,9 @@ swr_create_screen(struct sw_winsys *winsys)
    screen->base.destroy = swr_destroy_screen;
    screen->base.get_param = swr_get_param;
    screen->base.get_shader_param = swr_get_shader_param;
+   screen->base.get_compute_param = swr_get_compute_param;
    screen->base.get_paramf = swr_get_paramf;
+   screen->base.get_driver_query_info = swr_get_driver_query_info;
 
    screen->base.resource_create = swr_resource_create;
    screen->base.resource_destroy = swr_resource_destroy;
@@ -727,6 +1289,24 @@ swr_create_screen(struct sw_winsys *winsys)
 
    screen->hJitMgr = JitCreateContext(KNOB_SIMD_WIDTH, KNOB_ARCH_STR);
 
+   pipe_mutex_init(screen->tile_jit_mutex);
+   screen->loadTileJIT =
+      new std::unordered_map<TILE_COMPILE_STATE, PFN_LOAD_TILE_JIT_FUNC>;
+   screen->storeTileJIT =
+      new std::unordered_map<TILE_COMPILE_STATE, PFN_STORE_TILE_JIT_FUNC>;
+
+   /* Separate JitManager for background FS constant specialization */
+   pipe_mutex_init(screen->spec_jit_mutex);
+   if (KNOB_FS_SPECIALIZE_FRAMES)
+      screen->hJitMgrSpec = JitCreateContext(KNOB_SIMD_WIDTH, KNOB_ARCH_STR);
+
+   pipe_mutex_init(screen->buffer_pool_mutex);
+   screen->buffer_pool = new std::vector<swr_pooled_buffer>;
+
+   screen->async_present = debug_get_option_swr_async_present();
+   pipe_mutex_init(screen->present_mutex);
+   screen->present_job = new std::future<void>;
+
    swr_fence_init(&screen->base);
 
    return &screen->base;
@@ -743,3 +1323,9 @@ swr_get_displaytarget(struct pipe_resource *resource)
 {
    return ((struct swr_resource *)resource)->display_target;
 }
+
+uint64_t
+swr_get_committed_size(struct pipe_resource *resource)
+{
+   return p_atomic_read(&((struct swr_resource *)resource)->committed_size);
+}
@@ -26,18 +26,73 @@
 
 #include "pipe/p_screen.h"
 #include "pipe/p_defines.h"
+#include "os/os_thread.h"
+#include "util/u_hash.h"
 #include "api.h"
+#include "jit_api.h"
+#include "swr_resource.h"
+#include <future>
+#include <unordered_map>
+#include <vector>
 
 struct sw_winsys;
 
+namespace std
+{
+template <> struct hash<TILE_COMPILE_STATE> {
+   std::size_t operator()(const TILE_COMPILE_STATE &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
+};
+
+/* Upper bound on idle storage kept in the buffer pool */
+#define SWR_BUFFER_POOL_SIZE (64 * 1024 * 1024)
+
+/* Buffer storage retired by renaming, reusable once the draws of every
+ * context that used it have retired */
+struct swr_pooled_buffer {
+   void *ptr;
+   unsigned size;
+   struct swr_resource_use uses[SWR_MAX_RESOURCE_USES];
+};
+
 struct swr_screen {
    struct pipe_screen base;
 
-   struct pipe_fence_handle *flush_fence;
-
    struct sw_winsys *winsys;
 
    HANDLE hJitMgr;
+
+   /* load/store tile jit functions, shared by all contexts */
+   pipe_mutex tile_jit_mutex;
+   std::unordered_map<TILE_COMPILE_STATE, PFN_LOAD_TILE_JIT_FUNC> *loadTileJIT;
+   std::unordered_map<TILE_COMPILE_STATE, PFN_STORE_TILE_JIT_FUNC>
+      *storeTileJIT;
+
+   /* background compiles of constant specialized fragment shaders */
+   pipe_mutex spec_jit_mutex;
+   HANDLE hJitMgrSpec;
+
+   /* FS constant specialization, see swr_update_fs_specialization */
+   unsigned frame;               /* frames presented by all contexts */
+   unsigned fs_constants_stamps; /* last stamp handed to a context */
+
+   /* storage of discarded busy buffers, shared by all contexts */
+   pipe_mutex buffer_pool_mutex;
+   std::vector<swr_pooled_buffer> *buffer_pool;
+   unsigned buffer_renames; /* bumped whenever a buffer gets new storage */
+
+   /* bytes written of lazily committed textures, see swr_resource_commit */
+   uint64_t committed_size;
+
+   /* SWR_ASYNC_PRESENT: display target present waiting, off the API thread,
+    * for the StoreTiles of the surface it shows */
+   boolean async_present;
+   pipe_mutex present_mutex;
+   std::future<void> *present_job;
+   const void *present_surface;
 };
 
 static INLINE struct swr_screen *
@@ -49,4 +104,19 @@ swr_screen(struct pipe_screen *pipe)
 SWR_FORMAT
 mesa_to_swr_format(enum pipe_format format);
 
+void
+swr_get_tile_jit(struct swr_screen *screen,
+                 const SWR_SURFACE_STATE *surface,
+                 PFN_LOAD_TILE_JIT_FUNC *pfnLoadTile,
+                 PFN_STORE_TILE_JIT_FUNC *pfnStoreTile);
+
+void *swr_buffer_pool_alloc(struct swr_screen *screen, unsigned size);
+
+void swr_buffer_pool_release(struct swr_screen *screen,
+                             void *ptr,
+                             unsigned size,
+                             struct swr_resource_use *uses);
+
+void swr_present_wait(struct swr_screen *screen, const void *surface);
+
 #endif
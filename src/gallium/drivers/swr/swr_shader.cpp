@@ -30,7 +30,9 @@
 #include "llvm/Support/CBindingWrapping.h"
 
 #include "tgsi/tgsi_strings.h"
+#include "util/u_atomic.h"
 #include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_const.h"
 #include "gallivm/lp_bld_flow.h"
 #include "gallivm/lp_bld_struct.h"
 #include "gallivm/lp_bld_tgsi.h"
@@ -39,12 +41,89 @@
 #include "swr_context_llvm.h"
 #include "swr_state.h"
 #include "swr_screen.h"
+#include "swr_resource.h"
+
+#include <atomic>
 
 bool operator==(const swr_jit_key &lhs, const swr_jit_key &rhs)
 {
    return !memcmp(&lhs, &rhs, sizeof(lhs));
 }
 
+bool operator==(const swr_jit_cs_key &lhs, const swr_jit_cs_key &rhs)
+{
+   return !memcmp(&lhs, &rhs, sizeof(lhs));
+}
+
+bool operator==(const swr_jit_gs_key &lhs, const swr_jit_gs_key &rhs)
+{
+   return !memcmp(&lhs, &rhs, sizeof(lhs));
+}
+
+bool operator==(const swr_jit_tcs_key &lhs, const swr_jit_tcs_key &rhs)
+{
+   return !memcmp(&lhs, &rhs, sizeof(lhs));
+}
+
+bool operator==(const swr_jit_tes_key &lhs, const swr_jit_tes_key &rhs)
+{
+   return !memcmp(&lhs, &rhs, sizeof(lhs));
+}
+
+static void
+swr_sampler_static_texture_state(struct lp_static_texture_state *state,
+                                 const struct pipe_sampler_view *view)
+{
+   lp_sampler_static_texture_state(state, view);
+
+   /* The sampler swizzles its addresses for textures stored tiled */
+   if (view && view->texture)
+      state->tiled = swr_resource_is_tiled(swr_resource(view->texture));
+}
+
+static void
+swr_generate_sampler_key(const struct lp_tgsi_info &info,
+                         struct swr_context *ctx,
+                         unsigned shader_type,
+                         unsigned &nr_samplers,
+                         unsigned &nr_sampler_views,
+                         struct swr_sampler_static_state *sampler)
+{
+   nr_samplers = info.base.file_max[TGSI_FILE_SAMPLER] + 1;
+
+   for (unsigned i = 0; i < nr_samplers; i++) {
+      if (info.base.file_mask[TGSI_FILE_SAMPLER] & (1 << i)) {
+         lp_sampler_static_sampler_state(&sampler[i].sampler_state,
+                                         ctx->samplers[shader_type][i]);
+      }
+   }
+
+   /*
+    * XXX If TGSI_FILE_SAMPLER_VIEW exists assume all texture opcodes
+    * are dx10-style? Can't really have mixed opcodes, at least not
+    * if we want to skip the holes here (without rescanning tgsi).
+    */
+   if (info.base.file_max[TGSI_FILE_SAMPLER_VIEW] != -1) {
+      nr_sampler_views = info.base.file_max[TGSI_FILE_SAMPLER_VIEW] + 1;
+      for (unsigned i = 0; i < nr_sampler_views; i++) {
+         if (info.base.file_mask[TGSI_FILE_SAMPLER_VIEW] & (1 << i)) {
+            swr_sampler_static_texture_state(
+               &sampler[i].texture_state,
+               ctx->sampler_views[shader_type][i]);
+         }
+      }
+   } else {
+      nr_sampler_views = nr_samplers;
+      for (unsigned i = 0; i < nr_sampler_views; i++) {
+         if (info.base.file_mask[TGSI_FILE_SAMPLER] & (1 << i)) {
+            swr_sampler_static_texture_state(
+               &sampler[i].texture_state,
+               ctx->sampler_views[shader_type][i]);
+         }
+      }
+   }
+}
+
 void
 swr_generate_fs_key(struct swr_jit_key &key,
                     struct swr_context *ctx,
@@ -52,86 +131,1320 @@ swr_generate_fs_key(struct swr_jit_key &key,
 {
    key.nr_cbufs = ctx->framebuffer.nr_cbufs;
    key.light_twoside = ctx->rasterizer->light_twoside;
+   key.sprite_coord_enable = ctx->rasterizer->sprite_coord_enable;
+   /* the FS reads the outputs of the last stage before the rasterizer */
+   const struct tgsi_shader_info *last_info =
+      ctx->gs ? &ctx->gs->info.base :
+      ctx->tes ? &ctx->tes->info.base : &ctx->vs->info.base;
+   key.vs_num_outputs = last_info->num_outputs;
+   memcpy(&key.vs_output_semantic_name,
+          &last_info->output_semantic_name,
+          sizeof(key.vs_output_semantic_name));
+   memcpy(&key.vs_output_semantic_idx,
+          &last_info->output_semantic_index,
+          sizeof(key.vs_output_semantic_idx));
+
+   swr_generate_sampler_key(swr_fs->info, ctx, PIPE_SHADER_FRAGMENT,
+                            key.nr_samplers, key.nr_sampler_views,
+                            key.sampler);
+}
+
+void
+swr_generate_gs_key(struct swr_jit_gs_key &key,
+                    struct swr_context *ctx,
+                    swr_geometry_shader *swr_gs)
+{
+   const struct tgsi_shader_info *prev_info =
+      ctx->tes ? &ctx->tes->info.base : &ctx->vs->info.base;
+   key.vs_num_outputs = prev_info->num_outputs;
+   memcpy(&key.vs_output_semantic_name,
+          &prev_info->output_semantic_name,
+          sizeof(key.vs_output_semantic_name));
+   memcpy(&key.vs_output_semantic_idx,
+          &prev_info->output_semantic_index,
+          sizeof(key.vs_output_semantic_idx));
+
+   swr_generate_sampler_key(swr_gs->info, ctx, PIPE_SHADER_GEOMETRY,
+                            key.nr_samplers, key.nr_sampler_views,
+                            key.sampler);
+}
+
+/* TCS outputs other than these are per control point */
+static bool
+swr_tess_per_patch(ubyte name)
+{
+   return name == TGSI_SEMANTIC_PATCH || name == TGSI_SEMANTIC_TESSOUTER
+      || name == TGSI_SEMANTIC_TESSINNER;
+}
+
+void
+swr_generate_tcs_key(struct swr_jit_tcs_key &key,
+                     struct swr_context *ctx,
+                     swr_tess_ctrl_shader *swr_tcs,
+                     unsigned vertices_in)
+{
+   key.vs_num_outputs = ctx->vs->info.base.num_outputs;
    memcpy(&key.vs_output_semantic_name,
           &ctx->vs->info.base.output_semantic_name,
           sizeof(key.vs_output_semantic_name));
    memcpy(&key.vs_output_semantic_idx,
           &ctx->vs->info.base.output_semantic_index,
           sizeof(key.vs_output_semantic_idx));
+   key.vertices_in = vertices_in;
+   key.passthrough = !swr_tcs;
+   key.isolines =
+      ctx->tes->info.base.properties[TGSI_PROPERTY_TES_PRIM_MODE]
+      == PIPE_PRIM_LINES;
+
+   if (swr_tcs) {
+      swr_generate_sampler_key(swr_tcs->info, ctx, PIPE_SHADER_TESS_CTRL,
+                               key.nr_samplers, key.nr_sampler_views,
+                               key.sampler);
+   }
+}
+
+void
+swr_generate_tes_key(struct swr_jit_tes_key &key,
+                     struct swr_context *ctx,
+                     swr_tess_eval_shader *swr_tes,
+                     unsigned vertices_in)
+{
+   if (ctx->tcs) {
+      /* control points hold the per-vertex outputs, packed */
+      const struct tgsi_shader_info *info = &ctx->tcs->info.base;
+      for (unsigned i = 0; i < info->num_outputs; i++) {
+         if (swr_tess_per_patch(info->output_semantic_name[i]))
+            continue;
+         key.tcs_output_semantic_name[key.tcs_num_outputs] =
+            info->output_semantic_name[i];
+         key.tcs_output_semantic_idx[key.tcs_num_outputs] =
+            info->output_semantic_index[i];
+         key.tcs_num_outputs++;
+      }
+   } else {
+      key.tcs_num_outputs = ctx->vs->info.base.num_outputs;
+      memcpy(&key.tcs_output_semantic_name,
+             &ctx->vs->info.base.output_semantic_name,
+             sizeof(key.tcs_output_semantic_name));
+      memcpy(&key.tcs_output_semantic_idx,
+             &ctx->vs->info.base.output_semantic_index,
+             sizeof(key.tcs_output_semantic_idx));
+   }
+   key.vertices_in = vertices_in;
+
+   swr_generate_sampler_key(swr_tes->info, ctx, PIPE_SHADER_TESS_EVAL,
+                            key.nr_samplers, key.nr_sampler_views,
+                            key.sampler);
+}
+
+void
+swr_generate_cs_key(struct swr_jit_cs_key &key,
+                    struct swr_context *ctx,
+                    swr_compute_shader *swr_cs,
+                    const uint *block)
+{
+   memcpy(key.block, block, sizeof(key.block));
+
+   swr_generate_sampler_key(swr_cs->info, ctx, PIPE_SHADER_COMPUTE,
+                            key.nr_samplers, key.nr_sampler_views,
+                            key.sampler);
+}
+
+/*
+ * Raster tile kernels run the early depth test only as a cull; the fused
+ * output merger repeats it and does the write.  That only holds when
+ * failing pixels have no side effects, so stencil disables the cull.
+ */
+void
+swr_generate_fs_tile_key(struct swr_jit_key &key,
+                         struct swr_context *ctx,
+                         swr_fragment_shader *swr_fs)
+{
+   struct pipe_depth_stencil_alpha_state *dsa = ctx->depth_stencil;
+
+   key.tile_kernel = 1;
+   if (dsa->depth.enabled && !dsa->stencil[0].enabled
+       && !swr_fs->info.base.writes_z) {
+      key.depth_cull = 1;
+      key.depth_func = swr_convert_depth_func(dsa->depth.func);
+   }
+}
+
+struct swr_cs_iface;
+struct swr_gs_iface;
+struct swr_tess_iface;
+
+struct BuilderSWR : public Builder {
+   BuilderSWR(JitManager *pJitMgr)
+      : Builder(pJitMgr)
+   {
+      pJitMgr->SetupNewModule();
+   }
+
+   PFN_VERTEX_FUNC
+   CompileVS(struct pipe_context *ctx, swr_vertex_shader *swr_vs);
+   PFN_HS_FUNC CompileHS(struct swr_tess_ctrl_shader *swr_tcs,
+                         swr_jit_tcs_key &key);
+   PFN_DS_FUNC CompileDS(struct swr_tess_eval_shader *swr_tes,
+                         swr_jit_tes_key &key);
+   PFN_GS_FUNC CompileGS(struct swr_geometry_shader *swr_gs,
+                         swr_jit_gs_key &key);
+   PFN_PIXEL_KERNEL CompileFS(struct swr_fragment_shader *swr_fs,
+                              swr_jit_key &key,
+                              const swr_fs_constants *constants);
+   PFN_CS_FUNC CompileCS(struct swr_compute_shader *swr_cs,
+                         swr_jit_cs_key &key);
+
+   void CSChunkBegin(struct swr_cs_iface *iface,
+                     struct lp_bld_tgsi_system_values *system_values);
+   void CSChunkEnd(struct swr_cs_iface *iface);
+
+   void TCSInvocationBegin(struct swr_tess_iface *iface,
+                           struct lp_bld_tgsi_system_values *system_values);
+   void TCSInvocationEnd(struct swr_tess_iface *iface);
+   void HSPassthrough(struct swr_tess_iface *iface,
+                      swr_jit_tcs_key &key,
+                      Value *hPrivateData);
+   Value *TessRegAddress(struct swr_tess_iface *iface,
+                         uint32_t lane,
+                         boolean is_vindex_indirect,
+                         Value *vertex_index,
+                         boolean is_aindex_indirect,
+                         Value *attrib_index,
+                         Value *swizzle_index);
+   Value *TessFetchPatch(struct swr_tess_iface *iface,
+                         boolean is_vindex_indirect,
+                         Value *vertex_index,
+                         boolean is_aindex_indirect,
+                         Value *attrib_index,
+                         Value *swizzle_index);
+   void TCSStoreOutput(struct swr_tess_iface *iface,
+                       boolean is_vindex_indirect,
+                       Value *vertex_index,
+                       boolean is_aindex_indirect,
+                       Value *attrib_index,
+                       Value *swizzle_index,
+                       Value *value,
+                       Value *vMask);
+
+   Value *FetchVertexInput(struct gallivm_state *gallivm,
+                           Value *pCtx,
+                           uint32_t vertMember,
+                           const uint32_t *inputSlot,
+                           boolean is_vindex_indirect,
+                           Value *vertex_index,
+                           boolean is_aindex_indirect,
+                           Value *attrib_index,
+                           Value *swizzle_index);
+   void GSEmitVertex(struct swr_gs_iface *iface,
+                     LLVMValueRef (*outputs)[TGSI_NUM_CHANNELS],
+                     Value *vEmitted,
+                     Value *vMask);
+   void GSEndPrimitive(struct swr_gs_iface *iface,
+                       Value *vEmitted,
+                       Value *vMask);
+   void GSEpilogue(struct swr_gs_iface *iface, Value *vEmitted);
+};
+
+/*
+ * A thread group runs as a loop over SIMD chunks of its threads.  Barriers
+ * end the loop and start another one, so every chunk has finished the code
+ * before a barrier when the first one starts the code after it.  The
+ * temporaries of each chunk live in the spill fill buffer meanwhile.
+ */
+struct swr_cs_iface {
+   struct lp_build_tgsi_cs_iface base;
+   BuilderSWR *builder;
+   struct gallivm_state *gallivm;
+   const swr_jit_cs_key *key;
+   unsigned num_chunks;
+   Value *pSpillFill; /* null without barriers */
+   unsigned spill_stride;
+   struct lp_build_loop_state loop;
+   struct lp_build_mask_context mask;
+};
+
+static void
+swr_cs_barrier(struct lp_build_tgsi_cs_iface *cs_iface,
+               struct lp_build_tgsi_context *bld_base,
+               struct lp_bld_tgsi_system_values *system_values)
+{
+   struct swr_cs_iface *iface = (struct swr_cs_iface *)cs_iface;
+
+   iface->builder->CSChunkEnd(iface);
+   iface->builder->CSChunkBegin(iface, system_values);
+}
+
+/* Bytes of spill fill buffer a thread group of the shader needs */
+unsigned
+swr_cs_spill_fill_size(swr_compute_shader *swr_cs, const uint *block)
+{
+   if (!swr_cs->info.base.opcode_count[TGSI_OPCODE_BARRIER])
+      return 0;
+
+   unsigned num_chunks =
+      (block[0] * block[1] * block[2] + KNOB_SIMD_WIDTH - 1) / KNOB_SIMD_WIDTH;
+   unsigned num_temps = swr_cs->info.base.file_max[TGSI_FILE_TEMPORARY] + 1;
+
+   return num_chunks * num_temps * TGSI_NUM_CHANNELS * sizeof(simdscalar);
+}
+
+PFN_VERTEX_FUNC
+BuilderSWR::CompileVS(struct pipe_context *ctx, swr_vertex_shader *swr_vs)
+{
+   swr_vs->linkageMask = 0;
+
+   for (unsigned i = 0; i < swr_vs->info.base.num_outputs; i++) {
+      switch (swr_vs->info.base.output_semantic_name[i]) {
+      case TGSI_SEMANTIC_POSITION:
+         break;
+      default:
+         swr_vs->linkageMask |= (1 << i);
+         break;
+      }
+   }
+
+   //   tgsi_dump(swr_vs->pipe.tokens, 0);
+
+   struct gallivm_state *gallivm =
+      gallivm_create("VS", wrap(&JM()->mContext));
+   gallivm->module = wrap(JM()->mpCurrentModule);
+
+   LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
+   LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+
+   memset(outputs, 0, sizeof(outputs));
+
+   AttrBuilder attrBuilder;
+   attrBuilder.addStackAlignmentAttr(JM()->mVWidth * sizeof(float));
+   AttributeSet attrSet = AttributeSet::get(
+      JM()->mContext, AttributeSet::FunctionIndex, attrBuilder);
+
+   std::vector<Type *> vsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                              PointerType::get(Gen_SWR_VS_CONTEXT(JM()), 0)};
+   FunctionType *vsFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), vsArgs, false);
+
+   // create new vertex shader function
+   auto pFunction = Function::Create(vsFuncType,
+                                     GlobalValue::ExternalLinkage,
+                                     "VS",
+                                     JM()->mpCurrentModule);
+   pFunction->addAttributes(AttributeSet::FunctionIndex, attrSet);
+
+   BasicBlock *block = BasicBlock::Create(JM()->mContext, "entry", pFunction);
+   IRB()->SetInsertPoint(block);
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(block));
+
+   auto argitr = pFunction->arg_begin();
+   Value *hPrivateData = &*argitr++;
+   hPrivateData->setName("hPrivateData");
+   Value *pVsCtx = &*argitr++;
+   pVsCtx->setName("vsCtx");
+   
+   Value *consts_ptr = GEP(hPrivateData, {C(0), C(swr_draw_context_constantVS)});
+
+   consts_ptr->setName("vs_constants");
+   Value *const_sizes_ptr =
+      GEP(hPrivateData, {0, swr_draw_context_num_constantsVS});
+   const_sizes_ptr->setName("num_vs_constants");
+
+   Value *vtxInput = LOAD(pVsCtx, {0, SWR_VS_CONTEXT_pVin});
+
+   for (uint32_t attrib = 0; attrib < PIPE_MAX_SHADER_INPUTS; attrib++) {
+      const unsigned mask = swr_vs->info.base.input_usage_mask[attrib];
+      for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
+         if (mask & (1 << channel)) {
+            inputs[attrib][channel] =
+               wrap(LOAD(vtxInput, {0, 0, attrib, channel}));
+         }
+      }
+   }
+
+   struct lp_bld_tgsi_system_values system_values;
+   memset(&system_values, 0, sizeof(system_values));
+   system_values.instance_id = wrap(LOAD(pVsCtx, {0, SWR_VS_CONTEXT_InstanceID}));
+   system_values.vertex_id = wrap(LOAD(pVsCtx, {0, SWR_VS_CONTEXT_VertexID}));
+
+   lp_build_tgsi_soa(gallivm,
+                     swr_vs->pipe.tokens,
+                     lp_type_float_vec(32, 32 * 8),
+                     NULL, // mask
+                     wrap(consts_ptr),
+                     wrap(const_sizes_ptr),
+                     &system_values,
+                     inputs,
+                     outputs,
+                     NULL, // wrap(hPrivateData), (sampler context)
+                     NULL, // thread data
+                     NULL, // sampler
+                     &swr_vs->info.base,
+                     NULL, // geometry shader face
+                     NULL, // compute shader face
+                     NULL); // tessellation shader face
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   Value *vtxOutput = LOAD(pVsCtx, {0, SWR_VS_CONTEXT_pVout});
+
+   for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
+      for (uint32_t attrib = 0; attrib < PIPE_MAX_SHADER_OUTPUTS; attrib++) {
+         if (!outputs[attrib][channel])
+            continue;
+
+         Value *val = LOAD(unwrap(outputs[attrib][channel]));
+
+         uint32_t outSlot = attrib;
+         if (swr_vs->info.base.output_semantic_name[attrib] == TGSI_SEMANTIC_PSIZE)
+            outSlot = VERTEX_POINT_SIZE_SLOT;
+         STORE(val, vtxOutput, {0, 0, outSlot, channel});
+      }
+   }
+
+   RET_VOID();
+
+   gallivm_verify_function(gallivm, wrap(pFunction));
+   gallivm_compile_module(gallivm);
+
+   //   lp_debug_dump_value(func);
+
+   PFN_VERTEX_FUNC pFunc =
+      (PFN_VERTEX_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
+
+   debug_printf("vert shader  %p\n", pFunc);
+   assert(pFunc && "Error: VertShader = NULL");
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 5)
+   JM()->mIsModuleFinalized = true;
+#endif
+
+   return pFunc;
+}
+
+PFN_VERTEX_FUNC
+swr_compile_vs(struct pipe_context *ctx, swr_vertex_shader *swr_vs)
+{
+   BuilderSWR builder(
+      reinterpret_cast<JitManager *>(swr_screen(ctx->screen)->hJitMgr));
+   return builder.CompileVS(ctx, swr_vs);
+}
+
+/*
+ * The GS runs on a SIMD of input primitives.  Every lane emits into its own
+ * region of the core's GS output buffer, SIMD batches of simdvertex holding
+ * the lane's vertices, and marks the ends of its strips in its bytes of the
+ * cut buffer.
+ */
+struct swr_gs_iface {
+   struct lp_build_tgsi_gs_iface base;
+   BuilderSWR *builder;
+   struct gallivm_state *gallivm;
+   struct swr_geometry_shader *swr_gs;
+   Value *pGsCtx;
+   Value *pDummyVertex; /* stores of masked off lanes go here */
+   uint32_t primStride; /* bytes of output buffer per lane */
+   uint32_t cutStride;  /* bytes of cut buffer per lane */
+   uint32_t inputSlot[PIPE_MAX_SHADER_INPUTS];
+};
+
+static LLVMValueRef
+swr_gs_fetch_input(const struct lp_build_tgsi_gs_iface *gs_iface,
+                   struct lp_build_tgsi_context *bld_base,
+                   boolean is_vindex_indirect,
+                   LLVMValueRef vertex_index,
+                   boolean is_aindex_indirect,
+                   LLVMValueRef attrib_index,
+                   LLVMValueRef swizzle_index)
+{
+   struct swr_gs_iface *iface = (struct swr_gs_iface *)gs_iface;
+
+   return wrap(iface->builder->FetchVertexInput(iface->gallivm,
+                                                iface->pGsCtx,
+                                                SWR_GS_CONTEXT_vert,
+                                                iface->inputSlot,
+                                                is_vindex_indirect,
+                                                unwrap(vertex_index),
+                                                is_aindex_indirect,
+                                                unwrap(attrib_index),
+                                                unwrap(swizzle_index)));
+}
+
+static void
+swr_gs_emit_vertex(const struct lp_build_tgsi_gs_iface *gs_iface,
+                   struct lp_build_tgsi_context *bld_base,
+                   LLVMValueRef (*outputs)[4],
+                   LLVMValueRef emitted_vertices_vec,
+                   LLVMValueRef mask_vec)
+{
+   struct swr_gs_iface *iface = (struct swr_gs_iface *)gs_iface;
+
+   iface->builder->GSEmitVertex(
+      iface, outputs, unwrap(emitted_vertices_vec), unwrap(mask_vec));
+}
+
+static void
+swr_gs_end_primitive(const struct lp_build_tgsi_gs_iface *gs_iface,
+                     struct lp_build_tgsi_context *bld_base,
+                     LLVMValueRef total_emitted_vertices_vec,
+                     LLVMValueRef verts_per_prim_vec,
+                     LLVMValueRef emitted_prims_vec,
+                     LLVMValueRef mask_vec)
+{
+   struct swr_gs_iface *iface = (struct swr_gs_iface *)gs_iface;
+
+   iface->builder->GSEndPrimitive(
+      iface, unwrap(total_emitted_vertices_vec), unwrap(mask_vec));
+}
+
+static void
+swr_gs_epilogue(const struct lp_build_tgsi_gs_iface *gs_iface,
+                struct lp_build_tgsi_context *bld_base,
+                LLVMValueRef total_emitted_vertices_vec,
+                LLVMValueRef emitted_prims_vec)
+{
+   struct swr_gs_iface *iface = (struct swr_gs_iface *)gs_iface;
+
+   iface->builder->GSEpilogue(iface, unwrap(total_emitted_vertices_vec));
+}
+
+/* Slot of the previous stage's output an input reads, found by semantic */
+static uint32_t
+locate_input(ubyte name,
+             ubyte index,
+             unsigned num_outputs,
+             const ubyte *output_semantic_name,
+             const ubyte *output_semantic_idx)
+{
+   if (name == TGSI_SEMANTIC_PSIZE)
+      return VERTEX_POINT_SIZE_SLOT;
+
+   for (uint32_t i = 0; i < num_outputs; i++) {
+      if ((output_semantic_name[i] == name)
+          && (output_semantic_idx[i] == index)) {
+         return i;
+      }
+   }
+
+   /* not written by the previous stage, undefined */
+   return VERTEX_POSITION_SLOT;
+}
+
+/* Fetch from the simdvertex array of a GS or HS context */
+Value *
+BuilderSWR::FetchVertexInput(struct gallivm_state *gallivm,
+                             Value *pCtx,
+                             uint32_t vertMember,
+                             const uint32_t *inputSlot,
+                             boolean is_vindex_indirect,
+                             Value *vertex_index,
+                             boolean is_aindex_indirect,
+                             Value *attrib_index,
+                             Value *swizzle_index)
+{
+   Value *res;
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
 
-   key.nr_samplers = swr_fs->info.base.file_max[TGSI_FILE_SAMPLER] + 1;
+   if (!is_vindex_indirect && !is_aindex_indirect) {
+      uint32_t attrib = cast<ConstantInt>(attrib_index)->getZExtValue();
+      res = LOADV(pCtx,
+                  {C(0), C(vertMember), vertex_index,
+                   C(simdvertex_attrib), C(inputSlot[attrib]),
+                   swizzle_index});
+   } else {
+      std::vector<Constant *> slots;
+      for (uint32_t i = 0; i < PIPE_MAX_SHADER_INPUTS; i++)
+         slots.push_back(C(inputSlot[i]));
+      Value *vSlots = ConstantVector::get(slots);
+
+      // lanes may address different vertices and attributes
+      res = VUNDEF_F();
+      for (uint32_t lane = 0; lane < JM()->mVWidth; lane++) {
+         Value *vertex = is_vindex_indirect ?
+            VEXTRACT(vertex_index, C(lane)) : vertex_index;
+         Value *attrib = is_aindex_indirect ?
+            VEXTRACT(attrib_index, C(lane)) : attrib_index;
+         Value *val = LOADV(pCtx,
+                            {C(0), C(vertMember), vertex,
+                             C(simdvertex_attrib), VEXTRACT(vSlots, attrib),
+                             swizzle_index});
+         res = VINSERT(res, VEXTRACT(val, C(lane)), C(lane));
+      }
+   }
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+   return res;
+}
+
+void
+BuilderSWR::GSEmitVertex(struct swr_gs_iface *iface,
+                         LLVMValueRef (*outputs)[TGSI_NUM_CHANNELS],
+                         Value *vEmitted,
+                         Value *vMask)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+   const struct tgsi_shader_info *info = &iface->swr_gs->info.base;
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   // byte offset of the emitted vertex in the output region of each lane
+   std::vector<Constant *> lanes;
+   for (uint32_t lane = 0; lane < JM()->mVWidth; lane++)
+      lanes.push_back(C(lane * iface->primStride));
+   Value *vBatch = UDIV(vEmitted, VIMMED1(JM()->mVWidth));
+   Value *vIndex = UREM(vEmitted, VIMMED1(JM()->mVWidth));
+   Value *vOffset =
+      ADD(ConstantVector::get(lanes),
+          ADD(MUL(vBatch, VIMMED1((uint32_t)sizeof(simdvertex))),
+              MUL(vIndex, VIMMED1((uint32_t)sizeof(float)))));
+   Value *vActive = ICMP_NE(vMask, VIMMED1(0));
+
+   Value *pStream = LOAD(iface->pGsCtx, {0, SWR_GS_CONTEXT_pStream});
+
+   Value *values[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+   for (uint32_t attrib = 0; attrib < info->num_outputs; attrib++) {
+      for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
+         values[attrib][channel] = outputs[attrib][channel] ?
+            LOAD(unwrap(outputs[attrib][channel])) : nullptr;
+      }
+   }
+
+   for (uint32_t lane = 0; lane < JM()->mVWidth; lane++) {
+      Value *pVertex = SELECT(VEXTRACT(vActive, C(lane)),
+                              GEP(pStream, {VEXTRACT(vOffset, C(lane))}),
+                              iface->pDummyVertex);
+
+      for (uint32_t attrib = 0; attrib < info->num_outputs; attrib++) {
+         uint32_t outSlot = attrib;
+         uint32_t extraSlot = 0;
+         switch (info->output_semantic_name[attrib]) {
+         case TGSI_SEMANTIC_PSIZE:
+            outSlot = VERTEX_POINT_SIZE_SLOT;
+            break;
+         case TGSI_SEMANTIC_PRIMID:
+            extraSlot = VERTEX_PRIMID_SLOT;
+            break;
+         case TGSI_SEMANTIC_LAYER:
+            extraSlot = VERTEX_RTAI_SLOT;
+            break;
+         }
+
+         for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
+            if (!values[attrib][channel])
+               continue;
+
+            Value *val = VEXTRACT(values[attrib][channel], C(lane));
+            uint32_t offset =
+               outSlot * sizeof(simdvector) + channel * sizeof(simdscalar);
+            STORE(val,
+                  BITCAST(GEP(pVertex, {C(offset)}),
+                          PointerType::get(mFP32Ty, 0)));
+
+            // the core picks these up from their own slots
+            if (extraSlot && channel == 0) {
+               offset = extraSlot * sizeof(simdvector);
+               STORE(val,
+                     BITCAST(GEP(pVertex, {C(offset)}),
+                             PointerType::get(mFP32Ty, 0)));
+            }
+         }
+      }
+   }
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+}
+
+void
+BuilderSWR::GSEndPrimitive(struct swr_gs_iface *iface,
+                           Value *vEmitted,
+                           Value *vMask)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   // the last vertex the lane emitted ends the strip; masked off lanes OR
+   // nothing into their first byte
+   std::vector<Constant *> lanes;
+   for (uint32_t lane = 0; lane < JM()->mVWidth; lane++)
+      lanes.push_back(C(lane * iface->cutStride));
+   Value *vActive = ICMP_NE(vMask, VIMMED1(0));
+   Value *vLast = SUB(vEmitted, VIMMED1(1));
+   Value *vOffset = ADD(ConstantVector::get(lanes),
+                        SELECT(vActive, UDIV(vLast, VIMMED1(8)), VIMMED1(0)));
+   Value *vBit = SELECT(vActive,
+                        SHL(VIMMED1(1), UREM(vLast, VIMMED1(8))),
+                        VIMMED1(0));
+
+   Value *pCut =
+      LOAD(iface->pGsCtx, {0, SWR_GS_CONTEXT_pCutOrStreamIdBuffer});
+
+   for (uint32_t lane = 0; lane < JM()->mVWidth; lane++) {
+      Value *pByte = GEP(pCut, {VEXTRACT(vOffset, C(lane))});
+      Value *bit = TRUNC(VEXTRACT(vBit, C(lane)), mInt8Ty);
+      STORE(OR(LOAD(pByte), bit), pByte);
+   }
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+}
+
+void
+BuilderSWR::GSEpilogue(struct swr_gs_iface *iface, Value *vEmitted)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+   STORE(vEmitted, iface->pGsCtx, {0, SWR_GS_CONTEXT_vertexCount});
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+}
+
+PFN_GS_FUNC
+BuilderSWR::CompileGS(struct swr_geometry_shader *swr_gs, swr_jit_gs_key &key)
+{
+   const struct tgsi_shader_info *info = &swr_gs->info.base;
+   const SWR_GS_STATE *gsState = &swr_gs->gsState;
+
+   struct gallivm_state *gallivm =
+      gallivm_create("GS", wrap(&JM()->mContext));
+   gallivm->module = wrap(JM()->mpCurrentModule);
+
+   LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
+   LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+
+   memset(inputs, 0, sizeof(inputs));
+   memset(outputs, 0, sizeof(outputs));
+
+   AttrBuilder attrBuilder;
+   attrBuilder.addStackAlignmentAttr(JM()->mVWidth * sizeof(float));
+   AttributeSet attrSet = AttributeSet::get(
+      JM()->mContext, AttributeSet::FunctionIndex, attrBuilder);
+
+   std::vector<Type *> gsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                              PointerType::get(Gen_SWR_GS_CONTEXT(JM()), 0)};
+   FunctionType *gsFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), gsArgs, false);
+
+   // create new geometry shader function
+   auto pFunction = Function::Create(gsFuncType,
+                                     GlobalValue::ExternalLinkage,
+                                     "GS",
+                                     JM()->mpCurrentModule);
+   pFunction->addAttributes(AttributeSet::FunctionIndex, attrSet);
+
+   BasicBlock *block = BasicBlock::Create(JM()->mContext, "entry", pFunction);
+   IRB()->SetInsertPoint(block);
+
+   auto argitr = pFunction->arg_begin();
+   Value *hPrivateData = &*argitr++;
+   hPrivateData->setName("hPrivateData");
+   Value *pGsCtx = &*argitr++;
+   pGsCtx->setName("gsCtx");
+
+   Value *consts_ptr = GEP(hPrivateData, {C(0), C(swr_draw_context_constantGS)});
+   consts_ptr->setName("gs_constants");
+   Value *const_sizes_ptr =
+      GEP(hPrivateData, {0, swr_draw_context_num_constantsGS});
+   const_sizes_ptr->setName("num_gs_constants");
+
+   struct swr_gs_iface iface;
+   memset(&iface, 0, sizeof(iface));
+   iface.base.fetch_input = swr_gs_fetch_input;
+   iface.base.emit_vertex = swr_gs_emit_vertex;
+   iface.base.end_primitive = swr_gs_end_primitive;
+   iface.base.gs_epilogue = swr_gs_epilogue;
+   iface.builder = this;
+   iface.gallivm = gallivm;
+   iface.swr_gs = swr_gs;
+   iface.pGsCtx = pGsCtx;
+   iface.pDummyVertex = BITCAST(ALLOCA(Gen_simdvertex(JM())),
+                                PointerType::get(mInt8Ty, 0));
+   iface.primStride =
+      (gsState->maxNumVerts + JM()->mVWidth - 1) / JM()->mVWidth
+      * sizeof(simdvertex);
+   iface.cutStride = (gsState->maxNumVerts + 7) / 8;
+   for (uint32_t i = 0; i < info->num_inputs; i++) {
+      iface.inputSlot[i] = locate_input(info->input_semantic_name[i],
+                                        info->input_semantic_index[i],
+                                        key.vs_num_outputs,
+                                        key.vs_output_semantic_name,
+                                        key.vs_output_semantic_idx);
+   }
+
+   struct lp_bld_tgsi_system_values system_values;
+   memset(&system_values, 0, sizeof(system_values));
+   system_values.prim_id =
+      wrap(LOAD(pGsCtx, {0, SWR_GS_CONTEXT_PrimitiveID}));
+   system_values.invocation_id =
+      wrap(LOAD(pGsCtx, {0, SWR_GS_CONTEXT_InstanceID}));
+
+   // end primitive only ever sets cut bits, start the lanes' bytes clear
+   Value *pCut = LOAD(pGsCtx, {0, SWR_GS_CONTEXT_pCutOrStreamIdBuffer});
+   MEMSET(pCut, C((char)0), iface.cutStride * JM()->mVWidth, 1);
+
+   Value *vMask = LOAD(pGsCtx, {0, SWR_GS_CONTEXT_mask});
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+
+   struct lp_build_mask_context mask;
+   lp_build_mask_begin(
+      &mask, gallivm, lp_type_float_vec(32, 32 * 8), wrap(vMask));
+
+   struct lp_build_sampler_soa *sampler =
+      swr_sampler_soa_create(key.sampler, PIPE_SHADER_GEOMETRY);
+
+   lp_build_tgsi_soa(gallivm,
+                     swr_gs->pipe.tokens,
+                     lp_type_float_vec(32, 32 * 8),
+                     &mask, // mask
+                     wrap(consts_ptr),
+                     wrap(const_sizes_ptr),
+                     &system_values,
+                     inputs,
+                     outputs,
+                     wrap(hPrivateData),
+                     NULL, // thread data
+                     sampler, // sampler
+                     info,
+                     &iface.base, // geometry shader face
+                     NULL, // compute shader face
+                     NULL); // tessellation shader face
+
+   lp_build_mask_end(&mask);
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
 
-   for (unsigned i = 0; i < key.nr_samplers; i++) {
-      if (swr_fs->info.base.file_mask[TGSI_FILE_SAMPLER] & (1 << i)) {
-         lp_sampler_static_sampler_state(
-            &key.sampler[i].sampler_state,
-            ctx->samplers[PIPE_SHADER_FRAGMENT][i]);
+   RET_VOID();
+
+   gallivm_verify_function(gallivm, wrap(pFunction));
+   gallivm_compile_module(gallivm);
+
+   PFN_GS_FUNC pFunc =
+      (PFN_GS_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
+   debug_printf("geom shader  %p\n", pFunc);
+   assert(pFunc && "Error: GeomShader = NULL");
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 5)
+   JM()->mIsModuleFinalized = true;
+#endif
+
+   return pFunc;
+}
+
+PFN_GS_FUNC
+swr_compile_gs(struct swr_context *ctx, swr_jit_gs_key &key)
+{
+   BuilderSWR builder(
+      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr));
+   return builder.CompileGS(ctx->gs, key);
+}
+
+/*
+ * Control shader outputs and evaluation shader inputs live in the core's
+ * ScalarPatch.  Registers are found through tables of their byte offset in
+ * the patch, per channel, and their stride between control points, 0 for
+ * the per patch ones, so indirectly addressed registers cost a lookup.
+ */
+struct swr_patch_regs {
+   uint32_t offset[PIPE_MAX_SHADER_OUTPUTS * TGSI_NUM_CHANNELS];
+   uint32_t stride[PIPE_MAX_SHADER_OUTPUTS];
+};
+
+static void
+swr_locate_patch_reg(swr_patch_regs &regs,
+                     uint32_t reg,
+                     ubyte name,
+                     ubyte index,
+                     uint32_t cpSlot,
+                     bool isolines)
+{
+   for (uint32_t chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+      uint32_t offset = chan * sizeof(float);
+      switch (name) {
+      case TGSI_SEMANTIC_TESSOUTER:
+         // the core has isoline detail and density the other way around
+         if (isolines && chan < 2)
+            offset = (chan ^ 1) * sizeof(float);
+         offset += offsetof(ScalarPatch, tessFactors.OuterTessFactors);
+         break;
+      case TGSI_SEMANTIC_TESSINNER:
+         // two inner levels only, .zw land in a patch slot no varying uses
+         if (chan < 2)
+            offset += offsetof(ScalarPatch, tessFactors.InnerTessFactors);
+         else
+            offset += offsetof(ScalarPatch, patchData)
+               + (KNOB_NUM_ATTRIBUTES - 1) * sizeof(ScalarAttrib);
+         break;
+      case TGSI_SEMANTIC_PATCH:
+         offset += offsetof(ScalarPatch, patchData)
+            + index * sizeof(ScalarAttrib);
+         break;
+      default:
+         offset += offsetof(ScalarPatch, cp) + cpSlot * sizeof(ScalarAttrib);
+         break;
+      }
+      regs.offset[reg * TGSI_NUM_CHANNELS + chan] = offset;
+   }
+   regs.stride[reg] = swr_tess_per_patch(name) ? 0 : sizeof(ScalarCPoint);
+}
+
+/*
+ * The HS runs on a SIMD of patches, the control shader invocations of a
+ * patch as a loop.  Barriers end the loop and start another one, as for
+ * compute thread groups, with the temporaries of each invocation in a stack
+ * array meanwhile.  The DS runs a SIMD of domain points of one patch.
+ */
+struct swr_tess_iface {
+   struct lp_build_tgsi_tess_iface base;
+   struct lp_build_tgsi_cs_iface cs_base; /* TCS barriers */
+   BuilderSWR *builder;
+   struct gallivm_state *gallivm;
+   Value *pHsCtx;
+   Value *pPatch;         /* i8 pointer to the patch of lane 0 */
+   uint32_t patchStride;  /* bytes between the lanes' patches, 0 in the DS */
+   uint32_t maxVertex;    /* control points of the patch - 1 */
+   Value *vRegOffset;     /* swr_patch_regs */
+   Value *vRegStride;
+   Value *pDummy;         /* stores of masked off lanes go here */
+   uint32_t inputSlot[PIPE_MAX_SHADER_INPUTS];
+   unsigned vertices_out;
+   Value *pTemps;         /* null without barriers */
+   unsigned temps_stride;
+   struct lp_build_loop_state loop;
+   struct lp_build_mask_context mask;
+};
+
+static LLVMValueRef
+swr_tcs_fetch_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                    struct lp_build_tgsi_context *bld_base,
+                    boolean is_vindex_indirect,
+                    LLVMValueRef vertex_index,
+                    boolean is_aindex_indirect,
+                    LLVMValueRef attrib_index,
+                    LLVMValueRef swizzle_index)
+{
+   struct swr_tess_iface *iface = (struct swr_tess_iface *)tess_iface;
+
+   return wrap(iface->builder->FetchVertexInput(iface->gallivm,
+                                                iface->pHsCtx,
+                                                SWR_HS_CONTEXT_vert,
+                                                iface->inputSlot,
+                                                is_vindex_indirect,
+                                                unwrap(vertex_index),
+                                                is_aindex_indirect,
+                                                unwrap(attrib_index),
+                                                unwrap(swizzle_index)));
+}
+
+static LLVMValueRef
+swr_tess_fetch_patch(const struct lp_build_tgsi_tess_iface *tess_iface,
+                     struct lp_build_tgsi_context *bld_base,
+                     boolean is_vindex_indirect,
+                     LLVMValueRef vertex_index,
+                     boolean is_aindex_indirect,
+                     LLVMValueRef attrib_index,
+                     LLVMValueRef swizzle_index)
+{
+   struct swr_tess_iface *iface = (struct swr_tess_iface *)tess_iface;
+
+   return wrap(iface->builder->TessFetchPatch(iface,
+                                              is_vindex_indirect,
+                                              unwrap(vertex_index),
+                                              is_aindex_indirect,
+                                              unwrap(attrib_index),
+                                              unwrap(swizzle_index)));
+}
+
+static void
+swr_tcs_store_output(const struct lp_build_tgsi_tess_iface *tess_iface,
+                     struct lp_build_tgsi_context *bld_base,
+                     boolean is_vindex_indirect,
+                     LLVMValueRef vertex_index,
+                     boolean is_aindex_indirect,
+                     LLVMValueRef attrib_index,
+                     LLVMValueRef swizzle_index,
+                     LLVMValueRef value,
+                     LLVMValueRef mask_vec)
+{
+   struct swr_tess_iface *iface = (struct swr_tess_iface *)tess_iface;
+
+   iface->builder->TCSStoreOutput(iface,
+                                  is_vindex_indirect,
+                                  unwrap(vertex_index),
+                                  is_aindex_indirect,
+                                  unwrap(attrib_index),
+                                  unwrap(swizzle_index),
+                                  unwrap(value),
+                                  unwrap(mask_vec));
+}
+
+static void
+swr_tcs_barrier(struct lp_build_tgsi_cs_iface *cs_iface,
+                struct lp_build_tgsi_context *bld_base,
+                struct lp_bld_tgsi_system_values *system_values)
+{
+   struct swr_tess_iface *iface = (struct swr_tess_iface *)
+      ((char *)cs_iface - offsetof(struct swr_tess_iface, cs_base));
+
+   iface->builder->TCSInvocationEnd(iface);
+   iface->builder->TCSInvocationBegin(iface, system_values);
+}
+
+/* Address of a patch register in the patch of a lane */
+Value *
+BuilderSWR::TessRegAddress(struct swr_tess_iface *iface,
+                           uint32_t lane,
+                           boolean is_vindex_indirect,
+                           Value *vertex_index,
+                           boolean is_aindex_indirect,
+                           Value *attrib_index,
+                           Value *swizzle_index)
+{
+   Value *attrib = is_aindex_indirect ?
+      VEXTRACT(attrib_index, C(lane)) : attrib_index;
+   Value *offset =
+      VEXTRACT(iface->vRegOffset,
+               ADD(MUL(attrib, C(TGSI_NUM_CHANNELS)), swizzle_index));
+
+   if (vertex_index) {
+      Value *vertex = is_vindex_indirect ?
+         VEXTRACT(vertex_index, C(lane)) : vertex_index;
+      vertex = SELECT(ICMP_ULT(vertex, C(iface->maxVertex)),
+                      vertex, C(iface->maxVertex));
+      offset = ADD(offset,
+                   MUL(vertex, VEXTRACT(iface->vRegStride, attrib)));
+   }
+
+   offset = ADD(offset, C(lane * iface->patchStride));
+   return BITCAST(GEP(iface->pPatch, {offset}),
+                  PointerType::get(mFP32Ty, 0));
+}
+
+Value *
+BuilderSWR::TessFetchPatch(struct swr_tess_iface *iface,
+                           boolean is_vindex_indirect,
+                           Value *vertex_index,
+                           boolean is_aindex_indirect,
+                           Value *attrib_index,
+                           Value *swizzle_index)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+   Value *res;
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   if (!iface->patchStride && !is_vindex_indirect && !is_aindex_indirect) {
+      // all lanes read the same patch
+      res = VBROADCAST(LOAD(TessRegAddress(iface, 0,
+                                           is_vindex_indirect, vertex_index,
+                                           is_aindex_indirect, attrib_index,
+                                           swizzle_index)));
+   } else {
+      res = VUNDEF_F();
+      for (uint32_t lane = 0; lane < JM()->mVWidth; lane++) {
+         Value *pReg = TessRegAddress(iface, lane,
+                                      is_vindex_indirect, vertex_index,
+                                      is_aindex_indirect, attrib_index,
+                                      swizzle_index);
+         res = VINSERT(res, LOAD(pReg), C(lane));
+      }
+   }
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+   return res;
+}
+
+void
+BuilderSWR::TCSStoreOutput(struct swr_tess_iface *iface,
+                           boolean is_vindex_indirect,
+                           Value *vertex_index,
+                           boolean is_aindex_indirect,
+                           Value *attrib_index,
+                           Value *swizzle_index,
+                           Value *value,
+                           Value *vMask)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   Value *vActive = ICMP_NE(vMask, VIMMED1(0));
+   for (uint32_t lane = 0; lane < JM()->mVWidth; lane++) {
+      Value *pReg = TessRegAddress(iface, lane,
+                                   is_vindex_indirect, vertex_index,
+                                   is_aindex_indirect, attrib_index,
+                                   swizzle_index);
+      pReg = SELECT(VEXTRACT(vActive, C(lane)), pReg, iface->pDummy);
+      STORE(VEXTRACT(value, C(lane)), pReg);
+   }
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+}
+
+void
+BuilderSWR::TCSInvocationBegin(struct swr_tess_iface *iface,
+                               struct lp_bld_tgsi_system_values *system_values)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+
+   lp_build_loop_begin(&iface->loop, gallivm, lp_build_const_int32(gallivm, 0));
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   Value *invocation = unwrap(iface->loop.counter);
+   system_values->invocation_id = wrap(invocation);
+
+   if (iface->pTemps) {
+      Value *pTemps =
+         GEP(iface->pTemps, {MUL(invocation, C(iface->temps_stride))});
+      iface->cs_base.temps_ptr =
+         wrap(BITCAST(pTemps, PointerType::get(mSimdFP32Ty, 0)));
+   }
+
+   Value *vMask = LOAD(iface->pHsCtx, {0, SWR_HS_CONTEXT_mask});
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+   lp_build_mask_begin(
+      &iface->mask, gallivm, lp_type_float_vec(32, 32 * 8), wrap(vMask));
+}
+
+void
+BuilderSWR::TCSInvocationEnd(struct swr_tess_iface *iface)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+
+   lp_build_mask_end(&iface->mask);
+   lp_build_loop_end(&iface->loop,
+                     lp_build_const_int32(gallivm, iface->vertices_out),
+                     NULL);
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+}
+
+/* Without a TCS the VS outputs and the default levels make the patch */
+void
+BuilderSWR::HSPassthrough(struct swr_tess_iface *iface,
+                          swr_jit_tcs_key &key,
+                          Value *hPrivateData)
+{
+   Value *pHsCtx = iface->pHsCtx;
+
+   for (uint32_t lane = 0; lane < JM()->mVWidth; lane++) {
+      Value *pLanePatch = GEP(iface->pPatch, {C(lane * iface->patchStride)});
+
+      for (uint32_t v = 0; v < key.vertices_in; v++) {
+         for (uint32_t i = 0; i < key.vs_num_outputs; i++) {
+            uint32_t inSlot = i;
+            if (key.vs_output_semantic_name[i] == TGSI_SEMANTIC_PSIZE)
+               inSlot = VERTEX_POINT_SIZE_SLOT;
+            for (uint32_t chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+               Value *val = LOAD(pHsCtx,
+                                 {0, SWR_HS_CONTEXT_vert, v,
+                                  simdvertex_attrib, inSlot, chan});
+               uint32_t offset = offsetof(ScalarPatch, cp)
+                  + v * sizeof(ScalarCPoint) + i * sizeof(ScalarAttrib)
+                  + chan * sizeof(float);
+               STORE(VEXTRACT(val, C(lane)),
+                     BITCAST(GEP(pLanePatch, {C(offset)}),
+                             PointerType::get(mFP32Ty, 0)));
+            }
+         }
+      }
+
+      for (uint32_t i = 0; i < 4; i++) {
+         // the core has isoline detail and density the other way around
+         uint32_t level = (key.isolines && i < 2) ? i ^ 1 : i;
+         uint32_t offset = offsetof(ScalarPatch, tessFactors.OuterTessFactors)
+            + level * sizeof(float);
+         STORE(LOAD(hPrivateData, {0, swr_draw_context_tessOuterLevel, i}),
+               BITCAST(GEP(pLanePatch, {C(offset)}),
+                       PointerType::get(mFP32Ty, 0)));
+      }
+      for (uint32_t i = 0; i < 2; i++) {
+         uint32_t offset = offsetof(ScalarPatch, tessFactors.InnerTessFactors)
+            + i * sizeof(float);
+         STORE(LOAD(hPrivateData, {0, swr_draw_context_tessInnerLevel, i}),
+               BITCAST(GEP(pLanePatch, {C(offset)}),
+                       PointerType::get(mFP32Ty, 0)));
+      }
+   }
+}
+
+PFN_HS_FUNC
+BuilderSWR::CompileHS(struct swr_tess_ctrl_shader *swr_tcs,
+                      swr_jit_tcs_key &key)
+{
+   struct gallivm_state *gallivm =
+      gallivm_create("HS", wrap(&JM()->mContext));
+   gallivm->module = wrap(JM()->mpCurrentModule);
+
+   LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
+   LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+
+   memset(inputs, 0, sizeof(inputs));
+   memset(outputs, 0, sizeof(outputs));
+
+   AttrBuilder attrBuilder;
+   attrBuilder.addStackAlignmentAttr(JM()->mVWidth * sizeof(float));
+   AttributeSet attrSet = AttributeSet::get(
+      JM()->mContext, AttributeSet::FunctionIndex, attrBuilder);
+
+   std::vector<Type *> hsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                              PointerType::get(Gen_SWR_HS_CONTEXT(JM()), 0)};
+   FunctionType *hsFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), hsArgs, false);
+
+   // create new hull shader function
+   auto pFunction = Function::Create(hsFuncType,
+                                     GlobalValue::ExternalLinkage,
+                                     "HS",
+                                     JM()->mpCurrentModule);
+   pFunction->addAttributes(AttributeSet::FunctionIndex, attrSet);
+
+   BasicBlock *block = BasicBlock::Create(JM()->mContext, "entry", pFunction);
+   IRB()->SetInsertPoint(block);
+
+   auto argitr = pFunction->arg_begin();
+   Value *hPrivateData = &*argitr++;
+   hPrivateData->setName("hPrivateData");
+   Value *pHsCtx = &*argitr++;
+   pHsCtx->setName("hsCtx");
+
+   struct swr_tess_iface iface;
+   memset(&iface, 0, sizeof(iface));
+   iface.builder = this;
+   iface.gallivm = gallivm;
+   iface.pHsCtx = pHsCtx;
+   iface.pPatch = BITCAST(LOAD(pHsCtx, {0, SWR_HS_CONTEXT_pCPout}),
+                          PointerType::get(mInt8Ty, 0));
+   iface.patchStride = sizeof(ScalarPatch);
+
+   if (key.passthrough) {
+      HSPassthrough(&iface, key, hPrivateData);
+   } else {
+      const struct tgsi_shader_info *info = &swr_tcs->info.base;
+
+      Value *consts_ptr =
+         GEP(hPrivateData, {C(0), C(swr_draw_context_constantTCS)});
+      consts_ptr->setName("tcs_constants");
+      Value *const_sizes_ptr =
+         GEP(hPrivateData, {0, swr_draw_context_num_constantsTCS});
+      const_sizes_ptr->setName("num_tcs_constants");
+
+      iface.base.fetch_input = swr_tcs_fetch_input;
+      iface.base.fetch_output = swr_tess_fetch_patch;
+      iface.base.store_output = swr_tcs_store_output;
+      iface.cs_base.barrier = swr_tcs_barrier;
+      iface.vertices_out = swr_tcs->vertices_out;
+      iface.maxVertex = swr_tcs->vertices_out - 1;
+      iface.pDummy = ALLOCA(mFP32Ty);
+      for (uint32_t i = 0; i < info->num_inputs; i++) {
+         iface.inputSlot[i] = locate_input(info->input_semantic_name[i],
+                                           info->input_semantic_index[i],
+                                           key.vs_num_outputs,
+                                           key.vs_output_semantic_name,
+                                           key.vs_output_semantic_idx);
       }
-   }
 
-   /*
-    * XXX If TGSI_FILE_SAMPLER_VIEW exists assume all texture opcodes
-    * are dx10-style? Can't really have mixed opcodes, at least not
-    * if we want to skip the holes here (without rescanning tgsi).
-    */
-   if (swr_fs->info.base.file_max[TGSI_FILE_SAMPLER_VIEW] != -1) {
-      key.nr_sampler_views =
-         swr_fs->info.base.file_max[TGSI_FILE_SAMPLER_VIEW] + 1;
-      for (unsigned i = 0; i < key.nr_sampler_views; i++) {
-         if (swr_fs->info.base.file_mask[TGSI_FILE_SAMPLER_VIEW] & (1 << i)) {
-            lp_sampler_static_texture_state(
-               &key.sampler[i].texture_state,
-               ctx->sampler_views[PIPE_SHADER_FRAGMENT][i]);
-         }
+      swr_patch_regs regs;
+      memset(&regs, 0, sizeof(regs));
+      uint32_t cpSlot = 0;
+      for (uint32_t i = 0; i < info->num_outputs; i++) {
+         swr_locate_patch_reg(regs, i,
+                              info->output_semantic_name[i],
+                              info->output_semantic_index[i],
+                              cpSlot, key.isolines);
+         if (!swr_tess_per_patch(info->output_semantic_name[i]))
+            cpSlot++;
       }
-   } else {
-      key.nr_sampler_views = key.nr_samplers;
-      for (unsigned i = 0; i < key.nr_sampler_views; i++) {
-         if (swr_fs->info.base.file_mask[TGSI_FILE_SAMPLER] & (1 << i)) {
-            lp_sampler_static_texture_state(
-               &key.sampler[i].texture_state,
-               ctx->sampler_views[PIPE_SHADER_FRAGMENT][i]);
-         }
+      std::vector<Constant *> offsets, strides;
+      for (uint32_t i = 0; i < MAX2(info->num_outputs, 1); i++) {
+         for (uint32_t chan = 0; chan < TGSI_NUM_CHANNELS; chan++)
+            offsets.push_back(C(regs.offset[i * TGSI_NUM_CHANNELS + chan]));
+         strides.push_back(C(regs.stride[i]));
+      }
+      iface.vRegOffset = ConstantVector::get(offsets);
+      iface.vRegStride = ConstantVector::get(strides);
+
+      bool barriers = info->opcode_count[TGSI_OPCODE_BARRIER] != 0;
+      if (barriers) {
+         unsigned num_temps = info->file_max[TGSI_FILE_TEMPORARY] + 1;
+         iface.temps_stride = num_temps * TGSI_NUM_CHANNELS;
+         iface.pTemps = ALLOCA(mSimdFP32Ty,
+                               C(iface.vertices_out * iface.temps_stride));
       }
-   }
-}
 
-struct BuilderSWR : public Builder {
-   BuilderSWR(JitManager *pJitMgr)
-      : Builder(pJitMgr)
-   {
-      pJitMgr->SetupNewModule();
+      struct lp_bld_tgsi_system_values system_values;
+      memset(&system_values, 0, sizeof(system_values));
+      system_values.prim_id =
+         wrap(LOAD(pHsCtx, {0, SWR_HS_CONTEXT_PrimitiveID}));
+      system_values.vertices_in = wrap(C(key.vertices_in));
+
+      LLVMPositionBuilderAtEnd(gallivm->builder,
+                               wrap(IRB()->GetInsertBlock()));
+      TCSInvocationBegin(&iface, &system_values);
+
+      struct lp_build_sampler_soa *sampler =
+         swr_sampler_soa_create(key.sampler, PIPE_SHADER_TESS_CTRL);
+
+      lp_build_tgsi_soa(gallivm,
+                        swr_tcs->pipe.tokens,
+                        lp_type_float_vec(32, 32 * 8),
+                        &iface.mask, // mask
+                        wrap(consts_ptr),
+                        wrap(const_sizes_ptr),
+                        &system_values,
+                        inputs,
+                        outputs,
+                        wrap(hPrivateData),
+                        NULL, // thread data
+                        sampler, // sampler
+                        info,
+                        NULL, // geometry shader face
+                        barriers ? &iface.cs_base : NULL, // barriers
+                        &iface.base); // tessellation shader face
+
+      TCSInvocationEnd(&iface);
    }
 
-   PFN_VERTEX_FUNC
-   CompileVS(struct pipe_context *ctx, swr_vertex_shader *swr_vs);
-   PFN_PIXEL_KERNEL CompileFS(struct swr_context *ctx, swr_jit_key &key);
-};
+   RET_VOID();
 
-PFN_VERTEX_FUNC
-BuilderSWR::CompileVS(struct pipe_context *ctx, swr_vertex_shader *swr_vs)
-{
-   swr_vs->linkageMask = 0;
+   gallivm_verify_function(gallivm, wrap(pFunction));
+   gallivm_compile_module(gallivm);
 
-   for (unsigned i = 0; i < swr_vs->info.base.num_outputs; i++) {
-      switch (swr_vs->info.base.output_semantic_name[i]) {
-      case TGSI_SEMANTIC_POSITION:
-         break;
-      default:
-         swr_vs->linkageMask |= (1 << i);
-         break;
-      }
-   }
+   PFN_HS_FUNC pFunc =
+      (PFN_HS_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
+   debug_printf("hull shader  %p\n", pFunc);
+   assert(pFunc && "Error: HullShader = NULL");
 
-   //   tgsi_dump(swr_vs->pipe.tokens, 0);
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 5)
+   JM()->mIsModuleFinalized = true;
+#endif
+
+   return pFunc;
+}
+
+PFN_HS_FUNC
+swr_compile_hs(struct swr_context *ctx, swr_jit_tcs_key &key)
+{
+   BuilderSWR builder(
+      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr));
+   return builder.CompileHS(ctx->tcs, key);
+}
+
+PFN_DS_FUNC
+BuilderSWR::CompileDS(struct swr_tess_eval_shader *swr_tes,
+                      swr_jit_tes_key &key)
+{
+   const struct tgsi_shader_info *info = &swr_tes->info.base;
+   const unsigned prim_mode = info->properties[TGSI_PROPERTY_TES_PRIM_MODE];
+   const bool isolines = prim_mode == PIPE_PRIM_LINES;
 
    struct gallivm_state *gallivm =
-      gallivm_create("VS", wrap(&JM()->mContext));
+      gallivm_create("DS", wrap(&JM()->mContext));
    gallivm->module = wrap(JM()->mpCurrentModule);
 
    LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
    LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
 
+   memset(inputs, 0, sizeof(inputs));
    memset(outputs, 0, sizeof(outputs));
 
    AttrBuilder attrBuilder;
@@ -139,82 +1452,148 @@ BuilderSWR::CompileVS(struct pipe_context *ctx, swr_vertex_shader *swr_vs)
    AttributeSet attrSet = AttributeSet::get(
       JM()->mContext, AttributeSet::FunctionIndex, attrBuilder);
 
-   std::vector<Type *> vsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
-                              PointerType::get(Gen_SWR_VS_CONTEXT(JM()), 0)};
-   FunctionType *vsFuncType =
-      FunctionType::get(Type::getVoidTy(JM()->mContext), vsArgs, false);
+   std::vector<Type *> dsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                              PointerType::get(Gen_SWR_DS_CONTEXT(JM()), 0)};
+   FunctionType *dsFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), dsArgs, false);
 
-   // create new vertex shader function
-   auto pFunction = Function::Create(vsFuncType,
+   // create new domain shader function
+   auto pFunction = Function::Create(dsFuncType,
                                      GlobalValue::ExternalLinkage,
-                                     "VS",
+                                     "DS",
                                      JM()->mpCurrentModule);
    pFunction->addAttributes(AttributeSet::FunctionIndex, attrSet);
 
    BasicBlock *block = BasicBlock::Create(JM()->mContext, "entry", pFunction);
    IRB()->SetInsertPoint(block);
-   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(block));
 
    auto argitr = pFunction->arg_begin();
    Value *hPrivateData = &*argitr++;
    hPrivateData->setName("hPrivateData");
-   Value *pVsCtx = &*argitr++;
-   pVsCtx->setName("vsCtx");
-   
-   Value *consts_ptr = GEP(hPrivateData, {C(0), C(swr_draw_context_constantVS)});
+   Value *pDsCtx = &*argitr++;
+   pDsCtx->setName("dsCtx");
 
-   consts_ptr->setName("vs_constants");
+   Value *consts_ptr = GEP(hPrivateData, {C(0), C(swr_draw_context_constantTES)});
+   consts_ptr->setName("tes_constants");
    Value *const_sizes_ptr =
-      GEP(hPrivateData, {0, swr_draw_context_num_constantsVS});
-   const_sizes_ptr->setName("num_vs_constants");
-
-   Value *vtxInput = LOAD(pVsCtx, {0, SWR_VS_CONTEXT_pVin});
-
-   for (uint32_t attrib = 0; attrib < PIPE_MAX_SHADER_INPUTS; attrib++) {
-      const unsigned mask = swr_vs->info.base.input_usage_mask[attrib];
-      for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
-         if (mask & (1 << channel)) {
-            inputs[attrib][channel] =
-               wrap(LOAD(vtxInput, {0, 0, attrib, channel}));
+      GEP(hPrivateData, {0, swr_draw_context_num_constantsTES});
+   const_sizes_ptr->setName("num_tes_constants");
+
+   struct swr_tess_iface iface;
+   memset(&iface, 0, sizeof(iface));
+   iface.base.fetch_input = swr_tess_fetch_patch;
+   iface.builder = this;
+   iface.gallivm = gallivm;
+   iface.pPatch = BITCAST(LOAD(pDsCtx, {0, SWR_DS_CONTEXT_pCpIn}),
+                          PointerType::get(mInt8Ty, 0));
+   iface.maxVertex = key.vertices_in - 1;
+
+   swr_patch_regs regs;
+   memset(&regs, 0, sizeof(regs));
+   for (uint32_t i = 0; i < info->num_inputs; i++) {
+      ubyte name = info->input_semantic_name[i];
+      ubyte index = info->input_semantic_index[i];
+      uint32_t cpSlot = 0; /* not written by the TCS, undefined */
+      for (uint32_t slot = 0; slot < key.tcs_num_outputs; slot++) {
+         if (key.tcs_output_semantic_name[slot] == name
+             && key.tcs_output_semantic_idx[slot] == index) {
+            cpSlot = slot;
+            break;
          }
       }
+      swr_locate_patch_reg(regs, i, name, index, cpSlot, isolines);
    }
+   std::vector<Constant *> offsets, strides;
+   for (uint32_t i = 0; i < MAX2(info->num_inputs, 1); i++) {
+      for (uint32_t chan = 0; chan < TGSI_NUM_CHANNELS; chan++)
+         offsets.push_back(C(regs.offset[i * TGSI_NUM_CHANNELS + chan]));
+      strides.push_back(C(regs.stride[i]));
+   }
+   iface.vRegOffset = ConstantVector::get(offsets);
+   iface.vRegStride = ConstantVector::get(strides);
+
+   Value *vectorOffset = LOAD(pDsCtx, {0, SWR_DS_CONTEXT_vectorOffset});
+   Value *vectorStride = LOAD(pDsCtx, {0, SWR_DS_CONTEXT_vectorStride});
 
    struct lp_bld_tgsi_system_values system_values;
    memset(&system_values, 0, sizeof(system_values));
-   system_values.instance_id = wrap(LOAD(pVsCtx, {0, SWR_VS_CONTEXT_InstanceID}));
-   system_values.vertex_id = wrap(LOAD(pVsCtx, {0, SWR_VS_CONTEXT_VertexID}));
+   system_values.prim_id =
+      wrap(VBROADCAST(LOAD(pDsCtx, {0, SWR_DS_CONTEXT_PrimitiveID})));
+   system_values.vertices_in = wrap(C(key.vertices_in));
+
+   Value *vU = LOAD(GEP(LOAD(pDsCtx, {0, SWR_DS_CONTEXT_pDomainU}),
+                        {vectorOffset}));
+   Value *vV = LOAD(GEP(LOAD(pDsCtx, {0, SWR_DS_CONTEXT_pDomainV}),
+                        {vectorOffset}));
+   system_values.tess_coord[0] = wrap(vU);
+   system_values.tess_coord[1] = wrap(vV);
+   system_values.tess_coord[2] = wrap(prim_mode == PIPE_PRIM_TRIANGLES ?
+      FSUB(FSUB(VIMMED1(1.0f), vU), vV) : VIMMED1(0.0f));
+
+   for (uint32_t i = 0; i < 4; i++) {
+      uint32_t level = (isolines && i < 2) ? i ^ 1 : i;
+      uint32_t offset = offsetof(ScalarPatch, tessFactors.OuterTessFactors)
+         + level * sizeof(float);
+      system_values.tess_outer[i] =
+         wrap(LOAD(BITCAST(GEP(iface.pPatch, {C(offset)}),
+                           PointerType::get(mFP32Ty, 0))));
+   }
+   for (uint32_t i = 0; i < 2; i++) {
+      uint32_t offset = offsetof(ScalarPatch, tessFactors.InnerTessFactors)
+         + i * sizeof(float);
+      system_values.tess_inner[i] =
+         wrap(LOAD(BITCAST(GEP(iface.pPatch, {C(offset)}),
+                           PointerType::get(mFP32Ty, 0))));
+   }
+
+   Value *vMask = LOAD(pDsCtx, {0, SWR_DS_CONTEXT_mask});
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+
+   struct lp_build_mask_context mask;
+   lp_build_mask_begin(
+      &mask, gallivm, lp_type_float_vec(32, 32 * 8), wrap(vMask));
+
+   struct lp_build_sampler_soa *sampler =
+      swr_sampler_soa_create(key.sampler, PIPE_SHADER_TESS_EVAL);
 
    lp_build_tgsi_soa(gallivm,
-                     swr_vs->pipe.tokens,
+                     swr_tes->pipe.tokens,
                      lp_type_float_vec(32, 32 * 8),
-                     NULL, // mask
+                     &mask, // mask
                      wrap(consts_ptr),
                      wrap(const_sizes_ptr),
                      &system_values,
                      inputs,
                      outputs,
-                     NULL, // wrap(hPrivateData), (sampler context)
+                     wrap(hPrivateData),
                      NULL, // thread data
-                     NULL, // sampler
-                     &swr_vs->info.base,
-                     NULL); // geometry shader face
+                     sampler, // sampler
+                     info,
+                     NULL, // geometry shader face
+                     NULL, // compute shader face
+                     &iface.base); // tessellation shader face
+
+   lp_build_mask_end(&mask);
 
    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
 
-   Value *vtxOutput = LOAD(pVsCtx, {0, SWR_VS_CONTEXT_pVout});
+   // rows of SIMDs per attribute component, the core gathers the vertices
+   Value *pOutput = LOAD(pDsCtx, {0, SWR_DS_CONTEXT_pOutputData});
 
    for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
-      for (uint32_t attrib = 0; attrib < PIPE_MAX_SHADER_OUTPUTS; attrib++) {
+      for (uint32_t attrib = 0; attrib < info->num_outputs; attrib++) {
          if (!outputs[attrib][channel])
             continue;
 
          Value *val = LOAD(unwrap(outputs[attrib][channel]));
 
          uint32_t outSlot = attrib;
-         if (swr_vs->info.base.output_semantic_name[attrib] == TGSI_SEMANTIC_PSIZE)
+         if (info->output_semantic_name[attrib] == TGSI_SEMANTIC_PSIZE)
             outSlot = VERTEX_POINT_SIZE_SLOT;
-         STORE(val, vtxOutput, {0, 0, outSlot, channel});
+         Value *row = MUL(C(outSlot * TGSI_NUM_CHANNELS + channel),
+                          vectorStride);
+         STORE(val, GEP(pOutput, {ADD(row, vectorOffset)}));
       }
    }
 
@@ -223,13 +1602,10 @@ BuilderSWR::CompileVS(struct pipe_context *ctx, swr_vertex_shader *swr_vs)
    gallivm_verify_function(gallivm, wrap(pFunction));
    gallivm_compile_module(gallivm);
 
-   //   lp_debug_dump_value(func);
-
-   PFN_VERTEX_FUNC pFunc =
-      (PFN_VERTEX_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
-
-   debug_printf("vert shader  %p\n", pFunc);
-   assert(pFunc && "Error: VertShader = NULL");
+   PFN_DS_FUNC pFunc =
+      (PFN_DS_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
+   debug_printf("domain shader  %p\n", pFunc);
+   assert(pFunc && "Error: DomainShader = NULL");
 
 #if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 5)
    JM()->mIsModuleFinalized = true;
@@ -238,28 +1614,28 @@ BuilderSWR::CompileVS(struct pipe_context *ctx, swr_vertex_shader *swr_vs)
    return pFunc;
 }
 
-PFN_VERTEX_FUNC
-swr_compile_vs(struct pipe_context *ctx, swr_vertex_shader *swr_vs)
+PFN_DS_FUNC
+swr_compile_ds(struct swr_context *ctx, swr_jit_tes_key &key)
 {
    BuilderSWR builder(
-      reinterpret_cast<JitManager *>(swr_screen(ctx->screen)->hJitMgr));
-   return builder.CompileVS(ctx, swr_vs);
+      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr));
+   return builder.CompileDS(ctx->tes, key);
 }
 
 static unsigned
-locate_linkage(ubyte name, ubyte index, struct tgsi_shader_info *info)
+locate_linkage(ubyte name, ubyte index, const swr_jit_key &key)
 {
    for (int i = 0; i < PIPE_MAX_SHADER_OUTPUTS; i++) {
-      if ((info->output_semantic_name[i] == name)
-          && (info->output_semantic_index[i] == index)) {
+      if ((key.vs_output_semantic_name[i] == name)
+          && (key.vs_output_semantic_idx[i] == index)) {
          return i - 1; // position is not part of the linkage
       }
    }
 
    if (name == TGSI_SEMANTIC_COLOR) { // BCOLOR fallback
       for (int i = 0; i < PIPE_MAX_SHADER_OUTPUTS; i++) {
-         if ((info->output_semantic_name[i] == TGSI_SEMANTIC_BCOLOR)
-             && (info->output_semantic_index[i] == index)) {
+         if ((key.vs_output_semantic_name[i] == TGSI_SEMANTIC_BCOLOR)
+             && (key.vs_output_semantic_idx[i] == index)) {
             return i - 1; // position is not part of the linkage
          }
       }
@@ -268,11 +1644,15 @@ locate_linkage(ubyte name, ubyte index, struct tgsi_shader_info *info)
    return 0xFFFFFFFF;
 }
 
+/*
+ * Everything CompileFS depends on besides the shader itself is in the key,
+ * so constant specialized variants can be built off the API thread.
+ */
 PFN_PIXEL_KERNEL
-BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
+BuilderSWR::CompileFS(struct swr_fragment_shader *swr_fs,
+                      swr_jit_key &key,
+                      const swr_fs_constants *constants)
 {
-   struct swr_fragment_shader *swr_fs = ctx->fs;
-
    //   tgsi_dump(swr_fs->pipe.tokens, 0);
 
    struct gallivm_state *gallivm =
@@ -294,6 +1674,8 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
 
    std::vector<Type *> fsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
                               PointerType::get(Gen_SWR_PS_CONTEXT(JM()), 0)};
+   if (key.tile_kernel)
+      fsArgs.push_back(PointerType::get(Gen_SWR_PS_TILE_CONTEXT(JM()), 0));
    FunctionType *funcType =
       FunctionType::get(Type::getVoidTy(JM()->mContext), fsArgs, false);
 
@@ -312,23 +1694,207 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
    hPrivateData->setName("hPrivateData");
    Value *pPS = &*args++;
    pPS->setName("psCtx");
+   Value *pTile = nullptr;
+   if (key.tile_kernel) {
+      pTile = &*args++;
+      pTile->setName("tileCtx");
+   }
 
-   Value *consts_ptr = GEP(hPrivateData, {0, swr_draw_context_constantFS});
-   consts_ptr->setName("fs_constants");
-   Value *const_sizes_ptr =
-      GEP(hPrivateData, {0, swr_draw_context_num_constantsFS});
-   const_sizes_ptr->setName("num_fs_constants");
+   Value *consts_ptr, *const_sizes_ptr;
+   if (constants) {
+      /*
+       * Constant specialized variant: read the constant buffers from a
+       * snapshot baked into the module instead of swr_draw_context, so
+       * loads fold to immediates and uniform dependent branches go away.
+       */
+      PointerType *floatPtrTy = PointerType::get(mFP32Ty, 0);
+      std::vector<Constant *> buffers, sizes;
+      for (unsigned i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
+         sizes.push_back(C(constants->num_constants[i]));
+         if (constants->data[i].empty()) {
+            buffers.push_back(ConstantPointerNull::get(floatPtrTy));
+            continue;
+         }
+         Constant *init = ConstantDataArray::get(
+            JM()->mContext, ArrayRef<float>(constants->data[i]));
+         GlobalVariable *buffer = new GlobalVariable(
+            *JM()->mpCurrentModule, init->getType(), true,
+            GlobalValue::InternalLinkage, init, "fs_constant_buffer");
+         buffers.push_back(ConstantExpr::getBitCast(buffer, floatPtrTy));
+      }
+
+      Constant *init = ConstantArray::get(
+         ArrayType::get(floatPtrTy, PIPE_MAX_CONSTANT_BUFFERS), buffers);
+      consts_ptr = new GlobalVariable(*JM()->mpCurrentModule,
+                                      init->getType(), true,
+                                      GlobalValue::InternalLinkage, init,
+                                      "fs_constants");
+      init = ConstantArray::get(
+         ArrayType::get(mInt32Ty, PIPE_MAX_CONSTANT_BUFFERS), sizes);
+      const_sizes_ptr = new GlobalVariable(*JM()->mpCurrentModule,
+                                           init->getType(), true,
+                                           GlobalValue::InternalLinkage, init,
+                                           "num_fs_constants");
+   } else {
+      consts_ptr = GEP(hPrivateData, {0, swr_draw_context_constantFS});
+      consts_ptr->setName("fs_constants");
+      const_sizes_ptr =
+         GEP(hPrivateData, {0, swr_draw_context_num_constantsFS});
+      const_sizes_ptr->setName("num_fs_constants");
+   }
 
    // xxx should check for flat shading versus interpolation
 
+   /*
+    * Raster tile kernel: loop over the SIMD quads of the tile, doing the
+    * barycentric evaluation, coverage and early-Z cull BackendSingleSample
+    * would otherwise do around each shader call, then hand the quad to the
+    * fused output merger.
+    */
+   struct lp_build_loop_state tile_loop;
+   struct lp_build_if_state quad_if, cull_if;
+   Value *pQuadCoverage = nullptr, *pQuadDepthPass = nullptr,
+      *pQuadStencilPass = nullptr;
+   Value *pBlendState = nullptr, *pViewport = nullptr, *pfnOutputMerger = nullptr;
+   if (key.tile_kernel) {
+      static_assert(KNOB_SIMD_WIDTH == 8, "Unsupported SIMD width");
+
+      pQuadCoverage = ALLOCA(mSimdInt32Ty);
+      pQuadDepthPass = ALLOCA(mSimdInt32Ty);
+      pQuadStencilPass = ALLOCA(mSimdInt32Ty);
+
+      STORE(C(0), pTile, {0, SWR_PS_TILE_CONTEXT_psInvocations});
+      STORE(C(0), pTile, {0, SWR_PS_TILE_CONTEXT_depthPassCount});
+
+      pBlendState = LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pBlendState});
+      pViewport = LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pViewport});
+      pfnOutputMerger =
+         LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pfnOutputMerger});
+
+      // tile invariant plane equations
+      Value *vIa = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_I, 0}));
+      Value *vIb = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_I, 1}));
+      Value *vIc = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_I, 2}));
+      Value *vJa = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_J, 0}));
+      Value *vJb = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_J, 1}));
+      Value *vJc = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_J, 2}));
+      Value *vZa = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_Z, 0}));
+      Value *vZb = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_Z, 1}));
+      Value *vZc = VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_Z, 2}));
+      Value *vWa =
+         VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_OneOverW, 0}));
+      Value *vWb =
+         VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_OneOverW, 1}));
+      Value *vWc =
+         VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_OneOverW, 2}));
+      Value *vRecipDet =
+         VBROADCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_recipDet}));
+      Value *tileX = LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_x});
+      Value *tileY = LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_y});
+
+      lp_build_loop_begin(&tile_loop, gallivm, lp_build_const_int32(gallivm, 0));
+      IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+      Value *quad = unwrap(tile_loop.counter);
+
+      // 8 coverage bits per quad, quads walk the tile in rows
+      Value *quadBits = LSHR(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_coverageMask}),
+                             Z_EXT(MUL(quad, C(8)), mInt64Ty));
+      quadBits = AND(TRUNC(quadBits, mInt32Ty), C(0xff));
+      quadBits->setName("quadCoverage");
+
+      LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+      lp_build_if(&quad_if, gallivm, wrap(ICMP_NE(quadBits, C(0))));
+      IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+      const uint32_t quadsPerRow = KNOB_TILE_X_DIM / SIMD_TILE_X_DIM;
+      Value *quadX = UI_TO_FP(MUL(UREM(quad, C(quadsPerRow)), C(SIMD_TILE_X_DIM)),
+                              mFP32Ty);
+      Value *quadY = UI_TO_FP(MUL(UDIV(quad, C(quadsPerRow)), C(SIMD_TILE_Y_DIM)),
+                              mFP32Ty);
+
+      // UL pixel corner and pixel center, same lane order as the backend
+      Value *vXUL = FADD(VBROADCAST(FADD(tileX, quadX)),
+                         C({0.0f, 1.0f, 0.0f, 1.0f, 2.0f, 3.0f, 2.0f, 3.0f}));
+      Value *vYUL = FADD(VBROADCAST(FADD(tileY, quadY)),
+                         C({0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f}));
+      Value *vX = FADD(vXUL, VIMMED1(0.5f));
+      Value *vY = FADD(vYUL, VIMMED1(0.5f));
+
+      Value *vI = FMUL(VPLANEPS(vIa, vIb, vIc, vX, vY), vRecipDet);
+      Value *vJ = FMUL(VPLANEPS(vJa, vJb, vJc, vX, vY), vRecipDet);
+      Value *vOneOverW = VPLANEPS(vWa, vWb, vWc, vI, vJ);
+      Value *vZ = VPLANEPS(vZa, vZb, vZc, vI, vJ);
+
+      Value *vCoverage =
+         ICMP_NE(AND(VBROADCAST(quadBits),
+                     C({1, 2, 4, 8, 16, 32, 64, 128})),
+                 VIMMED1(0));
+
+      if (key.depth_cull) {
+         /*
+          * Cull only: the output merger repeats the test and does the
+          * write, so dropping pixels here can't change the result.
+          */
+         Value *vMinZ = VBROADCAST(LOAD(pViewport, {0, SWR_VIEWPORT_minZ}));
+         Value *vMaxZ = VBROADCAST(LOAD(pViewport, {0, SWR_VIEWPORT_maxZ}));
+         Value *vClampedZ = VMINPS(vMaxZ, VMAXPS(vMinZ, vZ));
+         Value *pDepth =
+            BITCAST(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pDepthBase}),
+                    PointerType::get(mSimdFP32Ty, 0));
+         Value *vDepth = LOAD(pDepth);
+
+         Value *vDepthPass = nullptr;
+         switch (key.depth_func) {
+         case ZFUNC_NEVER: vDepthPass = VIMMED1(false); break;
+         case ZFUNC_LT: vDepthPass = FCMP_OLT(vClampedZ, vDepth); break;
+         case ZFUNC_EQ: vDepthPass = FCMP_OEQ(vClampedZ, vDepth); break;
+         case ZFUNC_LE: vDepthPass = FCMP_OLE(vClampedZ, vDepth); break;
+         case ZFUNC_GT: vDepthPass = FCMP_OGT(vClampedZ, vDepth); break;
+         case ZFUNC_NE: vDepthPass = FCMP_ONE(vClampedZ, vDepth); break;
+         case ZFUNC_GE: vDepthPass = FCMP_OGE(vClampedZ, vDepth); break;
+         default: break;
+         }
+         if (vDepthPass)
+            vCoverage = AND(vCoverage, vDepthPass);
+
+         Value *anyPass = ICMP_NE(
+            VMOVMSKPS(BITCAST(S_EXT(vCoverage, mSimdInt32Ty), mSimdFP32Ty)),
+            C(0));
+
+         LLVMPositionBuilderAtEnd(gallivm->builder,
+                                  wrap(IRB()->GetInsertBlock()));
+         lp_build_if(&cull_if, gallivm, wrap(anyPass));
+         IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+      }
+
+      vCoverage = S_EXT(vCoverage, mSimdInt32Ty);
+
+      STORE(vXUL, pPS, {0, SWR_PS_CONTEXT_vX, PixelPositions_UL});
+      STORE(vX, pPS, {0, SWR_PS_CONTEXT_vX, PixelPositions_center});
+      STORE(vYUL, pPS, {0, SWR_PS_CONTEXT_vY, PixelPositions_UL});
+      STORE(vY, pPS, {0, SWR_PS_CONTEXT_vY, PixelPositions_center});
+      STORE(vI, pPS, {0, SWR_PS_CONTEXT_vI, PixelPositions_center});
+      STORE(vJ, pPS, {0, SWR_PS_CONTEXT_vJ, PixelPositions_center});
+      STORE(vOneOverW, pPS, {0, SWR_PS_CONTEXT_vOneOverW, PixelPositions_center});
+      STORE(vZ, pPS, {0, SWR_PS_CONTEXT_vZ});
+      STORE(vCoverage, pPS, {0, SWR_PS_CONTEXT_activeMask});
+      STORE(vCoverage, pQuadDepthPass);
+      STORE(vCoverage, pQuadStencilPass);
+
+      Value *psInvocations =
+         POPCNT(VMOVMSKPS(BITCAST(vCoverage, mSimdFP32Ty)));
+      STORE(ADD(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_psInvocations}),
+                psInvocations),
+            pTile, {0, SWR_PS_TILE_CONTEXT_psInvocations});
+   }
+
 
    // load *pAttribs, *pPerspAttribs
    Value *pRawAttribs = LOAD(pPS, {0, SWR_PS_CONTEXT_pAttribs}, "pRawAttribs");
    Value *pPerspAttribs =
       LOAD(pPS, {0, SWR_PS_CONTEXT_pPerspAttribs}, "pPerspAttribs");
 
-   swr_fs->constantMask = 0;
-   swr_fs->pointSpriteMask = 0;
+   uint32_t constantMask = 0, pointSpriteMask = 0;
 
    for (int attrib = 0; attrib < PIPE_MAX_SHADER_INPUTS; attrib++) {
       const unsigned mask = swr_fs->info.base.input_usage_mask[attrib];
@@ -408,12 +1974,12 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
       }
 
       unsigned linkedAttrib =
-         locate_linkage(semantic_name, semantic_idx, &ctx->vs->info.base);
+         locate_linkage(semantic_name, semantic_idx, key);
       if (linkedAttrib == 0xFFFFFFFF) {
          // not found - check for point sprite
-         if (ctx->rasterizer->sprite_coord_enable) {
-            linkedAttrib = ctx->vs->info.base.num_outputs - 1;
-            swr_fs->pointSpriteMask |= (1 << linkedAttrib);
+         if (key.sprite_coord_enable) {
+            linkedAttrib = key.vs_num_outputs - 1;
+            pointSpriteMask |= (1 << linkedAttrib);
          } else {
             fprintf(stderr,
                     "Missing %s[%d]\n",
@@ -424,7 +1990,7 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
       }
 
       if (interpMode == TGSI_INTERPOLATE_CONSTANT) {
-         swr_fs->constantMask |= 1 << linkedAttrib;
+         constantMask |= 1 << linkedAttrib;
       }
 
       for (int channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
@@ -434,9 +2000,9 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
             Value *indexC = C(linkedAttrib * 12 + channel + 8);
 
             if ((semantic_name == TGSI_SEMANTIC_COLOR)
-                && ctx->rasterizer->light_twoside) {
+                && key.light_twoside) {
                unsigned bcolorAttrib = locate_linkage(
-                  TGSI_SEMANTIC_BCOLOR, semantic_idx, &ctx->vs->info.base);
+                  TGSI_SEMANTIC_BCOLOR, semantic_idx, key);
 
                unsigned diff = 12 * (bcolorAttrib - linkedAttrib);
 
@@ -451,7 +2017,7 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
                indexC = ADD(indexC, offset);
 
                if (interpMode == TGSI_INTERPOLATE_CONSTANT) {
-                  swr_fs->constantMask |= 1 << bcolorAttrib;
+                  constantMask |= 1 << bcolorAttrib;
                }
             }
 
@@ -478,10 +2044,20 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
       }
    }
 
-   sampler = swr_sampler_soa_create(key.sampler);
+   /* Specialized variants share the linkage of the generic variant, which
+    * already published these */
+   if (!constants) {
+      swr_fs->constantMask = constantMask;
+      swr_fs->pointSpriteMask = pointSpriteMask;
+   }
+
+   sampler = swr_sampler_soa_create(key.sampler, PIPE_SHADER_FRAGMENT);
 
    struct lp_bld_tgsi_system_values system_values;
    memset(&system_values, 0, sizeof(system_values));
+   if (swr_fs->info.base.reads_samplemask)
+      system_values.sample_mask_in =
+         wrap(BITCAST(LOAD(pPS, {0, SWR_PS_CONTEXT_inputMask}), mSimdInt32Ty));
 
    struct lp_build_mask_context mask;
 
@@ -504,7 +2080,9 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
                      NULL, // thread data
                      sampler, // sampler
                      &swr_fs->info.base,
-                     NULL); // geometry shader face
+                     NULL, // geometry shader face
+                     NULL, // compute shader face
+                     NULL); // tessellation shader face
 
    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
 
@@ -564,10 +2142,96 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_key &key)
       STORE(unwrap(mask_result), pPS, {0, SWR_PS_CONTEXT_activeMask});
    }
 
+   if (key.tile_kernel) {
+      // late depth/stencil, blend and hot tile store for the quad
+      std::vector<Type *> omArgs{
+         pBlendState->getType(),
+         pViewport->getType(),
+         PointerType::get(mSimdFP32Ty, 0),
+         PointerType::get(mSimdFP32Ty, 0),
+         mInt32Ty,
+         PointerType::get(PointerType::get(mInt8Ty, 0), 0),
+         PointerType::get(mInt8Ty, 0),
+         PointerType::get(mInt8Ty, 0),
+         PointerType::get(mSimdInt32Ty, 0),
+         PointerType::get(mSimdInt32Ty, 0),
+         PointerType::get(mSimdInt32Ty, 0),
+         PointerType::get(mSimdInt32Ty, 0)};
+      FunctionType *omType =
+         FunctionType::get(Type::getVoidTy(JM()->mContext), omArgs, false);
+
+      STORE(LOAD(pPS, {0, SWR_PS_CONTEXT_activeMask}), pQuadCoverage);
+      CALL(BITCAST(pfnOutputMerger, PointerType::get(omType, 0)),
+           {pBlendState,
+            pViewport,
+            BITCAST(GEP(pPS, {0, SWR_PS_CONTEXT_shaded}),
+                    PointerType::get(mSimdFP32Ty, 0)),
+            GEP(pPS, {0, SWR_PS_CONTEXT_vZ}),
+            LOAD(pPS, {0, SWR_PS_CONTEXT_frontFace}),
+            GEP(pTile, {0, SWR_PS_TILE_CONTEXT_pColorBase, 0}),
+            LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pDepthBase}),
+            LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pStencilBase}),
+            GEP(pPS, {0, SWR_PS_CONTEXT_oMask}),
+            pQuadCoverage,
+            pQuadDepthPass,
+            pQuadStencilPass});
+
+      Value *depthPassCount =
+         POPCNT(VMOVMSKPS(BITCAST(LOAD(pQuadDepthPass), mSimdFP32Ty)));
+      STORE(ADD(LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_depthPassCount}),
+                depthPassCount),
+            pTile, {0, SWR_PS_TILE_CONTEXT_depthPassCount});
+
+      LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+      if (key.depth_cull)
+         lp_build_endif(&cull_if);
+      lp_build_endif(&quad_if);
+      IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+      // advance hot tile pointers to the next quad
+      static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT,
+                    "Unsupported hot tile format");
+      static_assert(KNOB_DEPTH_HOT_TILE_FORMAT == R32_FLOAT,
+                    "Unsupported depth hot tile format");
+      static_assert(KNOB_STENCIL_HOT_TILE_FORMAT == R8_UINT,
+                    "Unsupported stencil hot tile format");
+      for (uint32_t rt = 0; rt < key.nr_cbufs; rt++) {
+         Value *pColor = LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pColorBase, rt});
+         STORE(GEP(pColor, {(uint32_t)(KNOB_SIMD_WIDTH * 4 * sizeof(float))}),
+               pTile, {0, SWR_PS_TILE_CONTEXT_pColorBase, rt});
+      }
+      Value *pDepth = LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pDepthBase});
+      STORE(GEP(pDepth, {(uint32_t)(KNOB_SIMD_WIDTH * sizeof(float))}),
+            pTile, {0, SWR_PS_TILE_CONTEXT_pDepthBase});
+      Value *pStencil = LOAD(pTile, {0, SWR_PS_TILE_CONTEXT_pStencilBase});
+      STORE(GEP(pStencil, {(uint32_t)KNOB_SIMD_WIDTH}),
+            pTile, {0, SWR_PS_TILE_CONTEXT_pStencilBase});
+
+      LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+      const uint32_t numQuads = (KNOB_TILE_X_DIM / SIMD_TILE_X_DIM) *
+                                (KNOB_TILE_Y_DIM / SIMD_TILE_Y_DIM);
+      lp_build_loop_end(&tile_loop,
+                        lp_build_const_int32(gallivm, numQuads),
+                        NULL);
+      IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+   }
+
    RET_VOID();
 
    gallivm_verify_function(gallivm, wrap(pFunction));
 
+   if (constants) {
+      /* fold the snapshot loads and drop the dead uniform branches before
+       * the regular gallivm passes */
+      FunctionPassManager passes(JM()->mpCurrentModule);
+      passes.add(createPromoteMemoryToRegisterPass());
+      passes.add(createInstructionCombiningPass());
+      passes.add(createSCCPPass());
+      passes.add(createCFGSimplificationPass());
+      passes.add(createAggressiveDCEPass());
+      passes.run(*pFunction);
+   }
+
    gallivm_compile_module(gallivm);
 
    PFN_PIXEL_KERNEL kernel =
@@ -587,5 +2251,342 @@ swr_compile_fs(struct swr_context *ctx, swr_jit_key &key)
 {
    BuilderSWR builder(
       reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr));
-   return builder.CompileFS(ctx, key);
+   return builder.CompileFS(ctx->fs, key, NULL);
+}
+
+void
+BuilderSWR::CSChunkBegin(struct swr_cs_iface *iface,
+                         struct lp_bld_tgsi_system_values *system_values)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+   const unsigned *block = iface->key->block;
+   const uint32_t numThreads = block[0] * block[1] * block[2];
+
+   lp_build_loop_begin(&iface->loop, gallivm, lp_build_const_int32(gallivm, 0));
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   // flattened thread ids in the group of the chunk's lanes
+   std::vector<Constant *> lanes;
+   for (uint32_t lane = 0; lane < JM()->mVWidth; lane++)
+      lanes.push_back(C(lane));
+   Value *chunk = unwrap(iface->loop.counter);
+   Value *vThread = ADD(VBROADCAST(MUL(chunk, C(JM()->mVWidth))),
+                        ConstantVector::get(lanes));
+
+   system_values->thread_id[0] = wrap(UREM(vThread, VIMMED1(block[0])));
+   system_values->thread_id[1] =
+      wrap(UREM(UDIV(vThread, VIMMED1(block[0])), VIMMED1(block[1])));
+   system_values->thread_id[2] =
+      wrap(UDIV(vThread, VIMMED1(block[0] * block[1])));
+
+   Value *vActive =
+      S_EXT(ICMP_ULT(vThread, VIMMED1(numThreads)), mSimdInt32Ty);
+
+   if (iface->pSpillFill) {
+      Value *pTemps =
+         GEP(iface->pSpillFill, {MUL(chunk, C(iface->spill_stride))});
+      iface->base.temps_ptr =
+         wrap(BITCAST(pTemps, PointerType::get(mSimdFP32Ty, 0)));
+   }
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+   lp_build_mask_begin(
+      &iface->mask, gallivm, lp_type_float_vec(32, 32 * 8), wrap(vActive));
+}
+
+void
+BuilderSWR::CSChunkEnd(struct swr_cs_iface *iface)
+{
+   struct gallivm_state *gallivm = iface->gallivm;
+
+   lp_build_mask_end(&iface->mask);
+   lp_build_loop_end(&iface->loop,
+                     lp_build_const_int32(gallivm, iface->num_chunks),
+                     NULL);
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+}
+
+PFN_CS_FUNC
+BuilderSWR::CompileCS(struct swr_compute_shader *swr_cs, swr_jit_cs_key &key)
+{
+   struct gallivm_state *gallivm =
+      gallivm_create("CS", wrap(&JM()->mContext));
+   gallivm->module = wrap(JM()->mpCurrentModule);
+
+   LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
+   LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+
+   memset(inputs, 0, sizeof(inputs));
+   memset(outputs, 0, sizeof(outputs));
+
+   AttrBuilder attrBuilder;
+   attrBuilder.addStackAlignmentAttr(JM()->mVWidth * sizeof(float));
+   AttributeSet attrSet = AttributeSet::get(
+      JM()->mContext, AttributeSet::FunctionIndex, attrBuilder);
+
+   std::vector<Type *> csArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                              PointerType::get(Gen_SWR_CS_CONTEXT(JM()), 0)};
+   FunctionType *csFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), csArgs, false);
+
+   // create new compute shader function
+   auto pFunction = Function::Create(csFuncType,
+                                     GlobalValue::ExternalLinkage,
+                                     "CS",
+                                     JM()->mpCurrentModule);
+   pFunction->addAttributes(AttributeSet::FunctionIndex, attrSet);
+
+   BasicBlock *block = BasicBlock::Create(JM()->mContext, "entry", pFunction);
+   IRB()->SetInsertPoint(block);
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(block));
+
+   auto argitr = pFunction->arg_begin();
+   Value *hPrivateData = &*argitr++;
+   hPrivateData->setName("hPrivateData");
+   Value *pCsCtx = &*argitr++;
+   pCsCtx->setName("csCtx");
+
+   Value *consts_ptr = GEP(hPrivateData, {C(0), C(swr_draw_context_constantCS)});
+   consts_ptr->setName("cs_constants");
+   Value *const_sizes_ptr =
+      GEP(hPrivateData, {0, swr_draw_context_num_constantsCS});
+   const_sizes_ptr->setName("num_cs_constants");
+
+   struct lp_bld_tgsi_system_values system_values;
+   memset(&system_values, 0, sizeof(system_values));
+
+   // the core passes the linear index of the thread group
+   Value *group = LOAD(pCsCtx, {0, SWR_CS_CONTEXT_tileCounter});
+   Value *dims[3];
+   for (uint32_t i = 0; i < 3; i++) {
+      dims[i] = LOAD(pCsCtx, {0, SWR_CS_CONTEXT_dispatchDims, i});
+      system_values.grid_size[i] = wrap(dims[i]);
+      system_values.block_size[i] = wrap(C(key.block[i]));
+   }
+   system_values.block_id[0] = wrap(UREM(group, dims[0]));
+   system_values.block_id[1] = wrap(UREM(UDIV(group, dims[0]), dims[1]));
+   system_values.block_id[2] = wrap(UDIV(group, MUL(dims[0], dims[1])));
+
+   struct swr_cs_iface iface;
+   memset(&iface, 0, sizeof(iface));
+   iface.base.shared_ptr = wrap(LOAD(pCsCtx, {0, SWR_CS_CONTEXT_pTGSM}));
+   iface.base.shared_size = wrap(C(KNOB_MAX_TGSM_SIZE));
+   iface.base.ssbo_ptr = wrap(GEP(hPrivateData, {0, swr_draw_context_buffersCS}));
+   iface.base.ssbo_sizes_ptr =
+      wrap(GEP(hPrivateData, {0, swr_draw_context_num_buffersCS}));
+   iface.base.barrier = swr_cs_barrier;
+   iface.builder = this;
+   iface.gallivm = gallivm;
+   iface.key = &key;
+   iface.num_chunks =
+      (key.block[0] * key.block[1] * key.block[2] + JM()->mVWidth - 1)
+      / JM()->mVWidth;
+   if (swr_cs->info.base.opcode_count[TGSI_OPCODE_BARRIER]) {
+      iface.pSpillFill = LOAD(pCsCtx, {0, SWR_CS_CONTEXT_pSpillFillBuffer});
+      iface.spill_stride = swr_cs_spill_fill_size(swr_cs, key.block)
+                           / iface.num_chunks;
+   }
+
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(IRB()->GetInsertBlock()));
+   CSChunkBegin(&iface, &system_values);
+
+   struct lp_build_sampler_soa *sampler =
+      swr_sampler_soa_create(key.sampler, PIPE_SHADER_COMPUTE);
+
+   lp_build_tgsi_soa(gallivm,
+                     swr_cs->pipe.tokens,
+                     lp_type_float_vec(32, 32 * 8),
+                     &iface.mask, // mask
+                     wrap(consts_ptr),
+                     wrap(const_sizes_ptr),
+                     &system_values,
+                     inputs,
+                     outputs,
+                     wrap(hPrivateData),
+                     NULL, // thread data
+                     sampler, // sampler
+                     &swr_cs->info.base,
+                     NULL, // geometry shader face
+                     &iface.base, // compute shader face
+                     NULL); // tessellation shader face
+
+   CSChunkEnd(&iface);
+
+   RET_VOID();
+
+   gallivm_verify_function(gallivm, wrap(pFunction));
+   gallivm_compile_module(gallivm);
+
+   PFN_CS_FUNC pFunc =
+      (PFN_CS_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
+   debug_printf("compute shader  %p\n", pFunc);
+   assert(pFunc && "Error: ComputeShader = NULL");
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 5)
+   JM()->mIsModuleFinalized = true;
+#endif
+
+   return pFunc;
+}
+
+PFN_CS_FUNC
+swr_compile_cs(struct swr_context *ctx, swr_jit_cs_key &key)
+{
+   BuilderSWR builder(
+      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr));
+   return builder.CompileCS(ctx->cs, key);
+}
+
+static bool
+swr_fs_constants_match(const swr_fs_constants *constants,
+                       const swr_draw_context *pDC)
+{
+   for (unsigned i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
+      if (constants->num_constants[i] != pDC->num_constantsFS[i])
+         return false;
+      if (constants->data[i].empty())
+         continue;
+      if (!pDC->constantFS[i] ||
+          memcmp(constants->data[i].data(), pDC->constantFS[i],
+                 constants->num_constants[i]))
+         return false;
+   }
+   return true;
+}
+
+static std::shared_ptr<swr_fs_constants>
+swr_fs_constants_snapshot(const swr_draw_context *pDC)
+{
+   static std::atomic<unsigned> next_id(1);
+
+   auto constants = std::make_shared<swr_fs_constants>();
+   constants->id = next_id++;
+   for (unsigned i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
+      constants->num_constants[i] = pDC->num_constantsFS[i];
+      if (pDC->constantFS[i] && pDC->num_constantsFS[i]) {
+         constants->data[i].resize(AlignUp(pDC->num_constantsFS[i], 4) / 4);
+         memcpy(constants->data[i].data(), pDC->constantFS[i],
+                pDC->num_constantsFS[i]);
+      }
+   }
+   return constants;
+}
+
+/*
+ * Whether the FS constants bound may have changed since the last draw: they
+ * were rebound, or their buffers written by the CPU, or may be written by
+ * draws or persistent maps at any time.
+ */
+static bool
+swr_fs_constants_changed(struct swr_context *ctx)
+{
+   bool changed = ctx->dirty & SWR_NEW_FSCONSTANTS;
+
+   for (unsigned i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
+      struct pipe_constant_buffer *cb =
+         &ctx->constants[PIPE_SHADER_FRAGMENT][i];
+      unsigned write_seq = 0;
+
+      if (cb->buffer) {
+         struct swr_resource *spr = swr_resource(cb->buffer);
+         write_seq = p_atomic_read(&spr->write_seq);
+         if ((spr->status & SWR_RESOURCE_WRITE)
+             || p_atomic_read(&spr->persistent_writes))
+            changed = true;
+      }
+
+      if (write_seq != ctx->fs_constants_write_seq[i]) {
+         ctx->fs_constants_write_seq[i] = write_seq;
+         changed = true;
+      }
+   }
+
+   return changed;
+}
+
+/*
+ * Track the FS constant buffers across frames.  Once they have stayed the
+ * same for KNOB_FS_SPECIALIZE_FRAMES frames presented by any context, the
+ * shader's spec_id names the snapshot specialized variants get compiled
+ * for; it drops back to 0 (the generic variant) as soon as the values
+ * change.  Also collects finished background compiles into the shader's
+ * variant map.
+ *
+ * The values are only compared against the snapshot when the context's
+ * constants changed, or the shader last matched another stamp.
+ *
+ * Returns true if the pixel shader variant in use may have to change.
+ */
+bool
+swr_update_fs_specialization(struct swr_context *ctx)
+{
+   struct swr_screen *screen = swr_screen(ctx->pipe.screen);
+   struct swr_fragment_shader *fs = ctx->fs;
+   unsigned frame = p_atomic_read(&screen->frame);
+   bool changed = false;
+
+   if (fs->info.base.file_max[TGSI_FILE_CONSTANT] < 0)
+      return false;
+
+   if (swr_fs_constants_changed(ctx) || !ctx->fs_constants_stamp)
+      ctx->fs_constants_stamp =
+         p_atomic_inc_return(&screen->fs_constants_stamps);
+
+   if (fs->spec_job.valid() &&
+       fs->spec_job.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready) {
+      auto variant = fs->spec_job.get();
+      if (variant.second)
+         fs->map.insert(variant);
+      changed = true;
+   }
+
+   bool same = fs->spec_constants &&
+      (fs->spec_stamp == ctx->fs_constants_stamp ||
+       swr_fs_constants_match(fs->spec_constants.get(), &ctx->swrDC));
+   fs->spec_stamp = ctx->fs_constants_stamp;
+
+   if (!same) {
+      if (fs->spec_id)
+         changed = true;
+      fs->spec_constants = swr_fs_constants_snapshot(&ctx->swrDC);
+      fs->spec_frame = frame;
+      fs->spec_id = 0;
+   } else if (!fs->spec_id &&
+              fs->spec_count < SWR_MAX_FS_SPECIALIZATIONS &&
+              frame - fs->spec_frame >= KNOB_FS_SPECIALIZE_FRAMES) {
+      fs->spec_id = fs->spec_constants->id;
+      fs->spec_count++;
+      changed = true;
+   }
+
+   return changed;
+}
+
+/*
+ * Start a background compile of a constant specialized variant, unless one
+ * is already in flight for this shader.  Runs on the screen's specialization
+ * JitManager so it never touches the API thread's module.
+ */
+void
+swr_queue_fs_specialization(struct swr_context *ctx, const swr_jit_key &key)
+{
+   struct swr_fragment_shader *fs = ctx->fs;
+   struct swr_screen *screen = swr_screen(ctx->pipe.screen);
+
+   if (fs->spec_job.valid())
+      return;
+
+   std::shared_ptr<swr_fs_constants> constants = fs->spec_constants;
+   fs->spec_job = std::async(std::launch::async, [screen, fs, key, constants]() {
+      swr_jit_key spec_key = key;
+
+      pipe_mutex_lock(screen->spec_jit_mutex);
+      BuilderSWR builder(reinterpret_cast<JitManager *>(screen->hJitMgrSpec));
+      PFN_PIXEL_KERNEL func =
+         builder.CompileFS(fs, spec_key, constants.get());
+      pipe_mutex_unlock(screen->spec_jit_mutex);
+
+      return std::make_pair(key, func);
+   });
 }
@@ -24,12 +24,44 @@
 #pragma once
 
 class swr_vertex_shader;
+class swr_tess_ctrl_shader;
+class swr_tess_eval_shader;
+class swr_geometry_shader;
 class swr_fragment_shader;
+class swr_compute_shader;
 class swr_jit_key;
+class swr_jit_cs_key;
+class swr_jit_gs_key;
+class swr_jit_tcs_key;
+class swr_jit_tes_key;
 
 PFN_VERTEX_FUNC
 swr_compile_vs(struct pipe_context *ctx, swr_vertex_shader *swr_vs);
 
+PFN_HS_FUNC
+swr_compile_hs(struct swr_context *ctx, swr_jit_tcs_key &key);
+
+void swr_generate_tcs_key(struct swr_jit_tcs_key &key,
+                          struct swr_context *ctx,
+                          swr_tess_ctrl_shader *swr_tcs,
+                          unsigned vertices_in);
+
+PFN_DS_FUNC
+swr_compile_ds(struct swr_context *ctx, swr_jit_tes_key &key);
+
+void swr_generate_tes_key(struct swr_jit_tes_key &key,
+                          struct swr_context *ctx,
+                          swr_tess_eval_shader *swr_tes,
+                          unsigned vertices_in);
+
+PFN_GS_FUNC
+swr_compile_gs(struct swr_context *ctx, swr_jit_gs_key &key);
+
+void swr_generate_gs_key(struct swr_jit_gs_key &key,
+                         struct swr_context *ctx,
+                         swr_geometry_shader *swr_gs);
+
+/* key.tile_kernel variants are PFN_PIXEL_TILE_KERNEL, returned cast */
 PFN_PIXEL_KERNEL
 swr_compile_fs(struct swr_context *ctx, swr_jit_key &key);
 
@@ -37,14 +69,40 @@ void swr_generate_fs_key(struct swr_jit_key &key,
                          struct swr_context *ctx,
                          swr_fragment_shader *swr_fs);
 
+void swr_generate_fs_tile_key(struct swr_jit_key &key,
+                              struct swr_context *ctx,
+                              swr_fragment_shader *swr_fs);
+
+PFN_CS_FUNC
+swr_compile_cs(struct swr_context *ctx, swr_jit_cs_key &key);
+
+void swr_generate_cs_key(struct swr_jit_cs_key &key,
+                         struct swr_context *ctx,
+                         swr_compute_shader *swr_cs,
+                         const uint *block);
+
+unsigned swr_cs_spill_fill_size(swr_compute_shader *swr_cs,
+                                const uint *block);
+
+bool swr_update_fs_specialization(struct swr_context *ctx);
+
+void swr_queue_fs_specialization(struct swr_context *ctx,
+                                 const swr_jit_key &key);
+
 struct swr_jit_key {
    unsigned nr_cbufs;
    unsigned light_twoside;
+   unsigned sprite_coord_enable;
+   unsigned vs_num_outputs;
    ubyte vs_output_semantic_name[PIPE_MAX_SHADER_OUTPUTS];
    ubyte vs_output_semantic_idx[PIPE_MAX_SHADER_OUTPUTS];
    unsigned nr_samplers;
    unsigned nr_sampler_views;
    struct swr_sampler_static_state sampler[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   unsigned tile_kernel; /* PFN_PIXEL_TILE_KERNEL looping over a raster tile */
+   unsigned depth_cull;
+   unsigned depth_func;
+   unsigned const_id; /* swr_fs_constants snapshot folded in, 0 = none */
 };
 
 namespace std
@@ -58,3 +116,96 @@ template <> struct hash<swr_jit_key> {
 };
 
 bool operator==(const swr_jit_key &lhs, const swr_jit_key &rhs);
+
+/* The fixed block size is a launch parameter in TGSI, so it's part of the
+ * key; the chunk loop and the thread ids get built for it. */
+struct swr_jit_cs_key {
+   unsigned block[3];
+   unsigned nr_samplers;
+   unsigned nr_sampler_views;
+   struct swr_sampler_static_state sampler[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+};
+
+namespace std
+{
+template <> struct hash<swr_jit_cs_key> {
+   std::size_t operator()(const swr_jit_cs_key &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
+};
+
+bool operator==(const swr_jit_cs_key &lhs, const swr_jit_cs_key &rhs);
+
+/* GS inputs are found in the VS, or TES, outputs by semantic */
+struct swr_jit_gs_key {
+   unsigned vs_num_outputs;
+   ubyte vs_output_semantic_name[PIPE_MAX_SHADER_OUTPUTS];
+   ubyte vs_output_semantic_idx[PIPE_MAX_SHADER_OUTPUTS];
+   unsigned nr_samplers;
+   unsigned nr_sampler_views;
+   struct swr_sampler_static_state sampler[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+};
+
+namespace std
+{
+template <> struct hash<swr_jit_gs_key> {
+   std::size_t operator()(const swr_jit_gs_key &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
+};
+
+bool operator==(const swr_jit_gs_key &lhs, const swr_jit_gs_key &rhs);
+
+/* TCS inputs are found in the VS outputs by semantic.  Without a TCS the
+ * variant is a pass through, copying them to the control points. */
+struct swr_jit_tcs_key {
+   unsigned vs_num_outputs;
+   ubyte vs_output_semantic_name[PIPE_MAX_SHADER_OUTPUTS];
+   ubyte vs_output_semantic_idx[PIPE_MAX_SHADER_OUTPUTS];
+   unsigned vertices_in;
+   unsigned passthrough;
+   unsigned isolines; /* the core has detail and density swapped */
+   unsigned nr_samplers;
+   unsigned nr_sampler_views;
+   struct swr_sampler_static_state sampler[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+};
+
+namespace std
+{
+template <> struct hash<swr_jit_tcs_key> {
+   std::size_t operator()(const swr_jit_tcs_key &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
+};
+
+bool operator==(const swr_jit_tcs_key &lhs, const swr_jit_tcs_key &rhs);
+
+/* TES inputs are found in the control point slots by semantic, which hold
+ * the per-vertex TCS outputs packed, or the VS outputs of a pass through */
+struct swr_jit_tes_key {
+   unsigned tcs_num_outputs;
+   ubyte tcs_output_semantic_name[PIPE_MAX_SHADER_OUTPUTS];
+   ubyte tcs_output_semantic_idx[PIPE_MAX_SHADER_OUTPUTS];
+   unsigned vertices_in;
+   unsigned nr_samplers;
+   unsigned nr_sampler_views;
+   struct swr_sampler_static_state sampler[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+};
+
+namespace std
+{
+template <> struct hash<swr_jit_tes_key> {
+   std::size_t operator()(const swr_jit_tes_key &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
+};
+
+bool operator==(const swr_jit_tes_key &lhs, const swr_jit_tes_key &rhs);
@@ -33,6 +33,7 @@
 #include "util/u_inlines.h"
 #include "util/u_helpers.h"
 #include "util/u_framebuffer.h"
+#include "util/u_box.h"
 
 #include "swr_state.h"
 #include "swr_context.h"
@@ -313,6 +314,28 @@ swr_sampler_view_destroy(struct pipe_context *pipe,
    FREE(view);
 }
 
+static void
+swr_generate_so_state(SWR_STREAMOUT_STATE &soState,
+                      const pipe_stream_output_info *stream_output)
+{
+   soState = {0};
+
+   if (stream_output->num_outputs) {
+      soState.soEnable = true;
+      // soState.rasterizerDisable set on state dirty
+      // soState.streamToRasterizer not used
+
+      for (uint32_t i = 0; i < stream_output->num_outputs; i++) {
+         soState.streamMasks[stream_output->output[i].stream] |=
+            1 << (stream_output->output[i].register_index - 1);
+      }
+      for (uint32_t i = 0; i < MAX_SO_STREAMS; i++) {
+         soState.streamNumEntries[i] =
+            _mm_popcnt_u32(soState.streamMasks[i]);
+      }
+   }
+}
+
 static void *
 swr_create_vs_state(struct pipe_context *pipe,
                     const struct pipe_shader_state *vs)
@@ -329,24 +352,7 @@ swr_create_vs_state(struct pipe_context *pipe,
 
    swr_vs->func = swr_compile_vs(pipe, swr_vs);
 
-   swr_vs->soState = {0};
-
-   if (swr_vs->pipe.stream_output.num_outputs) {
-      pipe_stream_output_info *stream_output = &swr_vs->pipe.stream_output;
-
-      swr_vs->soState.soEnable = true;
-      // soState.rasterizerDisable set on state dirty
-      // soState.streamToRasterizer not used
-
-      for (uint32_t i = 0; i < stream_output->num_outputs; i++) {
-         swr_vs->soState.streamMasks[stream_output->output[i].stream] |=
-            1 << (stream_output->output[i].register_index - 1);
-      }
-      for (uint32_t i = 0; i < MAX_SO_STREAMS; i++) {
-        swr_vs->soState.streamNumEntries[i] =
-             _mm_popcnt_u32(swr_vs->soState.streamMasks[i]);
-       }
-   }
+   swr_generate_so_state(swr_vs->soState, &swr_vs->pipe.stream_output);
 
    return swr_vs;
 }
@@ -371,6 +377,241 @@ swr_delete_vs_state(struct pipe_context *pipe, void *vs)
    FREE(vs);
 }
 
+static void *
+swr_create_tcs_state(struct pipe_context *pipe,
+                     const struct pipe_shader_state *tcs)
+{
+   struct swr_tess_ctrl_shader *swr_tcs = new swr_tess_ctrl_shader;
+   if (!swr_tcs)
+      return NULL;
+
+   swr_tcs->pipe.tokens = tgsi_dup_tokens(tcs->tokens);
+
+   lp_build_tgsi_info(tcs->tokens, &swr_tcs->info);
+
+   swr_tcs->vertices_out =
+      swr_tcs->info.base.properties[TGSI_PROPERTY_TCS_VERTICES_OUT];
+
+   return swr_tcs;
+}
+
+static void
+swr_bind_tcs_state(struct pipe_context *pipe, void *tcs)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   if (ctx->tcs == tcs)
+      return;
+
+   ctx->tcs = (swr_tess_ctrl_shader *)tcs;
+   ctx->dirty |= SWR_NEW_TS;
+}
+
+static void
+swr_delete_tcs_state(struct pipe_context *pipe, void *tcs)
+{
+   struct swr_tess_ctrl_shader *swr_tcs = (swr_tess_ctrl_shader *)tcs;
+
+   FREE((void *)swr_tcs->pipe.tokens);
+   delete swr_tcs;
+}
+
+static void *
+swr_create_tes_state(struct pipe_context *pipe,
+                     const struct pipe_shader_state *tes)
+{
+   struct swr_tess_eval_shader *swr_tes = new swr_tess_eval_shader;
+   if (!swr_tes)
+      return NULL;
+
+   swr_tes->pipe.tokens = tgsi_dup_tokens(tes->tokens);
+   swr_tes->pipe.stream_output = tes->stream_output;
+
+   lp_build_tgsi_info(tes->tokens, &swr_tes->info);
+
+   const struct tgsi_shader_info *info = &swr_tes->info.base;
+   SWR_TS_STATE *tsState = &swr_tes->tsState;
+
+   /* attribute counts depend on the other stages, filled in on state dirty */
+   memset(tsState, 0, sizeof(*tsState));
+   tsState->tsEnable = true;
+
+   switch (info->properties[TGSI_PROPERTY_TES_SPACING]) {
+   case PIPE_TESS_SPACING_FRACTIONAL_ODD:
+      tsState->partitioning = SWR_TS_ODD_FRACTIONAL;
+      break;
+   case PIPE_TESS_SPACING_FRACTIONAL_EVEN:
+      tsState->partitioning = SWR_TS_EVEN_FRACTIONAL;
+      break;
+   default:
+      tsState->partitioning = SWR_TS_INTEGER;
+      break;
+   }
+
+   switch (info->properties[TGSI_PROPERTY_TES_PRIM_MODE]) {
+   case PIPE_PRIM_QUADS:
+      tsState->domain = SWR_TS_QUAD;
+      break;
+   case PIPE_PRIM_LINES:
+      tsState->domain = SWR_TS_ISOLINE;
+      break;
+   default:
+      tsState->domain = SWR_TS_TRI;
+      break;
+   }
+
+   if (info->properties[TGSI_PROPERTY_TES_POINT_MODE]) {
+      tsState->tsOutputTopology = SWR_TS_OUTPUT_POINT;
+      tsState->postDSTopology = TOP_POINT_LIST;
+      swr_tes->output_prim = PIPE_PRIM_POINTS;
+   } else if (tsState->domain == SWR_TS_ISOLINE) {
+      tsState->tsOutputTopology = SWR_TS_OUTPUT_LINE;
+      tsState->postDSTopology = TOP_LINE_LIST;
+      swr_tes->output_prim = PIPE_PRIM_LINES;
+   } else {
+      /* GL and the core's domain wind the other way around */
+      tsState->tsOutputTopology =
+         info->properties[TGSI_PROPERTY_TES_VERTEX_ORDER_CW] ?
+         SWR_TS_OUTPUT_TRI_CCW : SWR_TS_OUTPUT_TRI_CW;
+      tsState->postDSTopology = TOP_TRIANGLE_LIST;
+      swr_tes->output_prim = PIPE_PRIM_TRIANGLES;
+   }
+
+   swr_tes->linkageMask = 0;
+   for (unsigned i = 0; i < info->num_outputs; i++) {
+      switch (info->output_semantic_name[i]) {
+      case TGSI_SEMANTIC_POSITION:
+         break;
+      default:
+         swr_tes->linkageMask |= (1 << i);
+         break;
+      }
+   }
+
+   swr_generate_so_state(swr_tes->soState, &swr_tes->pipe.stream_output);
+
+   return swr_tes;
+}
+
+static void
+swr_bind_tes_state(struct pipe_context *pipe, void *tes)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   if (ctx->tes == tes)
+      return;
+
+   ctx->tes = (swr_tess_eval_shader *)tes;
+   ctx->dirty |= SWR_NEW_TS;
+}
+
+static void
+swr_delete_tes_state(struct pipe_context *pipe, void *tes)
+{
+   struct swr_tess_eval_shader *swr_tes = (swr_tess_eval_shader *)tes;
+
+   FREE((void *)swr_tes->pipe.tokens);
+   delete swr_tes;
+}
+
+static void
+swr_set_tess_state(struct pipe_context *pipe,
+                   const float default_outer_level[4],
+                   const float default_inner_level[2])
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   memcpy(ctx->swrDC.tessOuterLevel, default_outer_level,
+          sizeof(ctx->swrDC.tessOuterLevel));
+   memcpy(ctx->swrDC.tessInnerLevel, default_inner_level,
+          sizeof(ctx->swrDC.tessInnerLevel));
+   ctx->dirty |= SWR_NEW_TS;
+}
+
+static void *
+swr_create_gs_state(struct pipe_context *pipe,
+                    const struct pipe_shader_state *gs)
+{
+   struct swr_geometry_shader *swr_gs = new swr_geometry_shader;
+   if (!swr_gs)
+      return NULL;
+
+   swr_gs->pipe.tokens = tgsi_dup_tokens(gs->tokens);
+   swr_gs->pipe.stream_output = gs->stream_output;
+
+   lp_build_tgsi_info(gs->tokens, &swr_gs->info);
+
+   const struct tgsi_shader_info *info = &swr_gs->info.base;
+   SWR_GS_STATE *gsState = &swr_gs->gsState;
+
+   /* numInputAttribs depends on the VS, filled in on state dirty */
+   memset(gsState, 0, sizeof(*gsState));
+   gsState->gsEnable = true;
+   gsState->instanceCount = 1;
+   gsState->isSingleStream = true;
+   gsState->singleStreamID = 0;
+   gsState->maxNumVerts =
+      info->properties[TGSI_PROPERTY_GS_MAX_OUTPUT_VERTICES];
+   if (!gsState->maxNumVerts)
+      gsState->maxNumVerts = 32; /* matches gallivm */
+
+   switch (info->properties[TGSI_PROPERTY_GS_OUTPUT_PRIM]) {
+   case PIPE_PRIM_POINTS:
+      gsState->outputTopology = TOP_POINT_LIST;
+      break;
+   case PIPE_PRIM_LINE_STRIP:
+      gsState->outputTopology = TOP_LINE_STRIP;
+      break;
+   default:
+      gsState->outputTopology = TOP_TRIANGLE_STRIP;
+      break;
+   }
+
+   swr_gs->linkageMask = 0;
+   for (unsigned i = 0; i < info->num_outputs; i++) {
+      switch (info->output_semantic_name[i]) {
+      case TGSI_SEMANTIC_POSITION:
+         break;
+      case TGSI_SEMANTIC_PRIMID:
+         gsState->emitsPrimitiveID = true;
+         swr_gs->linkageMask |= (1 << i);
+         break;
+      case TGSI_SEMANTIC_LAYER:
+         gsState->emitsRenderTargetArrayIndex = true;
+         swr_gs->linkageMask |= (1 << i);
+         break;
+      default:
+         swr_gs->linkageMask |= (1 << i);
+         break;
+      }
+   }
+
+   swr_generate_so_state(swr_gs->soState, &swr_gs->pipe.stream_output);
+
+   return swr_gs;
+}
+
+static void
+swr_bind_gs_state(struct pipe_context *pipe, void *gs)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   if (ctx->gs == gs)
+      return;
+
+   ctx->gs = (swr_geometry_shader *)gs;
+   ctx->dirty |= SWR_NEW_GS;
+}
+
+static void
+swr_delete_gs_state(struct pipe_context *pipe, void *gs)
+{
+   struct swr_geometry_shader *swr_gs = (swr_geometry_shader *)gs;
+
+   FREE((void *)swr_gs->pipe.tokens);
+   delete swr_gs;
+}
+
 static void *
 swr_create_fs_state(struct pipe_context *pipe,
                     const struct pipe_shader_state *fs)
@@ -383,6 +624,11 @@ swr_create_fs_state(struct pipe_context *pipe,
 
    lp_build_tgsi_info(fs->tokens, &swr_fs->info);
 
+   swr_fs->spec_frame = 0;
+   swr_fs->spec_stamp = 0;
+   swr_fs->spec_id = 0;
+   swr_fs->spec_count = 0;
+
    return swr_fs;
 }
 
@@ -403,6 +649,11 @@ static void
 swr_delete_fs_state(struct pipe_context *pipe, void *fs)
 {
    struct swr_fragment_shader *swr_fs = (swr_fragment_shader *)fs;
+
+   /* a background specialization compile may still read the tokens */
+   if (swr_fs->spec_job.valid())
+      swr_fs->spec_job.wait();
+
    FREE((void *)swr_fs->pipe.tokens);
    delete swr_fs;
 }
@@ -423,7 +674,8 @@ swr_set_constant_buffer(struct pipe_context *pipe,
    /* note: reference counting */
    util_copy_constant_buffer(&ctx->constants[shader][index], cb);
 
-   if (shader == PIPE_SHADER_VERTEX || shader == PIPE_SHADER_GEOMETRY) {
+   if (shader == PIPE_SHADER_VERTEX || shader == PIPE_SHADER_GEOMETRY
+       || shader == PIPE_SHADER_TESS_CTRL || shader == PIPE_SHADER_TESS_EVAL) {
       ctx->dirty |= SWR_NEW_VSCONSTANTS;
    } else if (shader == PIPE_SHADER_FRAGMENT) {
       ctx->dirty |= SWR_NEW_FSCONSTANTS;
@@ -626,14 +878,53 @@ swr_set_sample_mask(struct pipe_context *pipe, unsigned sample_mask)
 
    if (sample_mask != ctx->sample_mask) {
       ctx->sample_mask = sample_mask;
-      ctx->dirty |= SWR_NEW_RASTERIZER;
+      ctx->dirty |= SWR_NEW_BLEND;
    }
 }
 
+/*
+ * Account for the pages of a lazily committed render target the core may
+ * store hot tiles to: all of level 0, which its surface state addresses.
+ */
+static void
+swr_commit_render_target(struct swr_resource *spr)
+{
+   struct pipe_resource *pt = &spr->base;
+   struct pipe_box box;
+
+   if (!spr->committed_pages)
+      return;
+
+   u_box_3d(0, 0, 0, pt->width0, pt->height0,
+            pt->target == PIPE_TEXTURE_3D ? pt->depth0 : pt->array_size,
+            &box);
+   swr_resource_commit(spr, 0, &box);
+}
+
+/* Look up (compiling on first use) the fused output merger for omState */
+static PFN_OUTPUT_MERGER_JIT_FUNC
+swr_get_output_merger(struct swr_context *ctx,
+                      const OUTPUT_MERGER_COMPILE_STATE &omState)
+{
+   auto search = ctx->outputMergerJIT->find(omState);
+   if (search != ctx->outputMergerJIT->end())
+      return search->second;
+
+   HANDLE hJitMgr = swr_screen(ctx->pipe.screen)->hJitMgr;
+   PFN_OUTPUT_MERGER_JIT_FUNC func = JitCompileOutputMerger(hJitMgr, omState);
+   debug_printf("OUTPUT MERGER shader %p\n", func);
+   assert(func && "Error: OutputMerger = NULL");
+
+   ctx->outputMergerJIT->insert(std::make_pair(omState, func));
+   return func;
+}
+
 /*
  * Update resource in-use status
  * All resources bound to color or depth targets marked as WRITE resources.
  * VBO Vertex/index buffers and texture views marked as READ resources.
+ * Called for every draw whose bindings changed, or that follows a sync;
+ * draws in between are retired by the same sync and share the tags.
  */
 void
 swr_update_resource_status(struct pipe_context *pipe,
@@ -642,39 +933,268 @@ swr_update_resource_status(struct pipe_context *pipe,
    struct swr_context *ctx = swr_context(pipe);
    struct pipe_framebuffer_state *fb = &ctx->framebuffer;
 
+   /* The draw is retired by the next sync submitted on the context fence */
+   uint64_t seq = swr_fence_next(ctx->fence);
+   ctx->status_seq = seq;
+
    /* colorbuffer targets */
    if (fb->nr_cbufs)
       for (uint32_t i = 0; i < fb->nr_cbufs; ++i)
-         if (fb->cbufs[i])
-            swr_resource_write(pipe, swr_resource(fb->cbufs[i]->texture));
+         if (fb->cbufs[i]) {
+            struct swr_resource *spr = swr_resource(fb->cbufs[i]->texture);
+            swr_resource_write(pipe, spr, seq);
+            swr_commit_render_target(spr);
+            if (spr->resolve_target)
+               swr_commit_render_target(swr_resource(spr->resolve_target));
+         }
 
    /* depth/stencil target */
    if (fb->zsbuf)
-      swr_resource_write(pipe, swr_resource(fb->zsbuf->texture));
+      swr_resource_write(pipe, swr_resource(fb->zsbuf->texture), seq);
 
    /* VBO vertex buffers */
    for (uint32_t i = 0; i < ctx->num_vertex_buffers; i++) {
       struct pipe_vertex_buffer *vb = &ctx->vertex_buffer[i];
       if (!vb->user_buffer)
-         swr_resource_read(pipe, swr_resource(vb->buffer));
+         swr_resource_read(pipe, swr_resource(vb->buffer), seq);
    }
 
-   /* VBO index buffer */
-   if (p_draw_info && p_draw_info->indexed) {
-      struct pipe_index_buffer *ib = &ctx->index_buffer;
-      if (!ib->user_buffer)
-         swr_resource_read(pipe, swr_resource(ib->buffer));
-   }
+   /* stream output targets */
+   for (uint32_t i = 0; i < ctx->num_so_targets; i++)
+      if (ctx->so_targets[i])
+         swr_resource_write(
+            pipe, swr_resource(ctx->so_targets[i]->buffer), seq);
+
+   /* VBO index buffer, whether or not this draw is indexed, as later
+    * draws sharing the tags may be */
+   if (ctx->index_buffer.buffer && !ctx->index_buffer.user_buffer)
+      swr_resource_read(pipe, swr_resource(ctx->index_buffer.buffer), seq);
 
    /* texture sampler views */
    for (uint32_t i = 0; i < PIPE_MAX_SHADER_SAMPLER_VIEWS; i++) {
       struct pipe_sampler_view *view =
          ctx->sampler_views[PIPE_SHADER_FRAGMENT][i];
       if (view)
-         swr_resource_read(pipe, swr_resource(view->texture));
+         swr_resource_read(pipe, swr_resource(view->texture), seq);
+
+      view = ctx->gs ? ctx->sampler_views[PIPE_SHADER_GEOMETRY][i] : NULL;
+      if (view)
+         swr_resource_read(pipe, swr_resource(view->texture), seq);
+
+      view = ctx->tes && ctx->tcs ?
+         ctx->sampler_views[PIPE_SHADER_TESS_CTRL][i] : NULL;
+      if (view)
+         swr_resource_read(pipe, swr_resource(view->texture), seq);
+
+      view = ctx->tes ? ctx->sampler_views[PIPE_SHADER_TESS_EVAL][i] : NULL;
+      if (view)
+         swr_resource_read(pipe, swr_resource(view->texture), seq);
+   }
+
+   /* constant buffers */
+   for (uint32_t i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
+      struct pipe_constant_buffer *cb =
+         &ctx->constants[PIPE_SHADER_VERTEX][i];
+      if (cb->buffer)
+         swr_resource_read(pipe, swr_resource(cb->buffer), seq);
+
+      cb = &ctx->constants[PIPE_SHADER_FRAGMENT][i];
+      if (cb->buffer)
+         swr_resource_read(pipe, swr_resource(cb->buffer), seq);
+
+      cb = &ctx->constants[PIPE_SHADER_GEOMETRY][i];
+      if (ctx->gs && cb->buffer)
+         swr_resource_read(pipe, swr_resource(cb->buffer), seq);
+
+      cb = &ctx->constants[PIPE_SHADER_TESS_CTRL][i];
+      if (ctx->tes && ctx->tcs && cb->buffer)
+         swr_resource_read(pipe, swr_resource(cb->buffer), seq);
+
+      cb = &ctx->constants[PIPE_SHADER_TESS_EVAL][i];
+      if (ctx->tes && cb->buffer)
+         swr_resource_read(pipe, swr_resource(cb->buffer), seq);
    }
 }
 
+/*
+ * Point the jitted shader at the constant buffers bound to a stage, copying
+ * user buffers to scratch space.
+ */
+void
+swr_update_jit_constants(struct swr_context *ctx,
+                         unsigned shader_type,
+                         const float **constants,
+                         unsigned *num_constants,
+                         struct swr_scratch_space *scratch)
+{
+   for (UINT i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
+      const pipe_constant_buffer *cb = &ctx->constants[shader_type][i];
+      num_constants[i] = cb->buffer_size;
+      if (cb->buffer)
+         constants[i] = (const float *)(
+            (const BYTE *)swr_resource_data(cb->buffer) + cb->buffer_offset);
+      else {
+         /* Need to copy these constants to scratch space */
+         if (cb->user_buffer && cb->buffer_size) {
+            const void *ptr =
+               ((const BYTE *)cb->user_buffer + cb->buffer_offset);
+            uint32_t size = AlignUp(cb->buffer_size, 4);
+            ptr = swr_copy_to_scratch_space(ctx, scratch, ptr, size);
+            constants[i] = (const float *)ptr;
+         }
+      }
+   }
+}
+
+void
+swr_update_jit_samplers(struct swr_context *ctx,
+                        unsigned shader_type,
+                        unsigned num_samplers,
+                        struct swr_jit_sampler *samplers)
+{
+   for (unsigned i = 0; i < num_samplers; i++) {
+      const struct pipe_sampler_state *sampler =
+         ctx->samplers[shader_type][i];
+
+      if (sampler) {
+         samplers[i].min_lod = sampler->min_lod;
+         samplers[i].max_lod = sampler->max_lod;
+         samplers[i].lod_bias = sampler->lod_bias;
+         COPY_4V(samplers[i].border_color, sampler->border_color.f);
+      }
+   }
+}
+
+void
+swr_update_jit_textures(struct swr_context *ctx,
+                        unsigned shader_type,
+                        unsigned num_sampler_views,
+                        struct swr_jit_texture *textures)
+{
+   for (unsigned i = 0; i < num_sampler_views; i++) {
+      struct pipe_sampler_view *view = ctx->sampler_views[shader_type][i];
+
+      if (view) {
+         struct pipe_resource *res = view->texture;
+         struct swr_resource *swr_res = swr_resource(res);
+         struct swr_jit_texture *jit_tex = &textures[i];
+         memset(jit_tex, 0, sizeof(*jit_tex));
+         jit_tex->width = res->width0;
+         jit_tex->height = res->height0;
+         jit_tex->depth = res->depth0;
+         jit_tex->first_level = view->u.tex.first_level;
+         jit_tex->last_level = view->u.tex.last_level;
+         jit_tex->base_ptr = swr_res->swr.pBaseAddress;
+
+         for (unsigned level = jit_tex->first_level;
+              level <= jit_tex->last_level;
+              level++) {
+            jit_tex->row_stride[level] = swr_res->row_stride[level];
+            jit_tex->img_stride[level] = swr_res->img_stride[level];
+            jit_tex->mip_offsets[level] = swr_res->mip_offsets[level];
+         }
+      }
+   }
+}
+
+/*
+ * Look up a fragment shader variant, compiling it on first use.
+ */
+static PFN_PIXEL_KERNEL
+swr_get_fs_variant(struct swr_context *ctx, swr_jit_key &key)
+{
+   auto search = ctx->fs->map.find(key);
+   if (search != ctx->fs->map.end())
+      return search->second;
+
+   PFN_PIXEL_KERNEL func = swr_compile_fs(ctx, key);
+   ctx->fs->map.insert(std::make_pair(key, func));
+   return func;
+}
+
+/*
+ * Look up a geometry shader variant, compiling it on first use.
+ */
+static PFN_GS_FUNC
+swr_get_gs_variant(struct swr_context *ctx, swr_jit_gs_key &key)
+{
+   auto search = ctx->gs->map.find(key);
+   if (search != ctx->gs->map.end())
+      return search->second;
+
+   PFN_GS_FUNC func = swr_compile_gs(ctx, key);
+   ctx->gs->map.insert(std::make_pair(key, func));
+   return func;
+}
+
+/*
+ * Look up a control shader variant, compiling it on first use.  Pass
+ * through variants belong to the evaluation shader.
+ */
+static PFN_HS_FUNC
+swr_get_hs_variant(struct swr_context *ctx, swr_jit_tcs_key &key)
+{
+   auto &map = ctx->tcs ? ctx->tcs->map : ctx->tes->hs_map;
+   auto search = map.find(key);
+   if (search != map.end())
+      return search->second;
+
+   PFN_HS_FUNC func = swr_compile_hs(ctx, key);
+   map.insert(std::make_pair(key, func));
+   return func;
+}
+
+/*
+ * Look up an evaluation shader variant, compiling it on first use.
+ */
+static PFN_DS_FUNC
+swr_get_ds_variant(struct swr_context *ctx, swr_jit_tes_key &key)
+{
+   auto search = ctx->tes->map.find(key);
+   if (search != ctx->tes->map.end())
+      return search->second;
+
+   PFN_DS_FUNC func = swr_compile_ds(ctx, key);
+   ctx->tes->map.insert(std::make_pair(key, func));
+   return func;
+}
+
+/*
+ * Blend JIT key for a render target.  Format is left as 0 (unused) for
+ * unbound color buffers.
+ */
+static void
+swr_generate_blend_compile_state(BLEND_COMPILE_STATE &compileState,
+                                 struct swr_context *ctx,
+                                 unsigned target)
+{
+   struct pipe_framebuffer_state *fb = &ctx->framebuffer;
+
+   memset(&compileState, 0, sizeof(compileState));
+   if (target < fb->nr_cbufs && fb->cbufs[target])
+      compileState.format =
+         swr_resource(fb->cbufs[target]->texture)->swr.format;
+   memcpy(&compileState.blendState,
+          &ctx->blend->compileState[target],
+          sizeof(compileState.blendState));
+
+   compileState.desc.alphaTestEnable =
+      ctx->depth_stencil->alpha.enabled;
+   compileState.desc.independentAlphaBlendEnable =
+      ctx->blend->pipe.independent_blend_enable;
+   compileState.desc.alphaToCoverageEnable =
+      ctx->blend->pipe.alpha_to_coverage;
+   unsigned num_samples = util_framebuffer_get_num_samples(fb);
+   unsigned all_samples = (1 << num_samples) - 1;
+   compileState.desc.sampleMaskEnable =
+      num_samples > 1 && (ctx->sample_mask & all_samples) != all_samples;
+   compileState.desc.numSamples = num_samples;
+
+   compileState.alphaTestFunction =
+      swr_convert_depth_func(ctx->depth_stencil->alpha.func);
+   compileState.alphaTestFormat = ALPHA_TEST_FLOAT32; // xxx
+}
+
 void
 swr_update_derived(struct pipe_context *pipe,
                    const struct pipe_draw_info *p_draw_info)
@@ -690,6 +1210,7 @@ swr_update_derived(struct pipe_context *pipe,
    if (ctx->dirty & SWR_NEW_FRAMEBUFFER) {
       struct pipe_framebuffer_state *fb = &ctx->framebuffer;
       SWR_SURFACE_STATE *new_attachment[SWR_NUM_ATTACHMENTS] = {0};
+      struct pipe_resource *new_resource[SWR_NUM_ATTACHMENTS] = {0};
       UINT i;
 
       /* colorbuffer targets */
@@ -699,6 +1220,7 @@ swr_update_derived(struct pipe_context *pipe,
                struct swr_resource *colorBuffer =
                   swr_resource(fb->cbufs[i]->texture);
                new_attachment[SWR_ATTACHMENT_COLOR0 + i] = &colorBuffer->swr;
+               new_resource[SWR_ATTACHMENT_COLOR0 + i] = &colorBuffer->base;
             }
 
       /* depth/stencil target */
@@ -707,18 +1229,26 @@ swr_update_derived(struct pipe_context *pipe,
             swr_resource(fb->zsbuf->texture);
          if (depthStencilBuffer->has_depth) {
             new_attachment[SWR_ATTACHMENT_DEPTH] = &depthStencilBuffer->swr;
+            new_resource[SWR_ATTACHMENT_DEPTH] = &depthStencilBuffer->base;
 
-            if (depthStencilBuffer->has_stencil)
+            if (depthStencilBuffer->has_stencil) {
                new_attachment[SWR_ATTACHMENT_STENCIL] =
                   &depthStencilBuffer->secondary;
+               new_resource[SWR_ATTACHMENT_STENCIL] =
+                  &depthStencilBuffer->base;
+            }
 
-         } else if (depthStencilBuffer->has_stencil)
+         } else if (depthStencilBuffer->has_stencil) {
             new_attachment[SWR_ATTACHMENT_STENCIL] = &depthStencilBuffer->swr;
+            new_resource[SWR_ATTACHMENT_STENCIL] = &depthStencilBuffer->base;
+         }
       }
 
       /* Make the attachment updates */
       swr_draw_context *pDC = &ctx->swrDC;
       SWR_SURFACE_STATE *renderTargets = pDC->renderTargets;
+      SWR_SURFACE_STATE *resolveTargets = pDC->resolveTargets;
+      struct pipe_resource *stored[SWR_NUM_ATTACHMENTS] = {0};
       unsigned need_fence = FALSE;
       for (i = 0; i < SWR_NUM_ATTACHMENTS; i++) {
          void *new_base = nullptr;
@@ -734,10 +1264,15 @@ swr_update_derived(struct pipe_context *pipe,
                 * won't try to load from non-existent target. */
                enum SWR_TILE_STATE post_state = (new_attachment[i]
                   ? SWR_TILE_INVALID : SWR_TILE_RESOLVED);
-               swr_store_render_target(pipe, i, post_state);
+               swr_store_render_target(pipe, i, post_state, NULL);
 
+               /* Keep the old target until the StoreTiles has retired */
+               stored[i] = ctx->derived.attachments[i];
+               ctx->derived.attachments[i] = NULL;
                need_fence |= TRUE;
             }
+            pipe_resource_reference(&ctx->derived.attachments[i],
+                                    new_resource[i]);
 
             /* Make new attachment */
             if (new_attachment[i])
@@ -745,13 +1280,41 @@ swr_update_derived(struct pipe_context *pipe,
             else
                if (renderTargets[i].pBaseAddress)
                   renderTargets[i] = {0};
+
+            /* Multisampled color attachments resolve as they are stored */
+            if (i <= SWR_ATTACHMENT_COLOR7) {
+               struct pipe_resource *resolve = nullptr;
+               if (new_attachment[i])
+                  resolve = swr_resource(fb->cbufs[i]->texture)->resolve_target;
+               if (resolve)
+                  resolveTargets[i] = swr_resource(resolve)->swr;
+               else
+                  resolveTargets[i] = {0};
+            }
          }
       }
 
-      /* This fence ensures any attachment changes are resolved before the
-       * next draw */
-      if (need_fence)
-         swr_fence_submit(ctx, screen->flush_fence);
+      /* Color load/store tile kernels for the new attachments */
+      for (i = 0; i < SWR_NUM_RENDERTARGETS; i++) {
+         pDC->pfnLoadTile[i] = NULL;
+         pDC->pfnStoreTile[i] = NULL;
+         if (KNOB_JIT_LOAD_STORE_TILES && renderTargets[i].pBaseAddress)
+            swr_get_tile_jit(screen, &renderTargets[i],
+                             &pDC->pfnLoadTile[i], &pDC->pfnStoreTile[i]);
+      }
+
+      /* This sync retires the StoreTiles of the old targets.  The core
+       * orders them ahead of later draws touching the same tiles, so only
+       * CPU access to the old targets has to wait for it. */
+      if (need_fence) {
+         swr_fence_submit(ctx, ctx->fence);
+         for (i = 0; i < SWR_NUM_ATTACHMENTS; i++) {
+            if (stored[i])
+               swr_resource_read(pipe, swr_resource(stored[i]),
+                                 swr_fence(ctx->fence)->write);
+            pipe_resource_reference(&stored[i], NULL);
+         }
+      }
    }
 
    /* Raster state */
@@ -778,12 +1341,27 @@ swr_update_derived(struct pipe_context *pipe,
       rastState->pointSpriteTopOrigin =
          rasterizer->sprite_coord_mode == PIPE_SPRITE_COORD_UPPER_LEFT;
 
-      /* XXX TODO: Add multisample */
-      rastState->msaaRastEnable = false;
-      rastState->rastMode = SWR_MSAA_RASTMODE_OFF_PIXEL;
-      rastState->sampleCount = SWR_MULTISAMPLE_1X;
+      /* Hot tiles hold as many samples as the framebuffer.  With
+       * multisample rasterization off, all samples are covered from the
+       * pixel center. */
+      unsigned num_samples = util_framebuffer_get_num_samples(fb);
+      rastState->msaaRastEnable = rasterizer->multisample && num_samples > 1;
+      rastState->rastMode = rastState->msaaRastEnable
+         ? SWR_MSAA_RASTMODE_ON_PATTERN
+         : SWR_MSAA_RASTMODE_OFF_PIXEL;
+      rastState->sampleCount =
+         (SWR_MULTISAMPLE_COUNT)util_logbase2(num_samples);
+      rastState->samplePattern = rastState->msaaRastEnable
+         ? SWR_MSAA_STANDARD_PATTERN
+         : SWR_MSAA_CENTER_PATTERN;
       rastState->bForcedSampleCount = false;
 
+      /* Conservative coverage is computed once per pixel and broadcast to
+       * all samples, as for the center pattern */
+      rastState->conservativeRast = rasterizer->conservative_raster;
+      if (rastState->conservativeRast)
+         rastState->samplePattern = SWR_MSAA_CENTER_PATTERN;
+
       bool do_offset = false;
       switch (rasterizer->fill_front) {
       case PIPE_POLYGON_MODE_FILL:
@@ -978,23 +1556,147 @@ swr_update_derived(struct pipe_context *pipe,
       SwrSetVertexFunc(ctx->swrContext, ctx->vs->func);
    }
 
+   /* Tessellation, only with an evaluation shader bound */
+   if (ctx->dirty & (SWR_NEW_TS | SWR_NEW_VS | SWR_NEW_SAMPLER
+                     | SWR_NEW_SAMPLER_VIEW | SWR_NEW_FRAMEBUFFER)) {
+      if (ctx->tes) {
+         const struct tgsi_shader_info *vs_info = &ctx->vs->info.base;
+         unsigned vertices_in = MAX2(ctx->patch_vertices, 1);
+         unsigned vertices_out =
+            ctx->tcs ? ctx->tcs->vertices_out : vertices_in;
+
+         swr_jit_tcs_key tcsKey;
+         memset(&tcsKey, 0, sizeof(tcsKey));
+         swr_generate_tcs_key(tcsKey, ctx, ctx->tcs, vertices_in);
+         PFN_HS_FUNC hsFunc = swr_get_hs_variant(ctx, tcsKey);
+
+         swr_jit_tes_key tesKey;
+         memset(&tesKey, 0, sizeof(tesKey));
+         swr_generate_tes_key(tesKey, ctx, ctx->tes, vertices_out);
+         PFN_DS_FUNC dsFunc = swr_get_ds_variant(ctx, tesKey);
+
+         /* the core assembles the VS output slots after position, point
+          * size lives in its own slot at the end */
+         SWR_TS_STATE tsState = ctx->tes->tsState;
+         tsState.numHsInputAttribs = vs_info->num_outputs
+            ? vs_info->num_outputs - 1 : 0;
+         tsState.numHsOutputAttribs = tesKey.tcs_num_outputs;
+         tsState.numDsOutputAttribs = ctx->tes->info.base.num_outputs;
+         for (unsigned i = 0; i < vs_info->num_outputs; i++) {
+            if (vs_info->output_semantic_name[i] == TGSI_SEMANTIC_PSIZE)
+               tsState.numHsInputAttribs = VERTEX_POINT_SIZE_SLOT;
+         }
+         for (unsigned i = 0; i < ctx->tes->info.base.num_outputs; i++) {
+            if (ctx->tes->info.base.output_semantic_name[i]
+                == TGSI_SEMANTIC_PSIZE)
+               tsState.numDsOutputAttribs = VERTEX_POINT_SIZE_SLOT + 1;
+         }
+         SwrSetTsState(ctx->swrContext, &tsState);
+         SwrSetHsFunc(ctx->swrContext, hsFunc);
+         SwrSetDsFunc(ctx->swrContext, dsFunc);
+
+         if (ctx->tcs) {
+            swr_update_jit_samplers(ctx, PIPE_SHADER_TESS_CTRL,
+                                    tcsKey.nr_samplers,
+                                    ctx->swrDC.samplersTCS);
+            swr_update_jit_textures(ctx, PIPE_SHADER_TESS_CTRL,
+                                    tcsKey.nr_sampler_views,
+                                    ctx->swrDC.texturesTCS);
+         }
+         swr_update_jit_samplers(ctx, PIPE_SHADER_TESS_EVAL,
+                                 tesKey.nr_samplers,
+                                 ctx->swrDC.samplersTES);
+         swr_update_jit_textures(ctx, PIPE_SHADER_TESS_EVAL,
+                                 tesKey.nr_sampler_views,
+                                 ctx->swrDC.texturesTES);
+      } else {
+         SWR_TS_STATE tsState = {0};
+         SwrSetTsState(ctx->swrContext, &tsState);
+         SwrSetHsFunc(ctx->swrContext, NULL);
+         SwrSetDsFunc(ctx->swrContext, NULL);
+      }
+   }
+
+   /* GeometryShader */
+   if (ctx->dirty & (SWR_NEW_GS | SWR_NEW_VS | SWR_NEW_TS | SWR_NEW_SAMPLER
+                     | SWR_NEW_SAMPLER_VIEW | SWR_NEW_FRAMEBUFFER)) {
+      if (ctx->gs) {
+         swr_jit_gs_key key;
+         memset(&key, 0, sizeof(key));
+         swr_generate_gs_key(key, ctx, ctx->gs);
+         PFN_GS_FUNC func = swr_get_gs_variant(ctx, key);
+
+         /* the core assembles the VS, or TES, output slots after
+          * position */
+         const struct tgsi_shader_info *prev_info =
+            ctx->tes ? &ctx->tes->info.base : &ctx->vs->info.base;
+         SWR_GS_STATE gsState = ctx->gs->gsState;
+         gsState.numInputAttribs = prev_info->num_outputs
+            ? prev_info->num_outputs - 1 : 0;
+         SwrSetGsState(ctx->swrContext, &gsState);
+         SwrSetGsFunc(ctx->swrContext, func);
+
+         swr_update_jit_samplers(ctx, PIPE_SHADER_GEOMETRY, key.nr_samplers,
+                                 ctx->swrDC.samplersGS);
+         swr_update_jit_textures(ctx, PIPE_SHADER_GEOMETRY,
+                                 key.nr_sampler_views,
+                                 ctx->swrDC.texturesGS);
+      } else {
+         SWR_GS_STATE gsState = {0};
+         SwrSetGsState(ctx->swrContext, &gsState);
+         SwrSetGsFunc(ctx->swrContext, NULL);
+      }
+   }
+
+   /* FragmentShader Constants */
+   if (ctx->dirty & SWR_NEW_FSCONSTANTS) {
+      swr_draw_context *pDC = &ctx->swrDC;
+      swr_update_jit_constants(ctx, PIPE_SHADER_FRAGMENT, pDC->constantFS,
+                               pDC->num_constantsFS,
+                               &ctx->scratch->fs_constants);
+   }
+
+   /* Constant specialization may swap the pixel shader variant */
+   if (KNOB_FS_SPECIALIZE_FRAMES && swr_update_fs_specialization(ctx))
+      ctx->dirty |= SWR_NEW_FS;
+
    swr_jit_key key;
-   if (ctx->dirty & (SWR_NEW_FS | SWR_NEW_SAMPLER | SWR_NEW_SAMPLER_VIEW
-                     | SWR_NEW_RASTERIZER | SWR_NEW_FRAMEBUFFER)) {
+   if (ctx->dirty & (SWR_NEW_FS | SWR_NEW_GS | SWR_NEW_TS | SWR_NEW_SAMPLER
+                     | SWR_NEW_SAMPLER_VIEW
+                     | SWR_NEW_RASTERIZER | SWR_NEW_FRAMEBUFFER
+                     | SWR_NEW_DEPTH_STENCIL_ALPHA)) {
       memset(&key, 0, sizeof(key));
       swr_generate_fs_key(key, ctx, ctx->fs);
-      auto search = ctx->fs->map.find(key);
-      PFN_PIXEL_KERNEL func;
-      if (search != ctx->fs->map.end()) {
-         func = search->second;
-      } else {
-         func = swr_compile_fs(ctx, key);
-         ctx->fs->map.insert(std::make_pair(key, func));
+      PFN_PIXEL_KERNEL func = swr_get_fs_variant(ctx, key);
+
+      /* Constant specialized variant, compiled in the background */
+      if (ctx->fs->spec_id) {
+         swr_jit_key spec_key = key;
+         spec_key.const_id = ctx->fs->spec_id;
+         auto search = ctx->fs->map.find(spec_key);
+         if (search != ctx->fs->map.end())
+            func = search->second;
+         else
+            swr_queue_fs_specialization(ctx, spec_key);
       }
+
+      /* Raster tile kernel, the per quad kernel stays as fallback */
+      PFN_PIXEL_TILE_KERNEL tileFunc = NULL;
+      if (KNOB_JIT_OUTPUT_MERGER && KNOB_JIT_PIXEL_TILE_KERNEL) {
+         swr_jit_key tileKey = key;
+         swr_generate_fs_tile_key(tileKey, ctx, ctx->fs);
+         tileFunc = (PFN_PIXEL_TILE_KERNEL)swr_get_fs_variant(ctx, tileKey);
+      }
+
       SWR_PS_STATE psState = {0};
       psState.pfnPixelShader = func;
+      psState.pfnPixelTileShader = tileFunc;
       psState.killsPixel = ctx->fs->info.base.uses_kill;
-      psState.inputCoverage = SWR_INPUT_COVERAGE_NORMAL;
+      /* The sample mask input is the inner coverage when conservative */
+      psState.inputCoverage =
+         ctx->fs->info.base.reads_samplemask && ctx->rasterizer->conservative_raster
+         ? SWR_INPUT_COVERAGE_INNER_CONSERVATIVE
+         : SWR_INPUT_COVERAGE_NORMAL;
       psState.writesODepth = ctx->fs->info.base.writes_z;
       psState.usesSourceDepth = ctx->fs->info.base.reads_z;
       psState.shadingRate = SWR_SHADING_RATE_PIXEL; // XXX
@@ -1030,112 +1732,52 @@ swr_update_derived(struct pipe_context *pipe,
       psState.barycentricsMask = barycentricsMask;
       psState.usesUAV = false; // XXX
       psState.forceEarlyZ = false;
+      /* Without inputs or system values every pixel shades the same,
+       * single pixel points can shade once per batch */
+      psState.constantOutput = ctx->fs->info.base.num_inputs == 0
+         && ctx->fs->info.base.num_system_values == 0
+         && !ctx->fs->info.base.uses_kill
+         && !ctx->fs->info.base.writes_z;
       SwrSetPixelShaderState(ctx->swrContext, &psState);
+      ctx->derived.psState = psState;
    }
 
    /* JIT sampler state */
    if (ctx->dirty & SWR_NEW_SAMPLER) {
-      swr_draw_context *pDC = &ctx->swrDC;
-
-      for (unsigned i = 0; i < key.nr_samplers; i++) {
-         const struct pipe_sampler_state *sampler =
-            ctx->samplers[PIPE_SHADER_FRAGMENT][i];
-
-         if (sampler) {
-            pDC->samplersFS[i].min_lod = sampler->min_lod;
-            pDC->samplersFS[i].max_lod = sampler->max_lod;
-            pDC->samplersFS[i].lod_bias = sampler->lod_bias;
-            COPY_4V(pDC->samplersFS[i].border_color, sampler->border_color.f);
-         }
-      }
+      swr_update_jit_samplers(ctx, PIPE_SHADER_FRAGMENT, key.nr_samplers,
+                              ctx->swrDC.samplersFS);
    }
 
    /* JIT sampler view state */
    if (ctx->dirty & (SWR_NEW_SAMPLER_VIEW | SWR_NEW_FRAMEBUFFER)) {
-      swr_draw_context *pDC = &ctx->swrDC;
-
-      for (unsigned i = 0; i < key.nr_sampler_views; i++) {
-         struct pipe_sampler_view *view =
-            ctx->sampler_views[PIPE_SHADER_FRAGMENT][i];
-
-         if (view) {
-            struct pipe_resource *res = view->texture;
-            struct swr_resource *swr_res = swr_resource(res);
-            struct swr_jit_texture *jit_tex = &pDC->texturesFS[i];
-            memset(jit_tex, 0, sizeof(*jit_tex));
-            jit_tex->width = res->width0;
-            jit_tex->height = res->height0;
-            jit_tex->depth = res->depth0;
-            jit_tex->first_level = view->u.tex.first_level;
-            jit_tex->last_level = view->u.tex.last_level;
-            jit_tex->base_ptr = swr_res->swr.pBaseAddress;
-
-            for (unsigned level = jit_tex->first_level;
-                 level <= jit_tex->last_level;
-                 level++) {
-               jit_tex->row_stride[level] = swr_res->row_stride[level];
-               jit_tex->img_stride[level] = swr_res->img_stride[level];
-               jit_tex->mip_offsets[level] = swr_res->mip_offsets[level];
-            }
-         }
-      }
+      swr_update_jit_textures(ctx, PIPE_SHADER_FRAGMENT, key.nr_sampler_views,
+                              ctx->swrDC.texturesFS);
    }
 
-   /* VertexShader Constants */
+   /* VertexShader and GeometryShader Constants */
    if (ctx->dirty & SWR_NEW_VSCONSTANTS) {
       swr_draw_context *pDC = &ctx->swrDC;
-
-      for (UINT i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
-         const pipe_constant_buffer *cb =
-            &ctx->constants[PIPE_SHADER_VERTEX][i];
-         pDC->num_constantsVS[i] = cb->buffer_size;
-         if (cb->buffer)
-            pDC->constantVS[i] =
-               (const float *)((const BYTE *)cb->buffer + cb->buffer_offset);
-         else {
-            /* Need to copy these constants to scratch space */
-            if (cb->user_buffer && cb->buffer_size) {
-               const void *ptr =
-                  ((const BYTE *)cb->user_buffer + cb->buffer_offset);
-               uint32_t size = AlignUp(cb->buffer_size, 4);
-               ptr = swr_copy_to_scratch_space(
-                  ctx, &ctx->scratch->vs_constants, ptr, size);
-               pDC->constantVS[i] = (const float *)ptr;
-            }
-         }
-      }
-   }
-
-   /* FragmentShader Constants */
-   if (ctx->dirty & SWR_NEW_FSCONSTANTS) {
-      swr_draw_context *pDC = &ctx->swrDC;
-
-      for (UINT i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
-         const pipe_constant_buffer *cb =
-            &ctx->constants[PIPE_SHADER_FRAGMENT][i];
-         pDC->num_constantsFS[i] = cb->buffer_size;
-         if (cb->buffer)
-            pDC->constantFS[i] =
-               (const float *)((const BYTE *)cb->buffer + cb->buffer_offset);
-         else {
-            /* Need to copy these constants to scratch space */
-            if (cb->user_buffer && cb->buffer_size) {
-               const void *ptr =
-                  ((const BYTE *)cb->user_buffer + cb->buffer_offset);
-               uint32_t size = AlignUp(cb->buffer_size, 4);
-               ptr = swr_copy_to_scratch_space(
-                  ctx, &ctx->scratch->fs_constants, ptr, size);
-               pDC->constantFS[i] = (const float *)ptr;
-            }
-         }
-      }
+      swr_update_jit_constants(ctx, PIPE_SHADER_VERTEX, pDC->constantVS,
+                               pDC->num_constantsVS,
+                               &ctx->scratch->vs_constants);
+      swr_update_jit_constants(ctx, PIPE_SHADER_GEOMETRY, pDC->constantGS,
+                               pDC->num_constantsGS,
+                               &ctx->scratch->gs_constants);
+      swr_update_jit_constants(ctx, PIPE_SHADER_TESS_CTRL, pDC->constantTCS,
+                               pDC->num_constantsTCS,
+                               &ctx->scratch->tcs_constants);
+      swr_update_jit_constants(ctx, PIPE_SHADER_TESS_EVAL, pDC->constantTES,
+                               pDC->num_constantsTES,
+                               &ctx->scratch->tes_constants);
    }
 
    /* Depth/stencil state */
    if (ctx->dirty & (SWR_NEW_DEPTH_STENCIL_ALPHA | SWR_NEW_FRAMEBUFFER)) {
       struct pipe_depth_state *depth = &(ctx->depth_stencil->depth);
       struct pipe_stencil_state *stencil = ctx->depth_stencil->stencil;
-      SWR_DEPTH_STENCIL_STATE depthStencilState = {{0}};
+      SWR_DEPTH_STENCIL_STATE &depthStencilState =
+         ctx->derived.depthStencilState;
+      memset(&depthStencilState, 0, sizeof(depthStencilState));
 
       /* XXX, incomplete.  Need to flesh out stencil & alpha test state
       struct pipe_stencil_state *front_stencil =
@@ -1199,9 +1841,10 @@ swr_update_derived(struct pipe_context *pipe,
       blendState.alphaTestReference =
          *((uint32_t*)&ctx->depth_stencil->alpha.ref_value);
 
-      // XXX MSAA
-      blendState.sampleMask = 0;
-      blendState.sampleCount = SWR_MULTISAMPLE_1X;
+      blendState.sampleMask = ctx->sample_mask;
+      blendState.sampleCount =
+         (SWR_MULTISAMPLE_COUNT)util_logbase2(
+            util_framebuffer_get_num_samples(fb));
 
       /* If there are no color buffers bound, disable writes on RT0
        * and skip loop */
@@ -1220,15 +1863,8 @@ swr_update_derived(struct pipe_context *pipe,
             if (!fb->cbufs[target])
                continue;
 
-            struct swr_resource *colorBuffer =
-               swr_resource(fb->cbufs[target]->texture);
-
             BLEND_COMPILE_STATE compileState;
-            memset(&compileState, 0, sizeof(compileState));
-            compileState.format = colorBuffer->swr.format;
-            memcpy(&compileState.blendState,
-                   &ctx->blend->compileState[target],
-                   sizeof(compileState.blendState));
+            swr_generate_blend_compile_state(compileState, ctx, target);
 
             if (compileState.blendState.blendEnable == false &&
                 compileState.blendState.logicOpEnable == false) {
@@ -1236,19 +1872,6 @@ swr_update_derived(struct pipe_context *pipe,
                continue;
             }
 
-            compileState.desc.alphaTestEnable =
-               ctx->depth_stencil->alpha.enabled;
-            compileState.desc.independentAlphaBlendEnable =
-               ctx->blend->pipe.independent_blend_enable;
-            compileState.desc.alphaToCoverageEnable =
-               ctx->blend->pipe.alpha_to_coverage;
-            compileState.desc.sampleMaskEnable = 0; // XXX
-            compileState.desc.numSamples = 1; // XXX
-
-            compileState.alphaTestFunction =
-               swr_convert_depth_func(ctx->depth_stencil->alpha.func);
-            compileState.alphaTestFormat = ALPHA_TEST_FLOAT32; // xxx
-
             PFN_BLEND_JIT_FUNC func = NULL;
             auto search = ctx->blendJIT->find(compileState);
             if (search != ctx->blendJIT->end()) {
@@ -1267,16 +1890,75 @@ swr_update_derived(struct pipe_context *pipe,
       SwrSetBlendState(ctx->swrContext, &blendState);
    }
 
+   /* Fused output merger */
+   if (KNOB_JIT_OUTPUT_MERGER &&
+       (ctx->dirty & (SWR_NEW_BLEND |
+                      SWR_NEW_FRAMEBUFFER |
+                      SWR_NEW_DEPTH_STENCIL_ALPHA |
+                      SWR_NEW_FS))) {
+      struct pipe_framebuffer_state *fb = &ctx->framebuffer;
+      const SWR_PS_STATE *psState = &ctx->derived.psState;
+
+      OUTPUT_MERGER_COMPILE_STATE omState;
+      memset(&omState, 0, sizeof(omState));
+      omState.numRenderTargets = fb->nr_cbufs;
+
+      /* RT0 state also carries alpha test when no color buffer is bound */
+      swr_generate_blend_compile_state(omState.renderTarget[0], ctx, 0);
+      for (unsigned target = 0; target < fb->nr_cbufs; target++) {
+         if (!fb->cbufs[target])
+            continue;
+
+         const SWR_RENDER_TARGET_BLEND_STATE *rtBlend =
+            &ctx->blend->blendState.renderTarget[target];
+
+         swr_generate_blend_compile_state(
+            omState.renderTarget[target], ctx, target);
+         omState.writeMask[target] =
+            (rtBlend->writeDisableRed ? 0 : PIPE_MASK_R) |
+            (rtBlend->writeDisableGreen ? 0 : PIPE_MASK_G) |
+            (rtBlend->writeDisableBlue ? 0 : PIPE_MASK_B) |
+            (rtBlend->writeDisableAlpha ? 0 : PIPE_MASK_A);
+      }
+
+      omState.depthStencilState = ctx->derived.depthStencilState;
+      omState.forceEarlyZ = psState->forceEarlyZ;
+      /* the per-quad backend tests depth before the shader when it can */
+      omState.earlyZ = psState->forceEarlyZ ||
+         (!psState->writesODepth && !psState->usesSourceDepth &&
+          !psState->usesUAV);
+      PFN_OUTPUT_MERGER_JIT_FUNC func = swr_get_output_merger(ctx, omState);
+
+      /* the raster tile kernel only culls, depth is tested in its output
+       * merger.  The backend falls back to the per-quad path for some
+       * triangles, which keeps early-Z. */
+      PFN_OUTPUT_MERGER_JIT_FUNC tileFunc = NULL;
+      if (psState->pfnPixelTileShader) {
+         omState.earlyZ = false;
+         omState.forceEarlyZ = false;
+         tileFunc = swr_get_output_merger(ctx, omState);
+      }
+
+      SwrSetOutputMergerFunc(ctx->swrContext, func, tileFunc);
+   }
+
    if (ctx->dirty & SWR_NEW_STIPPLE) {
       /* XXX What to do with this one??? SWR doesn't stipple */
    }
 
-   if (ctx->dirty & (SWR_NEW_VS | SWR_NEW_SO | SWR_NEW_RASTERIZER)) {
-      ctx->vs->soState.rasterizerDisable =
-         ctx->rasterizer->rasterizer_discard;
-      SwrSetSoState(ctx->swrContext, &ctx->vs->soState);
+   /* Stream output and linkage come from the last stage before the
+    * rasterizer */
+   SWR_STREAMOUT_STATE *soState =
+      ctx->gs ? &ctx->gs->soState :
+      ctx->tes ? &ctx->tes->soState : &ctx->vs->soState;
+   pipe_stream_output_info *stream_output =
+      ctx->gs ? &ctx->gs->pipe.stream_output :
+      ctx->tes ? &ctx->tes->pipe.stream_output : &ctx->vs->pipe.stream_output;
 
-      pipe_stream_output_info *stream_output = &ctx->vs->pipe.stream_output;
+   if (ctx->dirty & (SWR_NEW_VS | SWR_NEW_GS | SWR_NEW_TS | SWR_NEW_SO
+                     | SWR_NEW_RASTERIZER)) {
+      soState->rasterizerDisable = ctx->rasterizer->rasterizer_discard;
+      SwrSetSoState(ctx->swrContext, soState);
 
       for (uint32_t i = 0; i < ctx->num_so_targets; i++) {
          SWR_STREAMOUT_BUFFER buffer = {0};
@@ -1293,9 +1975,20 @@ swr_update_derived(struct pipe_context *pipe,
       }
    }
 
-   uint32_t linkage = ctx->vs->linkageMask;
-   if (ctx->rasterizer->sprite_coord_enable)
-      linkage |= (1 << ctx->vs->info.base.num_outputs);
+   uint32_t linkage;
+   if (ctx->gs) {
+      linkage = ctx->gs->linkageMask;
+      if (ctx->rasterizer->sprite_coord_enable)
+         linkage |= (1 << ctx->gs->info.base.num_outputs);
+   } else if (ctx->tes) {
+      linkage = ctx->tes->linkageMask;
+      if (ctx->rasterizer->sprite_coord_enable)
+         linkage |= (1 << ctx->tes->info.base.num_outputs);
+   } else {
+      linkage = ctx->vs->linkageMask;
+      if (ctx->rasterizer->sprite_coord_enable)
+         linkage |= (1 << ctx->vs->info.base.num_outputs);
+   }
 
    SwrSetLinkage(ctx->swrContext, linkage, NULL);
 
@@ -1312,13 +2005,6 @@ swr_update_derived(struct pipe_context *pipe,
 
    SwrSetBackendState(ctx->swrContext, &backendState);
 
-   /* Ensure that any in-progress attachment change StoreTiles finish */
-   if (swr_is_fence_pending(screen->flush_fence))
-      swr_fence_finish(pipe->screen, screen->flush_fence, 0);
-
-   /* Finally, update the in-use status of all resources involved in draw */
-   swr_update_resource_status(pipe, p_draw_info);
-
    ctx->dirty = post_update_dirty_flags;
 }
 
@@ -1406,6 +2092,20 @@ swr_state_init(struct pipe_context *pipe)
    pipe->bind_vs_state = swr_bind_vs_state;
    pipe->delete_vs_state = swr_delete_vs_state;
 
+   pipe->create_tcs_state = swr_create_tcs_state;
+   pipe->bind_tcs_state = swr_bind_tcs_state;
+   pipe->delete_tcs_state = swr_delete_tcs_state;
+
+   pipe->create_tes_state = swr_create_tes_state;
+   pipe->bind_tes_state = swr_bind_tes_state;
+   pipe->delete_tes_state = swr_delete_tes_state;
+
+   pipe->set_tess_state = swr_set_tess_state;
+
+   pipe->create_gs_state = swr_create_gs_state;
+   pipe->bind_gs_state = swr_bind_gs_state;
+   pipe->delete_gs_state = swr_delete_gs_state;
+
    pipe->create_fs_state = swr_create_fs_state;
    pipe->bind_fs_state = swr_bind_fs_state;
    pipe->delete_fs_state = swr_delete_fs_state;
@@ -34,6 +34,9 @@
 #include "swr_tex_sample.h"
 #include "swr_shader.h"
 #include <unordered_map>
+#include <future>
+#include <memory>
+#include <vector>
 
 /* skeleton */
 struct swr_vertex_shader {
@@ -45,12 +48,68 @@ struct swr_vertex_shader {
    PFN_SO_FUNC soFunc[PIPE_PRIM_MAX];
 };
 
+struct swr_tess_ctrl_shader {
+   struct pipe_shader_state pipe;
+   struct lp_tgsi_info info;
+   unsigned vertices_out;
+   std::unordered_map<swr_jit_tcs_key, PFN_HS_FUNC> map;
+};
+
+struct swr_tess_eval_shader {
+   struct pipe_shader_state pipe;
+   struct lp_tgsi_info info;
+   unsigned linkageMask;
+   unsigned output_prim; /* PIPE_PRIM_x the tessellator emits */
+   SWR_TS_STATE tsState;
+   SWR_STREAMOUT_STATE soState;
+   PFN_SO_FUNC soFunc[PIPE_PRIM_MAX];
+   std::unordered_map<swr_jit_tes_key, PFN_DS_FUNC> map;
+
+   /* pass through control shaders for drawing without a TCS */
+   std::unordered_map<swr_jit_tcs_key, PFN_HS_FUNC> hs_map;
+};
+
+struct swr_geometry_shader {
+   struct pipe_shader_state pipe;
+   struct lp_tgsi_info info;
+   unsigned linkageMask;
+   SWR_GS_STATE gsState;
+   SWR_STREAMOUT_STATE soState;
+   PFN_SO_FUNC soFunc[PIPE_PRIM_MAX];
+   std::unordered_map<swr_jit_gs_key, PFN_GS_FUNC> map;
+};
+
+/* Snapshot of the FS constant buffers a specialized variant folds in */
+struct swr_fs_constants {
+   unsigned id;
+   unsigned num_constants[PIPE_MAX_CONSTANT_BUFFERS]; /* bytes */
+   std::vector<float> data[PIPE_MAX_CONSTANT_BUFFERS];
+};
+
+/* Constant snapshots a shader gets specialized for before giving up */
+#define SWR_MAX_FS_SPECIALIZATIONS 8
+
 struct swr_fragment_shader {
    struct pipe_shader_state pipe;
    struct lp_tgsi_info info;
    uint32_t constantMask;
    uint32_t pointSpriteMask;
    std::unordered_map<swr_jit_key, PFN_PIXEL_KERNEL> map;
+
+   /* Constant specialization, see swr_update_fs_specialization() */
+   std::shared_ptr<swr_fs_constants> spec_constants;
+   unsigned spec_frame; /* screen frame spec_constants were first seen */
+   unsigned spec_stamp; /* context stamp last found to match them */
+   unsigned spec_id;    /* snapshot to use specialized variants of, or 0 */
+   unsigned spec_count;
+   std::future<std::pair<swr_jit_key, PFN_PIXEL_KERNEL>> spec_job;
+};
+
+struct swr_compute_shader {
+   struct pipe_shader_state pipe;
+   struct lp_tgsi_info info;
+   unsigned req_local_mem;
+   std::unordered_map<swr_jit_cs_key, PFN_CS_FUNC> map;
 };
 
 /* Vertex element state */
@@ -74,11 +133,33 @@ struct swr_derived_state {
    SWR_RASTSTATE rastState;
    SWR_VIEWPORT vp;
    SWR_VIEWPORT_MATRIX vpm;
+   SWR_PS_STATE psState;
+   SWR_DEPTH_STENCIL_STATE depthStencilState;
+
+   /* Resources of the attached render targets, referenced until their hot
+    * tiles have been stored on detach */
+   struct pipe_resource *attachments[SWR_NUM_ATTACHMENTS];
 };
 
 void swr_update_derived(struct pipe_context *,
                         const struct pipe_draw_info * = nullptr);
 
+void swr_update_jit_constants(struct swr_context *ctx,
+                              unsigned shader_type,
+                              const float **constants,
+                              unsigned *num_constants,
+                              struct swr_scratch_space *scratch);
+
+void swr_update_jit_samplers(struct swr_context *ctx,
+                             unsigned shader_type,
+                             unsigned num_samplers,
+                             struct swr_jit_sampler *samplers);
+
+void swr_update_jit_textures(struct swr_context *ctx,
+                             unsigned shader_type,
+                             unsigned num_sampler_views,
+                             struct swr_jit_texture *textures);
+
 /*
  * Conversion functions: Convert mesa state defines to SWR.
  */
@@ -72,6 +72,8 @@ struct swr_sampler_dynamic_state {
    struct lp_sampler_dynamic_state base;
 
    const struct swr_sampler_static_state *static_state;
+
+   unsigned shader_type; /* selects the swr_draw_context arrays */
 };
 
 
@@ -106,13 +108,31 @@ swr_texture_member(const struct lp_sampler_dynamic_state *base,
    LLVMValueRef indices[4];
    LLVMValueRef ptr;
    LLVMValueRef res;
+   unsigned shader_type =
+      ((const struct swr_sampler_dynamic_state *)base)->shader_type;
 
    assert(texture_unit < PIPE_MAX_SHADER_SAMPLER_VIEWS);
 
    /* context[0] */
    indices[0] = lp_build_const_int32(gallivm, 0);
    /* context[0].textures */
-   indices[1] = lp_build_const_int32(gallivm, swr_draw_context_texturesFS);
+   switch (shader_type) {
+   case PIPE_SHADER_GEOMETRY:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_texturesGS);
+      break;
+   case PIPE_SHADER_TESS_CTRL:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_texturesTCS);
+      break;
+   case PIPE_SHADER_TESS_EVAL:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_texturesTES);
+      break;
+   case PIPE_SHADER_COMPUTE:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_texturesCS);
+      break;
+   default:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_texturesFS);
+      break;
+   }
    /* context[0].textures[unit] */
    indices[2] = lp_build_const_int32(gallivm, texture_unit);
    /* context[0].textures[unit].member */
@@ -189,13 +209,31 @@ swr_sampler_member(const struct lp_sampler_dynamic_state *base,
    LLVMValueRef indices[4];
    LLVMValueRef ptr;
    LLVMValueRef res;
+   unsigned shader_type =
+      ((const struct swr_sampler_dynamic_state *)base)->shader_type;
 
    assert(sampler_unit < PIPE_MAX_SAMPLERS);
 
    /* context[0] */
    indices[0] = lp_build_const_int32(gallivm, 0);
    /* context[0].samplers */
-   indices[1] = lp_build_const_int32(gallivm, swr_draw_context_samplersFS);
+   switch (shader_type) {
+   case PIPE_SHADER_GEOMETRY:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_samplersGS);
+      break;
+   case PIPE_SHADER_TESS_CTRL:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_samplersTCS);
+      break;
+   case PIPE_SHADER_TESS_EVAL:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_samplersTES);
+      break;
+   case PIPE_SHADER_COMPUTE:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_samplersCS);
+      break;
+   default:
+      indices[1] = lp_build_const_int32(gallivm, swr_draw_context_samplersFS);
+      break;
+   }
    /* context[0].samplers[unit] */
    indices[2] = lp_build_const_int32(gallivm, sampler_unit);
    /* context[0].samplers[unit].member */
@@ -307,7 +345,8 @@ swr_sampler_soa_emit_size_query(const struct lp_build_sampler_soa *base,
 
 
 struct lp_build_sampler_soa *
-swr_sampler_soa_create(const struct swr_sampler_static_state *static_state)
+swr_sampler_soa_create(const struct swr_sampler_static_state *static_state,
+                       unsigned shader_type)
 {
    struct swr_sampler_soa *sampler;
 
@@ -333,6 +372,7 @@ swr_sampler_soa_create(const struct swr_sampler_static_state *static_state)
    sampler->dynamic_state.base.border_color = swr_sampler_border_color;
 
    sampler->dynamic_state.static_state = static_state;
+   sampler->dynamic_state.shader_type = shader_type;
 
    return &sampler->base;
 }
@@ -203,6 +203,7 @@ vc4_screen_get_param(struct pipe_screen *pscreen, enum pipe_cap param)
         case PIPE_CAP_SURFACE_REINTERPRET_BLOCKS:
         case PIPE_CAP_QUERY_BUFFER_OBJECT:
 	case PIPE_CAP_QUERY_MEMORY_INFO:
+	case PIPE_CAP_CONSERVATIVE_RASTER:
                 return 0;
 
                 /* Stream output. */
@@ -232,6 +232,7 @@ virgl_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_GENERATE_MIPMAP:
    case PIPE_CAP_SURFACE_REINTERPRET_BLOCKS:
    case PIPE_CAP_QUERY_BUFFER_OBJECT:
+   case PIPE_CAP_CONSERVATIVE_RASTER:
       return 0;
    case PIPE_CAP_VENDOR_ID:
       return 0x1af4;
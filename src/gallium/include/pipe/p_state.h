@@ -138,6 +138,15 @@ struct pipe_rasterizer_state
     */
    unsigned clip_halfz:1;
 
+   /**
+    * When true, triangles are rasterized conservatively: every pixel the
+    * triangle touches is covered, on all samples.  The fragment shader's
+    * SAMPLEMASK input then holds the inner coverage, bit 0 set for pixels
+    * the triangle covers completely.
+    * This depends on PIPE_CAP_CONSERVATIVE_RASTER.
+    */
+   unsigned conservative_raster:1;
+
    /**
     * Enable bits for clipping half-spaces.
     * This applies to both user clip planes and shader clip distances.